@@ -1,10 +1,11 @@
 #import <Foundation/Foundation.h>
 #import <AppSpecs/AppSpecs.h>
 #import <ReactCommon/RCTTurboModule.h>
+#import <ReactCommon/RCTTurboModuleWithJSIBindings.h>
 #import <AudioEngine.h>
 
 
-@interface AudioModule : NSObject <NativeAudioModuleSpec>
+@interface AudioModule : NSObject <NativeAudioModuleSpec, RCTTurboModuleWithJSIBindings>
 
 
 @property (nonatomic, assign) AudioEngine* audioEngine;
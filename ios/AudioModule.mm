@@ -2,7 +2,7 @@
 #import "AudioModule.h"
 #import "AudioEngine.h"
 #import "BaseOscillatorVoice.h"
-#import "MultiSamplerInstrument.h"
+#import "MultisamplerInstrument.h"
 #import "JuceInitializer.h"
 #import <Foundation/Foundation.h>
 
@@ -59,6 +59,199 @@
     return std::make_shared<facebook::react::NativeAudioModuleSpecJSI>(params);
 }
 
+// ────────────────────────────────────────────────
+// JSI Bindings
+// ────────────────────────────────────────────────
+
+// Note triggers for worklets on the UI thread. Worklets can't reach the
+// TurboModule, but a HostObject captured in one is handed to the UI runtime
+// as is, and get() builds its functions for whichever runtime asks. Notes go
+// straight into the engine's lock-free command queue stamped with the host
+// time of the call, so a pad sounds however busy the JS thread is.
+class WorkletNotesHostObject : public facebook::jsi::HostObject {
+public:
+    explicit WorkletNotesHostObject(AudioModule *module) : module(module) {}
+    
+    facebook::jsi::Value get(facebook::jsi::Runtime& rt, const facebook::jsi::PropNameID& name) override {
+        using namespace facebook;
+        const auto property = name.utf8(rt);
+        __weak AudioModule *weakModule = module;
+        
+        // noteOn(channel, note, velocity, hostTimeNs?) / noteOff(channel, note, hostTimeNs?)
+        if (property == "noteOn" || property == "noteOff") {
+            const bool isNoteOn = property == "noteOn";
+            return jsi::Function::createFromHostFunction(rt, name, isNoteOn ? 4 : 3,
+                [weakModule, isNoteOn](jsi::Runtime&, const jsi::Value&, const jsi::Value* args, size_t count) -> jsi::Value {
+                    const size_t minArgs = isNoteOn ? 3 : 2;
+                    if (count < minArgs) return jsi::Value(false);
+                    for (size_t i = 0; i < minArgs; ++i)
+                        if (!args[i].isNumber()) return jsi::Value(false);
+                    
+                    // Holding the module keeps dealloc from deleting the engine mid-call
+                    AudioModule *strongModule = weakModule;
+                    AudioEngine *engine = strongModule ? strongModule.audioEngine : nullptr;
+                    if (!engine) return jsi::Value(false);
+                    
+                    const int channel = static_cast<int>(args[0].getNumber());
+                    const int note = static_cast<int>(args[1].getNumber());
+                    const auto hostTimeNs = count > minArgs && args[minArgs].isNumber()
+                        ? static_cast<juce::uint64>(std::max(0.0, args[minArgs].getNumber()))
+                        : AudioEngine::getHostTimeNs();
+                    
+                    if (isNoteOn) {
+                        engine->scheduleNoteOn(channel, note, static_cast<float>(args[2].getNumber()), hostTimeNs);
+                    } else {
+                        engine->scheduleNoteOff(channel, note, hostTimeNs);
+                    }
+                    return jsi::Value(true);
+                });
+        }
+        
+        if (property == "getHostTimeNs") {
+            return jsi::Function::createFromHostFunction(rt, name, 0,
+                [](jsi::Runtime&, const jsi::Value&, const jsi::Value*, size_t) -> jsi::Value {
+                    return jsi::Value(static_cast<double>(AudioEngine::getHostTimeNs()));
+                });
+        }
+        
+        return jsi::Value::undefined();
+    }
+    
+    std::vector<facebook::jsi::PropNameID> getPropertyNames(facebook::jsi::Runtime& rt) override {
+        return facebook::jsi::PropNameID::names(rt, "noteOn", "noteOff", "getHostTimeNs");
+    }
+    
+private:
+    __weak AudioModule *module;
+};
+
+// The engine's telemetry block as JS sees it: the native words themselves,
+// not a copy. The buffer shares ownership of them, so it stays valid even if
+// the engine goes first.
+class TelemetryBuffer : public facebook::jsi::MutableBuffer {
+public:
+    explicit TelemetryBuffer(std::shared_ptr<EngineTelemetry::Block> block) : block(std::move(block)) {}
+    
+    size_t size() const override { return EngineTelemetry::getSizeInBytes(); }
+    uint8_t *data() override { return reinterpret_cast<uint8_t *>(block->words.data()); }
+    
+private:
+    std::shared_ptr<EngineTelemetry::Block> block;
+};
+
+// Hands each runtime that asks (JS or a worklet's UI runtime) its own
+// ArrayBuffer over the same telemetry words. A plain ArrayBuffer captured by
+// a worklet would be copied once and never change.
+class TelemetryHostObject : public facebook::jsi::HostObject {
+public:
+    explicit TelemetryHostObject(std::shared_ptr<TelemetryBuffer> buffer) : buffer(std::move(buffer)) {}
+    
+    facebook::jsi::Value get(facebook::jsi::Runtime& rt, const facebook::jsi::PropNameID& name) override {
+        if (name.utf8(rt) == "buffer") {
+            return facebook::jsi::ArrayBuffer(rt, buffer);
+        }
+        return facebook::jsi::Value::undefined();
+    }
+    
+    std::vector<facebook::jsi::PropNameID> getPropertyNames(facebook::jsi::Runtime& rt) override {
+        return facebook::jsi::PropNameID::names(rt, "buffer");
+    }
+    
+private:
+    std::shared_ptr<TelemetryBuffer> buffer;
+};
+
+// Codegen has no ArrayBuffer type, so the batch entry point is a plain JSI
+// function on the global object. It reads the buffer's bytes where they lie:
+// no copy, no NSArray, no strings. Installed when the module is first loaded.
+- (void)installJSIBindingsWithRuntime:(facebook::jsi::Runtime &)runtime
+                          callInvoker:(const std::shared_ptr<facebook::react::CallInvoker> &)callInvoker {
+    using namespace facebook;
+    __weak AudioModule *weakSelf = self;
+    
+    auto submitBatch = jsi::Function::createFromHostFunction(
+        runtime, jsi::PropNameID::forAscii(runtime, "__audioModuleSubmitBatch"), 2,
+        [weakSelf](jsi::Runtime& rt, const jsi::Value&, const jsi::Value* args, size_t count) -> jsi::Value {
+            if (count < 1 || !args[0].isObject() || !args[0].getObject(rt).isArrayBuffer(rt)) {
+                throw jsi::JSError(rt, "submitBatch expects an ArrayBuffer");
+            }
+            
+            AudioModule *strongSelf = weakSelf;
+            if (!strongSelf || !strongSelf->_audioEngine) return jsi::Value(-1);
+            
+            // Optional record count, so one buffer can be reused for batches of any length
+            auto buffer = args[0].getObject(rt).getArrayBuffer(rt);
+            auto numBytes = buffer.size(rt);
+            if (count > 1 && args[1].isNumber()) {
+                const auto records = static_cast<size_t>(std::max(0.0, args[1].getNumber()));
+                numBytes = std::min(numBytes, records * BatchRecord::size);
+            }
+            return jsi::Value(strongSelf->_audioEngine->submitBatch(buffer.data(rt), numBytes));
+        });
+    
+    runtime.global().setProperty(runtime, "__audioModuleSubmitBatch", std::move(submitBatch));
+    
+    // readAnalyzerFrame(channel, into: Float32Array) -> frame number (0 = none yet).
+    // Fills the caller's array in place: [0] sample rate, then the spectrum,
+    // then the scope, so a view redrawing every frame allocates nothing.
+    auto readAnalyzerFrame = jsi::Function::createFromHostFunction(
+        runtime, jsi::PropNameID::forAscii(runtime, "__audioModuleReadAnalyzerFrame"), 2,
+        [weakSelf](jsi::Runtime& rt, const jsi::Value&, const jsi::Value* args, size_t count) -> jsi::Value {
+            constexpr size_t frameFloats = 1 + AudioAnalyzer::numSpectrumBins + AudioAnalyzer::scopeLength;
+            if (count < 2 || !args[0].isNumber() || !args[1].isObject()) {
+                throw jsi::JSError(rt, "readAnalyzerFrame expects a channel and a Float32Array");
+            }
+            
+            // Sized and aligned in bytes, not elements: a Uint8Array with enough
+            // elements would otherwise let the copy run past the end of its buffer
+            auto array = args[1].getObject(rt);
+            const auto buffer = array.getProperty(rt, "buffer");
+            const auto byteLength = array.getProperty(rt, "byteLength");
+            const auto byteOffsetValue = array.getProperty(rt, "byteOffset");
+            const auto bytesPerElement = array.getProperty(rt, "BYTES_PER_ELEMENT");
+            if (!buffer.isObject() || !buffer.getObject(rt).isArrayBuffer(rt)
+                || !byteLength.isNumber() || !byteOffsetValue.isNumber() || !bytesPerElement.isNumber()
+                || bytesPerElement.getNumber() != sizeof(float)
+                || static_cast<size_t>(byteLength.getNumber()) < frameFloats * sizeof(float)
+                || static_cast<size_t>(byteOffsetValue.getNumber()) % sizeof(float) != 0) {
+                throw jsi::JSError(rt, "readAnalyzerFrame needs a Float32Array of at least "
+                                       + std::to_string(frameFloats) + " floats");
+            }
+            
+            AudioModule *strongSelf = weakSelf;
+            if (!strongSelf || !strongSelf->_audioEngine) return jsi::Value(0);
+            
+            const auto byteOffset = static_cast<size_t>(byteOffsetValue.getNumber());
+            auto arrayBuffer = buffer.getObject(rt).getArrayBuffer(rt);
+            if (byteOffset + frameFloats * sizeof(float) > arrayBuffer.size(rt)) {
+                throw jsi::JSError(rt, "readAnalyzerFrame needs a Float32Array of at least "
+                                       + std::to_string(frameFloats) + " floats");
+            }
+            auto* floats = reinterpret_cast<float *>(arrayBuffer.data(rt) + byteOffset);
+            
+            double sampleRate = 0.0;
+            const auto frame = strongSelf->_audioEngine->copyAnalyzerFrame(static_cast<int>(args[0].getNumber()),
+                                                                           floats + 1,
+                                                                           floats + 1 + AudioAnalyzer::numSpectrumBins,
+                                                                           sampleRate);
+            if (frame > 0) {
+                floats[0] = static_cast<float>(sampleRate);
+            }
+            return jsi::Value(static_cast<double>(frame));
+        });
+    
+    runtime.global().setProperty(runtime, "__audioModuleReadAnalyzerFrame", std::move(readAnalyzerFrame));
+    
+    runtime.global().setProperty(runtime, "__audioModuleWorkletNotes",
+                                 jsi::Object::createFromHostObject(runtime, std::make_shared<WorkletNotesHostObject>(self)));
+    
+    if (_audioEngine) {
+        auto telemetry = std::make_shared<TelemetryBuffer>(_audioEngine->getTelemetry().getBlock());
+        runtime.global().setProperty(runtime, "__audioModuleTelemetry",
+                                     jsi::Object::createFromHostObject(runtime, std::make_shared<TelemetryHostObject>(telemetry)));
+    }
+}
+
 // ────────────────────────────────────────────────
 // Instrument Management
 // ────────────────────────────────────────────────
@@ -99,6 +292,44 @@
     _audioEngine->createMultiSamplerInstrument(static_cast<int>(channel), config);
 }
 
+- (void)swapOscillatorInstrument:(double)channel
+                            name:(NSString *)name
+                       polyphony:(double)polyphony
+                        waveform:(NSString *)waveform
+                     crossfadeMs:(double)crossfadeMs {
+    if (!_audioEngine) return;
+    
+    Config config;
+    config.polyphony = static_cast<int>(polyphony);
+    config.name = juce::String([name UTF8String]);
+    
+    NSString *lowerWaveform = [waveform lowercaseString];
+    if ([lowerWaveform isEqualToString:@"sine"]) {
+        config.waveform = BaseOscillatorVoice::Waveform::Sine;
+    } else if ([lowerWaveform isEqualToString:@"saw"]) {
+        config.waveform = BaseOscillatorVoice::Waveform::Saw;
+    } else if ([lowerWaveform isEqualToString:@"square"]) {
+        config.waveform = BaseOscillatorVoice::Waveform::Square;
+    } else if ([lowerWaveform isEqualToString:@"triangle"]) {
+        config.waveform = BaseOscillatorVoice::Waveform::Triangle;
+    }
+    
+    _audioEngine->swapOscillatorInstrument(static_cast<int>(channel), config, crossfadeMs);
+}
+
+- (void)swapMultiSamplerInstrument:(double)channel
+                              name:(NSString *)name
+                         polyphony:(double)polyphony
+                       crossfadeMs:(double)crossfadeMs {
+    if (!_audioEngine) return;
+    
+    MultiSamplerConfig::Config config;
+    config.polyphony = static_cast<int>(polyphony);
+    config.name = juce::String([name UTF8String]);
+    
+    _audioEngine->swapMultiSamplerInstrument(static_cast<int>(channel), config, crossfadeMs);
+}
+
 - (void)removeInstrument:(double)channel {
     if (_audioEngine) {
         _audioEngine->removeInstrument(static_cast<int>(channel));
@@ -245,6 +476,148 @@
     }
 }
 
+- (void)scheduleNoteOn:(double)channel
+              midiNote:(double)midiNote
+              velocity:(double)velocity
+            hostTimeNs:(double)hostTimeNs {
+    if (_audioEngine) {
+        _audioEngine->scheduleNoteOn(static_cast<int>(channel),
+                                    static_cast<int>(midiNote),
+                                    static_cast<float>(velocity),
+                                    static_cast<juce::uint64>(hostTimeNs));
+    }
+}
+
+- (void)scheduleNoteOff:(double)channel
+               midiNote:(double)midiNote
+             hostTimeNs:(double)hostTimeNs {
+    if (_audioEngine) {
+        _audioEngine->scheduleNoteOff(static_cast<int>(channel),
+                                     static_cast<int>(midiNote),
+                                     static_cast<juce::uint64>(hostTimeNs));
+    }
+}
+
+- (void)noteOnRecordedAt:(double)channel
+                midiNote:(double)midiNote
+                velocity:(double)velocity
+        recordHostTimeNs:(double)recordHostTimeNs {
+    if (_audioEngine) {
+        _audioEngine->noteOnRecordedAt(static_cast<int>(channel),
+                                      static_cast<int>(midiNote),
+                                      static_cast<float>(velocity),
+                                      static_cast<juce::uint64>(recordHostTimeNs));
+    }
+}
+
+- (void)noteOffRecordedAt:(double)channel
+                 midiNote:(double)midiNote
+         recordHostTimeNs:(double)recordHostTimeNs {
+    if (_audioEngine) {
+        _audioEngine->noteOffRecordedAt(static_cast<int>(channel),
+                                       static_cast<int>(midiNote),
+                                       static_cast<juce::uint64>(recordHostTimeNs));
+    }
+}
+
+- (NSNumber *)getHostTimeNs {
+    return @(static_cast<double>(AudioEngine::getHostTimeNs()));
+}
+
+// ────────────────────────────────────────────────
+// Loop Sequencer
+// ────────────────────────────────────────────────
+
+static std::vector<LoopSequencer::Event> unpackSequenceEvents(NSArray *packed) {
+    std::vector<LoopSequencer::Event> events;
+    const NSUInteger count = packed.count / 4;
+    events.reserve(count);
+    
+    for (NSUInteger i = 0; i < count; ++i) {
+        LoopSequencer::Event event;
+        event.timeMs = [packed[i * 4] doubleValue];
+        event.isNoteOn = [packed[i * 4 + 1] intValue] != 0;
+        event.note = [packed[i * 4 + 2] intValue];
+        event.velocity = [packed[i * 4 + 3] floatValue];
+        events.push_back(event);
+    }
+    return events;
+}
+
+- (void)setSequence:(double)channel
+             events:(NSArray *)events
+         durationMs:(double)durationMs {
+    if (_audioEngine) {
+        _audioEngine->setSequence(static_cast<int>(channel), unpackSequenceEvents(events), durationMs);
+    }
+}
+
+- (void)clearSequence:(double)channel {
+    if (_audioEngine) {
+        _audioEngine->clearSequence(static_cast<int>(channel));
+    }
+}
+
+- (void)sequencerPlay {
+    if (_audioEngine) {
+        _audioEngine->startTransport();
+    }
+}
+
+- (void)sequencerStop {
+    if (_audioEngine) {
+        _audioEngine->stopTransport();
+    }
+}
+
+- (void)startRecording:(double)channel {
+    if (_audioEngine) {
+        _audioEngine->startRecording(static_cast<int>(channel));
+    }
+}
+
+- (NSArray<NSNumber *> *)stopRecording:(double)channel {
+    if (!_audioEngine) {
+        return @[];
+    }
+    
+    const auto events = _audioEngine->stopRecording(static_cast<int>(channel));
+    NSMutableArray<NSNumber *> *packed = [NSMutableArray arrayWithCapacity:events.size() * 4];
+    for (const auto& event : events) {
+        [packed addObject:@(event.timeMs)];
+        [packed addObject:@(event.isNoteOn ? 1 : 0)];
+        [packed addObject:@(event.note)];
+        [packed addObject:@(event.velocity)];
+    }
+    return packed;
+}
+
+- (NSArray<NSNumber *> *)pollSequencer {
+    if (!_audioEngine) {
+        return @[ @0 ];
+    }
+    
+    std::array<LoopSequencer::PlaybackEvent, LoopSequencer::playbackEventCapacity> events;
+    const int count = _audioEngine->readSequencerEvents(events.data(), static_cast<int>(events.size()));
+    
+    // Presentation times go out relative to now, so JS can line them up with performance.now()
+    const auto now = AudioEngine::getHostTimeNs();
+    
+    NSMutableArray<NSNumber *> *packed = [NSMutableArray arrayWithCapacity:3 + count * 5];
+    [packed addObject:@(_audioEngine->getTransportPositionMs())];
+    [packed addObject:@(_audioEngine->getHeardTransportPositionMs())];
+    [packed addObject:@(_audioEngine->getOutputLatencyMs())];
+    for (int i = 0; i < count; ++i) {
+        const auto presentation = events[i].presentationTimeNs;
+        [packed addObject:@(events[i].channel)];
+        [packed addObject:@(static_cast<int>(events[i].type))];
+        [packed addObject:@(events[i].note)];
+        [packed addObject:@(events[i].velocity)];
+        [packed addObject:@(presentation == 0 ? 0.0 : (static_cast<double>(presentation) - static_cast<double>(now)) / 1.0e6)];
+    }
+    return packed;
+}
+
 // ────────────────────────────────────────────────
 // Common Parameters
 // ────────────────────────────────────────────────
@@ -301,9 +674,26 @@
     } else if ([lowerType isEqualToString:@"triangle"]) {
         _audioEngine->setWaveform(static_cast<int>(channel),
                                  BaseOscillatorVoice::Waveform::Triangle);
+    } else if ([lowerType isEqualToString:@"wavetable"]) {
+        _audioEngine->setWaveform(static_cast<int>(channel),
+                                 BaseOscillatorVoice::Waveform::Wavetable);
     }
 }
 
+- (NSNumber *)loadWavetable:(double)channel
+                   filePath:(NSString *)filePath
+                crossfadeMs:(double)crossfadeMs {
+    if (!_audioEngine) return @NO;
+    
+    bool success = _audioEngine->loadWavetable(static_cast<int>(channel),
+                                               juce::String([filePath UTF8String]),
+                                               crossfadeMs);
+    if (!success) {
+        NSLog(@"[AudioModule] Failed to load wavetable '%@'", filePath);
+    }
+    return @(success);
+}
+
 - (void)setDetune:(double)channel
             cents:(double)cents {
     if (_audioEngine) {
@@ -316,12 +706,8 @@
 // Effects Management
 // ────────────────────────────────────────────────
 
-- (NSNumber *)addEffect:(double)channel
-                   type:(NSString *)type {
-    if (!_audioEngine) return @(-1);
-    
+static BOOL parseEffectType(NSString *type, Instrument::EffectType& effectType) {
     NSString *lowerType = [type lowercaseString];
-    Instrument::EffectType effectType;
     
     if ([lowerType isEqualToString:@"reverb"]) {
         effectType = Instrument::EffectType::Reverb;
@@ -337,8 +723,17 @@
         effectType = Instrument::EffectType::Compressor;
     } else {
         NSLog(@"[AudioModule] Unknown effect type: %@", type);
-        return @(-1);
+        return NO;
     }
+    return YES;
+}
+
+- (NSNumber *)addEffect:(double)channel
+                   type:(NSString *)type {
+    if (!_audioEngine) return @(-1);
+    
+    Instrument::EffectType effectType;
+    if (!parseEffectType(type, effectType)) return @(-1);
     
     int effectId = _audioEngine->addEffect(static_cast<int>(channel), effectType);
     NSLog(@"[AudioModule] Added effect '%@' to channel %d with ID %d", type, (int)channel, effectId);
@@ -382,6 +777,64 @@
     }
 }
 
+- (NSNumber *)setEffectSidechain:(double)channel
+                        effectId:(double)effectId
+                   sourceChannel:(double)sourceChannel {
+    if (!_audioEngine) return @NO;
+    
+    return @(_audioEngine->setEffectSidechain(static_cast<int>(channel),
+                                              static_cast<int>(effectId),
+                                              static_cast<int>(sourceChannel)));
+}
+
+// ────────────────────────────────────────────────
+// Send/Return Buses
+// ────────────────────────────────────────────────
+
+- (NSNumber *)setSendBusEffect:(double)bus
+                          type:(NSString *)type {
+    if (!_audioEngine) return @NO;
+    
+    Instrument::EffectType effectType;
+    if (!parseEffectType(type, effectType)) return @NO;
+    
+    return @(_audioEngine->setSendBusEffect(static_cast<int>(bus), effectType));
+}
+
+- (void)clearSendBusEffect:(double)bus {
+    if (_audioEngine) {
+        _audioEngine->clearSendBusEffect(static_cast<int>(bus));
+    }
+}
+
+- (void)setSendBusParameter:(double)bus
+                  paramName:(NSString *)paramName
+                      value:(double)value {
+    if (_audioEngine) {
+        _audioEngine->setSendBusParameter(static_cast<int>(bus),
+                                          juce::String([paramName UTF8String]),
+                                          static_cast<float>(value));
+    }
+}
+
+- (void)setSendBusReturnLevel:(double)bus
+                        level:(double)level {
+    if (_audioEngine) {
+        _audioEngine->setSendBusReturnLevel(static_cast<int>(bus),
+                                            static_cast<float>(level));
+    }
+}
+
+- (void)setSendLevel:(double)channel
+                 bus:(double)bus
+               level:(double)level {
+    if (_audioEngine) {
+        _audioEngine->setSendLevel(static_cast<int>(channel),
+                                   static_cast<int>(bus),
+                                   static_cast<float>(level));
+    }
+}
+
 // ────────────────────────────────────────────────
 // Global Controls
 // ────────────────────────────────────────────────
@@ -392,4 +845,286 @@
     }
 }
 
+- (void)setRenderThreadCount:(double)count {
+    if (_audioEngine) {
+        _audioEngine->setRenderThreadCount(static_cast<int>(count));
+    }
+}
+
+- (void)setProcessingQuantum:(double)frames {
+    if (_audioEngine) {
+        _audioEngine->setProcessingQuantum(static_cast<int>(frames));
+    }
+}
+
+- (NSNumber *)getProcessingQuantum {
+    return @(_audioEngine ? _audioEngine->getProcessingQuantum() : 0);
+}
+
+- (NSDictionary *)getBypassStats {
+    const auto stats = _audioEngine ? _audioEngine->getBypassStats() : AudioEngine::BypassStats {};
+    return @{
+        @"channelsRendered" : @(stats.channelsRendered),
+        @"channelsBypassed" : @(stats.channelsBypassed),
+        @"effectsBypassed" : @(stats.effectsBypassed),
+        @"totalBlocks" : @(static_cast<double>(stats.totalBlocks)),
+        @"totalChannelsBypassed" : @(static_cast<double>(stats.totalChannelsBypassed)),
+        @"totalEffectsBypassed" : @(static_cast<double>(stats.totalEffectsBypassed)),
+    };
+}
+
+static NSDictionary *timingToDictionary(const TimingHistogram::Summary& summary) {
+    return @{
+        @"count" : @(static_cast<double>(summary.count)),
+        @"meanMicros" : @(summary.meanMicros),
+        @"p99Micros" : @(summary.p99Micros),
+        @"maxMicros" : @(summary.maxMicros),
+    };
+}
+
+static NSString *effectTypeName(Instrument::EffectType type) {
+    switch (type) {
+        case Instrument::EffectType::Reverb:     return @"reverb";
+        case Instrument::EffectType::Delay:      return @"delay";
+        case Instrument::EffectType::Chorus:     return @"chorus";
+        case Instrument::EffectType::Distortion: return @"distortion";
+        case Instrument::EffectType::Filter:     return @"filter";
+        case Instrument::EffectType::Compressor: return @"compressor";
+    }
+    return @"unknown";
+}
+
+- (NSDictionary *)getPerformanceStats {
+    const auto stats = _audioEngine ? _audioEngine->getPerformanceStats() : AudioEngine::PerformanceStats {};
+    
+    NSMutableArray *channels = [NSMutableArray arrayWithCapacity:stats.channels.size()];
+    for (const auto& channel : stats.channels) {
+        NSMutableArray *effects = [NSMutableArray arrayWithCapacity:channel.effects.size()];
+        for (const auto& effect : channel.effects) {
+            [effects addObject:@{
+                @"effectId" : @(effect.effectId),
+                @"type" : effectTypeName(effect.type),
+                @"enabled" : @(effect.enabled),
+                @"timing" : timingToDictionary(effect.summary),
+            }];
+        }
+        
+        [channels addObject:@{
+            @"channel" : @(channel.channel),
+            @"render" : timingToDictionary(channel.render),
+            @"effects" : effects,
+        }];
+    }
+    
+    NSMutableArray *sendBuses = [NSMutableArray arrayWithCapacity:stats.sendBuses.size()];
+    for (const auto& bus : stats.sendBuses) {
+        [sendBuses addObject:@{
+            @"bus" : @(bus.bus),
+            @"type" : effectTypeName(bus.type),
+            @"timing" : timingToDictionary(bus.summary),
+        }];
+    }
+    
+    return @{
+        @"budgetMicros" : @(stats.budgetMicros),
+        @"loadPercent" : @(stats.loadProportion * 100.0),
+        @"overruns" : @(stats.overruns),
+        @"xruns" : @(stats.xruns),
+        @"callback" : timingToDictionary(stats.callback),
+        @"channels" : channels,
+        @"sendBuses" : sendBuses,
+    };
+}
+
+- (void)resetPerformanceStats {
+    if (_audioEngine) {
+        _audioEngine->resetPerformanceStats();
+    }
+}
+
+- (NSDictionary *)getRealtimeViolations {
+    const bool enabled = RealtimeSafety::isEnabled() && RealtimeSafety::areHooksInstalled();
+    const auto counts = _audioEngine ? _audioEngine->getRealtimeViolationCounts() : RealtimeSafety::Counts {};
+    
+    NSMutableArray *recent = [NSMutableArray array];
+    if (_audioEngine) {
+        for (const auto& description : _audioEngine->describeRealtimeViolations())
+            [recent addObject:[NSString stringWithUTF8String:description.toRawUTF8()]];
+    }
+    
+    return @{
+        @"enabled" : @(enabled),
+        @"allocations" : @(counts.allocations),
+        @"deallocations" : @(counts.deallocations),
+        @"locks" : @(counts.locks),
+        @"recent" : recent,
+    };
+}
+
+// ────────────────────────────────────────────────
+// Metering
+// ────────────────────────────────────────────────
+
+static NSMutableDictionary *meterToDictionary(const LoudnessMeter::Readings& readings) {
+    return [@{
+        @"peakDb" : @(readings.peakDb),
+        @"truePeakDb" : @(readings.truePeakDb),
+        @"maxTruePeakDb" : @(readings.maxTruePeakDb),
+        @"rmsDb" : @(readings.rmsDb),
+        @"momentaryLufs" : @(readings.momentaryLufs),
+        @"shortTermLufs" : @(readings.shortTermLufs),
+        @"integratedLufs" : @(readings.integratedLufs),
+    } mutableCopy];
+}
+
+- (NSDictionary *)getMeters {
+    const auto meters = _audioEngine ? _audioEngine->getMeters() : AudioEngine::Meters {};
+    
+    NSMutableArray *channels = [NSMutableArray array];
+    for (int index = 0; index < AudioEngine::maxChannels; ++index) {
+        if (!meters.hasInstrument[static_cast<size_t>(index)]) continue;
+        
+        NSMutableDictionary *channel = meterToDictionary(meters.channels[static_cast<size_t>(index)]);
+        channel[@"channel"] = @(index + 1);
+        [channels addObject:channel];
+    }
+    
+    return @{
+        @"blocks" : @(static_cast<double>(meters.blocks)),
+        @"master" : meterToDictionary(meters.master),
+        @"channels" : channels,
+    };
+}
+
+- (void)resetLoudness {
+    if (_audioEngine) {
+        _audioEngine->resetLoudness();
+    }
+}
+
+// ────────────────────────────────────────────────
+// Spectrum and Oscilloscope
+// ────────────────────────────────────────────────
+
+- (NSNumber *)attachAnalyzer:(double)channel {
+    if (!_audioEngine) return @NO;
+    return @(_audioEngine->attachAnalyzer(static_cast<int>(channel)));
+}
+
+- (void)detachAnalyzer:(double)channel {
+    if (_audioEngine) {
+        _audioEngine->detachAnalyzer(static_cast<int>(channel));
+    }
+}
+
+// Frames are read through __audioModuleReadAnalyzerFrame (see the JSI bindings)
+
+// ────────────────────────────────────────────────
+// Master Bus
+// ────────────────────────────────────────────────
+
+- (void)setMasterEqBand:(NSString *)band
+              frequency:(double)frequency
+                 gainDb:(double)gainDb
+                      q:(double)q {
+    if (!_audioEngine) return;
+    
+    NSString *lowerBand = [band lowercaseString];
+    MasterBus::EqBand eqBand;
+    
+    if ([lowerBand isEqualToString:@"lowshelf"]) {
+        eqBand = MasterBus::EqBand::LowShelf;
+    } else if ([lowerBand isEqualToString:@"peak"]) {
+        eqBand = MasterBus::EqBand::Peak;
+    } else if ([lowerBand isEqualToString:@"highshelf"]) {
+        eqBand = MasterBus::EqBand::HighShelf;
+    } else {
+        NSLog(@"[AudioModule] Unknown EQ band: %@", band);
+        return;
+    }
+    
+    _audioEngine->setMasterEqBand(eqBand,
+                                  static_cast<float>(frequency),
+                                  static_cast<float>(gainDb),
+                                  static_cast<float>(q));
+}
+
+- (void)setMasterEqEnabled:(BOOL)enabled {
+    if (_audioEngine) {
+        _audioEngine->setMasterEqEnabled(enabled);
+    }
+}
+
+- (void)setMasterCompressor:(double)thresholdDb
+                      ratio:(double)ratio
+                   attackMs:(double)attackMs
+                  releaseMs:(double)releaseMs
+                   makeupDb:(double)makeupDb {
+    if (_audioEngine) {
+        _audioEngine->setMasterCompressor(static_cast<float>(thresholdDb),
+                                          static_cast<float>(ratio),
+                                          static_cast<float>(attackMs),
+                                          static_cast<float>(releaseMs),
+                                          static_cast<float>(makeupDb));
+    }
+}
+
+- (void)setMasterCompressorEnabled:(BOOL)enabled {
+    if (_audioEngine) {
+        _audioEngine->setMasterCompressorEnabled(enabled);
+    }
+}
+
+- (void)setMasterLimiter:(double)ceilingDb
+               releaseMs:(double)releaseMs {
+    if (_audioEngine) {
+        _audioEngine->setMasterLimiter(static_cast<float>(ceilingDb),
+                                       static_cast<float>(releaseMs));
+    }
+}
+
+- (void)setMasterLimiterEnabled:(BOOL)enabled {
+    if (_audioEngine) {
+        _audioEngine->setMasterLimiterEnabled(enabled);
+    }
+}
+
+- (NSDictionary *)getMasterLatency {
+    if (!_audioEngine) return @{ @"samples": @0, @"ms": @0 };
+    
+    const auto samples = _audioEngine->getMasterLatencySamples();
+    return @{
+        @"samples": @(samples),
+        @"ms": @(samples * 1000.0 / _audioEngine->getSampleRate()),
+    };
+}
+
+- (NSNumber *)getMasterGainReduction {
+    return @(_audioEngine ? _audioEngine->getMasterGainReductionDb() : 0.0f);
+}
+
+// ────────────────────────────────────────────────
+// Session Snapshots
+// ────────────────────────────────────────────────
+
+- (NSNumber *)saveSnapshot:(NSString *)path {
+    if (!_audioEngine) return @NO;
+    
+    const auto result = _audioEngine->saveSnapshot(juce::File(juce::String([path UTF8String])));
+    if (result.failed()) {
+        NSLog(@"[AudioModule] Failed to save snapshot: %s", result.getErrorMessage().toRawUTF8());
+    }
+    return @(result.wasOk());
+}
+
+- (NSNumber *)loadSnapshot:(NSString *)path {
+    if (!_audioEngine) return @NO;
+    
+    const auto result = _audioEngine->loadSnapshot(juce::File(juce::String([path UTF8String])));
+    if (result.failed()) {
+        NSLog(@"[AudioModule] Failed to load snapshot: %s", result.getErrorMessage().toRawUTF8());
+    }
+    return @(result.wasOk());
+}
+
 @end
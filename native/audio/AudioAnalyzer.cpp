@@ -0,0 +1,298 @@
+#include "AudioAnalyzer.h"
+#include <algorithm>
+#include <cmath>
+
+AudioAnalyzer::AudioAnalyzer()
+    : juce::Thread("AudioAnalyzer")
+    , window(static_cast<size_t>(fftSize))
+    , spectrumScratch(static_cast<size_t>(numSpectrumBins))
+    , scopeScratch(static_cast<size_t>(scopeLength))
+{
+    juce::dsp::WindowingFunction<float>::fillWindowingTables(window.data(), static_cast<size_t>(fftSize),
+                                                              juce::dsp::WindowingFunction<float>::hann, false);
+
+    // So a full-scale sine reads 0 dB whatever the window
+    float sum = 0.0f;
+    for (auto value : window)
+        sum += value;
+    windowGain = 2.0f / sum;
+}
+
+AudioAnalyzer::~AudioAnalyzer()
+{
+    signalThreadShouldExit();
+    notify();
+    stopThread(1000);
+}
+
+// ──────────────────────────────────────────
+// Subscribers
+// ──────────────────────────────────────────
+
+bool AudioAnalyzer::subscribe(int index)
+{
+    if (!isValidTap(index))
+        return false;
+
+    auto& tap = taps[static_cast<size_t>(index)];
+    {
+        const juce::ScopedLock lock(subscribeLock);
+
+        // The ring and the analysis buffers come into being the first time
+        // a tap is watched, before either thread can touch them
+        if (!tap.allocated.load(std::memory_order_relaxed))
+        {
+            tap.ring.setSize(2, ringFrames);
+            tap.ring.clear();
+            tap.history.assign(static_cast<size_t>(fftSize), 0.0f);
+            tap.fftData.assign(static_cast<size_t>(fftSize * 2), 0.0f);
+            tap.magnitudes.assign(static_cast<size_t>(fftSize / 2 + 1), 0.0f);
+            tap.frame.spectrum.assign(static_cast<size_t>(numSpectrumBins), floorDb);
+            tap.frame.scope.assign(static_cast<size_t>(scopeLength), 0.0f);
+            tap.allocated.store(true, std::memory_order_release);
+        }
+
+        if (tap.subscribers.fetch_add(1, std::memory_order_relaxed) == 0)
+            tap.generation.fetch_add(1, std::memory_order_release);
+
+        startThread(juce::Thread::Priority::low);
+    }
+
+    notify();
+    return true;
+}
+
+void AudioAnalyzer::unsubscribe(int index)
+{
+    if (!isValidTap(index))
+        return;
+
+    // The analysis thread notices on its next frame and then sleeps
+    auto& subscribers = taps[static_cast<size_t>(index)].subscribers;
+    const juce::ScopedLock lock(subscribeLock);
+    if (subscribers.load(std::memory_order_relaxed) > 0)
+        subscribers.fetch_sub(1, std::memory_order_relaxed);
+}
+
+bool AudioAnalyzer::getLatestFrame(int index, Frame& frame) const
+{
+    if (!isValidTap(index))
+        return false;
+
+    const auto& tap = taps[static_cast<size_t>(index)];
+    if (!tap.allocated.load(std::memory_order_acquire))
+        return false;
+
+    const juce::SpinLock::ScopedLockType lock(tap.frameLock);
+    if (tap.frame.number == 0)
+        return false;
+
+    frame = tap.frame;
+    return true;
+}
+
+juce::int64 AudioAnalyzer::copyLatestFrame(int index, float* spectrum, float* scope, double& sampleRate) const
+{
+    if (!isValidTap(index))
+        return 0;
+
+    const auto& tap = taps[static_cast<size_t>(index)];
+    if (!tap.allocated.load(std::memory_order_acquire))
+        return 0;
+
+    const juce::SpinLock::ScopedLockType lock(tap.frameLock);
+    if (tap.frame.number == 0)
+        return 0;
+
+    std::copy(tap.frame.spectrum.begin(), tap.frame.spectrum.end(), spectrum);
+    std::copy(tap.frame.scope.begin(), tap.frame.scope.end(), scope);
+    sampleRate = tap.frame.sampleRate;
+    return tap.frame.number;
+}
+
+// ──────────────────────────────────────────
+// Audio thread
+// ──────────────────────────────────────────
+
+void AudioAnalyzer::write(int index, const juce::AudioBuffer<float>& buffer, int numSamples)
+{
+    jassert(isValidTap(index));
+    auto& tap = taps[static_cast<size_t>(index)];
+    if (tap.subscribers.load(std::memory_order_relaxed) == 0 || !tap.allocated.load(std::memory_order_acquire))
+        return;
+
+    const auto numChannels = buffer.getNumChannels();
+    if (numChannels == 0)
+    {
+        writeSilence(index, numSamples);
+        return;
+    }
+
+    // If the analysis has fallen a whole ring behind, the rest of the block is dropped
+    int start1, size1, start2, size2;
+    tap.fifo.prepareToWrite(numSamples, start1, size1, start2, size2);
+    for (int ch = 0; ch < tap.ring.getNumChannels(); ++ch)
+    {
+        const auto* source = buffer.getReadPointer(juce::jmin(ch, numChannels - 1));
+        if (size1 > 0)
+            juce::FloatVectorOperations::copy(tap.ring.getWritePointer(ch, start1), source, size1);
+        if (size2 > 0)
+            juce::FloatVectorOperations::copy(tap.ring.getWritePointer(ch, start2), source + size1, size2);
+    }
+    tap.fifo.finishedWrite(size1 + size2);
+}
+
+void AudioAnalyzer::writeSilence(int index, int numSamples)
+{
+    jassert(isValidTap(index));
+    auto& tap = taps[static_cast<size_t>(index)];
+    if (tap.subscribers.load(std::memory_order_relaxed) == 0 || !tap.allocated.load(std::memory_order_acquire))
+        return;
+
+    int start1, size1, start2, size2;
+    tap.fifo.prepareToWrite(numSamples, start1, size1, start2, size2);
+    for (int ch = 0; ch < tap.ring.getNumChannels(); ++ch)
+    {
+        if (size1 > 0)
+            tap.ring.clear(ch, start1, size1);
+        if (size2 > 0)
+            tap.ring.clear(ch, start2, size2);
+    }
+    tap.fifo.finishedWrite(size1 + size2);
+}
+
+// ──────────────────────────────────────────
+// Analysis thread
+// ──────────────────────────────────────────
+
+void AudioAnalyzer::run()
+{
+    while (!threadShouldExit())
+    {
+        bool watching = false;
+        for (auto& tap : taps)
+        {
+            if (tap.subscribers.load(std::memory_order_relaxed) > 0 && tap.allocated.load(std::memory_order_acquire))
+            {
+                watching = true;
+                analyse(tap);
+            }
+        }
+
+        wait(watching ? juce::roundToInt(frameIntervalMs) : -1);
+    }
+}
+
+bool AudioAnalyzer::analyse(Tap& tap)
+{
+    // Watching again after a break: whatever was left in the ring is stale
+    const auto generation = tap.generation.load(std::memory_order_acquire);
+    if (generation != tap.analysedGeneration)
+    {
+        tap.fifo.finishedRead(tap.fifo.getNumReady());
+        std::fill(tap.history.begin(), tap.history.end(), 0.0f);
+        std::fill(tap.magnitudes.begin(), tap.magnitudes.end(), 0.0f);
+        tap.analysedGeneration = generation;
+    }
+
+    const auto numReady = tap.fifo.getNumReady();
+    if (numReady == 0)
+        return false;
+
+    // Only the newest window matters
+    if (numReady > fftSize)
+        tap.fifo.finishedRead(numReady - fftSize);
+    readRing(tap, juce::jmin(numReady, fftSize));
+
+    buildSpectrum(tap, spectrumScratch);
+    buildScope(tap, scopeScratch);
+
+    const juce::SpinLock::ScopedLockType lock(tap.frameLock);
+    std::copy(spectrumScratch.begin(), spectrumScratch.end(), tap.frame.spectrum.begin());
+    std::copy(scopeScratch.begin(), scopeScratch.end(), tap.frame.scope.begin());
+    tap.frame.sampleRate = currentSampleRate.load(std::memory_order_relaxed);
+    ++tap.frame.number;
+    return true;
+}
+
+void AudioAnalyzer::readRing(Tap& tap, int numToRead)
+{
+    // Slide the history along and append the new samples, left and right averaged
+    auto& history = tap.history;
+    std::copy(history.begin() + numToRead, history.end(), history.begin());
+    auto* destination = history.data() + fftSize - numToRead;
+
+    int start1, size1, start2, size2;
+    tap.fifo.prepareToRead(numToRead, start1, size1, start2, size2);
+    for (const auto& [start, size] : { std::pair { start1, size1 }, std::pair { start2, size2 } })
+    {
+        if (size <= 0)
+            continue;
+        juce::FloatVectorOperations::copyWithMultiply(destination, tap.ring.getReadPointer(0, start), 0.5f, size);
+        juce::FloatVectorOperations::addWithMultiply(destination, tap.ring.getReadPointer(1, start), 0.5f, size);
+        destination += size;
+    }
+    tap.fifo.finishedRead(size1 + size2);
+}
+
+void AudioAnalyzer::buildSpectrum(Tap& tap, std::vector<float>& spectrum) const
+{
+    constexpr int numFftBins = fftSize / 2 + 1;
+    auto* data = tap.fftData.data();
+
+    juce::FloatVectorOperations::multiply(data, tap.history.data(), window.data(), fftSize);
+    juce::FloatVectorOperations::clear(data + fftSize, fftSize);
+    fft.performFrequencyOnlyForwardTransform(data, true);
+
+    // Exponential average over frames, in linear magnitude
+    auto* magnitudes = tap.magnitudes.data();
+    juce::FloatVectorOperations::multiply(magnitudes, smoothing, numFftBins);
+    juce::FloatVectorOperations::addWithMultiply(magnitudes, data, (1.0f - smoothing) * windowGain, numFftBins);
+
+    // Log-spaced bands: the loudest FFT bin inside each, or where a band is
+    // narrower than a bin (low down), the magnitude interpolated at its centre
+    const auto sampleRate = currentSampleRate.load(std::memory_order_relaxed);
+    const auto binsPerHz = fftSize / sampleRate;
+    const auto top = juce::jmin(static_cast<double>(maxFrequency), sampleRate * 0.5);
+    const auto range = std::log(top / minFrequency);
+
+    for (int band = 0; band < numSpectrumBins; ++band)
+    {
+        const auto low = minFrequency * std::exp(range * band / numSpectrumBins) * binsPerHz;
+        const auto high = minFrequency * std::exp(range * (band + 1) / numSpectrumBins) * binsPerHz;
+        const auto first = static_cast<int>(std::ceil(low));
+        const auto last = juce::jmin(static_cast<int>(std::floor(high)), numFftBins - 1);
+
+        float magnitude = 0.0f;
+        if (first <= last)
+        {
+            magnitude = juce::FloatVectorOperations::findMaximum(magnitudes + first, last - first + 1);
+        }
+        else
+        {
+            const auto centre = std::sqrt(low * high);
+            const auto bin = juce::jmin(static_cast<int>(centre), numFftBins - 2);
+            const auto fraction = static_cast<float>(centre - bin);
+            magnitude = magnitudes[bin] + fraction * (magnitudes[bin + 1] - magnitudes[bin]);
+        }
+
+        spectrum[static_cast<size_t>(band)] = juce::Decibels::gainToDecibels(magnitude, floorDb);
+    }
+}
+
+void AudioAnalyzer::buildScope(const Tap& tap, std::vector<float>& scope) const
+{
+    // Keep the larger excursion of each group so peaks survive decimation
+    const auto* samples = tap.history.data() + fftSize - scopeLength * scopeDecimation;
+    for (int point = 0; point < scopeLength; ++point)
+    {
+        auto value = 0.0f;
+        for (int i = 0; i < scopeDecimation; ++i)
+        {
+            const auto sample = samples[point * scopeDecimation + i];
+            if (std::abs(sample) > std::abs(value))
+                value = sample;
+        }
+        scope[static_cast<size_t>(point)] = value;
+    }
+}
@@ -0,0 +1,127 @@
+#pragma once
+#include "JuceHeader.h"
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+/**
+ * AudioAnalyzer - Spectrum and oscilloscope frames of the master output and
+ * of each channel, for drawing.
+ *
+ * The audio thread's whole part is copying each block of a watched signal
+ * into that tap's ring (a juce::AbstractFifo over a preallocated buffer).
+ * Signals nobody is watching aren't copied. A background thread, started on
+ * the first subscribe(), reads the rings about 60 times a second and
+ * for each watched tap:
+ *
+ *   - runs a Hann-windowed juce::dsp::FFT over the newest fftSize samples
+ *     (left and right averaged), smooths the magnitudes over time and folds
+ *     them into numSpectrumBins log-spaced bands from 20 Hz to 20 kHz, in dB
+ *   - decimates the newest scopeLength * scopeDecimation samples into
+ *     scopeLength points, keeping the larger excursion of each group
+ *
+ * and publishes the pair as the tap's latest frame. With no subscribers the
+ * thread waits without waking.
+ *
+ * Tap 0 is the master output; taps 1-16 are channels.
+ */
+class AudioAnalyzer : private juce::Thread
+{
+public:
+    static constexpr int numTaps = 17;
+    static constexpr int fftOrder = 11;
+    static constexpr int fftSize = 1 << fftOrder;
+    static constexpr int numSpectrumBins = 128;
+    static constexpr float minFrequency = 20.0f;
+    static constexpr float maxFrequency = 20000.0f;
+    static constexpr float floorDb = -120.0f;
+    static constexpr int scopeLength = 256;
+    static constexpr int scopeDecimation = 4;
+
+    AudioAnalyzer();
+    ~AudioAnalyzer() override;
+
+    /** Band frequencies are worked out from this. */
+    void setSampleRate(double sampleRate) { currentSampleRate.store(sampleRate, std::memory_order_relaxed); }
+
+    // ──────────────────────────────────────────
+    // Subscribers (control thread)
+    // ──────────────────────────────────────────
+
+    /** Start analysing a tap; each subscribe() needs an unsubscribe(). False for a bad tap. */
+    bool subscribe(int tap);
+    void unsubscribe(int tap);
+
+    struct Frame
+    {
+        juce::int64 number = 0;        // counts up with each new frame; 0 = none yet
+        double sampleRate = 0.0;
+        std::vector<float> spectrum;   // numSpectrumBins dB values, low to high
+        std::vector<float> scope;      // scopeLength samples, oldest first
+    };
+
+    /** Copy the tap's latest frame; false if it has none. Doesn't wait for the analysis. */
+    bool getLatestFrame(int tap, Frame& frame) const;
+
+    /**
+     * The same without allocating: numSpectrumBins values into spectrum and
+     * scopeLength into scope. Returns the frame number, 0 (nothing written)
+     * if the tap has no frame.
+     */
+    juce::int64 copyLatestFrame(int tap, float* spectrum, float* scope, double& sampleRate) const;
+
+    // ──────────────────────────────────────────
+    // Audio thread
+    // ──────────────────────────────────────────
+
+    /** Copy a block into the tap's ring if anyone is watching. Never allocates. */
+    void write(int tap, const juce::AudioBuffer<float>& buffer, int numSamples);
+    void writeSilence(int tap, int numSamples);
+
+private:
+    static constexpr int ringFrames = 8 * fftSize;
+    static constexpr double frameIntervalMs = 1000.0 / 60.0;
+    static constexpr float smoothing = 0.7f;   // share of the previous spectrum kept per frame
+
+    struct Tap
+    {
+        std::atomic<int> subscribers { 0 };
+        std::atomic<bool> allocated { false };
+        std::atomic<juce::uint32> generation { 0 };  // bumped when watching starts again
+
+        // Written by the audio thread, read by the analysis thread
+        juce::AbstractFifo fifo { ringFrames };
+        juce::AudioBuffer<float> ring;
+
+        // Analysis thread only
+        juce::uint32 analysedGeneration = 0;
+        std::vector<float> history;   // newest fftSize mono samples, oldest first
+        std::vector<float> fftData;
+        std::vector<float> magnitudes;
+
+        // The latest frame, guarded by frameLock
+        mutable juce::SpinLock frameLock;
+        Frame frame;
+    };
+
+    void run() override;
+    bool analyse(Tap& tap);
+    void readRing(Tap& tap, int numToRead);
+    void buildSpectrum(Tap& tap, std::vector<float>& spectrum) const;
+    void buildScope(const Tap& tap, std::vector<float>& scope) const;
+    static bool isValidTap(int tap) { return tap >= 0 && tap < numTaps; }
+
+    std::array<Tap, numTaps> taps;
+    std::atomic<double> currentSampleRate { 44100.0 };
+    juce::CriticalSection subscribeLock;  // control threads only
+
+    // Analysis thread only
+    juce::dsp::FFT fft { fftOrder };
+    std::vector<float> window;
+    float windowGain = 1.0f;
+    std::vector<float> spectrumScratch;
+    std::vector<float> scopeScratch;
+
+    JUCE_DECLARE_NON_COPYABLE(AudioAnalyzer)
+};
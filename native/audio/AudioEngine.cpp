@@ -1,6 +1,29 @@
 #include "AudioEngine.h"
 
-AudioEngine::AudioEngine() = default;
+#if JUCE_MAC || JUCE_IOS
+ #include <mach/mach_time.h>
+#endif
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+AudioEngine::AudioEngine()
+{
+    for (auto& slot : instrumentSlots)
+        slot.store(nullptr, std::memory_order_relaxed);
+    
+    for (auto& slot : outgoingSlots)
+        slot.store(nullptr, std::memory_order_relaxed);
+    
+    // Reserve room for the most events one block can add so addEvent() never
+    // allocates: a MidiBuffer stores each 3-byte message after an int32 time
+    // and a uint16 size
+    constexpr size_t bytesPerMidiEvent = sizeof(juce::int32) + sizeof(juce::uint16) + 3;
+    for (auto& buffer : midiBuffers)
+        buffer.ensureSize(maxMidiEventsPerBlock * bytesPerMidiEvent);
+    
+    releaseAllMidi.addEvent(juce::MidiMessage::allNotesOff(1), 0);
+}
 
 AudioEngine::~AudioEngine()
 {
@@ -46,8 +69,25 @@ void AudioEngine::shutdown()
     deviceManager.removeAudioCallback(this);
     deviceManager.closeAudioDevice();
     
-    juce::ScopedLock lock(instrumentLock);
-    instruments.clear();
+    // A swap still being built would publish into the slots we're emptying
+    instrumentBuilder.removeAllJobs(false, -1);
+    
+    // The callback is detached, so nothing can be reading the slots any more
+    for (auto& slot : instrumentSlots)
+        delete slot.exchange(nullptr, std::memory_order_acq_rel);
+    
+    for (auto& slot : outgoingSlots)
+        delete slot.exchange(nullptr, std::memory_order_acq_rel);
+    
+    for (auto& wrapper : fadingWrappers)
+    {
+        delete wrapper;
+        wrapper = nullptr;
+    }
+    
+    delete parallelRenderer.exchange(nullptr, std::memory_order_acq_rel);
+    
+    reclaimer.reclaimAll();
 }
 
 // ──────────────────────────────────────────
@@ -56,20 +96,26 @@ void AudioEngine::shutdown()
 
 bool AudioEngine::createOscillatorInstrument(int channel, const Config& config)
 {
-    if (channel < 1 || channel > 16)
+    if (!isValidChannel(channel))
         return false;
     
-    juce::ScopedLock lock(instrumentLock);
-    
+    // Build and prepare on this thread; the audio thread only sees the result
     auto instrument = std::make_unique<Instrument>(config);
+    instrument->setReclaimer(&reclaimer);
     
-    // Prepare if we're already playing
     if (currentSampleRate > 0.0)
     {
         instrument->prepareToPlay(currentSampleRate, currentBlockSize);
     }
     
-    instruments[channel] = std::make_unique<InstrumentWrapper>(std::move(instrument));
+    const juce::ScopedLock lock(sessionLock);
+    cancelInstrumentSwap(channel);
+    publishInstrument(channel, std::make_unique<InstrumentWrapper>(std::move(instrument)));
+    
+    auto* state = editSessionChannel(channel);
+    state->clearInstrument();
+    state->type = SessionSnapshot::ChannelType::Oscillator;
+    state->oscillator = config;
     return true;
 }
 
@@ -80,20 +126,25 @@ bool AudioEngine::createOscillatorInstrument(int channel)
 
 bool AudioEngine::createMultiSamplerInstrument(int channel, const MultiSamplerConfig::Config& config)
 {
-    if (channel < 1 || channel > 16)
+    if (!isValidChannel(channel))
         return false;
     
-    juce::ScopedLock lock(instrumentLock);
-    
     auto instrument = std::make_unique<MultiSamplerInstrument>(config);
+    instrument->setReclaimer(&reclaimer);
     
-    // Prepare if we're already playing
     if (currentSampleRate > 0.0)
     {
         instrument->prepareToPlay(currentSampleRate, currentBlockSize);
     }
     
-    instruments[channel] = std::make_unique<InstrumentWrapper>(std::move(instrument));
+    const juce::ScopedLock lock(sessionLock);
+    cancelInstrumentSwap(channel);
+    publishInstrument(channel, std::make_unique<InstrumentWrapper>(std::move(instrument)));
+    
+    auto* state = editSessionChannel(channel);
+    state->clearInstrument();
+    state->type = SessionSnapshot::ChannelType::MultiSampler;
+    state->sampler = config;
     return true;
 }
 
@@ -102,38 +153,183 @@ bool AudioEngine::createMultiSamplerInstrument(int channel)
     return createMultiSamplerInstrument(channel, MultiSamplerConfig::Config());
 }
 
+// ──────────────────────────────────────────
+// Instrument hot-swap
+// ──────────────────────────────────────────
+
+bool AudioEngine::swapOscillatorInstrument(int channel, const Config& config, double crossfadeMs)
+{
+    if (!isValidChannel(channel))
+        return false;
+    
+    const juce::ScopedLock lock(sessionLock);
+    auto* state = editSessionChannel(channel);
+    if (state->type != SessionSnapshot::ChannelType::Oscillator)
+        state->clearInstrument();
+    
+    state->type = SessionSnapshot::ChannelType::Oscillator;
+    state->oscillator = config;
+    startInstrumentSwap(channel, crossfadeMs);
+    return true;
+}
+
+bool AudioEngine::swapMultiSamplerInstrument(int channel, const MultiSamplerConfig::Config& config, double crossfadeMs)
+{
+    if (!isValidChannel(channel))
+        return false;
+    
+    const juce::ScopedLock lock(sessionLock);
+    auto* state = editSessionChannel(channel);
+    if (state->type != SessionSnapshot::ChannelType::MultiSampler)
+        state->clearInstrument();
+    
+    state->type = SessionSnapshot::ChannelType::MultiSampler;
+    state->sampler = config;
+    startInstrumentSwap(channel, crossfadeMs);
+    return true;
+}
+
+bool AudioEngine::isInstrumentSwapPending(int channel) const
+{
+    return isValidChannel(channel)
+        && pendingSwaps[static_cast<size_t>(channel - 1)].load(std::memory_order_acquire) > 0;
+}
+
+void AudioEngine::startInstrumentSwap(int channel, double crossfadeMs)
+{
+    // Caller holds sessionLock and has already updated the session
+    const auto index = static_cast<size_t>(channel - 1);
+    cancelInstrumentSwap(channel);
+    
+    const auto generation = swapGenerations[index];
+    const auto crossfadeSamples = juce::jmax(0, juce::roundToInt(crossfadeMs * 0.001 * currentSampleRate));
+    
+    pendingSwaps[index].fetch_add(1, std::memory_order_acq_rel);
+    instrumentBuilder.addJob([this, channel, index, generation, crossfadeSamples]
+    {
+        buildInstrumentSwap(channel, generation, crossfadeSamples);
+        pendingSwaps[index].fetch_sub(1, std::memory_order_acq_rel);
+    });
+}
+
+void AudioEngine::buildInstrumentSwap(int channel, juce::uint32 generation, int crossfadeSamples)
+{
+    const auto index = static_cast<size_t>(channel - 1);
+    
+    // Runs on the builder thread. Builds from a copy of the channel's state,
+    // and again from the new state if the channel was edited meanwhile.
+    for (;;)
+    {
+        SessionSnapshot::Channel state;
+        juce::uint32 revision = 0;
+        {
+            const juce::ScopedLock lock(sessionLock);
+            if (swapGenerations[index] != generation)
+                return;
+            
+            state = session.channels[index];
+            revision = sessionRevisions[index];
+        }
+        
+        auto wrapper = buildInstrument(state);
+        if (wrapper != nullptr)
+            wrapper->crossfadeSamples = crossfadeSamples;
+        
+        const juce::ScopedLock lock(sessionLock);
+        if (swapGenerations[index] != generation)
+            return;
+        
+        if (sessionRevisions[index] == revision)
+        {
+            publishInstrument(channel, std::move(wrapper));
+            return;
+        }
+    }
+}
+
 void AudioEngine::removeInstrument(int channel)
 {
-    juce::ScopedLock lock(instrumentLock);
-    instruments.erase(channel);
+    if (isValidChannel(channel))
+    {
+        const juce::ScopedLock lock(sessionLock);
+        cancelInstrumentSwap(channel);
+        publishInstrument(channel, nullptr);
+        editSessionChannel(channel)->clearInstrument();
+    }
 }
 
 void AudioEngine::clearAllInstruments()
 {
-    juce::ScopedLock lock(instrumentLock);
-    instruments.clear();
+    const juce::ScopedLock lock(sessionLock);
+    for (int channel = 1; channel <= maxChannels; ++channel)
+    {
+        cancelInstrumentSwap(channel);
+        publishInstrument(channel, nullptr);
+        editSessionChannel(channel)->clearInstrument();
+    }
 }
 
 bool AudioEngine::hasInstrument(int channel) const
 {
-    juce::ScopedLock lock(instrumentLock);
-    return instruments.find(channel) != instruments.end();
+    return getInstrumentWrapper(channel) != nullptr;
 }
 
 AudioEngine::InstrumentType AudioEngine::getInstrumentType(int channel) const
 {
-    juce::ScopedLock lock(instrumentLock);
-    auto it = instruments.find(channel);
-    if (it != instruments.end())
-        return it->second->type;
+    if (auto* wrapper = getInstrumentWrapper(channel))
+        return wrapper->type;
     return InstrumentType::Oscillator; // Default
 }
 
-AudioEngine::InstrumentWrapper* AudioEngine::getInstrumentWrapper(int channel)
+AudioEngine::InstrumentWrapper* AudioEngine::getInstrumentWrapper(int channel) const
+{
+    if (!isValidChannel(channel))
+        return nullptr;
+    
+    return instrumentSlots[static_cast<size_t>(channel - 1)].load(std::memory_order_acquire);
+}
+
+SessionSnapshot::Channel* AudioEngine::editSessionChannel(int channel)
+{
+    // Callers hold sessionLock
+    if (!isValidChannel(channel))
+        return nullptr;
+    
+    ++sessionRevisions[static_cast<size_t>(channel - 1)];
+    return &session.channels[static_cast<size_t>(channel - 1)];
+}
+
+void AudioEngine::publishInstrument(int channel, std::unique_ptr<InstrumentWrapper> wrapper)
+{
+    const auto index = static_cast<size_t>(channel - 1);
+    const bool crossfade = wrapper != nullptr && wrapper->crossfadeSamples > 0;
+    
+    // Single atomic swap - the audio thread picks up the new pointer on its next
+    // callback, and the old one is deleted later on the reclaimer thread.
+    auto* previous = instrumentSlots[index].exchange(wrapper.release(), std::memory_order_acq_rel);
+    
+    // A crossfade hands the old instrument to the audio thread instead, which
+    // gives it back once it has faded out. One the audio thread never took
+    // (swapped again straight away) is retired as usual.
+    if (crossfade && previous != nullptr)
+        previous = outgoingSlots[index].exchange(previous, std::memory_order_acq_rel);
+    
+    reclaimer.retire(std::unique_ptr<InstrumentWrapper>(previous));
+    
+    // Notes scheduled for the old instrument don't carry over to a new one or
+    // an empty channel; a crossfaded patch change keeps them
+    if (!crossfade)
+    {
+        EngineCommand command;
+        command.type = EngineCommand::Type::CancelScheduledNotes;
+        command.channel = static_cast<uint8_t>(channel);
+        pushCommand(command);
+    }
+}
+
+void AudioEngine::cancelInstrumentSwap(int channel)
 {
-    juce::ScopedLock lock(instrumentLock);
-    auto it = instruments.find(channel);
-    return (it != instruments.end()) ? it->second.get() : nullptr;
+    ++swapGenerations[static_cast<size_t>(channel - 1)];
 }
 
 Instrument* AudioEngine::getOscillatorInstrument(int channel)
@@ -163,17 +359,23 @@ MultiSamplerInstrument* AudioEngine::getMultiSamplerInstrument(int channel)
 bool AudioEngine::loadSample(int channel, int slotIndex, const juce::String& filePath,
                             const MultiSamplerConfig::SampleConfig& config)
 {
+    const juce::ScopedLock lock(sessionLock);
     auto* sampler = getMultiSamplerInstrument(channel);
     if (!sampler)
         return false;
     
-    return sampler->loadSample(slotIndex, filePath, config);
+    if (!sampler->loadSample(slotIndex, filePath, config))
+        return false;
+    
+    editSessionChannel(channel)->setSample(slotIndex, config, sampler->getSampleData(slotIndex));
+    return true;
 }
 
 bool AudioEngine::loadSampleFromBase64(int channel, int slotIndex, const juce::String& base64Data,
                                       double sampleRate, int numChannels,
                                       const MultiSamplerConfig::SampleConfig& config)
 {
+    const juce::ScopedLock lock(sessionLock);
     auto* sampler = getMultiSamplerInstrument(channel);
     if (!sampler)
         return false;
@@ -208,7 +410,8 @@ bool AudioEngine::loadSampleFromBase64(int channel, int slotIndex, const juce::S
         
         reader->read(&audioData, 0, static_cast<int>(reader->lengthInSamples), 0, true, true);
         
-        return sampler->loadSampleFromBuffer(slotIndex, audioData, reader->sampleRate, config);
+        if (!sampler->loadSampleFromBuffer(slotIndex, audioData, reader->sampleRate, config))
+            return false;
     }
     else
     {
@@ -240,101 +443,267 @@ bool AudioEngine::loadSampleFromBase64(int channel, int slotIndex, const juce::S
             }
         }
         
-        return sampler->loadSampleFromBuffer(slotIndex, audioData, sampleRate, config);
+        if (!sampler->loadSampleFromBuffer(slotIndex, audioData, sampleRate, config))
+            return false;
     }
+    
+    editSessionChannel(channel)->setSample(slotIndex, config, sampler->getSampleData(slotIndex));
+    return true;
 }
 
 void AudioEngine::clearSample(int channel, int slotIndex)
 {
+    const juce::ScopedLock lock(sessionLock);
     if (auto* sampler = getMultiSamplerInstrument(channel))
     {
         sampler->clearSample(slotIndex);
+        editSessionChannel(channel)->removeSample(slotIndex);
     }
 }
 
 void AudioEngine::clearAllSamples(int channel)
 {
+    const juce::ScopedLock lock(sessionLock);
     if (auto* sampler = getMultiSamplerInstrument(channel))
     {
         sampler->clearAllSamples();
+        editSessionChannel(channel)->samples.clear();
     }
 }
 
+bool AudioEngine::loadWavetable(int channel, const juce::String& filePath, double crossfadeMs)
+{
+    if (getInstrumentType(channel) != InstrumentType::Oscillator)
+        return false;
+    
+    // Decoded and band-limited here, outside the session lock
+    auto wavetable = Wavetable::fromAudioFile(juce::File(filePath));
+    return wavetable != nullptr && setWavetable(channel, std::move(wavetable), crossfadeMs);
+}
+
+bool AudioEngine::setWavetable(int channel, std::shared_ptr<const Wavetable> wavetable, double crossfadeMs)
+{
+    if (!isValidChannel(channel) || wavetable == nullptr)
+        return false;
+    
+    const juce::ScopedLock lock(sessionLock);
+    const auto& state = session.channels[static_cast<size_t>(channel - 1)];
+    if (state.type != SessionSnapshot::ChannelType::Oscillator)
+        return false;
+    
+    auto config = state.oscillator;
+    config.wavetable = std::move(wavetable);
+    config.waveform = BaseOscillatorVoice::Waveform::Wavetable;
+    return swapOscillatorInstrument(channel, config, crossfadeMs);
+}
+
 // ──────────────────────────────────────────
 // Note control
 // ──────────────────────────────────────────
 
 void AudioEngine::noteOn(int channel, int midiNote, float velocity)
 {
-    auto* wrapper = getInstrumentWrapper(channel);
-    if (!wrapper)
+    if (!isValidChannel(channel) || midiNote < 0 || midiNote > 127)
         return;
     
-    if (wrapper->type == InstrumentType::Oscillator)
-    {
-        auto* osc = std::get<std::unique_ptr<Instrument>>(wrapper->instrument).get();
-        osc->noteOn(midiNote, velocity);
-    }
-    else if (wrapper->type == InstrumentType::MultiSampler)
-    {
-        auto* sampler = std::get<std::unique_ptr<MultiSamplerInstrument>>(wrapper->instrument).get();
-        sampler->noteOn(midiNote, velocity);
-    }
+    EngineCommand command;
+    command.type = EngineCommand::Type::NoteOn;
+    command.channel = static_cast<uint8_t>(channel);
+    command.note = static_cast<uint8_t>(midiNote);
+    command.values[0] = velocity;
+    pushCommand(command);
 }
 
 void AudioEngine::noteOff(int channel, int midiNote)
 {
-    auto* wrapper = getInstrumentWrapper(channel);
-    if (!wrapper)
+    if (!isValidChannel(channel) || midiNote < 0 || midiNote > 127)
         return;
     
-    if (wrapper->type == InstrumentType::Oscillator)
-    {
-        auto* osc = std::get<std::unique_ptr<Instrument>>(wrapper->instrument).get();
-        osc->noteOff(midiNote);
-    }
-    else if (wrapper->type == InstrumentType::MultiSampler)
-    {
-        auto* sampler = std::get<std::unique_ptr<MultiSamplerInstrument>>(wrapper->instrument).get();
-        sampler->noteOff(midiNote);
-    }
+    EngineCommand command;
+    command.type = EngineCommand::Type::NoteOff;
+    command.channel = static_cast<uint8_t>(channel);
+    command.note = static_cast<uint8_t>(midiNote);
+    pushCommand(command);
 }
 
 void AudioEngine::allNotesOff(int channel)
 {
-    auto* wrapper = getInstrumentWrapper(channel);
-    if (!wrapper)
+    if (!isValidChannel(channel))
         return;
     
-    if (wrapper->type == InstrumentType::Oscillator)
-    {
-        auto* osc = std::get<std::unique_ptr<Instrument>>(wrapper->instrument).get();
-        osc->allNotesOff();
-    }
-    else if (wrapper->type == InstrumentType::MultiSampler)
-    {
-        auto* sampler = std::get<std::unique_ptr<MultiSamplerInstrument>>(wrapper->instrument).get();
-        sampler->allNotesOff();
-    }
+    EngineCommand command;
+    command.type = EngineCommand::Type::AllNotesOff;
+    command.channel = static_cast<uint8_t>(channel);
+    pushCommand(command);
 }
 
 void AudioEngine::allNotesOffAllChannels()
 {
-    juce::ScopedLock lock(instrumentLock);
-    for (auto& pair : instruments)
+    EngineCommand command;
+    command.type = EngineCommand::Type::AllNotesOff;
+    command.channel = 0;
+    pushCommand(command);
+}
+
+void AudioEngine::scheduleNoteOn(int channel, int midiNote, float velocity, juce::uint64 hostTimeNs)
+{
+    if (!isValidChannel(channel) || midiNote < 0 || midiNote > 127)
+        return;
+    
+    EngineCommand command;
+    command.type = EngineCommand::Type::NoteOn;
+    command.channel = static_cast<uint8_t>(channel);
+    command.note = static_cast<uint8_t>(midiNote);
+    command.values[0] = velocity;
+    command.hostTimeNs = hostTimeNs;
+    pushCommand(command);
+}
+
+void AudioEngine::scheduleNoteOff(int channel, int midiNote, juce::uint64 hostTimeNs)
+{
+    if (!isValidChannel(channel) || midiNote < 0 || midiNote > 127)
+        return;
+    
+    EngineCommand command;
+    command.type = EngineCommand::Type::NoteOff;
+    command.channel = static_cast<uint8_t>(channel);
+    command.note = static_cast<uint8_t>(midiNote);
+    command.hostTimeNs = hostTimeNs;
+    pushCommand(command);
+}
+
+void AudioEngine::noteOnRecordedAt(int channel, int midiNote, float velocity, juce::uint64 recordTimeNs)
+{
+    if (!isValidChannel(channel) || midiNote < 0 || midiNote > 127)
+        return;
+    
+    EngineCommand command;
+    command.type = EngineCommand::Type::NoteOn;
+    command.channel = static_cast<uint8_t>(channel);
+    command.note = static_cast<uint8_t>(midiNote);
+    command.values[0] = velocity;
+    command.recordTimeNs = recordTimeNs;
+    pushCommand(command);
+}
+
+void AudioEngine::noteOffRecordedAt(int channel, int midiNote, juce::uint64 recordTimeNs)
+{
+    if (!isValidChannel(channel) || midiNote < 0 || midiNote > 127)
+        return;
+    
+    EngineCommand command;
+    command.type = EngineCommand::Type::NoteOff;
+    command.channel = static_cast<uint8_t>(channel);
+    command.note = static_cast<uint8_t>(midiNote);
+    command.recordTimeNs = recordTimeNs;
+    pushCommand(command);
+}
+
+juce::uint64 AudioEngine::getHostTimeNs()
+{
+   #if JUCE_MAC || JUCE_IOS
+    // Same conversion CoreAudio's host time goes through before it reaches
+    // AudioIODeviceCallbackContext::hostTimeNs
+    static const auto timebase = []
     {
-        auto* wrapper = pair.second.get();
-        if (wrapper->type == InstrumentType::Oscillator)
-        {
-            auto* osc = std::get<std::unique_ptr<Instrument>>(wrapper->instrument).get();
-            osc->allNotesOff();
-        }
-        else if (wrapper->type == InstrumentType::MultiSampler)
+        mach_timebase_info_data_t info {};
+        mach_timebase_info(&info);
+        return info;
+    }();
+    
+    return static_cast<juce::uint64>(static_cast<unsigned __int128>(mach_absolute_time())
+                                     * timebase.numer / timebase.denom);
+   #else
+    return static_cast<juce::uint64>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+   #endif
+}
+
+int AudioEngine::submitBatch(const void* data, size_t numBytes)
+{
+    if (data == nullptr || numBytes % BatchRecord::size != 0)
+        return -1;
+    
+    // One clock read for the whole batch, so its delays stay relative to each other
+    const auto now = getHostTimeNs();
+    const auto timeFor = [now](float delayMs)
+    {
+        return delayMs > 0.0f ? now + static_cast<juce::uint64>(static_cast<double>(delayMs) * 1.0e6) : 0;
+    };
+    
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    int applied = 0;
+    
+    for (size_t offset = 0; offset < numBytes; offset += BatchRecord::size)
+    {
+        const auto record = BatchRecord::read(bytes, offset);
+        const int channel = record.channel;
+        const int index = record.index;
+        
+        const bool engineWide = (record.op == BatchRecord::Op::AllNotesOff && channel == 0)
+                                || record.op == BatchRecord::Op::StartTransport
+                                || record.op == BatchRecord::Op::StopTransport;
+        if (!engineWide && !isValidChannel(channel))
+            continue;
+        
+        switch (record.op)
         {
-            auto* sampler = std::get<std::unique_ptr<MultiSamplerInstrument>>(wrapper->instrument).get();
-            sampler->allNotesOff();
+            case BatchRecord::Op::NoteOn:
+                if (index > 127)
+                    continue;
+                scheduleNoteOn(channel, index, record.value, timeFor(record.delayMs));
+                break;
+            case BatchRecord::Op::NoteOff:
+                if (index > 127)
+                    continue;
+                scheduleNoteOff(channel, index, timeFor(record.delayMs));
+                break;
+            case BatchRecord::Op::AllNotesOff:
+                if (channel == 0)
+                    allNotesOffAllChannels();
+                else
+                    allNotesOff(channel);
+                break;
+            case BatchRecord::Op::SetVolume:
+                setVolume(channel, record.value);
+                break;
+            case BatchRecord::Op::SetPan:
+                setPan(channel, record.value);
+                break;
+            case BatchRecord::Op::SetDetune:
+                setDetune(channel, record.value);
+                break;
+            case BatchRecord::Op::SetWaveform:
+                if (index > static_cast<int>(BaseOscillatorVoice::Waveform::Wavetable))
+                    continue;
+                setWaveform(channel, static_cast<BaseOscillatorVoice::Waveform>(index));
+                break;
+            case BatchRecord::Op::SetEffectEnabled:
+                setEffectEnabled(channel, record.effectId, record.value != 0.0f);
+                break;
+            case BatchRecord::Op::SetEffectParameter:
+                if (index >= Instrument::numEffectParameters)
+                    continue;
+                setEffectParameter(channel, record.effectId, static_cast<Instrument::EffectParameter>(index), record.value);
+                break;
+            case BatchRecord::Op::SetSendLevel:
+                if (!isValidSendBus(index))
+                    continue;
+                setSendLevel(channel, index, record.value);
+                break;
+            case BatchRecord::Op::StartTransport:
+                startTransport();
+                break;
+            case BatchRecord::Op::StopTransport:
+                stopTransport();
+                break;
+            default:
+                continue;
         }
+        ++applied;
     }
+    
+    return applied;
 }
 
 // ──────────────────────────────────────────
@@ -343,18 +712,34 @@ void AudioEngine::allNotesOffAllChannels()
 
 void AudioEngine::setWaveform(int channel, BaseOscillatorVoice::Waveform waveform)
 {
-    if (auto* instrument = getOscillatorInstrument(channel))
-    {
-        instrument->setWaveform(waveform);
-    }
+    if (!isValidChannel(channel))
+        return;
+    
+    EngineCommand command;
+    command.type = EngineCommand::Type::SetWaveform;
+    command.channel = static_cast<uint8_t>(channel);
+    command.param = static_cast<int32_t>(waveform);
+    pushCommand(command);
+    
+    const juce::ScopedLock lock(sessionLock);
+    if (auto* state = editSessionChannel(channel))
+        state->oscillator.waveform = waveform;
 }
 
 void AudioEngine::setDetune(int channel, float cents)
 {
-    if (auto* instrument = getOscillatorInstrument(channel))
-    {
-        instrument->setDetune(cents);
-    }
+    if (!isValidChannel(channel))
+        return;
+    
+    EngineCommand command;
+    command.type = EngineCommand::Type::SetDetune;
+    command.channel = static_cast<uint8_t>(channel);
+    command.values[0] = cents;
+    pushCommand(command);
+    
+    const juce::ScopedLock lock(sessionLock);
+    if (auto* state = editSessionChannel(channel))
+        state->oscillator.detune = cents;
 }
 
 // ──────────────────────────────────────────
@@ -363,57 +748,62 @@ void AudioEngine::setDetune(int channel, float cents)
 
 void AudioEngine::setADSR(int channel, float attack, float decay, float sustain, float release)
 {
-    auto* wrapper = getInstrumentWrapper(channel);
-    if (!wrapper)
+    if (!isValidChannel(channel))
         return;
     
-    juce::ADSR::Parameters params { attack, decay, sustain, release };
+    EngineCommand command;
+    command.type = EngineCommand::Type::SetADSR;
+    command.channel = static_cast<uint8_t>(channel);
+    command.values[0] = attack;
+    command.values[1] = decay;
+    command.values[2] = sustain;
+    command.values[3] = release;
+    pushCommand(command);
     
-    if (wrapper->type == InstrumentType::Oscillator)
-    {
-        auto* osc = std::get<std::unique_ptr<Instrument>>(wrapper->instrument).get();
-        osc->setADSR(params);
-    }
-    else if (wrapper->type == InstrumentType::MultiSampler)
+    const juce::ScopedLock lock(sessionLock);
+    if (auto* state = editSessionChannel(channel))
     {
-        auto* sampler = std::get<std::unique_ptr<MultiSamplerInstrument>>(wrapper->instrument).get();
-        sampler->setADSR(params);
+        const juce::ADSR::Parameters params { attack, decay, sustain, release };
+        state->oscillator.adsrParams = params;
+        state->sampler.adsrParams = params;
     }
 }
 
 void AudioEngine::setVolume(int channel, float volume)
 {
-    auto* wrapper = getInstrumentWrapper(channel);
-    if (!wrapper)
+    if (!isValidChannel(channel))
         return;
     
-    if (wrapper->type == InstrumentType::Oscillator)
-    {
-        auto* osc = std::get<std::unique_ptr<Instrument>>(wrapper->instrument).get();
-        osc->setVolume(volume);
-    }
-    else if (wrapper->type == InstrumentType::MultiSampler)
+    EngineCommand command;
+    command.type = EngineCommand::Type::SetVolume;
+    command.channel = static_cast<uint8_t>(channel);
+    command.values[0] = volume;
+    pushCommand(command);
+    
+    const juce::ScopedLock lock(sessionLock);
+    if (auto* state = editSessionChannel(channel))
     {
-        auto* sampler = std::get<std::unique_ptr<MultiSamplerInstrument>>(wrapper->instrument).get();
-        sampler->setVolume(volume);
+        state->oscillator.volume = volume;
+        state->sampler.volume = volume;
     }
 }
 
 void AudioEngine::setPan(int channel, float pan)
 {
-    auto* wrapper = getInstrumentWrapper(channel);
-    if (!wrapper)
+    if (!isValidChannel(channel))
         return;
     
-    if (wrapper->type == InstrumentType::Oscillator)
-    {
-        auto* osc = std::get<std::unique_ptr<Instrument>>(wrapper->instrument).get();
-        osc->setPan(pan);
-    }
-    else if (wrapper->type == InstrumentType::MultiSampler)
+    EngineCommand command;
+    command.type = EngineCommand::Type::SetPan;
+    command.channel = static_cast<uint8_t>(channel);
+    command.values[0] = pan;
+    pushCommand(command);
+    
+    const juce::ScopedLock lock(sessionLock);
+    if (auto* state = editSessionChannel(channel))
     {
-        auto* sampler = std::get<std::unique_ptr<MultiSamplerInstrument>>(wrapper->instrument).get();
-        sampler->setPan(pan);
+        state->oscillator.pan = pan;
+        state->sampler.pan = pan;
     }
 }
 
@@ -423,147 +813,1407 @@ void AudioEngine::setPan(int channel, float pan)
 
 int AudioEngine::addEffect(int channel, Instrument::EffectType type)
 {
+    const juce::ScopedLock lock(sessionLock);
     if (auto* instrument = getOscillatorInstrument(channel))
     {
-        return instrument->addEffect(type);
+        const auto effectId = instrument->addEffect(type);
+        if (effectId > 0)
+        {
+            SessionSnapshot::Effect effect;
+            effect.id = effectId;
+            effect.type = type;
+            editSessionChannel(channel)->effects.push_back(effect);
+        }
+        return effectId;
     }
     return -1;
 }
 
 void AudioEngine::removeEffect(int channel, int effectId)
 {
+    const juce::ScopedLock lock(sessionLock);
     if (auto* instrument = getOscillatorInstrument(channel))
     {
         instrument->removeEffect(effectId);
+        
+        auto& effects = editSessionChannel(channel)->effects;
+        effects.erase(std::remove_if(effects.begin(), effects.end(),
+                                     [effectId](const auto& effect) { return effect.id == effectId; }),
+                      effects.end());
     }
 }
 
 void AudioEngine::clearEffects(int channel)
 {
+    const juce::ScopedLock lock(sessionLock);
     if (auto* instrument = getOscillatorInstrument(channel))
     {
         instrument->clearEffects();
+        editSessionChannel(channel)->effects.clear();
     }
 }
 
 void AudioEngine::setEffectEnabled(int channel, int effectId, bool enabled)
 {
-    if (auto* instrument = getOscillatorInstrument(channel))
-    {
-        instrument->setEffectEnabled(effectId, enabled);
-    }
+    if (!isValidChannel(channel))
+        return;
+    
+    EngineCommand command;
+    command.type = EngineCommand::Type::SetEffectEnabled;
+    command.channel = static_cast<uint8_t>(channel);
+    command.effectId = effectId;
+    command.param = enabled ? 1 : 0;
+    pushCommand(command);
+    
+    const juce::ScopedLock lock(sessionLock);
+    if (auto* state = editSessionChannel(channel))
+        if (auto* effect = state->findEffect(effectId))
+            effect->enabled = enabled;
 }
 
 void AudioEngine::setEffectParameter(int channel, int effectId,
                                      const juce::String& paramName, float value)
 {
-    if (auto* instrument = getOscillatorInstrument(channel))
-    {
-        instrument->setEffectParameter(effectId, paramName, value);
-    }
+    // Resolve the name here so the audio thread never handles strings
+    setEffectParameter(channel, effectId, Instrument::parseEffectParameter(paramName), value);
 }
 
-// ──────────────────────────────────────────
-// Global controls
-// ──────────────────────────────────────────
-
-void AudioEngine::setMasterVolume(float volume)
+void AudioEngine::setEffectParameter(int channel, int effectId,
+                                     Instrument::EffectParameter param, float value)
 {
-    masterVolume = juce::jlimit(0.0f, 2.0f, volume);
+    if (!isValidChannel(channel) || param == Instrument::EffectParameter::Unknown)
+        return;
+    
+    EngineCommand command;
+    command.type = EngineCommand::Type::SetEffectParameter;
+    command.channel = static_cast<uint8_t>(channel);
+    command.effectId = effectId;
+    command.param = static_cast<int32_t>(param);
+    command.values[0] = value;
+    pushCommand(command);
+    
+    const juce::ScopedLock lock(sessionLock);
+    if (auto* state = editSessionChannel(channel))
+        if (auto* effect = state->findEffect(effectId))
+            effect->setParameter(param, value);
 }
 
-// ──────────────────────────────────────────
-// Info
-// ──────────────────────────────────────────
-
-int AudioEngine::getActiveChannelCount() const
+bool AudioEngine::setEffectSidechain(int channel, int effectId, int sourceChannel)
 {
-    juce::ScopedLock lock(instrumentLock);
-    return static_cast<int>(instruments.size());
+    if (!isValidChannel(channel) || sourceChannel == channel
+        || (sourceChannel != 0 && !isValidChannel(sourceChannel)))
+        return false;
+    
+    const juce::ScopedLock lock(sessionLock);
+    auto& state = session.channels[static_cast<size_t>(channel - 1)];
+    if (state.type != SessionSnapshot::ChannelType::Oscillator || state.findEffect(effectId) == nullptr)
+        return false;
+    
+    if (sourceChannel != 0 && createsSidechainLoop(session, channel, sourceChannel))
+    {
+        DBG("Sidechain from channel " << sourceChannel << " to channel " << channel << " would form a loop");
+        return false;
+    }
+    
+    EngineCommand command;
+    command.type = EngineCommand::Type::SetEffectSidechain;
+    command.channel = static_cast<uint8_t>(channel);
+    command.effectId = effectId;
+    command.param = sourceChannel;
+    if (!pushCommand(command))
+        return false;
+    
+    editSessionChannel(channel)->findEffect(effectId)->sidechainChannel = sourceChannel;
+    return true;
 }
 
-std::vector<int> AudioEngine::getActiveChannels() const
+bool AudioEngine::createsSidechainLoop(const SessionSnapshot& state, int channel, int sourceChannel)
 {
-    juce::ScopedLock lock(instrumentLock);
-    std::vector<int> channels;
-    for (const auto& pair : instruments)
+    // Would channel end up keyed by itself, following the source's own sidechains?
+    std::vector<int> pending { sourceChannel };
+    juce::uint32 visited = 0;
+    
+    while (!pending.empty())
     {
-        channels.push_back(pair.first);
+        const auto current = pending.back();
+        pending.pop_back();
+        
+        if (current == channel)
+            return true;
+        if ((visited & (1u << (current - 1))) != 0)
+            continue;
+        visited |= 1u << (current - 1);
+        
+        for (const auto& effect : state.channels[static_cast<size_t>(current - 1)].effects)
+            if (effect.sidechainChannel > 0)
+                pending.push_back(effect.sidechainChannel);
     }
-    return channels;
+    
+    return false;
 }
 
 // ──────────────────────────────────────────
-// JUCE callbacks
+// Send/return effect buses
 // ──────────────────────────────────────────
 
-void AudioEngine::audioDeviceAboutToStart(juce::AudioIODevice* device)
+bool AudioEngine::setSendBusEffect(int bus, Instrument::EffectType type)
 {
-    currentSampleRate = device->getCurrentSampleRate();
-    currentBlockSize = device->getCurrentBufferSizeSamples();
+    if (!isValidSendBus(bus))
+        return false;
     
-    // Prepare mix buffer
-    mixBuffer.setSize(2, currentBlockSize);
+    const juce::ScopedLock lock(sessionLock);
+    if (!sendBuses.setEffect(bus - 1, type))
+        return false;
     
-    // Prepare all instruments
-    juce::ScopedLock lock(instrumentLock);
-    for (auto& pair : instruments)
-    {
-        prepareInstrumentWrapper(pair.second.get());
-    }
+    auto& state = session.sendBuses[static_cast<size_t>(bus - 1)];
+    state.hasEffect = true;
+    state.effect = SessionSnapshot::Effect();
+    state.effect.id = bus;
+    state.effect.type = type;
+    return true;
 }
 
-void AudioEngine::audioDeviceIOCallbackWithContext(
-    const float* const* /*inputChannelData*/,
+void AudioEngine::clearSendBusEffect(int bus)
+{
+    if (!isValidSendBus(bus))
+        return;
+    
+    const juce::ScopedLock lock(sessionLock);
+    sendBuses.clearEffect(bus - 1);
+    
+    auto& state = session.sendBuses[static_cast<size_t>(bus - 1)];
+    state.hasEffect = false;
+    state.effect = SessionSnapshot::Effect();
+}
+
+void AudioEngine::setSendBusParameter(int bus, const juce::String& paramName, float value)
+{
+    const auto param = Instrument::parseEffectParameter(paramName);
+    if (!isValidSendBus(bus) || param == Instrument::EffectParameter::Unknown)
+        return;
+    
+    const juce::ScopedLock lock(sessionLock);
+    sendBuses.setEffectParameter(bus - 1, param, value);
+    
+    auto& state = session.sendBuses[static_cast<size_t>(bus - 1)];
+    if (state.hasEffect)
+        state.effect.setParameter(param, value);
+}
+
+void AudioEngine::setSendBusReturnLevel(int bus, float level)
+{
+    if (!isValidSendBus(bus))
+        return;
+    
+    const juce::ScopedLock lock(sessionLock);
+    sendBuses.setReturnLevel(bus - 1, level);
+    session.sendBuses[static_cast<size_t>(bus - 1)].returnLevel = juce::jlimit(0.0f, 1.0f, level);
+}
+
+void AudioEngine::setSendLevel(int channel, int bus, float level)
+{
+    if (!isValidChannel(channel) || !isValidSendBus(bus))
+        return;
+    
+    // Sends belong to the channel, not its instrument: no revision bump
+    const juce::ScopedLock lock(sessionLock);
+    sendBuses.setSendLevel(channel - 1, bus - 1, level);
+    session.channels[static_cast<size_t>(channel - 1)].sendLevels[static_cast<size_t>(bus - 1)] = juce::jlimit(0.0f, 1.0f, level);
+}
+
+// ──────────────────────────────────────────
+// Global controls
+// ──────────────────────────────────────────
+
+void AudioEngine::setMasterVolume(float volume)
+{
+    masterBus.setGain(volume);
+}
+
+void AudioEngine::setMasterEqBand(MasterBus::EqBand band, float frequencyHz, float gainDb, float q)
+{
+    masterBus.setEqBand(band, frequencyHz, gainDb, q);
+}
+
+void AudioEngine::setMasterEqEnabled(bool enabled)
+{
+    masterBus.setEqEnabled(enabled);
+}
+
+void AudioEngine::setMasterCompressor(float thresholdDb, float ratio, float attackMs, float releaseMs, float makeupDb)
+{
+    masterBus.setCompressor(thresholdDb, ratio, attackMs, releaseMs, makeupDb);
+}
+
+void AudioEngine::setMasterCompressorEnabled(bool enabled)
+{
+    masterBus.setCompressorEnabled(enabled);
+}
+
+void AudioEngine::setMasterLimiter(float ceilingDb, float releaseMs)
+{
+    masterBus.setLimiter(ceilingDb, releaseMs);
+}
+
+void AudioEngine::setMasterLimiterEnabled(bool enabled)
+{
+    masterBus.setLimiterEnabled(enabled);
+}
+
+// ──────────────────────────────────────────
+// Info
+// ──────────────────────────────────────────
+
+int AudioEngine::getActiveChannelCount() const
+{
+    return static_cast<int>(getActiveChannels().size());
+}
+
+std::vector<int> AudioEngine::getActiveChannels() const
+{
+    std::vector<int> channels;
+    for (int channel = 1; channel <= maxChannels; ++channel)
+    {
+        if (hasInstrument(channel))
+            channels.push_back(channel);
+    }
+    return channels;
+}
+
+AudioEngine::BypassStats AudioEngine::getBypassStats() const
+{
+    BypassStats stats;
+    stats.channelsRendered = lastChannelsRendered.load(std::memory_order_relaxed);
+    stats.channelsBypassed = lastChannelsBypassed.load(std::memory_order_relaxed);
+    stats.effectsBypassed = lastEffectsBypassed.load(std::memory_order_relaxed);
+    stats.totalBlocks = totalBlocksRendered.load(std::memory_order_relaxed);
+    stats.totalChannelsBypassed = totalChannelsBypassed.load(std::memory_order_relaxed);
+    stats.totalEffectsBypassed = totalEffectsBypassed.load(std::memory_order_relaxed);
+    return stats;
+}
+
+AudioEngine::PerformanceStats AudioEngine::getPerformanceStats() const
+{
+    PerformanceStats stats;
+    stats.budgetMicros = deviceBlockSize * 1.0e6 / currentSampleRate;
+    stats.loadProportion = loadProportion.load(std::memory_order_relaxed);
+    stats.callback = callbackTiming.getSummary();
+    stats.overruns = overrunCount.load(std::memory_order_relaxed);
+    stats.xruns = juce::jmax(0, deviceManager.getXRunCount() - xrunCountAtReset);
+    
+    // Instruments are published and retired, and their effect chains edited,
+    // only with sessionLock held, so both stay alive while we walk them
+    const juce::ScopedLock lock(sessionLock);
+    for (int channel = 1; channel <= maxChannels; ++channel)
+    {
+        auto* wrapper = getInstrumentWrapper(channel);
+        if (wrapper == nullptr)
+            continue;
+        
+        PerformanceStats::Channel channelStats;
+        channelStats.channel = channel;
+        channelStats.render = channelTimings[static_cast<size_t>(channel - 1)].getSummary();
+        
+        if (wrapper->type == InstrumentType::Oscillator)
+            channelStats.effects = std::get<std::unique_ptr<Instrument>>(wrapper->instrument)->getEffectTimings();
+        
+        stats.channels.push_back(std::move(channelStats));
+    }
+    
+    stats.sendBuses = sendBuses.getTimings();
+    for (auto& bus : stats.sendBuses)
+        ++bus.bus;
+    
+    return stats;
+}
+
+void AudioEngine::resetPerformanceStats()
+{
+    xrunCountAtReset = deviceManager.getXRunCount();
+    timingResetPending.store(true, std::memory_order_release);
+}
+
+AudioEngine::Meters AudioEngine::getMeters() const
+{
+    const juce::ScopedLock lock(meterReadLock);
+    return publishedMeters.read();
+}
+
+void AudioEngine::resetLoudness()
+{
+    loudnessResetPending.store(true, std::memory_order_release);
+}
+
+juce::StringArray AudioEngine::describeRealtimeViolations() const
+{
+    juce::StringArray descriptions;
+    for (const auto& violation : RealtimeSafety::getRecentViolations())
+        descriptions.add(RealtimeSafety::describe(violation));
+    return descriptions;
+}
+
+int AudioEngine::getCommandQueueDepth() const
+{
+    return static_cast<int>(commandQueue.getApproximateDepth());
+}
+
+int AudioEngine::getCommandQueueOverflowCount() const
+{
+    return static_cast<int>(commandQueue.getOverflowCount());
+}
+
+// ──────────────────────────────────────────
+// Loop sequencer
+// ──────────────────────────────────────────
+
+void AudioEngine::setSequence(int channel, std::vector<LoopSequencer::Event> events, double durationMs)
+{
+    if (!isValidChannel(channel))
+        return;
+    
+    if (durationMs <= 0.0)
+    {
+        clearSequence(channel);
+        return;
+    }
+    
+    const juce::ScopedLock lock(sessionLock);
+    auto* state = editSessionChannel(channel);
+    state->sequence = events;
+    state->sequenceDurationMs = durationMs;
+    
+    sequencer.setSequence(channel, std::move(events), durationMs);
+}
+
+void AudioEngine::clearSequence(int channel)
+{
+    sequencer.clearSequence(channel);
+    
+    const juce::ScopedLock lock(sessionLock);
+    if (auto* state = editSessionChannel(channel))
+    {
+        state->sequence.clear();
+        state->sequenceDurationMs = 0.0;
+    }
+}
+
+void AudioEngine::startTransport()
+{
+    sequencer.play();
+}
+
+void AudioEngine::stopTransport()
+{
+    // The loop's own notes are released by the sequencer. Notes parked by
+    // scheduleNoteOn(), delayed batch records or worklets don't belong to the
+    // transport and stay queued, so no note-on loses its matching note-off.
+    sequencer.stop();
+}
+
+void AudioEngine::startRecording(int channel)
+{
+    sequencer.startRecording(channel);
+}
+
+std::vector<LoopSequencer::Event> AudioEngine::stopRecording(int channel)
+{
+    return sequencer.stopRecording(channel);
+}
+
+int AudioEngine::readSequencerEvents(LoopSequencer::PlaybackEvent* destination, int maxEvents)
+{
+    return sequencer.readPlaybackEvents(destination, maxEvents);
+}
+
+double AudioEngine::getOutputLatencyMs() const
+{
+    const auto samples = deviceOutputLatency.load(std::memory_order_relaxed) + masterBus.getLatencySamples();
+    return samples * 1000.0 / currentSampleRate;
+}
+
+// ──────────────────────────────────────────
+// Session snapshots
+// ──────────────────────────────────────────
+
+juce::Result AudioEngine::saveSnapshot(const juce::File& file) const
+{
+    SessionSnapshot snapshot;
+    {
+        const juce::ScopedLock lock(sessionLock);
+        snapshot = session;
+    }
+    snapshot.master = masterBus.getSettings();
+    return snapshot.write(file);
+}
+
+juce::Result AudioEngine::loadSnapshot(const juce::File& file)
+{
+    SessionSnapshot snapshot;
+    const auto result = SessionSnapshot::read(file, snapshot);
+    if (result.failed())
+    {
+        DBG("Failed to load snapshot: " << result.getErrorMessage());
+        return result;
+    }
+    
+    // A file could route sidechains in a loop; drop the routes that close one
+    for (int channel = 1; channel <= maxChannels; ++channel)
+    {
+        for (auto& effect : snapshot.channels[static_cast<size_t>(channel - 1)].effects)
+        {
+            const auto source = effect.sidechainChannel;
+            effect.sidechainChannel = 0;
+            if (source > 0 && !createsSidechainLoop(snapshot, channel, source))
+                effect.sidechainChannel = source;
+        }
+    }
+    
+    // Each instrument is built complete, samples and all, before the audio
+    // thread sees it
+    std::array<std::unique_ptr<InstrumentWrapper>, maxChannels> wrappers;
+    for (size_t index = 0; index < wrappers.size(); ++index)
+        wrappers[index] = buildInstrument(snapshot.channels[index]);
+    
+    const juce::ScopedLock lock(sessionLock);
+    for (int channel = 1; channel <= maxChannels; ++channel)
+    {
+        const auto index = static_cast<size_t>(channel - 1);
+        const auto& state = snapshot.channels[index];
+        
+        cancelInstrumentSwap(channel);
+        publishInstrument(channel, std::move(wrappers[index]));
+        ++sessionRevisions[index];
+        
+        if (state.sequenceDurationMs > 0.0)
+            sequencer.setSequence(channel, state.sequence, state.sequenceDurationMs);
+        else
+            sequencer.clearSequence(channel);
+    }
+    
+    for (int bus = 0; bus < numSendBuses; ++bus)
+    {
+        const auto& state = snapshot.sendBuses[static_cast<size_t>(bus)];
+        if (state.hasEffect && sendBuses.setEffect(bus, state.effect.type))
+        {
+            for (const auto& [param, value] : state.effect.parameters)
+                sendBuses.setEffectParameter(bus, param, value);
+        }
+        else
+        {
+            sendBuses.clearEffect(bus);
+        }
+        
+        sendBuses.setReturnLevel(bus, state.returnLevel);
+        for (int channel = 0; channel < maxChannels; ++channel)
+            sendBuses.setSendLevel(channel, bus, snapshot.channels[static_cast<size_t>(channel)].sendLevels[static_cast<size_t>(bus)]);
+    }
+    
+    masterBus.setSettings(snapshot.master);
+    session = std::move(snapshot);
+    return juce::Result::ok();
+}
+
+std::unique_ptr<AudioEngine::InstrumentWrapper> AudioEngine::buildInstrument(const SessionSnapshot::Channel& state)
+{
+    if (state.type == SessionSnapshot::ChannelType::Oscillator)
+    {
+        auto instrument = std::make_unique<Instrument>(state.oscillator);
+        instrument->setReclaimer(&reclaimer);
+        if (currentSampleRate > 0.0)
+            instrument->prepareToPlay(currentSampleRate, currentBlockSize);
+        
+        for (const auto& effect : state.effects)
+        {
+            instrument->addEffect(effect.type, effect.id);
+            instrument->setEffectEnabled(effect.id, effect.enabled);
+            for (const auto& [param, value] : effect.parameters)
+                instrument->setEffectParameter(effect.id, param, value);
+            if (effect.sidechainChannel > 0)
+                instrument->setEffectSidechain(effect.id, &sidechainKeys[static_cast<size_t>(effect.sidechainChannel - 1)]);
+        }
+        
+        return std::make_unique<InstrumentWrapper>(std::move(instrument));
+    }
+    
+    if (state.type == SessionSnapshot::ChannelType::MultiSampler)
+    {
+        auto instrument = std::make_unique<MultiSamplerInstrument>(state.sampler);
+        instrument->setReclaimer(&reclaimer);
+        if (currentSampleRate > 0.0)
+            instrument->prepareToPlay(currentSampleRate, currentBlockSize);
+        
+        for (const auto& sample : state.samples)
+            instrument->loadSampleData(sample.slot, sample.data, sample.config);
+        
+        return std::make_unique<InstrumentWrapper>(std::move(instrument));
+    }
+    
+    return nullptr;
+}
+
+// ──────────────────────────────────────────
+// Multi-core rendering
+// ──────────────────────────────────────────
+
+void AudioEngine::setRenderThreadCount(int numWorkers)
+{
+    numWorkers = juce::jlimit(0, maxChannels - 1, numWorkers);
+    if (numWorkers == getRenderThreadCount())
+        return;
+    
+    std::unique_ptr<ParallelRenderer> renderer;
+    if (numWorkers > 0)
+    {
+        // Threads are started here, on the caller's thread, never by the callback
+        renderer = std::make_unique<ParallelRenderer>(numWorkers, currentBlockSize, currentSampleRate);
+        renderer->setWorkgroup(deviceManager.getDeviceAudioWorkgroup());
+    }
+    
+    renderThreadCount.store(numWorkers, std::memory_order_relaxed);
+    auto* old = parallelRenderer.exchange(renderer.release(), std::memory_order_acq_rel);
+    reclaimer.retire(std::unique_ptr<ParallelRenderer>(old));
+}
+
+void AudioEngine::setProcessingQuantum(int frames)
+{
+    frames = frames <= 0 ? 0 : juce::jlimit(minProcessingQuantum, maxProcessingQuantum, frames);
+    if (processingQuantum.exchange(frames, std::memory_order_relaxed) == frames)
+        return;
+    
+    // Buffers are resized in audioDeviceAboutToStart(), which JUCE calls
+    // again when the callback is re-attached to an open device
+    if (deviceManager.getCurrentAudioDevice() != nullptr)
+    {
+        deviceManager.removeAudioCallback(this);
+        deviceManager.addAudioCallback(this);
+    }
+}
+
+// ──────────────────────────────────────────
+// Command queue
+// ──────────────────────────────────────────
+
+bool AudioEngine::pushCommand(const EngineCommand& command)
+{
+    if (command.channel != 0 && !isValidChannel(command.channel))
+        return false;
+    
+    if (!commandQueue.push(command))
+    {
+        DBG("AudioEngine command queue full, dropping command");
+        return false;
+    }
+    return true;
+}
+
+void AudioEngine::processCommands(juce::uint64 blockStartNs, int numSamples)
+{
+    for (auto& buffer : midiBuffers)
+        buffer.clear();
+    
+    const double nsPerSample = 1.0e9 / currentSampleRate;
+    const auto blockEndNs = blockStartNs + static_cast<juce::uint64>(numSamples * nsPerSample);
+    
+    const auto offsetFor = [&](juce::uint64 hostTimeNs)
+    {
+        if (hostTimeNs <= blockStartNs)
+            return 0;
+        return juce::jlimit(0, numSamples - 1,
+                            static_cast<int>(static_cast<double>(hostTimeNs - blockStartNs) / nsPerSample));
+    };
+    
+    // Recordings take a note's own stamp when it has one, even outside this block
+    const auto apply = [&](const EngineCommand& due)
+    {
+        const int sampleOffset = offsetFor(due.hostTimeNs);
+        const auto recordOffset = due.recordTimeNs != 0
+            ? static_cast<juce::int64>(std::floor((static_cast<double>(due.recordTimeNs)
+                                                   - static_cast<double>(blockStartNs)) / nsPerSample))
+            : static_cast<juce::int64>(sampleOffset);
+        applyCommand(due, sampleOffset, recordOffset);
+    };
+    
+    // New commands: apply now if due in this block, otherwise park them. At
+    // most a queue's worth, so a producer that keeps pushing can't outrun the
+    // MIDI buffers' reserved room; the rest wait for the next block.
+    EngineCommand command;
+    for (size_t popped = 0; popped < commandQueueSize && commandQueue.pop(command); ++popped)
+    {
+        if (command.hostTimeNs < blockEndNs)
+        {
+            apply(command);
+        }
+        else if (!scheduledCommands.schedule(command))
+        {
+            scheduledOverflowCount.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    
+    // Previously parked commands that fall inside this block, in time order
+    while (scheduledCommands.popDue(blockEndNs, command))
+        apply(command);
+}
+
+void AudioEngine::applyCommand(const EngineCommand& command, int sampleOffset, juce::int64 recordOffset)
+{
+    // Notes parked for later would otherwise still start after these
+    if (command.type == EngineCommand::Type::AllNotesOff
+        || command.type == EngineCommand::Type::CancelScheduledNotes)
+        cancelScheduledNotes(command.channel);
+    
+    // Engine-wide commands fan out to every channel
+    if (command.channel == 0)
+    {
+        if (command.type == EngineCommand::Type::AllNotesOff)
+        {
+            for (auto& buffer : midiBuffers)
+                buffer.addEvent(juce::MidiMessage::allNotesOff(1), sampleOffset);
+        }
+        return;
+    }
+    
+    // Live notes on an armed channel are captured before they reach the synth
+    if (command.type == EngineCommand::Type::NoteOn)
+        sequencer.recordLiveEvent(command.channel, true, command.note, command.values[0], recordOffset);
+    else if (command.type == EngineCommand::Type::NoteOff)
+        sequencer.recordLiveEvent(command.channel, false, command.note, 0.0f, recordOffset);
+    
+    const auto index = static_cast<size_t>(command.channel - 1);
+    auto* wrapper = instrumentSlots[index].load(std::memory_order_acquire);
+    if (!wrapper)
+        return;
+    
+    if (command.type == EngineCommand::Type::NoteOn)
+        sequencer.reportLiveEvent(command.channel, true, command.note, command.values[0], sampleOffset);
+    else if (command.type == EngineCommand::Type::NoteOff)
+        sequencer.reportLiveEvent(command.channel, false, command.note, 0.0f, sampleOffset);
+    
+    Instrument* osc = wrapper->type == InstrumentType::Oscillator
+                        ? std::get<std::unique_ptr<Instrument>>(wrapper->instrument).get()
+                        : nullptr;
+    MultiSamplerInstrument* sampler = wrapper->type == InstrumentType::MultiSampler
+                        ? std::get<std::unique_ptr<MultiSamplerInstrument>>(wrapper->instrument).get()
+                        : nullptr;
+    
+    switch (command.type)
+    {
+        case EngineCommand::Type::NoteOn:
+            midiBuffers[index].addEvent(juce::MidiMessage::noteOn(1, command.note, command.values[0]), sampleOffset);
+            break;
+            
+        case EngineCommand::Type::NoteOff:
+            midiBuffers[index].addEvent(juce::MidiMessage::noteOff(1, command.note), sampleOffset);
+            break;
+            
+        case EngineCommand::Type::AllNotesOff:
+            midiBuffers[index].addEvent(juce::MidiMessage::allNotesOff(1), sampleOffset);
+            break;
+            
+        case EngineCommand::Type::SetADSR:
+        {
+            juce::ADSR::Parameters params { command.values[0], command.values[1],
+                                            command.values[2], command.values[3] };
+            if (osc)
+                osc->setADSR(params);
+            else if (sampler)
+                sampler->setADSR(params);
+            break;
+        }
+            
+        case EngineCommand::Type::SetVolume:
+            if (osc)
+                osc->setVolume(command.values[0]);
+            else if (sampler)
+                sampler->setVolume(command.values[0]);
+            break;
+            
+        case EngineCommand::Type::SetPan:
+            if (osc)
+                osc->setPan(command.values[0]);
+            else if (sampler)
+                sampler->setPan(command.values[0]);
+            break;
+            
+        case EngineCommand::Type::SetWaveform:
+            if (osc)
+                osc->setWaveform(static_cast<BaseOscillatorVoice::Waveform>(command.param));
+            break;
+            
+        case EngineCommand::Type::SetDetune:
+            if (osc)
+                osc->setDetune(command.values[0]);
+            break;
+            
+        case EngineCommand::Type::SetEffectEnabled:
+            if (osc)
+                osc->setEffectEnabled(command.effectId, command.param != 0);
+            break;
+            
+        case EngineCommand::Type::SetEffectParameter:
+            if (osc)
+                osc->setEffectParameter(command.effectId,
+                                        static_cast<Instrument::EffectParameter>(command.param),
+                                        command.values[0]);
+            break;
+            
+        case EngineCommand::Type::SetEffectSidechain:
+            if (osc)
+                osc->setEffectSidechain(command.effectId,
+                                        command.param > 0 ? &sidechainKeys[static_cast<size_t>(command.param - 1)] : nullptr);
+            break;
+            
+        case EngineCommand::Type::CancelScheduledNotes:
+            break;  // done above
+    }
+}
+
+void AudioEngine::cancelScheduledNotes(int channel)
+{
+    scheduledCommands.removeIf([channel](const EngineCommand& parked)
+    {
+        return (channel == 0 || parked.channel == channel)
+            && (parked.type == EngineCommand::Type::NoteOn || parked.type == EngineCommand::Type::NoteOff);
+    });
+}
+
+// ──────────────────────────────────────────
+// JUCE callbacks
+// ──────────────────────────────────────────
+
+void AudioEngine::audioDeviceAboutToStart(juce::AudioIODevice* device)
+{
+    deviceOutputLatency.store(device->getOutputLatencyInSamples(), std::memory_order_relaxed);
+    prepareToPlay(device->getCurrentSampleRate(), device->getCurrentBufferSizeSamples());
+    
+    // Render workers should share the device thread's deadline (CoreAudio only)
+    if (auto* renderer = parallelRenderer.load(std::memory_order_acquire))
+        renderer->setWorkgroup(device->getWorkgroup());
+}
+
+void AudioEngine::prepareToPlay(double sampleRate, int maximumBlockSize)
+{
+    currentSampleRate = sampleRate;
+    deviceBlockSize = maximumBlockSize;
+    activeQuantum = processingQuantum.load(std::memory_order_relaxed);
+    currentBlockSize = activeQuantum > 0 ? activeQuantum : maximumBlockSize;
+    
+    // The FIFO holds one quantum; it starts empty so the first callback renders
+    quantumBuffer.setSize(2, juce::jmax(1, activeQuantum));
+    quantumFifo.setTotalSize(juce::jmax(1, activeQuantum) + 1);
+    quantumFifo.reset();
+    
+    for (auto& buffer : channelBuffers)
+        buffer.setSize(2, currentBlockSize);
+    
+    for (auto& buffer : fadeBuffers)
+        buffer.setSize(2, currentBlockSize);
+    
+    for (auto& buffer : sidechainKeys)
+        buffer.setSize(2, currentBlockSize);
+    
+    // setSize() may have reallocated, so don't trust what the buffers held
+    channelDirtySamples.fill(currentBlockSize);
+    sidechainKeyDirtySamples.fill(currentBlockSize);
+    
+    sequencer.prepare(currentSampleRate);
+    sendBuses.prepare(currentSampleRate, currentBlockSize);
+    
+    for (auto& meter : channelMeters)
+        meter.prepare(currentSampleRate, currentBlockSize);
+    masterMeter.prepare(currentSampleRate, currentBlockSize);
+    analyzer.setSampleRate(currentSampleRate);
+    masterBus.prepare(currentSampleRate, currentBlockSize, 2);
+    
+    // Prepare all instruments (the callback is not running yet)
+    for (auto& slot : instrumentSlots)
+    {
+        prepareInstrumentWrapper(slot.load(std::memory_order_acquire));
+    }
+    
+    for (auto* wrapper : fadingWrappers)
+        prepareInstrumentWrapper(wrapper);
+}
+
+void AudioEngine::audioDeviceIOCallbackWithContext(
+    const float* const* /*inputChannelData*/,
     int /*numInputChannels*/,
     float* const* outputChannelData,
     int numOutputChannels,
     int numSamples,
-    const juce::AudioIODeviceCallbackContext& /*context*/)
+    const juce::AudioIODeviceCallbackContext& context)
 {
     juce::AudioBuffer<float> outputBuffer(outputChannelData, numOutputChannels, numSamples);
     
+    // Timestamped events are placed relative to when the device stamped this block
+    renderNextBlock(outputBuffer, context.hostTimeNs != nullptr ? *context.hostTimeNs : getHostTimeNs());
+}
+
+void AudioEngine::renderNextBlock(juce::AudioBuffer<float>& outputBuffer, juce::uint64 blockStartNs)
+{
+    const ScopedRealtimeContext realtime("AudioEngine::renderNextBlock");
+    const auto startTicks = TimingHistogram::now();
+    const int numSamples = outputBuffer.getNumSamples();
+    
+    if (activeQuantum > 0)
+    {
+        renderFromQuantumFifo(outputBuffer, blockStartNs);
+    }
+    else
+    {
+        // Some backends deliver more than they announced; render it in pieces
+        for (int offset = 0; offset < numSamples; offset += currentBlockSize)
+        {
+            juce::AudioBuffer<float> view(outputBuffer.getArrayOfWritePointers(), outputBuffer.getNumChannels(),
+                                          offset, juce::jmin(currentBlockSize, numSamples - offset));
+            renderBlock(view, blockStartNs + samplesToNs(offset));
+        }
+    }
+    
+    recordCallbackTime(startTicks, numSamples);
+}
+
+void AudioEngine::renderFromQuantumFifo(juce::AudioBuffer<float>& outputBuffer, juce::uint64 blockStartNs)
+{
+    const int numSamples = outputBuffer.getNumSamples();
+    const int numOutputChannels = outputBuffer.getNumChannels();
+    
+    for (int written = 0; written < numSamples;)
+    {
+        // Render the next quantum once the last one has gone out. It starts
+        // playing at this point of the callback, so that's its timestamp.
+        if (quantumFifo.getNumReady() == 0)
+        {
+            quantumFifo.reset();   // so the quantum lands at the start of quantumBuffer
+            renderBlock(quantumBuffer, blockStartNs + samplesToNs(written));
+            quantumFifo.finishedWrite(activeQuantum);
+        }
+        
+        const auto toCopy = juce::jmin(quantumFifo.getNumReady(), numSamples - written);
+        const auto scope = quantumFifo.read(toCopy);
+        
+        for (int ch = 0; ch < numOutputChannels; ++ch)
+        {
+            if (ch >= quantumBuffer.getNumChannels())
+            {
+                outputBuffer.clear(ch, written, toCopy);
+                continue;
+            }
+            
+            if (scope.blockSize1 > 0)
+                outputBuffer.copyFrom(ch, written, quantumBuffer, ch, scope.startIndex1, scope.blockSize1);
+            if (scope.blockSize2 > 0)
+                outputBuffer.copyFrom(ch, written + scope.blockSize1, quantumBuffer, ch, scope.startIndex2, scope.blockSize2);
+        }
+        
+        written += toCopy;
+    }
+}
+
+juce::uint64 AudioEngine::samplesToNs(int numSamples) const
+{
+    return static_cast<juce::uint64>(numSamples * 1.0e9 / currentSampleRate);
+}
+
+void AudioEngine::renderBlock(juce::AudioBuffer<float>& outputBuffer, juce::uint64 blockStartNs)
+{
+    const int numSamples = outputBuffer.getNumSamples();
+    jassert(numSamples <= currentBlockSize);
+    
     // Clear output buffer
     outputBuffer.clear();
     
-    // Clear MIDI buffer (we control notes programmatically)
-    midiBuffer.clear();
+    // Anything we load from the slots stays alive until exitAudioCallback(),
+    // even if a control thread swaps it out meanwhile.
+    reclaimer.enterAudioCallback();
+    
+    if (timingResetPending.exchange(false, std::memory_order_acquire))
+        resetTimings();
+    
+    if (loudnessResetPending.exchange(false, std::memory_order_acquire))
+    {
+        for (auto& meter : channelMeters)
+            meter.resetIntegrated();
+        masterMeter.resetIntegrated();
+    }
     
-    // Render and mix all instruments
+    // Turn queued notes and parameter changes into this block's MIDI
     {
-        juce::ScopedLock lock(instrumentLock);
+        const ScopedRealtimeContext realtime("AudioEngine::processCommands");
+        const auto latencySamples = deviceOutputLatency.load(std::memory_order_relaxed) + masterBus.getLatencySamples();
+        const auto presentationNs = blockStartNs + samplesToNs(latencySamples);
+        sequencer.beginBlock(presentationNs);
+        processCommands(blockStartNs, numSamples);
         
-        for (auto& pair : instruments)
+        // Where the transport starts this block, and when that is heard
+        auto& snapshot = telemetry.getWriteSnapshot();
+        snapshot.playing = sequencer.isPlaying();
+        snapshot.transportPositionMs = sequencer.getTransportPositionMs();
+        snapshot.presentationTimeMs = static_cast<double>(presentationNs) / 1.0e6;
+    }
+    
+    // Loop patterns for this block go into the same MIDI buffers
+    {
+        const ScopedRealtimeContext realtime("LoopSequencer::process");
+        sequencer.process(midiBuffers, numSamples);
+    }
+    
+    // Instruments replaced by a hot-swap start fading out this block
+    takeOverOutgoingInstruments();
+    
+    // Collect the channels that have something to render, including ones
+    // whose only instrument is fading out
+    numRenderChannels = 0;
+    renderedChannelMask = 0;
+    for (size_t index = 0; index < instrumentSlots.size(); ++index)
+    {
+        auto* wrapper = instrumentSlots[index].load(std::memory_order_acquire);
+        if (wrapper != nullptr || fadingWrappers[index] != nullptr)
         {
-            auto* wrapper = pair.second.get();
-            
-            // Clear mix buffer
-            mixBuffer.clear();
+            renderWrappers[static_cast<size_t>(numRenderChannels)] = wrapper;
+            renderIndices[static_cast<size_t>(numRenderChannels)] = static_cast<int>(index);
+            renderedChannelMask |= 1u << index;
+            ++numRenderChannels;
+        }
+    }
+    
+    // Sidechain sources go ahead of the channels keyed by them
+    orderRenderChannels();
+    
+    // Render each channel into its own buffer, stage by stage, across cores if enabled
+    auto* renderer = renderStagesSerially ? nullptr : parallelRenderer.load(std::memory_order_acquire);
+    int firstSlot = 0;
+    for (int stage = 0; stage < numRenderStages; ++stage)
+    {
+        const int endSlot = renderStageEnds[static_cast<size_t>(stage)];
+        if (renderer != nullptr && endSlot - firstSlot > 1)
+        {
+            auto task = [this, firstSlot, numSamples](int i) { renderChannel(firstSlot + i, numSamples); };
+            renderer->run(endSlot - firstSlot, task);
+        }
+        else
+        {
+            for (int renderSlot = firstSlot; renderSlot < endSlot; ++renderSlot)
+                renderChannel(renderSlot, numSamples);
+        }
+        firstSlot = endSlot;
+    }
+    
+    // Mix in slot order so the result doesn't depend on which thread
+    // finished first, feeding the send buses on the way
+    sendBuses.beginBlock();
+    int channelsBypassed = 0;
+    int effectsBypassed = 0;
+    for (int renderSlot = 0; renderSlot < numRenderChannels; ++renderSlot)
+    {
+        const auto index = static_cast<size_t>(renderIndices[static_cast<size_t>(renderSlot)]);
+        effectsBypassed += channelEffectsBypassed[index];
+        
+        if (!channelHasAudio[index])
+        {
+            ++channelsBypassed;
+            continue;
+        }
+        
+        const auto& channelBuffer = channelBuffers[index];
+        for (int ch = 0; ch < juce::jmin(outputBuffer.getNumChannels(), channelBuffer.getNumChannels()); ++ch)
+        {
+            outputBuffer.addFrom(ch, 0, channelBuffer, ch, 0, numSamples);
+        }
+        sendBuses.addChannel(static_cast<int>(index), channelBuffer, numSamples);
+    }
+    
+    {
+        const ScopedRealtimeContext realtime("SendBuses::process");
+        effectsBypassed += sendBuses.process(outputBuffer, numSamples);
+    }
+    
+    // Voice state has to be read while the instruments are still safe to touch
+    publishTelemetry();
+    
+    releaseFadedInstruments();
+    reclaimer.exitAudioCallback();
+    
+    lastChannelsRendered.store(numRenderChannels, std::memory_order_relaxed);
+    lastChannelsBypassed.store(channelsBypassed, std::memory_order_relaxed);
+    lastEffectsBypassed.store(effectsBypassed, std::memory_order_relaxed);
+    totalBlocksRendered.fetch_add(1, std::memory_order_relaxed);
+    totalChannelsBypassed.fetch_add(channelsBypassed, std::memory_order_relaxed);
+    totalEffectsBypassed.fetch_add(effectsBypassed, std::memory_order_relaxed);
+    
+    // Master volume, EQ, compressor and limiter on the first two channels
+    {
+        const ScopedRealtimeContext realtime("MasterBus::process");
+        juce::dsp::AudioBlock<float> outputBlock(outputBuffer);
+        masterBus.process(outputBlock);
+    }
+    
+    publishMeters(outputBuffer, numSamples);
+    
+    // Analyzer taps on the master, and silence from channels that didn't render
+    analyzer.write(0, outputBuffer, numSamples);
+    for (int index = 0; index < maxChannels; ++index)
+        if ((renderedChannelMask & (1u << index)) == 0)
+            analyzer.writeSilence(index + 1, numSamples);
+}
+
+void AudioEngine::publishTelemetry()
+{
+    auto& snapshot = telemetry.getWriteSnapshot();
+    snapshot.sampleRate = static_cast<float>(currentSampleRate);
+    for (auto& channel : snapshot.channels)
+        channel.clear();
+    
+    const auto addVoices = [](EngineTelemetry::Channel& channel, const auto& voices)
+    {
+        for (const auto* voice : voices)
+            if (voice->isVoiceActive())
+                channel.addVoice(voice->getCurrentlyPlayingNote(), voice->isKeyDown(), voice->getEnvelopeLevel());
+    };
+    
+    // Only the live instrument counts; one fading out after a swap is on its way out
+    for (int renderSlot = 0; renderSlot < numRenderChannels; ++renderSlot)
+    {
+        const auto* wrapper = renderWrappers[static_cast<size_t>(renderSlot)];
+        if (wrapper == nullptr)
+            continue;
+        
+        auto& channel = snapshot.channels[static_cast<size_t>(renderIndices[static_cast<size_t>(renderSlot)])];
+        if (wrapper->type == InstrumentType::Oscillator)
+            std::get<std::unique_ptr<Instrument>>(wrapper->instrument)->visitVoices(
+                [&channel](int note, bool keyDown, float envelopeLevel) { channel.addVoice(note, keyDown, envelopeLevel); });
+        else
+            addVoices(channel, std::get<std::unique_ptr<MultiSamplerInstrument>>(wrapper->instrument)->getVoices());
+    }
+    
+    telemetry.publish();
+}
+
+void AudioEngine::publishMeters(const juce::AudioBuffer<float>& output, int numSamples)
+{
+    const ScopedRealtimeContext realtime("AudioEngine::publishMeters");
+    auto& meters = publishedMeters.getWriteSlot();
+    
+    // Channels that rendered were measured in renderChannel(); the rest are silent
+    meters.hasInstrument.fill(false);
+    for (int renderSlot = 0; renderSlot < numRenderChannels; ++renderSlot)
+    {
+        const auto index = static_cast<size_t>(renderIndices[static_cast<size_t>(renderSlot)]);
+        meters.hasInstrument[index] = renderWrappers[static_cast<size_t>(renderSlot)] != nullptr;
+    }
+    
+    for (size_t index = 0; index < channelMeters.size(); ++index)
+    {
+        if ((renderedChannelMask & (1u << index)) == 0)
+            channelMeters[index].processSilence(numSamples);
+        meters.channels[index] = channelMeters[index].getReadings();
+    }
+    
+    masterMeter.process(output, numSamples);
+    meters.master = masterMeter.getReadings();
+    meters.blocks = ++blocksMetered;
+    publishedMeters.publish();
+}
+
+void AudioEngine::recordCallbackTime(juce::int64 startTicks, int numSamples)
+{
+    const auto micros = TimingHistogram::ticksToMicros(TimingHistogram::now() - startTicks);
+    callbackTiming.record(micros);
+    
+    const auto budgetMicros = numSamples * 1.0e6 / currentSampleRate;
+    if (micros > budgetMicros)
+        overrunCount.fetch_add(1, std::memory_order_relaxed);
+    
+    // Same smoothing as juce::AudioProcessLoadMeasurer
+    const auto filterAmount = 0.2;
+    const auto load = loadProportion.load(std::memory_order_relaxed);
+    loadProportion.store(load + filterAmount * (micros / budgetMicros - load), std::memory_order_relaxed);
+}
+
+void AudioEngine::resetTimings()
+{
+    callbackTiming.reset();
+    for (auto& timing : channelTimings)
+        timing.reset();
+    sendBuses.resetTimings();
+    
+    for (auto& slot : instrumentSlots)
+    {
+        auto* wrapper = slot.load(std::memory_order_acquire);
+        if (wrapper != nullptr && wrapper->type == InstrumentType::Oscillator)
+            std::get<std::unique_ptr<Instrument>>(wrapper->instrument)->resetEffectTimings();
+    }
+    
+    overrunCount.store(0, std::memory_order_relaxed);
+    loadProportion.store(0.0, std::memory_order_relaxed);
+}
+
+void AudioEngine::renderChannel(int renderSlot, int numSamples)
+{
+    // Also runs on the render workers, which have no context of their own
+    const ScopedRealtimeContext realtime("AudioEngine::renderChannel");
+    auto* wrapper = renderWrappers[static_cast<size_t>(renderSlot)];
+    const auto index = static_cast<size_t>(renderIndices[static_cast<size_t>(renderSlot)]);
+    auto& buffer = channelBuffers[index];
+    
+    // Instruments add into the buffer; a channel that stayed silent left it clear
+    if (channelDirtySamples[index] > 0)
+        buffer.clear(0, channelDirtySamples[index]);
+    
+    bool hasAudio = false;
+    int effectsBypassed = 0;
+    const ScopedRenderTimer timer(channelTimings[index]);
+    
+    // A sidechain source also leaves its output, before volume and pan, as a key
+    auto* key = (sidechainSourceMask & (1u << index)) != 0 ? &sidechainKeys[index] : nullptr;
+    
+    if (wrapper != nullptr)
+        hasAudio = renderInstrument(*wrapper, buffer, midiBuffers[index], numSamples, effectsBypassed, key);
+    
+    if (key != nullptr)
+    {
+        if (hasAudio)
+            sidechainKeyDirtySamples[index] = numSamples;
+        else if (sidechainKeyDirtySamples[index] > 0)
+        {
+            key->clear(0, sidechainKeyDirtySamples[index]);
+            sidechainKeyDirtySamples[index] = 0;
+        }
+    }
+    
+    // A hot-swapped-out instrument releases its notes while it fades out
+    if (auto* fading = fadingWrappers[index])
+    {
+        auto& fadeBuffer = fadeBuffers[index];
+        fadeBuffer.clear(0, numSamples);
+        
+        const auto& fadingMidi = fadePositions[index] == 0 ? releaseAllMidi : noMidi;
+        int fadingEffectsBypassed = 0;
+        fadingHasAudio[index] = renderInstrument(*fading, fadeBuffer, fadingMidi, numSamples, fadingEffectsBypassed);
+        
+        const bool fadingAudible = fadingHasAudio[index] && fadePositions[index] < fadeLengths[index];
+        applyCrossfade(static_cast<int>(index), numSamples, hasAudio, fadingHasAudio[index]);
+        hasAudio = hasAudio || fadingAudible;
+    }
+    
+    channelHasAudio[index] = hasAudio;
+    channelDirtySamples[index] = hasAudio ? numSamples : 0;
+    channelEffectsBypassed[index] = effectsBypassed;
+    
+    // Post-fader, as the mix hears it
+    if (hasAudio)
+        channelMeters[index].process(buffer, numSamples);
+    else
+        channelMeters[index].processSilence(numSamples);
+    analyzer.write(static_cast<int>(index) + 1, buffer, numSamples);
+}
+
+bool AudioEngine::renderInstrument(InstrumentWrapper& wrapper, juce::AudioBuffer<float>& buffer,
+                                   const juce::MidiBuffer& midi, int numSamples, int& effectsBypassed,
+                                   juce::AudioBuffer<float>* preFaderTap)
+{
+    if (wrapper.type == InstrumentType::Oscillator)
+    {
+        auto* osc = std::get<std::unique_ptr<Instrument>>(wrapper.instrument).get();
+        const bool hasAudio = osc->renderNextBlock(buffer, midi, 0, numSamples, preFaderTap);
+        effectsBypassed = osc->getBypassedEffectCount();
+        return hasAudio;
+    }
+    
+    auto* sampler = std::get<std::unique_ptr<MultiSamplerInstrument>>(wrapper.instrument).get();
+    return sampler->renderNextBlock(buffer, midi, 0, numSamples, preFaderTap);
+}
+
+// ──────────────────────────────────────────
+// Sidechain ordering (audio thread)
+// ──────────────────────────────────────────
+
+juce::uint32 AudioEngine::getSidechainSources(const InstrumentWrapper* wrapper) const
+{
+    if (wrapper == nullptr || wrapper->type != InstrumentType::Oscillator)
+        return 0;
+    
+    juce::uint32 sources = 0;
+    std::get<std::unique_ptr<Instrument>>(wrapper->instrument)->visitSidechainKeys([this, &sources](const auto* key)
+    {
+        const auto index = key - sidechainKeys.data();
+        jassert(index >= 0 && index < maxChannels);
+        sources |= 1u << index;
+    });
+    return sources;
+}
+
+void AudioEngine::orderRenderChannels()
+{
+    // Read from the effect chains as they are now, crossfading instruments
+    // included, rather than from the session: a chain and the session
+    // disagree while a swap is being built
+    std::array<juce::uint32, maxChannels> sources {};
+    juce::uint32 rendered = 0;
+    juce::uint32 allSources = 0;
+    for (int renderSlot = 0; renderSlot < numRenderChannels; ++renderSlot)
+    {
+        const auto slot = static_cast<size_t>(renderSlot);
+        const auto index = static_cast<size_t>(renderIndices[slot]);
+        sources[slot] = getSidechainSources(renderWrappers[slot]) | getSidechainSources(fadingWrappers[index]);
+        rendered |= 1u << index;
+        allSources |= sources[slot];
+    }
+    sidechainSourceMask = allSources;
+    renderStagesSerially = false;
+    
+    // Keys from empty channels hold silence
+    for (size_t index = 0; index < sidechainKeys.size(); ++index)
+    {
+        const auto bit = 1u << index;
+        if ((allSources & bit) != 0 && (rendered & bit) == 0 && sidechainKeyDirtySamples[index] > 0)
+        {
+            sidechainKeys[index].clear(0, sidechainKeyDirtySamples[index]);
+            sidechainKeyDirtySamples[index] = 0;
+        }
+    }
+    
+    numRenderStages = 1;
+    renderStageEnds[0] = numRenderChannels;
+    if ((allSources & rendered) == 0)
+        return;
+    
+    // Each channel's stage is one past its latest source's. The session
+    // refuses loops, but one can exist for a block or two while edits to two
+    // channels land; it never settles, and then everything renders serially.
+    std::array<int, maxChannels> stages {};
+    bool settled = false;
+    for (int pass = 0; pass <= maxChannels && !settled; ++pass)
+    {
+        settled = true;
+        for (int renderSlot = 0; renderSlot < numRenderChannels; ++renderSlot)
+        {
+            const auto slot = static_cast<size_t>(renderSlot);
+            int stage = 0;
+            for (int other = 0; other < numRenderChannels; ++other)
+            {
+                const auto otherSlot = static_cast<size_t>(other);
+                if ((sources[slot] & (1u << renderIndices[otherSlot])) != 0)
+                    stage = juce::jmax(stage, stages[otherSlot] + 1);
+            }
             
-            // Render based on instrument type
-            if (wrapper->type == InstrumentType::Oscillator)
+            if (stage != stages[slot])
             {
-                auto* osc = std::get<std::unique_ptr<Instrument>>(wrapper->instrument).get();
-                osc->renderNextBlock(mixBuffer, midiBuffer, 0, numSamples);
+                stages[slot] = stage;
+                settled = false;
             }
-            else if (wrapper->type == InstrumentType::MultiSampler)
+        }
+    }
+    
+    if (!settled)
+    {
+        renderStagesSerially = true;
+        return;
+    }
+    
+    // Reorder the slots by stage, keeping channel order within each
+    std::array<InstrumentWrapper*, maxChannels> wrappers = renderWrappers;
+    std::array<int, maxChannels> indices = renderIndices;
+    int nextSlot = 0;
+    numRenderStages = 0;
+    for (int stage = 0; nextSlot < numRenderChannels; ++stage)
+    {
+        for (int renderSlot = 0; renderSlot < numRenderChannels; ++renderSlot)
+        {
+            const auto slot = static_cast<size_t>(renderSlot);
+            if (stages[slot] == stage)
             {
-                auto* sampler = std::get<std::unique_ptr<MultiSamplerInstrument>>(wrapper->instrument).get();
-                sampler->renderNextBlock(mixBuffer, midiBuffer, 0, numSamples);
+                renderWrappers[static_cast<size_t>(nextSlot)] = wrappers[slot];
+                renderIndices[static_cast<size_t>(nextSlot)] = indices[slot];
+                ++nextSlot;
             }
+        }
+        renderStageEnds[static_cast<size_t>(numRenderStages++)] = nextSlot;
+    }
+}
+
+// ──────────────────────────────────────────
+// Hot-swap crossfades (audio thread)
+// ──────────────────────────────────────────
+
+void AudioEngine::takeOverOutgoingInstruments()
+{
+    for (size_t index = 0; index < outgoingSlots.size(); ++index)
+    {
+        // Only this thread empties the slot, so once it's seen non-null it stays so
+        if (outgoingSlots[index].load(std::memory_order_relaxed) == nullptr)
+            continue;
+        
+        // Swapped again mid-fade: the instrument still fading out is cut, and
+        // the one that was fading in fades out instead. If the hand-back FIFO
+        // is full, try again next block.
+        if (fadingWrappers[index] != nullptr)
+        {
+            if (!reclaimer.releaseFromAudioThread(fadingWrappers[index]))
+                continue;
+            fadingWrappers[index] = nullptr;
+        }
+        
+        auto* outgoing = outgoingSlots[index].exchange(nullptr, std::memory_order_acq_rel);
+        const auto* incoming = instrumentSlots[index].load(std::memory_order_acquire);
+        fadingWrappers[index] = outgoing;
+        fadePositions[index] = 0;
+        fadingHasAudio[index] = true;
+        fadeLengths[index] = incoming != nullptr && incoming->crossfadeSamples > 0
+                                 ? incoming->crossfadeSamples
+                                 : juce::roundToInt(defaultSwapCrossfadeMs * 0.001 * currentSampleRate);
+    }
+}
+
+void AudioEngine::applyCrossfade(int index, int numSamples, bool incomingHasAudio, bool outgoingHasAudio)
+{
+    const auto slot = static_cast<size_t>(index);
+    auto& buffer = channelBuffers[slot];
+    const auto& fadeBuffer = fadeBuffers[slot];
+    
+    const auto length = juce::jmax(1, fadeLengths[slot]);
+    const auto position = fadePositions[slot];
+    const auto numChannels = juce::jmin(buffer.getNumChannels(), fadeBuffer.getNumChannels());
+    
+    // A silent incoming instrument left the channel buffer stale
+    if (!incomingHasAudio)
+        buffer.clear(0, numSamples);
+    
+    // Equal-power: sin up for the incoming, cos down for the outgoing, so the
+    // summed power stays constant. Past the end the outgoing one is gone.
+    if (position < length)
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const auto progress = juce::jmin(1.0f, static_cast<float>(position + i) / static_cast<float>(length));
+            const auto incomingGain = std::sin(progress * juce::MathConstants<float>::halfPi);
+            const auto outgoingGain = outgoingHasAudio ? std::cos(progress * juce::MathConstants<float>::halfPi) : 0.0f;
             
-            // Add to output (mix)
-            for (int ch = 0; ch < juce::jmin(numOutputChannels, mixBuffer.getNumChannels()); ++ch)
+            for (int ch = 0; ch < numChannels; ++ch)
             {
-                outputBuffer.addFrom(ch, 0, mixBuffer, ch, 0, numSamples);
+                auto* samples = buffer.getWritePointer(ch);
+                samples[i] = samples[i] * incomingGain + fadeBuffer.getSample(ch, i) * outgoingGain;
             }
         }
     }
     
-    // Apply master volume
-    if (masterVolume != 1.0f)
+    fadePositions[slot] = position + numSamples;
+}
+
+void AudioEngine::releaseFadedInstruments()
+{
+    for (size_t index = 0; index < fadingWrappers.size(); ++index)
     {
-        outputBuffer.applyGain(masterVolume);
+        auto* fading = fadingWrappers[index];
+        if (fading == nullptr)
+            continue;
+        
+        // Faded out, or nothing left to play before it got there
+        if (fadingHasAudio[index] && fadePositions[index] < fadeLengths[index])
+            continue;
+        
+        // If the hand-back FIFO is full it stays (silent) until next block
+        if (reclaimer.releaseFromAudioThread(fading))
+            fadingWrappers[index] = nullptr;
     }
 }
 
@@ -1,14 +1,56 @@
 #pragma once
 #include "JuceHeader.h"
 #include "Instrument.h"
-#include "MultiSamplerInstrument.h"
-#include <map>
+#include "MultisamplerInstrument.h"
+#include "RealtimeReclaimer.h"
+#include "CommandQueue.h"
+#include "EngineCommand.h"
+#include "CommandBatch.h"
+#include "CommandScheduler.h"
+#include "LoopSequencer.h"
+#include "ParallelRenderer.h"
+#include "TimingHistogram.h"
+#include "MasterBus.h"
+#include "SendBuses.h"
+#include "LoudnessMeter.h"
+#include "AudioAnalyzer.h"
+#include "EngineTelemetry.h"
+#include "RealtimeSafety.h"
+#include "SessionSnapshot.h"
+#include <array>
+#include <atomic>
 #include <memory>
 #include <variant>
 
 /**
  * Enhanced AudioEngine with multi-channel instrument support.
  * Each channel can have either an Oscillator-based Instrument or a MultiSamplerInstrument.
+ *
+ * Instruments live in a fixed table of atomically published pointers. Control
+ * methods build and prepare instruments on the calling thread, publish them with
+ * a single atomic store, and hand replaced ones to a RealtimeReclaimer, so the
+ * audio callback never blocks or frees memory.
+ *
+ * Note and parameter changes never touch synth or voice state from the caller's
+ * thread: they are posted as EngineCommands to a lock-free queue that the audio
+ * thread drains into per-channel MIDI buffers at the start of each block.
+ *
+ * Loop playback runs on the audio thread too: the LoopSequencer adds each
+ * channel's pattern events to the same MIDI buffers, sample-accurately.
+ *
+ * Every channel renders into its own buffer and the buffers are summed in
+ * channel order, optionally with a ParallelRenderer spreading the channels
+ * over several cores. The mix is identical either way.
+ *
+ * Silent channels cost next to nothing: an instrument with no notes, no
+ * sounding voices and no ringing effect tail is skipped, its buffer is left
+ * cleared and it is left out of the mix.
+ *
+ * A channel's instrument can also be hot-swapped: the replacement is built on
+ * a background thread and the audio thread crossfades from the old one to it.
+ *
+ * Besides its own effect chain, each channel can send to a few shared effect
+ * buses (SendBuses) whose returns join the mix before the master bus.
  */
 class AudioEngine : public juce::AudioIODeviceCallback
 {
@@ -18,6 +60,8 @@ public:
         Oscillator,
         MultiSampler
     };
+
+    static constexpr int maxChannels = 16;
     
     AudioEngine();
     ~AudioEngine();
@@ -50,6 +94,33 @@ public:
     bool createMultiSamplerInstrument(int channel, const MultiSamplerConfig::Config& config);
     bool createMultiSamplerInstrument(int channel);
     
+    // ──────────────────────────────────────────
+    // Instrument hot-swap
+    // ──────────────────────────────────────────
+    
+    static constexpr double defaultSwapCrossfadeMs = 20.0;
+    
+    /**
+     * Replace a channel's instrument while it plays. The new instrument is
+     * built and prepared on a background thread; the audio thread then switches
+     * over and deletes nothing itself. The two are crossfaded along an
+     * equal-power (sin/cos) curve. The old one is sent all-notes-off, so its
+     * voices start their release, and is released once the fade is over or
+     * as soon as it has nothing left to play, whichever comes first.
+     *
+     * Swapping to the same type keeps the channel's effect chain (oscillator)
+     * or loaded samples (sampler). Changes made to the channel while the swap
+     * is being built carry over to the new instrument; creating, removing or
+     * swapping the channel again cancels it.
+     */
+    bool swapOscillatorInstrument(int channel, const Config& config,
+                                  double crossfadeMs = defaultSwapCrossfadeMs);
+    bool swapMultiSamplerInstrument(int channel, const MultiSamplerConfig::Config& config,
+                                    double crossfadeMs = defaultSwapCrossfadeMs);
+    
+    /** True while a swap for the channel is still being built. */
+    bool isInstrumentSwapPending(int channel) const;
+    
     /**
      * Remove an instrument from a channel
      */
@@ -92,12 +163,106 @@ public:
     void clearAllSamples(int channel);
 
     // ──────────────────────────────────────────
-    // Note control (per channel)
+    // Wavetables (for oscillator instruments)
+    // ──────────────────────────────────────────
+    /**
+     * Play a wavetable on an oscillator channel: the instrument is swapped
+     * (see swapOscillatorInstrument()) for one with the table and
+     * Waveform::Wavetable, keeping its other settings. loadWavetable() reads
+     * a single-cycle file first (see Wavetable::fromAudioFile()). False if
+     * the channel has no oscillator or the file can't be used.
+     */
+    bool loadWavetable(int channel, const juce::String& filePath,
+                       double crossfadeMs = defaultSwapCrossfadeMs);
+    bool setWavetable(int channel, std::shared_ptr<const Wavetable> wavetable,
+                      double crossfadeMs = defaultSwapCrossfadeMs);
+
+    // ──────────────────────────────────────────
+    // Note control (per channel, queued for the audio thread)
     // ──────────────────────────────────────────
     void noteOn(int channel, int midiNote, float velocity);
     void noteOff(int channel, int midiNote);
     void allNotesOff(int channel);
     void allNotesOffAllChannels();
+    
+    /**
+     * Schedule a note at an absolute host time (see getHostTimeNs()).
+     * The event lands on the matching sample inside the block that covers
+     * that time; events further ahead wait in a time-ordered queue on the
+     * audio thread. Times in the past play at the start of the next block.
+     */
+    void scheduleNoteOn(int channel, int midiNote, float velocity, juce::uint64 hostTimeNs);
+    void scheduleNoteOff(int channel, int midiNote, juce::uint64 hostTimeNs);
+    
+    /**
+     * Play a note now, but have a recording channel capture it at
+     * recordTimeNs (getHostTimeNs() clock) instead. Note-repeat hits fire up
+     * to a frame after the grid line they belong to; this keeps the take on
+     * the grid without delaying the sound.
+     */
+    void noteOnRecordedAt(int channel, int midiNote, float velocity, juce::uint64 recordTimeNs);
+    void noteOffRecordedAt(int channel, int midiNote, juce::uint64 recordTimeNs);
+    
+    /**
+     * Current time on the clock used for scheduling, in nanoseconds.
+     * This is the clock CoreAudio stamps callbacks with on Apple platforms
+     * (mach_absolute_time); elsewhere a monotonic clock read at each callback.
+     */
+    static juce::uint64 getHostTimeNs();
+    
+    /**
+     * Apply a packed run of BatchRecords (see CommandBatch.h) in one call, so
+     * a chord or a burst of parameter changes crosses from JS once rather
+     * than once per command. Records go through the same queue and session
+     * mirror as the individual methods, in order; invalid ones are skipped.
+     * Returns how many were applied, or -1 if numBytes isn't a whole number
+     * of records.
+     *
+     * The batch itself costs no per-record allocation or string parsing at
+     * the JSI boundary. Parameter records still update the session mirror
+     * under sessionLock like their setters do, so they can allocate there
+     * (a first-time effect parameter) and can wait behind a control-thread
+     * caller holding that lock (loadSample() decoding a file): submit from
+     * a control thread, never from the audio thread.
+     */
+    int submitBatch(const void* data, size_t numBytes);
+
+    // ──────────────────────────────────────────
+    // Loop sequencer (played on the audio thread)
+    // ──────────────────────────────────────────
+    
+    /**
+     * Replace a channel's loop. Events are loop-relative (ms) and may be in any
+     * order; the loop restarts every durationMs while the transport runs.
+     */
+    void setSequence(int channel, std::vector<LoopSequencer::Event> events, double durationMs);
+    void clearSequence(int channel);
+    
+    void startTransport();
+    void stopTransport();
+    bool isTransportPlaying() const { return sequencer.isPlaying(); }
+    double getTransportPositionMs() const { return sequencer.getTransportPositionMs(); }
+    
+    /** Capture live notes played on a channel, timed by the audio clock. */
+    void startRecording(int channel);
+    std::vector<LoopSequencer::Event> stopRecording(int channel);
+    bool isRecording(int channel) const { return sequencer.isRecording(channel); }
+    
+    /**
+     * Notes (sequenced and live) and loop wraps played since the last call,
+     * for UI feedback. Each carries the host time it reaches the speaker, so
+     * visuals can wait for the sound rather than lead it by the output latency.
+     */
+    int readSequencerEvents(LoopSequencer::PlaybackEvent* destination, int maxEvents);
+    
+    /** The transport position coming out of the speaker now, in ms (see getOutputLatencyMs()). */
+    double getHeardTransportPositionMs() { return sequencer.getHeardTransportPositionMs(getHostTimeNs()); }
+    
+    /**
+     * How long after its callback a sample reaches the speaker: the device's
+     * output latency plus the master limiter's lookahead.
+     */
+    double getOutputLatencyMs() const;
 
     // ──────────────────────────────────────────
     // Oscillator parameter control (only affects oscillator instruments)
@@ -121,18 +286,242 @@ public:
     void setEffectEnabled(int channel, int effectId, bool enabled);
     void setEffectParameter(int channel, int effectId,
                           const juce::String& paramName, float value);
+    void setEffectParameter(int channel, int effectId,
+                          Instrument::EffectParameter param, float value);
+    
+    /**
+     * Key an effect's detector (the compressor's) from another channel's
+     * output before its volume and pan, e.g. a kick ducking a bass.
+     * sourceChannel 0 returns it to the effect's own input. Sources render
+     * before the channels keyed by them; a route that would loop back to
+     * channel is refused.
+     */
+    bool setEffectSidechain(int channel, int effectId, int sourceChannel);
+
+    // ──────────────────────────────────────────
+    // Send/return effect buses (shared by all channels)
+    // ──────────────────────────────────────────
+    
+    static constexpr int numSendBuses = SendBuses::numBuses;
+    
+    /**
+     * Put an effect on a bus (1-numSendBuses), replacing any it had. Channels
+     * feed it through setSendLevel() and its output returns to the mix, so one
+     * reverb can serve every channel. Returns false for an unknown bus or an
+     * effect type that isn't implemented.
+     */
+    bool setSendBusEffect(int bus, Instrument::EffectType type);
+    void clearSendBusEffect(int bus);
+    void setSendBusParameter(int bus, const juce::String& paramName, float value);
+    void setSendBusReturnLevel(int bus, float level);
+    
+    /** How much of a channel's output (post volume and pan) goes to a bus, 0-1. */
+    void setSendLevel(int channel, int bus, float level);
 
     // ──────────────────────────────────────────
     // Global controls
     // ──────────────────────────────────────────
     void setMasterVolume(float volume);
-    float getMasterVolume() const { return masterVolume; }
+    float getMasterVolume() const { return masterBus.getGain(); }
+
+    // ──────────────────────────────────────────
+    // Master bus: gain -> EQ -> compressor -> lookahead limiter
+    // ──────────────────────────────────────────
+    void setMasterEqBand(MasterBus::EqBand band, float frequencyHz, float gainDb, float q);
+    void setMasterEqEnabled(bool enabled);
+    void setMasterCompressor(float thresholdDb, float ratio, float attackMs, float releaseMs, float makeupDb);
+    void setMasterCompressorEnabled(bool enabled);
+    void setMasterLimiter(float ceilingDb, float releaseMs);
+    void setMasterLimiterEnabled(bool enabled);
+    
+    /** Samples the master output lags behind the mix (the limiter's lookahead). */
+    int getMasterLatencySamples() const { return masterBus.getLatencySamples(); }
+    
+    /** Deepest limiter gain reduction in the last block, in dB (0 or negative). */
+    float getMasterGainReductionDb() const { return masterBus.getLimiterGainReductionDb(); }
+
+    // ──────────────────────────────────────────
+    // Session snapshots
+    // ──────────────────────────────────────────
+    
+    /**
+     * Save every channel's instrument, effects, samples and sequence plus the
+     * master bus to a binary snapshot file (see SessionSnapshot.h).
+     */
+    juce::Result saveSnapshot(const juce::File& file) const;
+    
+    /**
+     * Replace the whole session with a saved snapshot. Sample frames are
+     * memory-mapped rather than decoded, so this takes milliseconds however
+     * many samples the session holds. On failure the session is unchanged.
+     */
+    juce::Result loadSnapshot(const juce::File& file);
+
+    // ──────────────────────────────────────────
+    // Multi-core rendering
+    // ──────────────────────────────────────────
+    
+    /**
+     * Render channels on this many worker threads alongside the audio thread.
+     * 0 (the default) renders everything on the audio thread.
+     */
+    void setRenderThreadCount(int numWorkers);
+    int getRenderThreadCount() const { return renderThreadCount.load(std::memory_order_relaxed); }
+
+    // ──────────────────────────────────────────
+    // Processing quantum
+    // ──────────────────────────────────────────
+    
+    static constexpr int minProcessingQuantum = 16;
+    static constexpr int maxProcessingQuantum = 1024;
+    
+    /**
+     * Render internally in fixed blocks of this many frames, whatever block
+     * size the device uses; device callbacks are fed from a FIFO. 0 (the
+     * default) renders at the device's block size. Commands and sequencer
+     * events then land with the same resolution on every device, at the
+     * cost of up to one quantum of extra latency for immediate commands.
+     *
+     * Takes effect at the next audioDeviceAboutToStart() / prepareToPlay();
+     * a running device is restarted to apply it.
+     */
+    void setProcessingQuantum(int frames);
+    int getProcessingQuantum() const { return processingQuantum.load(std::memory_order_relaxed); }
+
+    // ──────────────────────────────────────────
+    // Rendering without an audio device (benchmarks, offline tools)
+    // ──────────────────────────────────────────
+    
+    /** Same as audioDeviceAboutToStart(), for when no device is open. */
+    void prepareToPlay(double sampleRate, int maximumBlockSize);
+    
+    /**
+     * Render one block of any length into output; the device callback goes
+     * through here too. Output longer than prepareToPlay()'s block size is
+     * rendered in several internal blocks.
+     */
+    void renderNextBlock(juce::AudioBuffer<float>& output, juce::uint64 blockStartNs);
 
     // ──────────────────────────────────────────
     // Info
     // ──────────────────────────────────────────
     int getActiveChannelCount() const;
     std::vector<int> getActiveChannels() const;
+    double getSampleRate() const { return currentSampleRate; }
+    
+    // Commands waiting for the audio thread, and commands dropped because the queue was full
+    int getCommandQueueDepth() const;
+    int getCommandQueueOverflowCount() const;
+    
+    // Timed commands dropped because the scheduler was full
+    int getScheduledOverflowCount() const { return scheduledOverflowCount.load(std::memory_order_relaxed); }
+    
+    /** How much work silence tracking saved: the last block, and totals since start. */
+    struct BypassStats
+    {
+        int channelsRendered = 0;   // last block, channels with an instrument
+        int channelsBypassed = 0;   // last block, of those, skipped as silent
+        int effectsBypassed = 0;    // last block, enabled effects asleep
+        juce::int64 totalBlocks = 0;
+        juce::int64 totalChannelsBypassed = 0;
+        juce::int64 totalEffectsBypassed = 0;
+    };
+    BypassStats getBypassStats() const;
+    
+    /**
+     * Where the audio budget goes: time per callback, per channel render and
+     * per effect, as histograms recorded on the audio thread. Reading never
+     * blocks the audio thread. Call from the control thread.
+     */
+    struct PerformanceStats
+    {
+        struct Channel
+        {
+            int channel = 0;
+            TimingHistogram::Summary render;  // instrument + effects + volume/pan
+            std::vector<Instrument::EffectTiming> effects;
+        };
+        
+        double budgetMicros = 0.0;          // length of one block at the current settings
+        double loadProportion = 0.0;        // smoothed callback time / block length
+        TimingHistogram::Summary callback;  // everything the audio callback does
+        int overruns = 0;                   // callbacks that took longer than their block
+        int xruns = 0;                      // dropouts reported by the audio device
+        std::vector<Channel> channels;
+        std::vector<SendBuses::BusTiming> sendBuses;  // bus numbers 1-numSendBuses
+    };
+    PerformanceStats getPerformanceStats() const;
+    
+    /** Start the histograms and counters over (takes effect on the next block). */
+    void resetPerformanceStats();
+    
+    /**
+     * Allocations, frees and locks caught on the render path (see
+     * RealtimeSafety.h). Always zero unless the build has AUDIO_REALTIME_CHECKS
+     * and links RealtimeSafetyHooks.cpp.
+     */
+    RealtimeSafety::Counts getRealtimeViolationCounts() const { return RealtimeSafety::getCounts(); }
+    
+    /** The most recent violations with their stacks, oldest first. Allocates. */
+    juce::StringArray describeRealtimeViolations() const;
+    
+    /** Clear the counts and the ring. Only while nothing is rendering. */
+    void resetRealtimeViolations() { RealtimeSafety::reset(); }
+
+    // ──────────────────────────────────────────
+    // Metering
+    // ──────────────────────────────────────────
+    
+    /**
+     * Levels of each channel (after its volume and pan) and of the master
+     * output, measured on the audio thread every block and published as one
+     * set. Reading copies the newest set; it never blocks the audio thread
+     * and doesn't add to its work however often it's called.
+     */
+    struct Meters
+    {
+        std::array<LoudnessMeter::Readings, maxChannels> channels {};
+        std::array<bool, maxChannels> hasInstrument {};
+        LoudnessMeter::Readings master;
+        juce::int64 blocks = 0;     // blocks measured; stops moving when the audio does
+    };
+    Meters getMeters() const;
+    
+    /** Restart integrated loudness and the true-peak maxima (from the next block). */
+    void resetLoudness();
+
+    // ──────────────────────────────────────────
+    // Spectrum and oscilloscope
+    // ──────────────────────────────────────────
+    
+    /**
+     * Watch a channel's output (1-16, after volume and pan) or the master
+     * output (0). Only watched signals are copied off the audio thread, and
+     * only they are analysed (see AudioAnalyzer). Each attach needs a detach.
+     */
+    bool attachAnalyzer(int channel) { return analyzer.subscribe(channel); }
+    void detachAnalyzer(int channel) { analyzer.unsubscribe(channel); }
+    
+    /** The newest spectrum and scope frame; false until there is one. */
+    bool getAnalyzerFrame(int channel, AudioAnalyzer::Frame& frame) const { return analyzer.getLatestFrame(channel, frame); }
+    
+    /** getAnalyzerFrame() into caller-owned floats (see AudioAnalyzer::copyLatestFrame); 0 if none. */
+    juce::int64 copyAnalyzerFrame(int channel, float* spectrum, float* scope, double& sampleRate) const
+    {
+        return analyzer.copyLatestFrame(channel, spectrum, scope, sampleRate);
+    }
+
+    // ──────────────────────────────────────────
+    // Telemetry (read straight from memory)
+    // ──────────────────────────────────────────
+    
+    /**
+     * Transport position and each channel's held notes, voice count and
+     * envelope, rewritten every block under a seqlock (see EngineTelemetry).
+     * Readers never block the audio thread, so UI can poll it every frame;
+     * the iOS module maps the block into JS as an ArrayBuffer.
+     */
+    const EngineTelemetry& getTelemetry() const { return telemetry; }
 
     // ──────────────────────────────────────────
     // JUCE AudioIODeviceCallback
@@ -157,6 +546,10 @@ private:
         std::variant<std::unique_ptr<Instrument>,
                     std::unique_ptr<MultiSamplerInstrument>> instrument;
         
+        // When this replaces a playing instrument, crossfade over this many
+        // samples (0 = switch at once)
+        int crossfadeSamples = 0;
+        
         InstrumentWrapper(std::unique_ptr<Instrument> osc)
             : type(InstrumentType::Oscillator)
             , instrument(std::move(osc))
@@ -173,28 +566,183 @@ private:
     // ──────────────────────────────────────────
     juce::AudioDeviceManager deviceManager;
     
-    // Map of channel number to InstrumentWrapper
-    std::map<int, std::unique_ptr<InstrumentWrapper>> instruments;
+    // One slot per channel (index = channel - 1). Written only by control
+    // threads, read lock-free by the audio callback.
+    std::array<std::atomic<InstrumentWrapper*>, maxChannels> instrumentSlots;
+    
+    // Deletes replaced instruments once the audio thread has let go of them
+    RealtimeReclaimer reclaimer;
+    
+    // Instruments replaced by a hot-swap, waiting for the audio thread to take
+    // them over and fade them out
+    std::array<std::atomic<InstrumentWrapper*>, maxChannels> outgoingSlots;
     
-    // Thread safety
-    juce::CriticalSection instrumentLock;
+    // Control thread -> audio thread messages
+    static constexpr size_t commandQueueSize = 1024;
+    CommandQueue<EngineCommand, commandQueueSize> commandQueue;
     
-    // Master controls
-    float masterVolume = 1.0f;
+    // Commands stamped for a later block (audio thread only)
+    CommandScheduler<commandQueueSize> scheduledCommands;
+    std::atomic<int> scheduledOverflowCount { 0 };
     
-    // Audio state
+    // Loop playback and live recording, driven from the audio callback
+    LoopSequencer sequencer { reclaimer };
+    
+    // Shared effect buses fed by channel sends, mixed in ahead of the master
+    SendBuses sendBuses { reclaimer };
+    
+    // Master insert chain, including master volume
+    MasterBus masterBus;
+    
+    // Audio state. currentBlockSize is the internal block size: the quantum
+    // when one is set, otherwise the device's block size.
     double currentSampleRate = 44100.0;
     int currentBlockSize = 512;
+    int deviceBlockSize = 512;
+    std::atomic<int> deviceOutputLatency { 0 };  // samples, as the device reports it
+    
+    // Fixed processing quantum (0 = off); the audio thread uses the value
+    // captured by prepareToPlay()
+    std::atomic<int> processingQuantum { 0 };
+    int activeQuantum = 0;
+    
+    // One quantum of rendered audio waiting to go out to the device
+    juce::AudioBuffer<float> quantumBuffer;
+    juce::AbstractFifo quantumFifo { 1 };
+    
+    // Per-channel MIDI buffers, filled from the command queue each block. Each
+    // command adds at most one event to a buffer, so a block adds at most the
+    // popped commands, the parked ones coming due and the sequencer's events.
+    static constexpr size_t maxMidiEventsPerBlock = commandQueueSize + commandQueueSize
+                                                  + static_cast<size_t>(LoopSequencer::maxEventsPerBlock);
+    std::array<juce::MidiBuffer, maxChannels> midiBuffers;
+    static_assert(maxChannels == LoopSequencer::numChannels, "Sequencer and engine channel counts differ");
+    
+    // One render target per channel, summed in channel order after rendering
+    std::array<juce::AudioBuffer<float>, maxChannels> channelBuffers;
+    
+    // Channels with an instrument this block, or with only a swapped-out one
+    // still fading (wrapper nullptr); audio thread only
+    std::array<InstrumentWrapper*, maxChannels> renderWrappers {};
+    std::array<int, maxChannels> renderIndices {};
+    int numRenderChannels = 0;
+    juce::uint32 renderedChannelMask = 0;   // bit per channel index
+    
+    // Sidechains (audio thread only). Each block the render slots are put in
+    // stages from the keys their effect chains listen to: a source renders in
+    // an earlier stage and copies its pre-fader output to its key buffer.
+    // Channels within a stage may render in parallel.
+    std::array<juce::AudioBuffer<float>, maxChannels> sidechainKeys;
+    std::array<int, maxChannels> sidechainKeyDirtySamples {};
+    std::array<int, maxChannels> renderStageEnds {};
+    int numRenderStages = 0;
+    juce::uint32 sidechainSourceMask = 0;
+    bool renderStagesSerially = false;
+    
+    // Hot-swap crossfades (audio thread only). The outgoing instrument renders
+    // into fadeBuffers, getting all-notes-off in its first block and no MIDI
+    // after, and is handed back to the reclaimer once the fade is over or it
+    // has gone silent.
+    std::array<InstrumentWrapper*, maxChannels> fadingWrappers {};
+    std::array<int, maxChannels> fadePositions {};
+    std::array<int, maxChannels> fadeLengths {};
+    std::array<bool, maxChannels> fadingHasAudio {};
+    std::array<juce::AudioBuffer<float>, maxChannels> fadeBuffers;
+    const juce::MidiBuffer noMidi;
+    juce::MidiBuffer releaseAllMidi;  // one all-notes-off, built in the constructor
+    
+    // Per channel: whether it produced audio this block, how many samples of
+    // its buffer may be non-zero, and how many effects slept (audio thread only)
+    std::array<bool, maxChannels> channelHasAudio {};
+    std::array<int, maxChannels> channelDirtySamples {};
+    std::array<int, maxChannels> channelEffectsBypassed {};
+    
+    // Bypass telemetry, published once per block
+    std::atomic<int> lastChannelsRendered { 0 };
+    std::atomic<int> lastChannelsBypassed { 0 };
+    std::atomic<int> lastEffectsBypassed { 0 };
+    std::atomic<juce::int64> totalBlocksRendered { 0 };
+    std::atomic<juce::int64> totalChannelsBypassed { 0 };
+    std::atomic<juce::int64> totalEffectsBypassed { 0 };
+    
+    // CPU load instrumentation, written on the audio thread (channel timings by
+    // whichever thread rendered that channel)
+    TimingHistogram callbackTiming;
+    std::array<TimingHistogram, maxChannels> channelTimings;
+    std::atomic<double> loadProportion { 0.0 };
+    std::atomic<int> overrunCount { 0 };
+    std::atomic<bool> timingResetPending { false };
+    int xrunCountAtReset = 0;
+    
+    // Meters, each updated by whichever thread renders its signal. The
+    // readings go out through a triple buffer once per block; readers take
+    // turns on meterReadLock, which the audio thread never touches.
+    std::array<LoudnessMeter, maxChannels> channelMeters;
+    LoudnessMeter masterMeter;
+    mutable TripleBuffer<Meters> publishedMeters;
+    mutable juce::CriticalSection meterReadLock;
+    std::atomic<bool> loudnessResetPending { false };
+    juce::int64 blocksMetered = 0;
+    
+    // Copies of watched signals go here; tap 0 is the master
+    AudioAnalyzer analyzer;
+    
+    // Rewritten at the end of every block (audio thread only writes)
+    EngineTelemetry telemetry;
+    
+    // What has been set up on each channel, as seen by the control thread:
+    // saveSnapshot() writes this rather than reading audio-thread state.
+    // sessionLock also serialises instrument edits with the swap builder;
+    // the audio thread never takes it.
+    SessionSnapshot session;
+    juce::CriticalSection sessionLock;
+    
+    // Per channel, bumped by every session edit (a swap being built restarts
+    // when it changes) and by every publish that cancels a pending swap
+    std::array<juce::uint32, maxChannels> sessionRevisions {};
+    std::array<juce::uint32, maxChannels> swapGenerations {};
+    std::array<std::atomic<int>, maxChannels> pendingSwaps {};
     
-    // MIDI buffer for passing to instruments
-    juce::MidiBuffer midiBuffer;
+    // Optional worker pool; swapped by setRenderThreadCount(), retired via the reclaimer
+    std::atomic<ParallelRenderer*> parallelRenderer { nullptr };
+    std::atomic<int> renderThreadCount { 0 };
     
-    // Mix buffer for combining all instruments
-    juce::AudioBuffer<float> mixBuffer;
+    // Builds hot-swapped instruments; last, so its jobs finish before
+    // anything they use is destroyed
+    juce::ThreadPool instrumentBuilder { 1 };
 
     // ──────────────────────────────────────────
     // Helper methods
     // ──────────────────────────────────────────
     void prepareInstrumentWrapper(InstrumentWrapper* wrapper);
-    InstrumentWrapper* getInstrumentWrapper(int channel);
+    InstrumentWrapper* getInstrumentWrapper(int channel) const;
+    SessionSnapshot::Channel* editSessionChannel(int channel);
+    std::unique_ptr<InstrumentWrapper> buildInstrument(const SessionSnapshot::Channel& state);
+    void publishInstrument(int channel, std::unique_ptr<InstrumentWrapper> wrapper);
+    void cancelInstrumentSwap(int channel);
+    void startInstrumentSwap(int channel, double crossfadeMs);
+    void buildInstrumentSwap(int channel, juce::uint32 generation, int crossfadeSamples);
+    bool pushCommand(const EngineCommand& command);
+    void renderBlock(juce::AudioBuffer<float>& output, juce::uint64 blockStartNs);
+    void renderFromQuantumFifo(juce::AudioBuffer<float>& output, juce::uint64 blockStartNs);
+    juce::uint64 samplesToNs(int numSamples) const;
+    void processCommands(juce::uint64 blockStartNs, int numSamples);
+    void applyCommand(const EngineCommand& command, int sampleOffset, juce::int64 recordOffset);
+    void cancelScheduledNotes(int channel);
+    void renderChannel(int renderSlot, int numSamples);
+    bool renderInstrument(InstrumentWrapper& wrapper, juce::AudioBuffer<float>& buffer,
+                          const juce::MidiBuffer& midi, int numSamples, int& effectsBypassed,
+                          juce::AudioBuffer<float>* preFaderTap = nullptr);
+    void orderRenderChannels();
+    juce::uint32 getSidechainSources(const InstrumentWrapper* wrapper) const;
+    static bool createsSidechainLoop(const SessionSnapshot& state, int channel, int sourceChannel);
+    void takeOverOutgoingInstruments();
+    void releaseFadedInstruments();
+    void applyCrossfade(int index, int numSamples, bool incomingHasAudio, bool outgoingHasAudio);
+    void resetTimings();
+    void publishMeters(const juce::AudioBuffer<float>& output, int numSamples);
+    void publishTelemetry();
+    void recordCallbackTime(juce::int64 startTicks, int numSamples);
+    static bool isValidChannel(int channel) { return channel >= 1 && channel <= maxChannels; }
+    static bool isValidSendBus(int bus) { return bus >= 1 && bus <= numSendBuses; }
 };
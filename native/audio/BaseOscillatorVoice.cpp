@@ -26,7 +26,8 @@ void BaseOscillatorVoice::startNote(int midiNoteNumber,
     freqHz = juce::MidiMessage::getMidiNoteInHertz(midiNoteNumber);
     freqHz *= std::pow(2.0, detuneCents / 1200.0);
 
-    phaseDelta = freqHz * juce::MathConstants<double>::twoPi / getSampleRate();
+    phaseDelta = freqHz / getSampleRate();
+    tableLevel = Wavetable::getLevelForIncrement(phaseDelta);
 
     currentPhase = 0.0;
     noteVelocity = velocity;
@@ -57,6 +58,7 @@ void BaseOscillatorVoice::renderNextBlock(juce::AudioBuffer<float>& outputBuffer
 
     juce::ScopedNoDenormals noDenormals;
 
+    const auto* level = table->getLevel(tableLevel);
     auto* left  = outputBuffer.getWritePointer(0, startSample);
     auto* right = outputBuffer.getNumChannels() > 1 ?
                   outputBuffer.getWritePointer(1, startSample) : nullptr;
@@ -64,6 +66,7 @@ void BaseOscillatorVoice::renderNextBlock(juce::AudioBuffer<float>& outputBuffer
     for (int i = 0; i < numSamples; ++i)
     {
         float env = adsr.getNextSample();
+        envelopeLevel = env;
 
         if (!adsr.isActive())
         {
@@ -71,7 +74,7 @@ void BaseOscillatorVoice::renderNextBlock(juce::AudioBuffer<float>& outputBuffer
             break;
         }
 
-        float osc = getOscValue(currentPhase);
+        float osc = Wavetable::lookup(level, currentPhase);
 
         float sample = osc * (noteVelocity * 0.4f) * env;
 
@@ -79,8 +82,8 @@ void BaseOscillatorVoice::renderNextBlock(juce::AudioBuffer<float>& outputBuffer
         if (right) right[i] += sample;
 
         currentPhase += phaseDelta;
-        if (currentPhase >= juce::MathConstants<double>::twoPi)
-            currentPhase -= juce::MathConstants<double>::twoPi;
+        if (currentPhase >= 1.0)
+            currentPhase -= 1.0;
     }
 }
 
@@ -97,6 +100,13 @@ void BaseOscillatorVoice::controllerMoved(int /*controllerNumber*/, int /*newCon
 void BaseOscillatorVoice::setWaveform(Waveform newType)
 {
     waveform = newType;
+    table = &getTable(newType);
+}
+
+void BaseOscillatorVoice::setWavetable(std::shared_ptr<const Wavetable> newTable)
+{
+    wavetable = std::move(newTable);
+    table = &getTable(waveform);
 }
 
 void BaseOscillatorVoice::setADSR(const juce::ADSR::Parameters& params)
@@ -109,26 +119,15 @@ void BaseOscillatorVoice::setDetune(float cents)
     detuneCents = cents;
 }
 
-float BaseOscillatorVoice::getOscValue(double phase) const
+const Wavetable& BaseOscillatorVoice::getTable(Waveform type) const
 {
-    switch (waveform)
+    switch (type)
     {
+        case Waveform::Saw:       return Wavetable::saw();
+        case Waveform::Square:    return Wavetable::square();
+        case Waveform::Triangle:  return Wavetable::triangle();
+        case Waveform::Wavetable: return wavetable != nullptr ? *wavetable : Wavetable::sine();
         case Waveform::Sine:
-            return std::sin(phase);
-
-        case Waveform::Saw:
-            return 2.0f * float(phase / juce::MathConstants<double>::twoPi) - 1.0f;
-
-        case Waveform::Square:
-            return (phase < juce::MathConstants<double>::pi) ? 1.0f : -1.0f;
-
-        case Waveform::Triangle:
-            {
-                double norm = phase / juce::MathConstants<double>::twoPi;
-                return 2.0f * std::abs(2.0f * norm - 1.0f) - 1.0f;
-            }
-
-        default:
-            return 0.0f;
+        default:                  return Wavetable::sine();
     }
 }
@@ -1,5 +1,7 @@
 #pragma once
 #include "JuceHeader.h"
+#include "Wavetable.h"
+#include <memory>
 //#include <juce_audio_basics/juce_audio_basics.h>
 //#include <juce_dsp/juce_dsp.h>
 
@@ -29,16 +31,26 @@ public:
     void controllerMoved(int controllerNumber, int newControllerValue) override;
 
     // Your public interface
-    enum class Waveform { Sine, Saw, Square, Triangle };
+    // Wavetable plays the table given to setWavetable() (a sine without one)
+    enum class Waveform { Sine, Saw, Square, Triangle, Wavetable };
 
     void setWaveform(Waveform newType);
+    
+    /** The table Waveform::Wavetable plays. Set it before the voice renders; kept alive here. */
+    void setWavetable(std::shared_ptr<const Wavetable> newTable);
     void setADSR(const juce::ADSR::Parameters& params);
     void setDetune(float cents);
 
+    /** Envelope at the end of the last rendered block, 0 when silent. */
+    float getEnvelopeLevel() const { return isVoiceActive() ? envelopeLevel : 0.0f; }
+
 private:
     Waveform waveform = Waveform::Sine;
+    std::shared_ptr<const Wavetable> wavetable;
+    const Wavetable* table  = &Wavetable::sine();   // the one being played; builds the built-ins
+    int tableLevel          = 0;                    // band limit for the note's pitch
 
-    double currentPhase     = 0.0;
+    double currentPhase     = 0.0;                  // in cycles, 0 to 1
     double phaseDelta       = 0.0;
     double freqHz           = 440.0;
 
@@ -46,6 +58,7 @@ private:
     float detuneCents       = 0.0f;
 
     juce::ADSR adsr;
+    float envelopeLevel     = 0.0f;
 
-    float getOscValue(double phase) const;
+    const Wavetable& getTable(Waveform type) const;
 };
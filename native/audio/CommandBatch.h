@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+
+/**
+ * CommandBatch - Wire format of the packed commands AudioEngine::submitBatch()
+ * takes from JS in one ArrayBuffer (packed by src/specs/CommandBatch.ts).
+ *
+ * Each record is 16 bytes, little-endian:
+ *
+ *   0   uint8    op (BatchRecord::Op)
+ *   1   uint8    channel, 1-16 (0 = every channel, AllNotesOff only)
+ *   2   uint8    note, waveform, send bus or Instrument::EffectParameter
+ *   3   uint8    reserved, 0
+ *   4   int32    effect id
+ *   8   float32  value: velocity, volume, pan, cents, level, parameter value
+ *   12  float32  delay in ms from submission (notes only, 0 = next block)
+ *
+ * Keep the ops and the layout in step with the TypeScript side; ops are only
+ * ever appended.
+ */
+struct BatchRecord
+{
+    enum class Op : uint8_t
+    {
+        None,               // padding, skipped
+        NoteOn,
+        NoteOff,
+        AllNotesOff,
+        SetVolume,
+        SetPan,
+        SetDetune,
+        SetWaveform,
+        SetEffectEnabled,   // value != 0 enables
+        SetEffectParameter,
+        SetSendLevel,
+        StartTransport,
+        StopTransport
+    };
+
+    Op op = Op::None;
+    uint8_t channel = 0;
+    uint8_t index = 0;
+    uint8_t reserved = 0;
+    int32_t effectId = 0;
+    float value = 0.0f;
+    float delayMs = 0.0f;
+
+    static constexpr size_t size = 16;
+
+    /** Copy out the record at byte offset; the buffer needn't be aligned. */
+    static BatchRecord read(const uint8_t* data, size_t offset)
+    {
+        BatchRecord record;
+        std::memcpy(&record, data + offset, size);
+        return record;
+    }
+};
+
+static_assert(sizeof(BatchRecord) == BatchRecord::size, "BatchRecord must match the packed JS layout");
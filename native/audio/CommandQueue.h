@@ -0,0 +1,109 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+/**
+ * CommandQueue - Bounded multi-producer / single-consumer queue for small POD
+ * messages (Dmitry Vyukov's bounded queue with per-cell sequence numbers).
+ *
+ * Any number of control threads may push(); only the audio thread may pop().
+ * Neither side allocates or locks. pop() is wait-free; push() only retries
+ * when another producer claimed the same cell first, and fails immediately
+ * (counting an overflow) when the queue is full.
+ */
+template <typename ItemType, size_t Capacity>
+class CommandQueue
+{
+public:
+    static_assert(std::is_trivially_copyable_v<ItemType>, "Queue items must be POD");
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+    CommandQueue()
+    {
+        for (size_t i = 0; i < Capacity; ++i)
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    // ──────────────────────────────────────────
+    // Producers (any thread)
+    // ──────────────────────────────────────────
+    bool push(const ItemType& item) noexcept
+    {
+        auto pos = enqueuePos.load(std::memory_order_relaxed);
+
+        for (;;)
+        {
+            auto& cell = cells[pos & mask];
+            const auto seq = cell.sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+
+            if (diff == 0)
+            {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    cell.item = item;
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+            {
+                overflowCount.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            else
+            {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // ──────────────────────────────────────────
+    // Consumer (audio thread only)
+    // ──────────────────────────────────────────
+    bool pop(ItemType& item) noexcept
+    {
+        const auto pos = dequeuePos.load(std::memory_order_relaxed);
+        auto& cell = cells[pos & mask];
+        const auto seq = cell.sequence.load(std::memory_order_acquire);
+
+        if (static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos + 1) < 0)
+            return false;
+
+        item = cell.item;
+        cell.sequence.store(pos + Capacity, std::memory_order_release);
+        dequeuePos.store(pos + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // ──────────────────────────────────────────
+    // Counters (any thread, approximate while in flight)
+    // ──────────────────────────────────────────
+    size_t getApproximateDepth() const noexcept
+    {
+        const auto tail = dequeuePos.load(std::memory_order_relaxed);
+        const auto head = enqueuePos.load(std::memory_order_relaxed);
+        return head > tail ? head - tail : 0;
+    }
+
+    uint32_t getOverflowCount() const noexcept { return overflowCount.load(std::memory_order_relaxed); }
+
+    static constexpr size_t getCapacity() noexcept { return Capacity; }
+
+private:
+    struct Cell
+    {
+        std::atomic<size_t> sequence { 0 };
+        ItemType item {};
+    };
+
+    static constexpr size_t mask = Capacity - 1;
+
+    std::array<Cell, Capacity> cells;
+    alignas(64) std::atomic<size_t> enqueuePos { 0 };
+    alignas(64) std::atomic<size_t> dequeuePos { 0 };
+    alignas(64) std::atomic<uint32_t> overflowCount { 0 };
+};
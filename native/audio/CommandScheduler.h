@@ -0,0 +1,72 @@
+#pragma once
+#include "EngineCommand.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * CommandScheduler - Fixed-capacity, time-ordered holding area for commands
+ * stamped with a future host time. Owned by the audio thread; a binary
+ * min-heap over a preallocated array, so scheduling and popping never
+ * allocate. Commands with equal timestamps come out in the order they went in.
+ */
+template <size_t Capacity>
+class CommandScheduler
+{
+public:
+    /** Returns false (and leaves the command unscheduled) when full. */
+    bool schedule(const EngineCommand& command) noexcept
+    {
+        if (numEntries >= Capacity)
+            return false;
+
+        entries[numEntries++] = { command, nextOrder++ };
+        std::push_heap(entries.begin(), entries.begin() + static_cast<std::ptrdiff_t>(numEntries), later);
+        return true;
+    }
+
+    /** Pops the earliest command if it is due before the given host time. */
+    bool popDue(uint64_t beforeHostTimeNs, EngineCommand& command) noexcept
+    {
+        if (numEntries == 0 || entries.front().command.hostTimeNs >= beforeHostTimeNs)
+            return false;
+
+        std::pop_heap(entries.begin(), entries.begin() + static_cast<std::ptrdiff_t>(numEntries), later);
+        command = entries[--numEntries].command;
+        return true;
+    }
+
+    /** Drops every command for which shouldRemove(command) is true. */
+    template <typename Predicate>
+    void removeIf(Predicate shouldRemove) noexcept
+    {
+        const auto end = entries.begin() + static_cast<std::ptrdiff_t>(numEntries);
+        const auto kept = std::remove_if(entries.begin(), end,
+                                         [&shouldRemove](const Entry& entry) { return shouldRemove(entry.command); });
+        numEntries = static_cast<size_t>(kept - entries.begin());
+        std::make_heap(entries.begin(), kept, later);
+    }
+
+    void clear() noexcept { numEntries = 0; }
+    size_t size() const noexcept { return numEntries; }
+
+private:
+    struct Entry
+    {
+        EngineCommand command;
+        uint64_t order;
+    };
+
+    // Heap comparator: "a comes out after b"
+    static bool later(const Entry& a, const Entry& b) noexcept
+    {
+        if (a.command.hostTimeNs != b.command.hostTimeNs)
+            return a.command.hostTimeNs > b.command.hostTimeNs;
+        return a.order > b.order;
+    }
+
+    std::array<Entry, Capacity> entries {};
+    size_t numEntries = 0;
+    uint64_t nextOrder = 0;
+};
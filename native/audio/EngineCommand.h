@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdint>
+
+/**
+ * EngineCommand - Fixed-size POD message sent from control threads to the
+ * audio thread through AudioEngine's command queue. Nothing in here owns
+ * memory, so commands can be copied around freely on the audio thread.
+ */
+struct EngineCommand
+{
+    enum class Type : uint8_t
+    {
+        NoteOn,             // note, values[0] = velocity
+        NoteOff,            // note
+        AllNotesOff,        // channel 0 = every channel
+        SetADSR,            // values = attack, decay, sustain, release
+        SetVolume,          // values[0]
+        SetPan,             // values[0]
+        SetWaveform,        // param = BaseOscillatorVoice::Waveform
+        SetDetune,          // values[0] = cents
+        SetEffectEnabled,   // effectId, param = enabled
+        SetEffectParameter, // effectId, param = Instrument::EffectParameter, values[0]
+        SetEffectSidechain, // effectId, param = source channel (0 = the effect's own input)
+        CancelScheduledNotes // drop parked NoteOn/NoteOff; channel 0 = every channel
+    };
+
+    Type type = Type::NoteOn;
+    uint8_t channel = 0;    // 1-16, 0 = engine-wide
+    uint8_t note = 0;
+    uint8_t reserved = 0;
+    int32_t effectId = 0;
+    int32_t param = 0;
+    float values[4] {};
+    uint64_t hostTimeNs = 0; // when to apply (AudioEngine::getHostTimeNs clock), 0 = next block
+    uint64_t recordTimeNs = 0; // NoteOn/NoteOff: where a recording captures it (same clock), 0 = where it plays
+};
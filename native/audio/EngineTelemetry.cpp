@@ -0,0 +1,98 @@
+#include "EngineTelemetry.h"
+#include <bit>
+
+namespace
+{
+    using Words = std::array<juce::uint32, EngineTelemetry::numWords>;
+
+    void putDouble(Words& words, int index, double value)
+    {
+        const auto bits = std::bit_cast<juce::uint64>(value);
+        words[static_cast<size_t>(index)] = static_cast<juce::uint32>(bits);
+        words[static_cast<size_t>(index + 1)] = static_cast<juce::uint32>(bits >> 32);
+    }
+
+    double getDouble(const Words& words, int index)
+    {
+        const auto bits = static_cast<juce::uint64>(words[static_cast<size_t>(index)])
+                          | static_cast<juce::uint64>(words[static_cast<size_t>(index + 1)]) << 32;
+        return std::bit_cast<double>(bits);
+    }
+}
+
+EngineTelemetry::EngineTelemetry()
+    : block(std::make_shared<Block>())
+{
+    block->words[1].store(layoutVersion, std::memory_order_relaxed);
+    block->words[2].store(numChannels, std::memory_order_relaxed);
+}
+
+void EngineTelemetry::publish()
+{
+    Words encoded {};
+    encoded[1] = layoutVersion;
+    encoded[2] = numChannels;
+    encoded[3] = pending.playing ? 1u : 0u;
+    putDouble(encoded, 4, pending.transportPositionMs);
+    putDouble(encoded, 6, pending.presentationTimeMs);
+    encoded[8] = std::bit_cast<juce::uint32>(pending.sampleRate);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        const auto& channel = pending.channels[static_cast<size_t>(ch)];
+        const auto base = static_cast<size_t>(headerWords + ch * channelWords);
+        std::copy(channel.heldNotes.begin(), channel.heldNotes.end(), encoded.begin() + static_cast<std::ptrdiff_t>(base));
+        encoded[base + 4] = channel.voices;
+        encoded[base + 5] = std::bit_cast<juce::uint32>(channel.envelope);
+    }
+
+    // Odd while writing; the release fence keeps the data stores after it
+    auto& words = block->words;
+    const auto sequence = words[0].load(std::memory_order_relaxed);
+    words[0].store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (size_t i = 1; i < encoded.size(); ++i)
+        words[i].store(encoded[i], std::memory_order_relaxed);
+
+    words[0].store(sequence + 2, std::memory_order_release);
+}
+
+bool EngineTelemetry::read(Snapshot& snapshot) const
+{
+    const auto& words = block->words;
+    Words copy {};
+
+    for (int attempt = 0; attempt < maxReadAttempts; ++attempt)
+    {
+        const auto before = words[0].load(std::memory_order_acquire);
+        if ((before & 1u) != 0)
+            continue;
+
+        for (size_t i = 1; i < copy.size(); ++i)
+            copy[i] = words[i].load(std::memory_order_relaxed);
+
+        // Keeps the data loads before the second look at the sequence
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (words[0].load(std::memory_order_relaxed) != before)
+            continue;
+
+        snapshot.playing = (copy[3] & 1u) != 0;
+        snapshot.transportPositionMs = getDouble(copy, 4);
+        snapshot.presentationTimeMs = getDouble(copy, 6);
+        snapshot.sampleRate = std::bit_cast<float>(copy[8]);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto& channel = snapshot.channels[static_cast<size_t>(ch)];
+            const auto base = static_cast<size_t>(headerWords + ch * channelWords);
+            std::copy(copy.begin() + static_cast<std::ptrdiff_t>(base),
+                      copy.begin() + static_cast<std::ptrdiff_t>(base + 4), channel.heldNotes.begin());
+            channel.voices = copy[base + 4];
+            channel.envelope = std::bit_cast<float>(copy[base + 5]);
+        }
+        return true;
+    }
+
+    return false;
+}
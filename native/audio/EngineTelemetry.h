@@ -0,0 +1,106 @@
+#pragma once
+#include "JuceHeader.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+/**
+ * EngineTelemetry - A small fixed block of engine state the audio thread
+ * rewrites every block, for UI that reads it at display rate (playheads, pad
+ * glow) straight from memory: JS gets it as an ArrayBuffer over the same
+ * bytes, so there is no call per read.
+ *
+ * The block is guarded by a seqlock: the first word is odd while the audio
+ * thread is writing and goes up by 2 per update. A reader copies what it
+ * needs and keeps the copy only if the word was even and unchanged on both
+ * sides of it. Neither side ever waits for the other, and the writer never
+ * learns a reader exists.
+ *
+ * Layout, as 32-bit little-endian words (the JS side in
+ * src/specs/EngineTelemetry.ts mirrors it):
+ *
+ *   0       sequence
+ *   1       layoutVersion
+ *   2       numChannels
+ *   3       flags (bit 0: transport playing)
+ *   4-5     float64 transport position at the block's start, ms
+ *   6-7     float64 host time that position is heard, ms (getHostTimeNs clock / 1e6)
+ *   8       float32 sample rate
+ *   9-15    reserved
+ *   16 + 8c channel c+1: words 0-3 notes held (bit n of word n / 32),
+ *           4 voices sounding, 5 float32 loudest envelope (0-1), 6-7 reserved
+ */
+class EngineTelemetry
+{
+public:
+    static constexpr int numChannels = 16;
+    static constexpr juce::uint32 layoutVersion = 1;
+    static constexpr int headerWords = 16;
+    static constexpr int channelWords = 8;
+    static constexpr int numWords = headerWords + numChannels * channelWords;
+
+    struct Channel
+    {
+        std::array<juce::uint32, 4> heldNotes {};
+        juce::uint32 voices = 0;
+        float envelope = 0.0f;
+
+        void clear() { *this = {}; }
+
+        void addVoice(int note, bool held, float envelopeLevel)
+        {
+            if (held && note >= 0 && note < 128)
+                heldNotes[static_cast<size_t>(note >> 5)] |= 1u << (note & 31);
+            ++voices;
+            envelope = juce::jmax(envelope, envelopeLevel);
+        }
+    };
+
+    struct Snapshot
+    {
+        bool playing = false;
+        double transportPositionMs = 0.0;
+        double presentationTimeMs = 0.0;
+        float sampleRate = 0.0f;
+        std::array<Channel, numChannels> channels {};
+    };
+
+    /** The words themselves; shared so a JS ArrayBuffer over them can outlive the engine. */
+    struct Block
+    {
+        std::array<std::atomic<juce::uint32>, numWords> words {};
+    };
+
+    static_assert(sizeof(std::atomic<juce::uint32>) == sizeof(juce::uint32)
+                  && std::atomic<juce::uint32>::is_always_lock_free,
+                  "the block is read as plain 32-bit words");
+
+    EngineTelemetry();
+
+    // ──────────────────────────────────────────
+    // Audio thread
+    // ──────────────────────────────────────────
+
+    /** The next update, filled in place; publish() makes it visible. */
+    Snapshot& getWriteSnapshot() { return pending; }
+    void publish();
+
+    // ──────────────────────────────────────────
+    // Readers (any thread)
+    // ──────────────────────────────────────────
+
+    /** The newest update; false if the writer kept getting in the way (try next frame). */
+    bool read(Snapshot& snapshot) const;
+
+    const std::shared_ptr<Block>& getBlock() const { return block; }
+    static constexpr size_t getSizeInBytes() { return sizeof(Block); }
+
+private:
+    static constexpr int maxReadAttempts = 4;
+
+    std::shared_ptr<Block> block;
+    Snapshot pending;   // audio thread only
+
+    JUCE_DECLARE_NON_COPYABLE(EngineTelemetry)
+};
@@ -1,5 +1,6 @@
 #include "Instrument.h"
 #include "SimpleEffects.h"
+#include "RealtimeSafety.h"
 
 // ──────────────────────────────────────────
 // Wrapper classes to adapt lightweight effects to EffectProcessor interface
@@ -16,6 +17,7 @@ public:
     {
         reverb.processBlock(buffer);
     }
+    bool isTailActive() const override { return reverb.isTailActive(); }
     SimpleReverbProcessor* getProcessor() { return &reverb; }
 private:
     SimpleReverbProcessor reverb;
@@ -33,6 +35,7 @@ public:
     {
         delay.processBlock(buffer);
     }
+    bool isTailActive() const override { return delay.isTailActive(); }
     SimpleDelayProcessor* getProcessor() { return &delay; }
 private:
     SimpleDelayProcessor delay;
@@ -50,18 +53,42 @@ public:
     {
         filter.processBlock(buffer);
     }
+    bool isTailActive() const override { return filter.isTailActive(); }
     SimpleFilterProcessor* getProcessor() { return &filter; }
 private:
     SimpleFilterProcessor filter;
 };
 
+class CompressorEffectWrapper : public Instrument::EffectProcessor
+{
+public:
+    void prepareToPlay(double sampleRate, int samplesPerBlock) override
+    {
+        compressor.prepareToPlay(sampleRate, samplesPerBlock);
+    }
+    void releaseResources() override { compressor.releaseResources(); }
+    void processBlock(juce::AudioBuffer<float>& buffer) override
+    {
+        compressor.processBlock(buffer, sidechainKey);
+    }
+    bool isTailActive() const override { return compressor.isTailActive(); }
+    void setSidechain(const juce::AudioBuffer<float>* key) override { sidechainKey = key; }
+    SimpleCompressorProcessor* getProcessor() { return &compressor; }
+private:
+    SimpleCompressorProcessor compressor;
+    const juce::AudioBuffer<float>* sidechainKey = nullptr;
+};
+
 // ──────────────────────────────────────────
 // Instrument Implementation
 // ──────────────────────────────────────────
 
 Instrument::Instrument(const Config& cfg)
     : config(cfg)
+    , effectsChain(std::make_unique<EffectChain>())
 {
+    publishedEffects.store(effectsChain.get(), std::memory_order_release);
+    
     // Initialize synthesizer
     synth.clearVoices();
     synth.clearSounds();
@@ -69,13 +96,27 @@ Instrument::Instrument(const Config& cfg)
     // Add sound
     synth.addSound(new BasicSynthSound());
     
-    // Add voices based on polyphony
-    for (int i = 0; i < config.polyphony; ++i)
+    if (config.simdVoices)
     {
-        auto* voice = new BaseOscillatorVoice();
-        voice->setWaveform(config.waveform);
-        voice->setADSR(config.adsrParams);
-        synth.addVoice(voice);
+        voiceBank = std::make_unique<OscillatorVoiceBank>(config.polyphony);
+        voiceBank->setWavetable(config.wavetable);
+        voiceBank->setWaveform(config.waveform);
+        voiceBank->setADSR(config.adsrParams);
+        voiceBank->setDetune(config.detune);
+    }
+    else
+    {
+        // Add voices based on polyphony
+        for (int i = 0; i < config.polyphony; ++i)
+        {
+            auto* voice = new BaseOscillatorVoice();
+            voice->setWavetable(config.wavetable);
+            voice->setWaveform(config.waveform);
+            voice->setADSR(config.adsrParams);
+            voice->setDetune(config.detune);
+            synth.addVoice(voice);
+            voices.push_back(voice);
+        }
     }
 }
 
@@ -83,7 +124,6 @@ Instrument::~Instrument()
 {
     synth.clearVoices();
     synth.clearSounds();
-    effectsChain.clear();
 }
 
 void Instrument::prepareToPlay(double sampleRate, int samplesPerBlock)
@@ -92,12 +132,15 @@ void Instrument::prepareToPlay(double sampleRate, int samplesPerBlock)
     currentBlockSize = samplesPerBlock;
     
     synth.setCurrentPlaybackSampleRate(sampleRate);
+    if (voiceBank != nullptr)
+        voiceBank->prepare(sampleRate);
+    gainPan.prepare(sampleRate, samplesPerBlock);
     
     // Prepare effects buffer
     effectsBuffer.setSize(2, samplesPerBlock);
     
     // Prepare all effects
-    for (auto& effect : effectsChain)
+    for (auto& effect : *effectsChain)
     {
         if (effect->processor)
         {
@@ -106,11 +149,17 @@ void Instrument::prepareToPlay(double sampleRate, int samplesPerBlock)
     }
 }
 
-void Instrument::renderNextBlock(juce::AudioBuffer<float>& buffer,
+bool Instrument::renderNextBlock(juce::AudioBuffer<float>& buffer,
                                  const juce::MidiBuffer& midiMessages,
                                  int startSample,
-                                 int numSamples)
+                                 int numSamples,
+                                 juce::AudioBuffer<float>* preFaderTap)
 {
+    bypassedEffectCount = 0;
+    
+    // Idle voices and no new notes: only effect tails can make sound
+    const bool voicesActive = !midiMessages.isEmpty() || isActive();
+    
     // Create a view into the buffer for this render block
     juce::AudioBuffer<float> bufferView(
         buffer.getArrayOfWritePointers(),
@@ -120,16 +169,39 @@ void Instrument::renderNextBlock(juce::AudioBuffer<float>& buffer,
     );
     
     // Render synth output
-    synth.renderNextBlock(bufferView, midiMessages, 0, numSamples);
+    if (voicesActive && voiceBank != nullptr)
+    {
+        voiceBank->renderNextBlock(bufferView, midiMessages, 0, numSamples);
+    }
+    else if (voicesActive)
+    {
+        const ScopedRealtimeLockExemption synthLock;   // juce::Synthesiser locks every block
+        synth.renderNextBlock(bufferView, midiMessages, 0, numSamples);
+    }
     
     // Process effects chain
-    if (!effectsChain.empty())
+    bool hasOutput = voicesActive;
+    if (!getPublishedEffects().empty())
+    {
+        hasOutput = processEffectsChain(bufferView, numSamples, voicesActive);
+    }
+    
+    // Silent: nothing to click, so volume/pan changes can land at once
+    if (!hasOutput)
+    {
+        gainPan.snapToTarget();
+        return false;
+    }
+    
+    if (preFaderTap != nullptr)
     {
-        processEffectsChain(bufferView, numSamples);
+        for (int ch = 0; ch < juce::jmin(bufferView.getNumChannels(), preFaderTap->getNumChannels()); ++ch)
+            preFaderTap->copyFrom(ch, 0, bufferView, ch, 0, numSamples);
     }
     
     // Apply volume and pan
-    applyVolumeAndPan(bufferView, numSamples);
+    gainPan.process(bufferView, numSamples);
+    return true;
 }
 
 // ──────────────────────────────────────────
@@ -138,17 +210,26 @@ void Instrument::renderNextBlock(juce::AudioBuffer<float>& buffer,
 
 void Instrument::noteOn(int midiNote, float velocity)
 {
-    synth.noteOn(1, midiNote, velocity);
+    if (voiceBank != nullptr)
+        voiceBank->noteOn(midiNote, velocity);
+    else
+        synth.noteOn(1, midiNote, velocity);
 }
 
 void Instrument::noteOff(int midiNote, bool allowTailOff)
 {
-    synth.noteOff(1, midiNote, 1.0f, allowTailOff);
+    if (voiceBank != nullptr)
+        voiceBank->noteOff(midiNote, allowTailOff);
+    else
+        synth.noteOff(1, midiNote, 1.0f, allowTailOff);
 }
 
 void Instrument::allNotesOff()
 {
-    synth.allNotesOff(1, true);
+    if (voiceBank != nullptr)
+        voiceBank->allNotesOff(true);
+    else
+        synth.allNotesOff(1, true);
 }
 
 // ──────────────────────────────────────────
@@ -158,61 +239,58 @@ void Instrument::allNotesOff()
 void Instrument::setWaveform(BaseOscillatorVoice::Waveform waveform)
 {
     config.waveform = waveform;
+    if (voiceBank != nullptr)
+        voiceBank->setWaveform(waveform);
     
-    for (int i = 0; i < synth.getNumVoices(); ++i)
-    {
-        if (auto* voice = dynamic_cast<BaseOscillatorVoice*>(synth.getVoice(i)))
-        {
-            voice->setWaveform(waveform);
-        }
-    }
+    for (auto* voice : voices)
+        voice->setWaveform(waveform);
 }
 
 void Instrument::setADSR(const juce::ADSR::Parameters& params)
 {
     config.adsrParams = params;
+    if (voiceBank != nullptr)
+        voiceBank->setADSR(params);
     
-    for (int i = 0; i < synth.getNumVoices(); ++i)
-    {
-        if (auto* voice = dynamic_cast<BaseOscillatorVoice*>(synth.getVoice(i)))
-        {
-            voice->setADSR(params);
-        }
-    }
+    for (auto* voice : voices)
+        voice->setADSR(params);
 }
 
 void Instrument::setVolume(float volume)
 {
     config.volume = juce::jlimit(0.0f, 1.0f, volume);
+    gainPan.setVolume(config.volume);
 }
 
 void Instrument::setPan(float pan)
 {
     config.pan = juce::jlimit(0.0f, 1.0f, pan);
+    gainPan.setPan(config.pan);
 }
 
 void Instrument::setDetune(float cents)
 {
-    for (int i = 0; i < synth.getNumVoices(); ++i)
-    {
-        if (auto* voice = dynamic_cast<BaseOscillatorVoice*>(synth.getVoice(i)))
-        {
-            voice->setDetune(cents);
-        }
-    }
+    config.detune = cents;
+    if (voiceBank != nullptr)
+        voiceBank->setDetune(cents);
+    
+    for (auto* voice : voices)
+        voice->setDetune(cents);
 }
 
 // ──────────────────────────────────────────
 // Effects chain management
 // ──────────────────────────────────────────
 
-int Instrument::addEffect(EffectType type)
+int Instrument::addEffect(EffectType type, int effectId)
 {
     auto processor = createEffect(type);
     if (!processor)
         return -1;
     
-    int effectId = nextEffectId++;
+    if (effectId <= 0)
+        effectId = nextEffectId;
+    nextEffectId = juce::jmax(nextEffectId, effectId + 1);
     
     // Prepare the effect if we're already playing
     if (currentSampleRate > 0.0)
@@ -220,101 +298,192 @@ int Instrument::addEffect(EffectType type)
         processor->prepareToPlay(currentSampleRate, currentBlockSize);
     }
     
-    effectsChain.push_back(
-        std::make_unique<Effect>(effectId, type, std::move(processor))
+    auto chain = std::make_unique<EffectChain>(*effectsChain);
+    chain->push_back(
+        std::make_shared<Effect>(effectId, type, std::move(processor))
     );
+    publishEffects(std::move(chain));
     
     return effectId;
 }
 
 void Instrument::removeEffect(int effectId)
 {
-    effectsChain.erase(
-        std::remove_if(effectsChain.begin(), effectsChain.end(),
+    auto chain = std::make_unique<EffectChain>(*effectsChain);
+    chain->erase(
+        std::remove_if(chain->begin(), chain->end(),
             [effectId](const auto& effect) { return effect->id == effectId; }),
-        effectsChain.end()
+        chain->end()
     );
+    publishEffects(std::move(chain));
 }
 
 void Instrument::clearEffects()
 {
-    effectsChain.clear();
+    publishEffects(std::make_unique<EffectChain>());
+}
+
+void Instrument::publishEffects(std::unique_ptr<EffectChain> chain)
+{
+    publishedEffects.store(chain.get(), std::memory_order_release);
+    std::swap(effectsChain, chain);
+    
+    // chain now holds the replaced one; removed effects die with it
+    if (reclaimer != nullptr)
+        reclaimer->retire(std::move(chain));
 }
 
 void Instrument::setEffectEnabled(int effectId, bool enabled)
 {
-    for (auto& effect : effectsChain)
+    for (auto& effect : getPublishedEffects())
     {
         if (effect->id == effectId)
         {
-            effect->enabled = enabled;
+            effect->enabled.store(enabled, std::memory_order_relaxed);
             break;
         }
     }
 }
 
+Instrument::EffectParameter Instrument::parseEffectParameter(const juce::String& paramName)
+{
+    if (paramName.equalsIgnoreCase("roomSize"))
+        return EffectParameter::RoomSize;
+    if (paramName.equalsIgnoreCase("damping"))
+        return EffectParameter::Damping;
+    if (paramName.equalsIgnoreCase("wetLevel"))
+        return EffectParameter::WetLevel;
+    if (paramName.equalsIgnoreCase("dryLevel"))
+        return EffectParameter::DryLevel;
+    if (paramName.equalsIgnoreCase("width"))
+        return EffectParameter::Width;
+    if (paramName.equalsIgnoreCase("delayTime"))
+        return EffectParameter::DelayTime;
+    if (paramName.equalsIgnoreCase("feedback"))
+        return EffectParameter::Feedback;
+    if (paramName.equalsIgnoreCase("cutoff") || paramName.equalsIgnoreCase("frequency"))
+        return EffectParameter::Cutoff;
+    if (paramName.equalsIgnoreCase("resonance") || paramName.equalsIgnoreCase("q"))
+        return EffectParameter::Resonance;
+    if (paramName.equalsIgnoreCase("type"))
+        return EffectParameter::FilterType;
+    if (paramName.equalsIgnoreCase("threshold"))
+        return EffectParameter::Threshold;
+    if (paramName.equalsIgnoreCase("ratio"))
+        return EffectParameter::Ratio;
+    if (paramName.equalsIgnoreCase("attack"))
+        return EffectParameter::Attack;
+    if (paramName.equalsIgnoreCase("release"))
+        return EffectParameter::Release;
+    if (paramName.equalsIgnoreCase("makeup") || paramName.equalsIgnoreCase("makeupGain"))
+        return EffectParameter::MakeupGain;
+    
+    return EffectParameter::Unknown;
+}
+
 void Instrument::setEffectParameter(int effectId, const juce::String& paramName, float value)
 {
-    for (auto& effect : effectsChain)
+    setEffectParameter(effectId, parseEffectParameter(paramName), value);
+}
+
+void Instrument::setEffectParameter(int effectId, EffectParameter param, float value)
+{
+    for (auto& effect : getPublishedEffects())
     {
         if (effect->id == effectId && effect->processor)
         {
-            // Cast to specific effect type and set parameters
-            if (effect->type == EffectType::Reverb)
-            {
-                auto* wrapper = dynamic_cast<ReverbEffectWrapper*>(effect->processor.get());
-                if (wrapper)
-                {
-                    auto* reverb = wrapper->getProcessor();
-                    if (paramName.equalsIgnoreCase("roomSize"))
-                        reverb->setRoomSize(value);
-                    else if (paramName.equalsIgnoreCase("damping"))
-                        reverb->setDamping(value);
-                    else if (paramName.equalsIgnoreCase("wetLevel"))
-                        reverb->setWetLevel(value);
-                    else if (paramName.equalsIgnoreCase("dryLevel"))
-                        reverb->setDryLevel(value);
-                    else if (paramName.equalsIgnoreCase("width"))
-                        reverb->setWidth(value);
-                }
-            }
-            else if (effect->type == EffectType::Delay)
-            {
-                auto* wrapper = dynamic_cast<DelayEffectWrapper*>(effect->processor.get());
-                if (wrapper)
-                {
-                    auto* delay = wrapper->getProcessor();
-                    if (paramName.equalsIgnoreCase("delayTime"))
-                        delay->setDelayTime(value);
-                    else if (paramName.equalsIgnoreCase("feedback"))
-                        delay->setFeedback(value);
-                    else if (paramName.equalsIgnoreCase("wetLevel"))
-                        delay->setWetLevel(value);
-                }
-            }
-            else if (effect->type == EffectType::Filter)
+            applyEffectParameter(*effect->processor, effect->type, param, value);
+            break;
+        }
+    }
+}
+
+void Instrument::applyEffectParameter(EffectProcessor& processor, EffectType type, EffectParameter param, float value)
+{
+    // Cast to specific effect type and set parameters
+    if (type == EffectType::Reverb)
+    {
+        auto* wrapper = dynamic_cast<ReverbEffectWrapper*>(&processor);
+        if (wrapper)
+        {
+            auto* reverb = wrapper->getProcessor();
+            if (param == EffectParameter::RoomSize)
+                reverb->setRoomSize(value);
+            else if (param == EffectParameter::Damping)
+                reverb->setDamping(value);
+            else if (param == EffectParameter::WetLevel)
+                reverb->setWetLevel(value);
+            else if (param == EffectParameter::DryLevel)
+                reverb->setDryLevel(value);
+            else if (param == EffectParameter::Width)
+                reverb->setWidth(value);
+        }
+    }
+    else if (type == EffectType::Delay)
+    {
+        auto* wrapper = dynamic_cast<DelayEffectWrapper*>(&processor);
+        if (wrapper)
+        {
+            auto* delay = wrapper->getProcessor();
+            if (param == EffectParameter::DelayTime)
+                delay->setDelayTime(value);
+            else if (param == EffectParameter::Feedback)
+                delay->setFeedback(value);
+            else if (param == EffectParameter::WetLevel)
+                delay->setWetLevel(value);
+        }
+    }
+    else if (type == EffectType::Filter)
+    {
+        auto* wrapper = dynamic_cast<FilterEffectWrapper*>(&processor);
+        if (wrapper)
+        {
+            auto* filter = wrapper->getProcessor();
+            if (param == EffectParameter::Cutoff)
+                filter->setCutoffFrequency(value);
+            else if (param == EffectParameter::Resonance)
+                filter->setResonance(value);
+            else if (param == EffectParameter::FilterType)
             {
-                auto* wrapper = dynamic_cast<FilterEffectWrapper*>(effect->processor.get());
-                if (wrapper)
-                {
-                    auto* filter = wrapper->getProcessor();
-                    if (paramName.equalsIgnoreCase("cutoff") || paramName.equalsIgnoreCase("frequency"))
-                        filter->setCutoffFrequency(value);
-                    else if (paramName.equalsIgnoreCase("resonance") || paramName.equalsIgnoreCase("q"))
-                        filter->setResonance(value);
-                    else if (paramName.equalsIgnoreCase("type"))
-                    {
-                        // value: 0 = LowPass, 1 = HighPass, 2 = BandPass
-                        int typeInt = static_cast<int>(value);
-                        if (typeInt == 0)
-                            filter->setFilterType(SimpleFilterProcessor::FilterType::LowPass);
-                        else if (typeInt == 1)
-                            filter->setFilterType(SimpleFilterProcessor::FilterType::HighPass);
-                        else if (typeInt == 2)
-                            filter->setFilterType(SimpleFilterProcessor::FilterType::BandPass);
-                    }
-                }
+                // value: 0 = LowPass, 1 = HighPass, 2 = BandPass
+                int typeInt = static_cast<int>(value);
+                if (typeInt == 0)
+                    filter->setFilterType(SimpleFilterProcessor::FilterType::LowPass);
+                else if (typeInt == 1)
+                    filter->setFilterType(SimpleFilterProcessor::FilterType::HighPass);
+                else if (typeInt == 2)
+                    filter->setFilterType(SimpleFilterProcessor::FilterType::BandPass);
             }
+        }
+    }
+    else if (type == EffectType::Compressor)
+    {
+        auto* wrapper = dynamic_cast<CompressorEffectWrapper*>(&processor);
+        if (wrapper)
+        {
+            auto* compressor = wrapper->getProcessor();
+            if (param == EffectParameter::Threshold)
+                compressor->setThreshold(value);
+            else if (param == EffectParameter::Ratio)
+                compressor->setRatio(value);
+            else if (param == EffectParameter::Attack)
+                compressor->setAttack(value);
+            else if (param == EffectParameter::Release)
+                compressor->setRelease(value);
+            else if (param == EffectParameter::MakeupGain)
+                compressor->setMakeupGain(value);
+        }
+    }
+}
+
+void Instrument::setEffectSidechain(int effectId, const juce::AudioBuffer<float>* key)
+{
+    for (auto& effect : getPublishedEffects())
+    {
+        if (effect->id == effectId && effect->processor)
+        {
+            effect->processor->setSidechain(key);
+            effect->sidechainKey = key;
             break;
         }
     }
@@ -322,27 +491,44 @@ void Instrument::setEffectParameter(int effectId, const juce::String& paramName,
 
 bool Instrument::isActive() const
 {
-    for (int i = 0; i < synth.getNumVoices(); ++i)
+    if (voiceBank != nullptr && voiceBank->isActive())
+        return true;
+    
+    for (auto* voice : voices)
     {
-        if (synth.getVoice(i)->isVoiceActive())
+        if (voice->isVoiceActive())
             return true;
     }
     return false;
 }
 
+std::vector<Instrument::EffectTiming> Instrument::getEffectTimings() const
+{
+    std::vector<EffectTiming> timings;
+    timings.reserve(effectsChain->size());
+    
+    for (const auto& effect : *effectsChain)
+        timings.push_back({ effect->id, effect->type, effect->enabled.load(std::memory_order_relaxed), effect->timing.getSummary() });
+    
+    return timings;
+}
+
+void Instrument::resetEffectTimings()
+{
+    for (auto& effect : getPublishedEffects())
+        effect->timing.reset();
+}
+
 // ──────────────────────────────────────────
 // Private helper methods
 // ──────────────────────────────────────────
 
 void Instrument::updateVoiceParameters()
 {
-    for (int i = 0; i < synth.getNumVoices(); ++i)
+    for (auto* voice : voices)
     {
-        if (auto* voice = dynamic_cast<BaseOscillatorVoice*>(synth.getVoice(i)))
-        {
-            voice->setWaveform(config.waveform);
-            voice->setADSR(config.adsrParams);
-        }
+        voice->setWaveform(config.waveform);
+        voice->setADSR(config.adsrParams);
     }
 }
 
@@ -359,9 +545,11 @@ std::unique_ptr<Instrument::EffectProcessor> Instrument::createEffect(EffectType
         case EffectType::Filter:
             return std::make_unique<FilterEffectWrapper>();
             
+        case EffectType::Compressor:
+            return std::make_unique<CompressorEffectWrapper>();
+            
         case EffectType::Chorus:
         case EffectType::Distortion:
-        case EffectType::Compressor:
             // TODO: Implement these effects
             return nullptr;
             
@@ -370,34 +558,31 @@ std::unique_ptr<Instrument::EffectProcessor> Instrument::createEffect(EffectType
     }
 }
 
-void Instrument::processEffectsChain(juce::AudioBuffer<float>& buffer, int numSamples)
+bool Instrument::processEffectsChain(juce::AudioBuffer<float>& buffer, int numSamples, bool hasInput)
 {
     juce::ignoreUnused(numSamples);
     
-    for (auto& effect : effectsChain)
+    // Silence goes in until some effect is still ringing; everything before
+    // that can sleep. Returns whether the chain produced any output.
+    bool hasSignal = hasInput;
+    
+    for (auto& effect : getPublishedEffects())
     {
-        if (effect->enabled && effect->processor)
+        if (effect->enabled.load(std::memory_order_relaxed) && effect->processor)
         {
-            effect->processor->processBlock(buffer);
+            if (!hasSignal && !effect->processor->isTailActive())
+            {
+                ++bypassedEffectCount;
+                continue;
+            }
+            
+            {
+                ScopedRenderTimer timer(effect->timing);
+                effect->processor->processBlock(buffer);
+            }
+            hasSignal = true;
         }
     }
-}
-
-void Instrument::applyVolumeAndPan(juce::AudioBuffer<float>& buffer, int numSamples)
-{
-    if (buffer.getNumChannels() < 2)
-        return;
-    
-    auto* left = buffer.getWritePointer(0);
-    auto* right = buffer.getWritePointer(1);
     
-    // Calculate pan gains (constant power panning)
-    float leftGain = std::cos(config.pan * juce::MathConstants<float>::halfPi) * config.volume;
-    float rightGain = std::sin(config.pan * juce::MathConstants<float>::halfPi) * config.volume;
-    
-    for (int i = 0; i < numSamples; ++i)
-    {
-        left[i] *= leftGain;
-        right[i] *= rightGain;
-    }
+    return hasSignal;
 }
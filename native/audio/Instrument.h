@@ -1,7 +1,13 @@
 #pragma once
 #include "JuceHeader.h"
+#include "SmoothedGain.h"
+#include "RealtimeSynthesiser.h"
 #include "BaseOscillatorVoice.h"
+#include "OscillatorVoiceBank.h"
 #include "BasicSynthSound.h"
+#include "TimingHistogram.h"
+#include "RealtimeReclaimer.h"
+#include <atomic>
 
 /**
  * Instrument - A complete synthesizer with its own voice configuration,
@@ -12,9 +18,12 @@ struct Config
 {
     int polyphony = 16;
     BaseOscillatorVoice::Waveform waveform = BaseOscillatorVoice::Waveform::Sine;
+    std::shared_ptr<const Wavetable> wavetable;  // played by Waveform::Wavetable
+    bool simdVoices = true;  // OscillatorVoiceBank; false renders BaseOscillatorVoices in a juce::Synthesiser
     juce::ADSR::Parameters adsrParams { 0.01f, 0.1f, 0.8f, 0.3f };
     float volume = 0.7f;
     float pan = 0.5f;  // 0.0 = left, 0.5 = center, 1.0 = right
+    float detune = 0.0f;  // cents
     juce::String name = "Untitled Instrument";
 };
 class Instrument
@@ -29,10 +38,23 @@ public:
     // Core functionality
     // ──────────────────────────────────────────
     void prepareToPlay(double sampleRate, int samplesPerBlock);
-    void renderNextBlock(juce::AudioBuffer<float>& buffer,
+    
+    /**
+     * Adds this block's output to buffer. Returns false, without touching the
+     * buffer, when there was nothing to play: no MIDI, no sounding voices and
+     * no effect tail still ringing.
+     *
+     * With preFaderTap, the block is also copied there (from sample 0) after
+     * the effects and before volume and pan, unless this returns false.
+     */
+    bool renderNextBlock(juce::AudioBuffer<float>& buffer,
                         const juce::MidiBuffer& midiMessages,
                         int startSample,
-                        int numSamples);
+                        int numSamples,
+                        juce::AudioBuffer<float>* preFaderTap = nullptr);
+    
+    /** Enabled effects skipped in the last block because they had gone quiet. */
+    int getBypassedEffectCount() const { return bypassedEffectCount; }
 
     // ──────────────────────────────────────────
     // Note control
@@ -63,8 +85,16 @@ public:
         Compressor
     };
 
-    // Add an effect to the chain (returns effect ID)
-    int addEffect(EffectType type);
+    /**
+     * Where replaced effect chains are deleted once the audio thread is done
+     * with them. Without one they are deleted straight away, which is only
+     * safe while the instrument isn't rendering.
+     */
+    void setReclaimer(RealtimeReclaimer* newReclaimer) { reclaimer = newReclaimer; }
+    
+    // Add an effect to the chain (returns effect ID). Pass an ID to restore
+    // a saved chain with the same IDs; it must not be in use.
+    int addEffect(EffectType type, int effectId = -1);
     
     // Remove an effect by ID
     void removeEffect(int effectId);
@@ -75,8 +105,50 @@ public:
     // Enable/disable an effect
     void setEffectEnabled(int effectId, bool enabled);
     
+    // Effect parameters understood by the built-in effects
+    enum class EffectParameter
+    {
+        Unknown,
+        RoomSize,
+        Damping,
+        WetLevel,
+        DryLevel,
+        Width,
+        DelayTime,
+        Feedback,
+        Cutoff,
+        Resonance,
+        FilterType,
+        Threshold,      // compressor, dB
+        Ratio,
+        Attack,         // compressor, ms
+        Release,        // compressor, ms
+        MakeupGain      // compressor, dB
+    };
+    static constexpr int numEffectParameters = static_cast<int>(EffectParameter::MakeupGain) + 1;
+
+    // Map a parameter name from JS ("roomSize", "cutoff", ...) to its ID
+    static EffectParameter parseEffectParameter(const juce::String& paramName);
+
     // Set effect parameters (specific to each effect type)
     void setEffectParameter(int effectId, const juce::String& paramName, float value);
+    void setEffectParameter(int effectId, EffectParameter param, float value);
+    
+    /**
+     * Feed an effect's detector from key instead of its own input (only the
+     * compressor has one); nullptr goes back to the input. key must hold each
+     * block before this instrument renders and outlive its use.
+     */
+    void setEffectSidechain(int effectId, const juce::AudioBuffer<float>* key);
+    
+    /** Calls visit(key) for each enabled effect listening to a sidechain. Audio thread. */
+    template <typename Visitor>
+    void visitSidechainKeys(Visitor&& visit) const
+    {
+        for (const auto& effect : getPublishedEffects())
+            if (effect->sidechainKey != nullptr && effect->enabled.load(std::memory_order_relaxed))
+                visit(effect->sidechainKey);
+    }
 
     // ──────────────────────────────────────────
     // Info & state
@@ -89,6 +161,32 @@ public:
     float getPan() const { return config.pan; }
     
     bool isActive() const;  // Returns true if any voices are active
+    
+    /** Calls visit(note, keyDown, envelopeLevel) for each sounding voice. Audio thread. */
+    template <typename Visitor>
+    void visitVoices(Visitor&& visit) const
+    {
+        if (voiceBank != nullptr)
+            voiceBank->visitVoices(visit);
+        
+        for (const auto* voice : voices)
+            if (voice->isVoiceActive())
+                visit(voice->getCurrentlyPlayingNote(), voice->isKeyDown(), voice->getEnvelopeLevel());
+    }
+    
+    // Render time of each effect in the chain, in chain order. Control thread,
+    // while nothing else edits the chain.
+    struct EffectTiming
+    {
+        int effectId;
+        EffectType type;
+        bool enabled;
+        TimingHistogram::Summary summary;
+    };
+    std::vector<EffectTiming> getEffectTimings() const;
+    
+    // Audio thread only
+    void resetEffectTimings();
 
     // ──────────────────────────────────────────
     // Effect base class (lightweight)
@@ -100,7 +198,26 @@ public:
         virtual void prepareToPlay(double sampleRate, int samplesPerBlock) = 0;
         virtual void releaseResources() = 0;
         virtual void processBlock(juce::AudioBuffer<float>& buffer) = 0;
+        
+        /**
+         * True while the effect may still output something after its input went
+         * silent. Effects that can't tell stay awake.
+         */
+        virtual bool isTailActive() const { return true; }
+        
+        /** Detector input for effects with a sidechain; others ignore it. */
+        virtual void setSidechain(const juce::AudioBuffer<float>* key) { juce::ignoreUnused(key); }
     };
+    
+    /** A new, unprepared built-in effect; nullptr for types not implemented yet. */
+    static std::unique_ptr<EffectProcessor> createEffect(EffectType type);
+    
+    /**
+     * Set a parameter on an effect made by createEffect(). Parameters the
+     * effect doesn't have are ignored. Only from the thread that renders it.
+     */
+    static void applyEffectParameter(EffectProcessor& processor, EffectType type,
+                                     EffectParameter param, float value);
 
 private:
     // ──────────────────────────────────────────
@@ -110,8 +227,10 @@ private:
     {
         int id;
         EffectType type;
-        bool enabled = true;
+        std::atomic<bool> enabled { true };
         std::unique_ptr<EffectProcessor> processor;
+        const juce::AudioBuffer<float>* sidechainKey = nullptr;  // as given to the processor
+        TimingHistogram timing;  // processBlock() time, recorded on the audio thread
         
         Effect(int id, EffectType type, std::unique_ptr<EffectProcessor> proc)
             : id(id), type(type), processor(std::move(proc)) {}
@@ -121,14 +240,33 @@ private:
     // Members
     // ──────────────────────────────────────────
     Config config;
-    juce::Synthesiser synth;
-    std::vector<std::unique_ptr<Effect>> effectsChain;
+    RealtimeSynthesiser synth;
+    
+    // The synth owns these; kept here so the audio thread can reach the voices
+    // without Synthesiser::getVoice(), which takes the synth's lock.
+    // Empty when the voice bank plays instead (config.simdVoices).
+    std::vector<BaseOscillatorVoice*> voices;
+    std::unique_ptr<OscillatorVoiceBank> voiceBank;
+    
+    // Volume and pan from config, ramped so changes don't click
+    StereoGainPan gainPan { config.volume, config.pan };
+    
+    // Effects are edited copy-on-write: the control thread builds a new chain
+    // and publishes it with one atomic store, and the replaced chain goes to
+    // the reclaimer, so the audio thread never sees a vector being resized.
+    using EffectChain = std::vector<std::shared_ptr<Effect>>;
+    std::unique_ptr<EffectChain> effectsChain;               // control thread
+    std::atomic<const EffectChain*> publishedEffects { nullptr };
+    RealtimeReclaimer* reclaimer = nullptr;
     
     double currentSampleRate = 44100.0;
     int currentBlockSize = 512;
     
     int nextEffectId = 1;
     
+    // Audio thread only
+    int bypassedEffectCount = 0;
+    
     // Temporary buffers for effects processing
     juce::AudioBuffer<float> effectsBuffer;
     juce::MidiBuffer emptyMidiBuffer;  // For effects that need MIDI input
@@ -137,7 +275,7 @@ private:
     // Helper methods
     // ──────────────────────────────────────────
     void updateVoiceParameters();
-    std::unique_ptr<EffectProcessor> createEffect(EffectType type);
-    void processEffectsChain(juce::AudioBuffer<float>& buffer, int numSamples);
-    void applyVolumeAndPan(juce::AudioBuffer<float>& buffer, int numSamples);
+    void publishEffects(std::unique_ptr<EffectChain> chain);
+    const EffectChain& getPublishedEffects() const { return *publishedEffects.load(std::memory_order_acquire); }
+    bool processEffectsChain(juce::AudioBuffer<float>& buffer, int numSamples, bool hasInput);
 };
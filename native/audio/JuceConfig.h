@@ -72,10 +72,21 @@
  #define   JUCE_STRICT_REFCOUNTEDPOINTER 1
 #endif
 
+// Left off: RealtimeSafetyHooks.cpp replaces operator new/delete itself
 #ifndef    JUCE_ENABLE_ALLOCATION_HOOKS
  //#define JUCE_ENABLE_ALLOCATION_HOOKS 0
 #endif
 
+// Record allocations, frees and locks on the audio thread (RealtimeSafety.h).
+// On in debug builds; the CMake build has an AUDIO_REALTIME_CHECKS option.
+#ifndef    AUDIO_REALTIME_CHECKS
+ #if defined (DEBUG) || defined (_DEBUG)
+  #define  AUDIO_REALTIME_CHECKS 1
+ #else
+  #define  AUDIO_REALTIME_CHECKS 0
+ #endif
+#endif
+
 #define JUCE_DECLARE_COMPILATION_TIME 1
 
 //==============================================================================
@@ -0,0 +1,194 @@
+#include "LookaheadLimiter.h"
+#include <numeric>
+
+void LookaheadLimiter::prepare(double sampleRate, int maximumBlockSize, int channels)
+{
+    currentSampleRate = sampleRate;
+    maxBlockSize = juce::jmax(1, maximumBlockSize);
+    numChannels = juce::jmax(1, channels);
+
+    lookaheadSamples = juce::jmax(1, juce::roundToInt(lookaheadMs * 0.001 * sampleRate));
+
+    // A requirement seen at step n applies to input n - detectorLatency, and
+    // the min + average pipeline has fully ramped lookaheadSamples - 1 later
+    delaySamples = lookaheadSamples + detectorLatency - 1;
+
+    history.assign(static_cast<size_t>(numChannels), {});
+    peaks.assign(static_cast<size_t>(maxBlockSize), 0.0f);
+    channelPeaks.assign(static_cast<size_t>(maxBlockSize), 0.0f);
+    gains.assign(static_cast<size_t>(maxBlockSize), 1.0f);
+
+    minQueueValues.assign(static_cast<size_t>(lookaheadSamples + 1), 1.0f);
+    minQueueIndices.assign(static_cast<size_t>(lookaheadSamples + 1), 0);
+    averageWindow.assign(static_cast<size_t>(lookaheadSamples), 1.0f);
+
+    delayBuffer.setSize(numChannels, delaySamples + maxBlockSize);
+
+    setReleaseMs(100.0f);
+    reset();
+}
+
+void LookaheadLimiter::reset()
+{
+    for (auto& channelHistory : history)
+        channelHistory.fill(0.0f);
+
+    minQueueHead = 0;
+    minQueueSize = 0;
+    sampleIndex = 0;
+    releasedGain = 1.0f;
+
+    std::fill(averageWindow.begin(), averageWindow.end(), 1.0f);
+    averagePosition = 0;
+    averageSum = static_cast<double>(averageWindow.size());
+
+    delayBuffer.clear();
+    delayWritePosition = 0;
+    lastGainReductionDb = 0.0f;
+}
+
+void LookaheadLimiter::setCeilingDecibels(float ceilingDb)
+{
+    ceiling = juce::Decibels::decibelsToGain(juce::jlimit(-24.0f, 0.0f, ceilingDb));
+}
+
+void LookaheadLimiter::setReleaseMs(float releaseMs)
+{
+    const auto seconds = juce::jmax(1.0f, releaseMs) * 0.001;
+    releaseCoefficient = static_cast<float>(std::exp(-1.0 / (seconds * currentSampleRate)));
+}
+
+void LookaheadLimiter::process(const juce::dsp::AudioBlock<float>& block)
+{
+    const auto numSamples = static_cast<int>(block.getNumSamples());
+    jassert(numSamples <= maxBlockSize);
+    jassert(static_cast<int>(block.getNumChannels()) <= numChannels);
+
+    detectPeaks(block, numSamples);
+    computeGains(numSamples);
+    applyDelayAndGain(block, numSamples);
+}
+
+void LookaheadLimiter::detectPeaks(const juce::dsp::AudioBlock<float>& block, int numSamples)
+{
+    std::fill(peaks.begin(), peaks.begin() + numSamples, 0.0f);
+
+    for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+    {
+        const auto* input = block.getChannelPointer(channel);
+        auto& h = history[channel];
+
+        // y0..y3 slide along the input; the segment checked is y1 -> y2
+        float y0 = h[0], y1 = h[1], y2 = h[2];
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float y3 = input[i];
+
+            const float c1 = 0.5f * (y2 - y0);
+            const float c2 = y0 - 2.5f * y1 + 2.0f * y2 - 0.5f * y3;
+            const float c3 = 0.5f * (y3 - y0) + 1.5f * (y1 - y2);
+
+            const auto at = [&](float t) { return ((c3 * t + c2) * t + c1) * t + y1; };
+
+            channelPeaks[static_cast<size_t>(i)] = juce::jmax(std::abs(y1),
+                                                              juce::jmax(std::abs(at(0.25f)), std::abs(at(0.5f)), std::abs(at(0.75f))));
+            y0 = y1;
+            y1 = y2;
+            y2 = y3;
+        }
+
+        h = { y0, y1, y2 };
+        juce::FloatVectorOperations::max(peaks.data(), peaks.data(), channelPeaks.data(), numSamples);
+    }
+}
+
+void LookaheadLimiter::computeGains(int numSamples)
+{
+    const auto queueCapacity = static_cast<int>(minQueueValues.size());
+    const auto windowLength = static_cast<double>(lookaheadSamples);
+    float minGain = 1.0f;
+
+    for (int i = 0; i < numSamples; ++i, ++sampleIndex)
+    {
+        const float peak = peaks[static_cast<size_t>(i)];
+        const float required = peak > ceiling ? ceiling / peak : 1.0f;
+
+        // Sliding minimum: drop entries that can no longer be the minimum,
+        // then entries that left the window
+        while (minQueueSize > 0)
+        {
+            const auto back = (minQueueHead + minQueueSize - 1) % queueCapacity;
+            if (minQueueValues[static_cast<size_t>(back)] < required)
+                break;
+            --minQueueSize;
+        }
+
+        const auto slot = (minQueueHead + minQueueSize) % queueCapacity;
+        minQueueValues[static_cast<size_t>(slot)] = required;
+        minQueueIndices[static_cast<size_t>(slot)] = sampleIndex;
+        ++minQueueSize;
+
+        if (minQueueIndices[static_cast<size_t>(minQueueHead)] <= sampleIndex - lookaheadSamples)
+        {
+            minQueueHead = (minQueueHead + 1) % queueCapacity;
+            --minQueueSize;
+        }
+
+        const float held = minQueueValues[static_cast<size_t>(minQueueHead)];
+
+        // Release: follow downwards at once, recover exponentially
+        releasedGain = held < releasedGain ? held : held + releaseCoefficient * (releasedGain - held);
+
+        // Average over the lookahead so the gain ramps down instead of stepping
+        averageSum += releasedGain - averageWindow[static_cast<size_t>(averagePosition)];
+        averageWindow[static_cast<size_t>(averagePosition)] = releasedGain;
+        averagePosition = (averagePosition + 1) % lookaheadSamples;
+
+        // Recompute the running sum once per window so rounding can't accumulate
+        if (averagePosition == 0)
+            averageSum = std::accumulate(averageWindow.begin(), averageWindow.end(), 0.0);
+
+        const auto gain = static_cast<float>(averageSum / windowLength);
+        gains[static_cast<size_t>(i)] = gain;
+        minGain = juce::jmin(minGain, gain);
+    }
+
+    lastGainReductionDb = juce::Decibels::gainToDecibels(minGain, -96.0f);
+}
+
+void LookaheadLimiter::applyDelayAndGain(const juce::dsp::AudioBlock<float>& block, int numSamples)
+{
+    const auto delayLength = delayBuffer.getNumSamples();
+    const auto readPosition = (delayWritePosition + delayLength - delaySamples) % delayLength;
+
+    // Copies in at most two pieces, wrapping around the ring
+    const auto copyRing = [delayLength](float* ring, int position, const float* source, int count)
+    {
+        const auto first = juce::jmin(count, delayLength - position);
+        juce::FloatVectorOperations::copy(ring + position, source, first);
+        juce::FloatVectorOperations::copy(ring, source + first, count - first);
+    };
+
+    const auto readRing = [delayLength](float* destination, const float* ring, int position, int count)
+    {
+        const auto first = juce::jmin(count, delayLength - position);
+        juce::FloatVectorOperations::copy(destination, ring + position, first);
+        juce::FloatVectorOperations::copy(destination + first, ring, count - first);
+    };
+
+    for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+    {
+        auto* samples = block.getChannelPointer(channel);
+        auto* ring = delayBuffer.getWritePointer(static_cast<int>(channel));
+
+        // Write first: with delaySamples < numSamples part of the output is this block's input
+        copyRing(ring, delayWritePosition, samples, numSamples);
+        readRing(samples, ring, readPosition, numSamples);
+
+        juce::FloatVectorOperations::multiply(samples, gains.data(), numSamples);
+        juce::FloatVectorOperations::clip(samples, samples, -ceiling, ceiling, numSamples);
+    }
+
+    delayWritePosition = (delayWritePosition + numSamples) % delayLength;
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include "JuceHeader.h"
+#include <array>
+#include <vector>
+
+/**
+ * LookaheadLimiter - Brickwall peak limiter that sees peaks coming.
+ *
+ * juce::dsp::Limiter reacts after the fact, so transients overshoot before
+ * it catches up. This one delays the audio by the lookahead time and ramps
+ * the gain down over that window, so the gain has already reached its target
+ * when the loudest sample comes out.
+ *
+ * Peaks are measured between samples as well: a Catmull-Rom interpolation
+ * at three points per sample estimates the true peak that a DAC or a
+ * resampler would reconstruct. Anything that still gets past the estimate
+ * is hard-clipped at the ceiling.
+ *
+ * Gain path per sample: required gain -> sliding minimum over the lookahead
+ * -> release smoothing (instant down, exponential up) -> moving average over
+ * the lookahead. The audio is delayed by getLatencySamples().
+ */
+class LookaheadLimiter
+{
+public:
+    static constexpr double lookaheadMs = 1.5;
+
+    /** Allocates everything; call before processing, not on the audio thread. */
+    void prepare(double sampleRate, int maximumBlockSize, int numChannels);
+    void reset();
+
+    void setCeilingDecibels(float ceilingDb);
+    void setReleaseMs(float releaseMs);
+
+    /** Audio thread: limit the block in place. Never allocates. */
+    void process(const juce::dsp::AudioBlock<float>& block);
+
+    int getLatencySamples() const { return delaySamples; }
+
+    /** Deepest gain reduction during the last block, in dB (0 or negative). */
+    float getLastGainReductionDecibels() const { return lastGainReductionDb; }
+
+private:
+    // The detector looks at the segment two samples back, so it needs x[n]
+    static constexpr int detectorLatency = 2;
+    static constexpr int historyLength = 3;
+
+    void detectPeaks(const juce::dsp::AudioBlock<float>& block, int numSamples);
+    void computeGains(int numSamples);
+    void applyDelayAndGain(const juce::dsp::AudioBlock<float>& block, int numSamples);
+
+    double currentSampleRate = 44100.0;
+    int numChannels = 0;
+    int maxBlockSize = 0;
+    int lookaheadSamples = 1;
+    int delaySamples = 0;
+
+    float ceiling = 1.0f;
+    float releaseCoefficient = 0.0f;
+    float lastGainReductionDb = 0.0f;
+
+    // Per channel: the last input samples the detector needs
+    std::vector<std::array<float, historyLength>> history;
+
+    // Per block scratch
+    std::vector<float> peaks;
+    std::vector<float> channelPeaks;
+    std::vector<float> gains;
+
+    // Sliding minimum of required gain (monotonic queue in a ring)
+    std::vector<float> minQueueValues;
+    std::vector<juce::int64> minQueueIndices;
+    int minQueueHead = 0;
+    int minQueueSize = 0;
+    juce::int64 sampleIndex = 0;
+
+    float releasedGain = 1.0f;
+
+    // Moving average over the lookahead
+    std::vector<float> averageWindow;
+    int averagePosition = 0;
+    double averageSum = 0.0;
+
+    // Audio delay line, one ring per channel
+    juce::AudioBuffer<float> delayBuffer;
+    int delayWritePosition = 0;
+};
@@ -0,0 +1,432 @@
+#include "LoopSequencer.h"
+#include <algorithm>
+
+LoopSequencer::LoopSequencer(RealtimeReclaimer& r)
+    : reclaimer(r)
+{
+    for (auto& pattern : patterns)
+        pattern.store(nullptr, std::memory_order_relaxed);
+
+    for (auto& recording : recordings)
+        recording.events.resize(maxRecordedEvents);
+
+    playbackEvents.resize(playbackEventCapacity);
+}
+
+LoopSequencer::~LoopSequencer()
+{
+    // The owning engine has detached the audio callback by now
+    for (auto& pattern : patterns)
+        delete pattern.exchange(nullptr);
+}
+
+// ──────────────────────────────────────────
+// Sequences
+// ──────────────────────────────────────────
+void LoopSequencer::setSequence(int channel, std::vector<Event> events, double durationMs)
+{
+    if (channel < 1 || channel > numChannels)
+        return;
+
+    events.erase(std::remove_if(events.begin(), events.end(),
+                                [](const Event& e) { return e.note < 0 || e.note > 127 || e.timeMs < 0.0; }),
+                 events.end());
+
+    // Note-offs before note-ons at the same timestamp, so retriggers work
+    std::stable_sort(events.begin(), events.end(), [](const Event& a, const Event& b) {
+        if (a.timeMs != b.timeMs)
+            return a.timeMs < b.timeMs;
+        return !a.isNoteOn && b.isNoteOn;
+    });
+
+    auto pattern = std::make_unique<Pattern>();
+    pattern->events = std::move(events);
+    pattern->durationMs = durationMs;
+    pattern->version = nextPatternVersion.fetch_add(1, std::memory_order_relaxed);
+
+    auto* old = patterns[channel - 1].exchange(pattern.release(), std::memory_order_acq_rel);
+    reclaimer.retire(std::unique_ptr<Pattern>(old));
+}
+
+void LoopSequencer::clearSequence(int channel)
+{
+    if (channel < 1 || channel > numChannels)
+        return;
+
+    auto* old = patterns[channel - 1].exchange(nullptr, std::memory_order_acq_rel);
+    reclaimer.retire(std::unique_ptr<Pattern>(old));
+}
+
+bool LoopSequencer::hasSequence(int channel) const
+{
+    if (channel < 1 || channel > numChannels)
+        return false;
+
+    return patterns[channel - 1].load(std::memory_order_acquire) != nullptr;
+}
+
+// ──────────────────────────────────────────
+// Transport
+// ──────────────────────────────────────────
+void LoopSequencer::play()
+{
+    playing.store(true, std::memory_order_relaxed);
+    transportRequest.store(TransportRequest::Play, std::memory_order_release);
+}
+
+void LoopSequencer::stop()
+{
+    playing.store(false, std::memory_order_relaxed);
+    transportRequest.store(TransportRequest::Stop, std::memory_order_release);
+}
+
+double LoopSequencer::getTransportPositionMs() const
+{
+    return samplesToMs(transportPosition.load(std::memory_order_relaxed));
+}
+
+// ──────────────────────────────────────────
+// Recording
+// ──────────────────────────────────────────
+void LoopSequencer::startRecording(int channel)
+{
+    if (channel < 1 || channel > numChannels)
+        return;
+
+    auto& recording = recordings[channel - 1];
+    recording.armed.store(true, std::memory_order_relaxed);
+    recording.request.store(RecordRequest::Start, std::memory_order_release);
+}
+
+std::vector<LoopSequencer::Event> LoopSequencer::stopRecording(int channel)
+{
+    std::vector<Event> result;
+
+    if (channel < 1 || channel > numChannels)
+        return result;
+
+    auto& recording = recordings[channel - 1];
+    if (!recording.armed.exchange(false, std::memory_order_relaxed))
+        return result;
+
+    // Still "Start" means the audio thread never picked the recording up
+    if (recording.request.exchange(RecordRequest::Stop, std::memory_order_acq_rel) == RecordRequest::Start)
+        return result;
+
+    // Everything below count was fully written before count was published
+    const int count = recording.count.load(std::memory_order_acquire);
+    const auto toMs = [&](juce::int64 position) {
+        return samplesToMs(position - recording.startClock) + recording.loopOffsetMs;
+    };
+
+    std::bitset<128> held;
+    result.reserve(static_cast<size_t>(count) + 8);
+
+    for (int i = 0; i < count; ++i)
+    {
+        const auto& recorded = recording.events[static_cast<size_t>(i)];
+        result.push_back({ toMs(recorded.clockPosition), recorded.isNoteOn, recorded.note, recorded.velocity });
+        held.set(recorded.note, recorded.isNoteOn);
+    }
+
+    const auto endMs = toMs(std::max(clockPosition.load(std::memory_order_relaxed), recording.startClock));
+
+    for (int note = 0; note < 128; ++note)
+        if (held.test(static_cast<size_t>(note)))
+            result.push_back({ endMs, false, note, 0.0f });
+
+    return result;
+}
+
+bool LoopSequencer::isRecording(int channel) const
+{
+    if (channel < 1 || channel > numChannels)
+        return false;
+
+    return recordings[channel - 1].armed.load(std::memory_order_relaxed);
+}
+
+int LoopSequencer::readPlaybackEvents(PlaybackEvent* destination, int maxEvents)
+{
+    const auto scope = playbackFifo.read(maxEvents);
+    int numRead = 0;
+
+    scope.forEach([&](int index) { destination[numRead++] = playbackEvents[static_cast<size_t>(index)]; });
+    return numRead;
+}
+
+double LoopSequencer::getHeardTransportPositionMs(juce::uint64 hostTimeNs)
+{
+    TransportAnchor anchor;
+    {
+        const juce::SpinLock::ScopedLockType lock(heardTransportReadLock);
+        anchor = heardTransport.read();
+    }
+
+    if (!anchor.running || anchor.presentationTimeNs == 0)
+        return 0.0;
+
+    const auto sinceHeardMs = (static_cast<double>(hostTimeNs) - static_cast<double>(anchor.presentationTimeNs)) / 1.0e6;
+    return std::max(0.0, samplesToMs(anchor.position) + sinceHeardMs);
+}
+
+// ──────────────────────────────────────────
+// Audio thread
+// ──────────────────────────────────────────
+void LoopSequencer::prepare(double newSampleRate)
+{
+    sampleRate.store(newSampleRate, std::memory_order_relaxed);
+
+    // Loop lengths are cached in samples; make every channel recompute them
+    for (auto& state : channelStates)
+        state.patternVersion = 0;
+}
+
+void LoopSequencer::beginBlock(juce::uint64 presentationTimeNs)
+{
+    blockPresentationNs = presentationTimeNs;
+
+    const auto request = transportRequest.exchange(TransportRequest::None, std::memory_order_acquire);
+
+    if (request != TransportRequest::None)
+    {
+        transportRunning = request == TransportRequest::Play;
+        transportPosition.store(0, std::memory_order_relaxed);
+        releasePending = true;
+    }
+
+    for (auto& recording : recordings)
+    {
+        auto pending = recording.request.load(std::memory_order_acquire);
+
+        if (pending == RecordRequest::Start)
+        {
+            const auto longest = getLongestLoopLength();
+            const auto position = transportPosition.load(std::memory_order_relaxed);
+
+            recording.startClock = clockPosition.load(std::memory_order_relaxed);
+            recording.loopOffsetMs = transportRunning && longest > 0 ? samplesToMs(position % longest) : 0.0;
+            recording.count.store(0, std::memory_order_relaxed);
+            recording.active = true;
+
+            // If stopRecording() got in first, it has already given up on this take
+            if (!recording.request.compare_exchange_strong(pending, RecordRequest::None, std::memory_order_acq_rel))
+                recording.active = false;
+        }
+        else if (pending == RecordRequest::Stop)
+        {
+            recording.active = false;
+            recording.request.compare_exchange_strong(pending, RecordRequest::None, std::memory_order_relaxed);
+        }
+    }
+}
+
+void LoopSequencer::recordLiveEvent(int channel, bool isNoteOn, int note, float velocity, juce::int64 sampleOffset)
+{
+    if (channel < 1 || channel > numChannels)
+        return;
+
+    auto& recording = recordings[channel - 1];
+    if (!recording.active)
+        return;
+
+    const int index = recording.count.load(std::memory_order_relaxed);
+    if (index >= maxRecordedEvents)
+        return;
+
+    const auto position = std::max(recording.startClock, clockPosition.load(std::memory_order_relaxed) + sampleOffset);
+    recording.events[static_cast<size_t>(index)] = { position,
+                                                     isNoteOn,
+                                                     static_cast<uint8_t>(note),
+                                                     velocity };
+    recording.count.store(index + 1, std::memory_order_release);
+}
+
+void LoopSequencer::reportLiveEvent(int channel, bool isNoteOn, int note, float velocity, int sampleOffset)
+{
+    if (channel < 1 || channel > numChannels)
+        return;
+
+    pushPlaybackEvent(isNoteOn ? PlaybackEvent::Type::LiveNoteOn : PlaybackEvent::Type::LiveNoteOff,
+                      channel - 1, note, velocity,
+                      transportPosition.load(std::memory_order_relaxed) + sampleOffset, sampleOffset);
+}
+
+void LoopSequencer::process(std::array<juce::MidiBuffer, numChannels>& midiBuffers, int numSamples)
+{
+    if (releasePending)
+    {
+        for (int index = 0; index < numChannels; ++index)
+        {
+            releaseActiveNotes(index, midiBuffers[static_cast<size_t>(index)], 0);
+            channelStates[static_cast<size_t>(index)].patternVersion = 0;
+        }
+
+        releasePending = false;
+    }
+
+    // Before the position moves on: this block's start is what will be heard at blockPresentationNs
+    auto& anchor = heardTransport.getWriteSlot();
+    anchor = { blockPresentationNs, transportPosition.load(std::memory_order_relaxed), transportRunning };
+    heardTransport.publish();
+
+    if (transportRunning)
+    {
+        const auto blockStart = transportPosition.load(std::memory_order_relaxed);
+
+        for (int index = 0; index < numChannels; ++index)
+        {
+            auto& state = channelStates[static_cast<size_t>(index)];
+            auto& midi = midiBuffers[static_cast<size_t>(index)];
+            const auto* pattern = patterns[static_cast<size_t>(index)].load(std::memory_order_acquire);
+
+            if (pattern == nullptr)
+            {
+                if (state.patternVersion != 0)
+                {
+                    releaseActiveNotes(index, midi, 0);
+                    state.patternVersion = 0;
+                }
+                continue;
+            }
+
+            if (state.patternVersion != pattern->version)
+            {
+                releaseActiveNotes(index, midi, 0);
+                resetChannel(state, pattern, blockStart);
+            }
+
+            if (state.loopLength <= 0)
+                continue;
+
+            const auto& events = pattern->events;
+            int offset = 0;
+            int remaining = numSamples;
+            int eventsPlayed = 0;
+
+            while (remaining > 0)
+            {
+                if (state.loopPosition >= state.loopLength)
+                {
+                    releaseActiveNotes(index, midi, offset);
+                    pushPlaybackEvent(PlaybackEvent::Type::LoopWrap, index, 0, 0.0f, blockStart + offset, offset);
+                    state.loopPosition = 0;
+                    state.cursor = 0;
+                }
+
+                const auto segmentEnd = std::min(state.loopPosition + remaining, state.loopLength);
+
+                while (state.cursor < events.size())
+                {
+                    const auto& event = events[state.cursor];
+                    const auto eventPosition = std::max(msToSamples(event.timeMs), state.loopPosition);
+
+                    if (eventPosition >= segmentEnd)
+                        break;
+
+                    const int eventOffset = offset + static_cast<int>(eventPosition - state.loopPosition);
+
+                    // Keep within the room the engine reserved (see maxEventsPerBlock)
+                    if (eventsPlayed++ >= maxRecordedEvents)
+                    {
+                        ++state.cursor;
+                        continue;
+                    }
+
+                    if (event.isNoteOn)
+                    {
+                        midi.addEvent(juce::MidiMessage::noteOn(1, event.note, event.velocity), eventOffset);
+                        state.activeNotes.set(static_cast<size_t>(event.note));
+                        pushPlaybackEvent(PlaybackEvent::Type::NoteOn, index, event.note, event.velocity,
+                                          blockStart + eventOffset, eventOffset);
+                    }
+                    else
+                    {
+                        midi.addEvent(juce::MidiMessage::noteOff(1, event.note), eventOffset);
+                        state.activeNotes.reset(static_cast<size_t>(event.note));
+                        pushPlaybackEvent(PlaybackEvent::Type::NoteOff, index, event.note, 0.0f,
+                                          blockStart + eventOffset, eventOffset);
+                    }
+
+                    ++state.cursor;
+                }
+
+                const int consumed = static_cast<int>(segmentEnd - state.loopPosition);
+                offset += consumed;
+                remaining -= consumed;
+                state.loopPosition = segmentEnd;
+            }
+        }
+
+        transportPosition.store(blockStart + numSamples, std::memory_order_relaxed);
+    }
+
+    clockPosition.store(clockPosition.load(std::memory_order_relaxed) + numSamples, std::memory_order_relaxed);
+}
+
+// ──────────────────────────────────────────
+// Helpers (audio thread)
+// ──────────────────────────────────────────
+void LoopSequencer::releaseActiveNotes(int channelIndex, juce::MidiBuffer& midi, int sampleOffset)
+{
+    auto& state = channelStates[static_cast<size_t>(channelIndex)];
+    if (state.activeNotes.none())
+        return;
+
+    const auto position = transportPosition.load(std::memory_order_relaxed) + sampleOffset;
+
+    for (int note = 0; note < 128; ++note)
+    {
+        if (!state.activeNotes.test(static_cast<size_t>(note)))
+            continue;
+
+        midi.addEvent(juce::MidiMessage::noteOff(1, note), sampleOffset);
+        pushPlaybackEvent(PlaybackEvent::Type::NoteOff, channelIndex, note, 0.0f, position, sampleOffset);
+    }
+
+    state.activeNotes.reset();
+}
+
+void LoopSequencer::resetChannel(ChannelState& state, const Pattern* pattern, juce::int64 position)
+{
+    state.patternVersion = pattern->version;
+    state.loopLength = msToSamples(pattern->durationMs);
+    state.loopPosition = state.loopLength > 0 ? position % state.loopLength : 0;
+
+    // Join mid-loop: skip whatever already went by
+    const auto loopPosition = state.loopPosition;
+    const auto firstPending = std::partition_point(pattern->events.begin(), pattern->events.end(),
+                                                   [&](const Event& e) { return msToSamples(e.timeMs) < loopPosition; });
+    state.cursor = static_cast<size_t>(std::distance(pattern->events.begin(), firstPending));
+}
+
+void LoopSequencer::pushPlaybackEvent(PlaybackEvent::Type type, int channelIndex, int note, float velocity,
+                                      juce::int64 position, int sampleOffset)
+{
+    const auto presentationTimeNs = blockPresentationNs == 0
+        ? juce::uint64 { 0 }
+        : blockPresentationNs + static_cast<juce::uint64>(sampleOffset * 1.0e9 / getSampleRate());
+
+    // Dropped when the UI isn't draining - nothing audible depends on it
+    const auto scope = playbackFifo.write(1);
+
+    scope.forEach([&](int index) {
+        playbackEvents[static_cast<size_t>(index)] = { type,
+                                                       static_cast<uint8_t>(channelIndex + 1),
+                                                       static_cast<uint8_t>(note),
+                                                       velocity,
+                                                       position,
+                                                       presentationTimeNs };
+    });
+}
+
+juce::int64 LoopSequencer::getLongestLoopLength() const
+{
+    juce::int64 longest = 0;
+
+    for (const auto& slot : patterns)
+        if (const auto* pattern = slot.load(std::memory_order_acquire))
+            longest = std::max(longest, msToSamples(pattern->durationMs));
+
+    return longest;
+}
@@ -0,0 +1,230 @@
+#pragma once
+#include "JuceHeader.h"
+#include "RealtimeReclaimer.h"
+#include "TripleBuffer.h"
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <vector>
+
+/**
+ * LoopSequencer - Audio-thread loop player for per-channel note sequences.
+ *
+ * Each channel gets one immutable Pattern (events + loop length) uploaded in a
+ * single call from the control thread and published through an atomic pointer.
+ * Every block the audio thread walks the patterns against a shared transport
+ * position and writes sample-accurate MIDI into the channel's MidiBuffer.
+ * Loops of different lengths wrap independently, like the old JS transport.
+ *
+ * What was played (live notes included) is reported back through a
+ * lock-free FIFO of PlaybackEvents, each stamped with the host time it
+ * reaches the output, and live notes on armed channels are captured with
+ * audio-clock timestamps, so JS only needs one call per frame to follow along
+ * in step with what is heard.
+ */
+class LoopSequencer
+{
+public:
+    static constexpr int numChannels = 16;
+    static constexpr int maxRecordedEvents = 2048;
+    static constexpr int playbackEventCapacity = 1024;
+
+    // Most events process() adds to one channel's MidiBuffer in a block: up to
+    // maxRecordedEvents from the pattern (a loop shorter than the block that
+    // would play more has the rest skipped), plus a note-off for each note
+    // they or earlier blocks left sounding
+    static constexpr int maxEventsPerBlock = 2 * maxRecordedEvents + 128;
+
+    struct Event
+    {
+        double timeMs = 0.0;    // loop-relative
+        bool isNoteOn = true;
+        int note = 60;
+        float velocity = 0.0f;
+    };
+
+    struct PlaybackEvent
+    {
+        enum class Type : uint8_t
+        {
+            NoteOn,
+            NoteOff,
+            LoopWrap,
+            LiveNoteOn,     // played from the command queue, not a pattern
+            LiveNoteOff
+        };
+
+        Type type = Type::NoteOn;
+        uint8_t channel = 0;    // 1-16
+        uint8_t note = 0;
+        float velocity = 0.0f;
+        juce::int64 transportPosition = 0;  // samples
+        juce::uint64 presentationTimeNs = 0; // when it leaves the speaker (getHostTimeNs clock), 0 = unknown
+    };
+
+    explicit LoopSequencer(RealtimeReclaimer& reclaimer);
+    ~LoopSequencer();
+
+    // ──────────────────────────────────────────
+    // Sequences (control thread)
+    // ──────────────────────────────────────────
+    void setSequence(int channel, std::vector<Event> events, double durationMs);
+    void clearSequence(int channel);
+    bool hasSequence(int channel) const;
+
+    // ──────────────────────────────────────────
+    // Transport (control thread)
+    // ──────────────────────────────────────────
+    void play();
+    void stop();
+    bool isPlaying() const { return playing.load(std::memory_order_relaxed); }
+    double getTransportPositionMs() const;
+
+    // ──────────────────────────────────────────
+    // Recording (control thread)
+    // ──────────────────────────────────────────
+
+    /** Arm a channel: live notes from the next block on are captured. */
+    void startRecording(int channel);
+
+    /**
+     * Disarm a channel and return what was captured. Timestamps are in ms
+     * relative to the start of recording, offset by where the longest loop
+     * was when recording started (so overdubs line up with the loop).
+     * Notes still held (or whose note-off hasn't reached the audio thread yet)
+     * are closed at the current audio clock.
+     */
+    std::vector<Event> stopRecording(int channel);
+    bool isRecording(int channel) const;
+
+    /** Copy out events played since the last call. Returns the number copied. */
+    int readPlaybackEvents(PlaybackEvent* destination, int maxEvents);
+
+    /**
+     * The transport position being heard at hostTimeNs, in ms: the newest
+     * block's position at the moment it reaches the output, moved on by the
+     * time since. 0 while stopped or before the first block is heard.
+     */
+    double getHeardTransportPositionMs(juce::uint64 hostTimeNs);
+
+    // ──────────────────────────────────────────
+    // Audio thread
+    // ──────────────────────────────────────────
+    void prepare(double sampleRate);
+
+    /**
+     * Handle pending transport / record requests. Call before any live events.
+     * presentationTimeNs is when the block's first sample reaches the output
+     * (host time plus output latency), 0 if unknown.
+     */
+    void beginBlock(juce::uint64 presentationTimeNs = 0);
+
+    /**
+     * Capture a live note at the given offset from this block's start. The
+     * offset may fall outside the block for notes stamped with another time
+     * than the one they play at (never earlier than the start of the take).
+     */
+    void recordLiveEvent(int channel, bool isNoteOn, int note, float velocity, juce::int64 sampleOffset);
+
+    /** Report a live note that reached an instrument, for the UI. */
+    void reportLiveEvent(int channel, bool isNoteOn, int note, float velocity, int sampleOffset);
+
+    /** Dispatch this block's sequence events and advance the clocks. */
+    void process(std::array<juce::MidiBuffer, numChannels>& midiBuffers, int numSamples);
+
+private:
+    struct Pattern
+    {
+        std::vector<Event> events;
+        double durationMs = 0.0;
+        juce::uint64 version = 0;
+    };
+
+    // Audio-thread playback state per channel. The pattern pointer is reloaded
+    // every block (it's only safe inside one callback); the version tells us
+    // whether it changed, even if a new pattern reuses the old address.
+    struct ChannelState
+    {
+        juce::uint64 patternVersion = 0;
+        size_t cursor = 0;
+        juce::int64 loopPosition = 0;
+        juce::int64 loopLength = 0;
+        std::bitset<128> activeNotes;
+    };
+
+    enum class RecordRequest
+    {
+        None,
+        Start,
+        Stop
+    };
+
+    struct RecordedEvent
+    {
+        juce::int64 clockPosition = 0;
+        bool isNoteOn = true;
+        uint8_t note = 0;
+        float velocity = 0.0f;
+    };
+
+    struct Recording
+    {
+        std::atomic<bool> armed { false };      // control thread's view
+        std::atomic<RecordRequest> request { RecordRequest::None };
+        bool active = false;                    // audio thread's view
+        juce::int64 startClock = 0;             // published by count's release
+        double loopOffsetMs = 0.0;
+        std::vector<RecordedEvent> events;      // sized once, never reallocated
+        std::atomic<int> count { 0 };
+    };
+
+    enum class TransportRequest
+    {
+        None,
+        Play,
+        Stop
+    };
+
+    double getSampleRate() const { return sampleRate.load(std::memory_order_relaxed); }
+    juce::int64 msToSamples(double ms) const { return static_cast<juce::int64>(ms * getSampleRate() / 1000.0); }
+    double samplesToMs(juce::int64 samples) const { return static_cast<double>(samples) * 1000.0 / getSampleRate(); }
+
+    void releaseActiveNotes(int channelIndex, juce::MidiBuffer& midi, int sampleOffset);
+    void resetChannel(ChannelState& state, const Pattern* pattern, juce::int64 position);
+    void pushPlaybackEvent(PlaybackEvent::Type type, int channelIndex, int note, float velocity,
+                           juce::int64 position, int sampleOffset);
+    juce::int64 getLongestLoopLength() const;
+
+    RealtimeReclaimer& reclaimer;
+
+    std::array<std::atomic<Pattern*>, numChannels> patterns;
+    std::atomic<juce::uint64> nextPatternVersion { 1 };
+    std::array<ChannelState, numChannels> channelStates;
+    std::array<Recording, numChannels> recordings;
+
+    std::atomic<TransportRequest> transportRequest { TransportRequest::None };
+    std::atomic<bool> playing { false };
+    std::atomic<juce::int64> transportPosition { 0 };   // samples since play()
+    std::atomic<juce::int64> clockPosition { 0 };       // samples since the device started
+    bool transportRunning = false;                      // audio thread's view of `playing`
+    bool releasePending = false;                        // flush active notes next process()
+
+    std::atomic<double> sampleRate { 44100.0 };
+
+    juce::AbstractFifo playbackFifo { playbackEventCapacity };
+    std::vector<PlaybackEvent> playbackEvents;
+    juce::uint64 blockPresentationNs = 0;               // audio thread
+
+    // Where the transport was when the newest block reaches the output
+    struct TransportAnchor
+    {
+        juce::uint64 presentationTimeNs = 0;
+        juce::int64 position = 0;
+        bool running = false;
+    };
+
+    TripleBuffer<TransportAnchor> heardTransport;
+    juce::SpinLock heardTransportReadLock;              // TripleBuffer has one reader
+
+    JUCE_DECLARE_NON_COPYABLE(LoopSequencer)
+};
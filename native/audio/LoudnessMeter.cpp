@@ -0,0 +1,309 @@
+#include "LoudnessMeter.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    float gainToDb(float gain)
+    {
+        return juce::Decibels::gainToDecibels(gain, LoudnessMeter::floorDb);
+    }
+}
+
+void LoudnessMeter::prepare(double sampleRate, int maximumBlockSize)
+{
+    currentSampleRate = sampleRate;
+    segmentLength = juce::jmax(1, juce::roundToInt(sampleRate * 0.1));
+    fallbackPerSample = static_cast<float>(fallbackDbPerSecond / sampleRate);
+
+    // K-weighting, BS.1770 stage 1: a +4 dB shelf above ~1.7 kHz (head effects)
+    {
+        const double f0 = 1681.974450955533, gainDb = 3.999843853973347, q = 0.7071752369554196;
+        const auto k = std::tan(juce::MathConstants<double>::pi * f0 / sampleRate);
+        const auto vh = std::pow(10.0, gainDb / 20.0);
+        const auto vb = std::pow(vh, 0.4996667741545416);
+        const auto a0 = 1.0 + k / q + k * k;
+        shelf.b0 = (vh + vb * k / q + k * k) / a0;
+        shelf.b1 = 2.0 * (k * k - vh) / a0;
+        shelf.b2 = (vh - vb * k / q + k * k) / a0;
+        shelf.a1 = 2.0 * (k * k - 1.0) / a0;
+        shelf.a2 = (1.0 - k / q + k * k) / a0;
+    }
+
+    // Stage 2: the RLB high-pass at ~38 Hz
+    {
+        const double f0 = 38.13547087602444, q = 0.5003270373238773;
+        const auto k = std::tan(juce::MathConstants<double>::pi * f0 / sampleRate);
+        const auto a0 = 1.0 + k / q + k * k;
+        highPass.b0 = 1.0;
+        highPass.b1 = -2.0;
+        highPass.b2 = 1.0;
+        highPass.a1 = 2.0 * (k * k - 1.0) / a0;
+        highPass.a2 = (1.0 - k / q + k * k) / a0;
+    }
+
+    // Kaiser-windowed sinc at 4x, centred on a tap so phase 0 is the input
+    constexpr int numTaps = oversampling * tapsPerPhase + 1;
+    constexpr int centre = numTaps / 2;
+    std::array<float, numTaps> window {};
+    juce::dsp::WindowingFunction<float>::fillWindowingTables(window.data(), numTaps,
+                                                              juce::dsp::WindowingFunction<float>::kaiser,
+                                                              false, 6.0f);
+    for (int phase = 1; phase < oversampling; ++phase)
+    {
+        for (int tap = 0; tap < tapsPerPhase; ++tap)
+        {
+            const auto n = tap * oversampling + phase;
+            const auto x = juce::MathConstants<double>::pi * (n - centre) / oversampling;
+            phases[static_cast<size_t>(phase - 1)][static_cast<size_t>(tap)]
+                = static_cast<float>(std::sin(x) / x) * window[static_cast<size_t>(n)];
+        }
+    }
+
+    for (auto& channel : channels)
+        channel.history.assign(static_cast<size_t>(historyLength + juce::jmax(1, maximumBlockSize)), 0.0f);
+    phaseOutput.assign(static_cast<size_t>(juce::jmax(1, maximumBlockSize)), 0.0f);
+
+    reset();
+}
+
+void LoudnessMeter::reset()
+{
+    for (auto& channel : channels)
+    {
+        channel.shelfState.fill(0.0);
+        channel.highPassState.fill(0.0);
+        std::fill(channel.history.begin(), channel.history.end(), 0.0f);
+    }
+    isSilent = true;
+
+    segmentWeighted = 0.0;
+    segmentSquares = 0.0;
+    segmentSamples = 0;
+    weightedSegments.fill(0.0);
+    squareSegments.fill(0.0);
+    segmentPosition = 0;
+    segmentsFilled = 0;
+
+    readings = {};
+    resetIntegrated();
+}
+
+void LoudnessMeter::resetIntegrated()
+{
+    histogramCounts.fill(0);
+    histogramEnergy.fill(0.0);
+    readings.integratedLufs = floorDb;
+    readings.maxTruePeakDb = floorDb;
+}
+
+// ──────────────────────────────────────────
+// Measuring
+// ──────────────────────────────────────────
+
+void LoudnessMeter::process(const juce::AudioBuffer<float>& buffer, int numSamples)
+{
+    const auto numChannels = juce::jmin(buffer.getNumChannels(), maxChannels);
+    if (numChannels == 0 || numSamples <= 0)
+    {
+        processSilence(numSamples);
+        return;
+    }
+    jassert(static_cast<size_t>(numSamples) <= phaseOutput.size());
+    isSilent = false;
+
+    float peak = 0.0f;
+    for (int ch = 0; ch < numChannels; ++ch)
+        peak = juce::jmax(peak, buffer.getMagnitude(ch, 0, numSamples));
+
+    float truePeak = peak;
+    for (int ch = 0; ch < numChannels; ++ch)
+        truePeak = juce::jmax(truePeak, measureTruePeak(channels[static_cast<size_t>(ch)], buffer.getReadPointer(ch), numSamples));
+
+    fallBack(numSamples);
+    readings.peakDb = juce::jmax(readings.peakDb, gainToDb(peak));
+    readings.truePeakDb = juce::jmax(readings.truePeakDb, gainToDb(truePeak));
+    readings.maxTruePeakDb = juce::jmax(readings.maxTruePeakDb, readings.truePeakDb);
+
+    // Loudness, split where 100 ms segments end
+    for (int offset = 0; offset < numSamples;)
+    {
+        const auto count = juce::jmin(numSamples - offset, segmentLength - segmentSamples);
+        accumulate(buffer, numChannels, offset, count);
+        offset += count;
+        segmentSamples += count;
+        if (segmentSamples == segmentLength)
+            finishSegment();
+    }
+}
+
+void LoudnessMeter::processSilence(int numSamples)
+{
+    // Whatever the filters and interpolator held has gone by now
+    if (!isSilent)
+    {
+        for (auto& channel : channels)
+        {
+            channel.shelfState.fill(0.0);
+            channel.highPassState.fill(0.0);
+            std::fill(channel.history.begin(), channel.history.begin() + historyLength, 0.0f);
+        }
+        isSilent = true;
+    }
+
+    fallBack(numSamples);
+
+    while (numSamples > 0)
+    {
+        const auto count = juce::jmin(numSamples, segmentLength - segmentSamples);
+        numSamples -= count;
+        segmentSamples += count;
+        if (segmentSamples == segmentLength)
+            finishSegment();
+    }
+}
+
+float LoudnessMeter::measureTruePeak(ChannelState& channel, const float* input, int numSamples)
+{
+    // history holds the previous block's last inputs, then this block
+    auto* samples = channel.history.data();
+    juce::FloatVectorOperations::copy(samples + historyLength, input, numSamples);
+
+    float peak = 0.0f;
+    auto* output = phaseOutput.data();
+    for (const auto& taps : phases)
+    {
+        // output[m] = sum over k of taps[k] * input[m - k]
+        juce::FloatVectorOperations::copyWithMultiply(output, samples + historyLength, taps[0], numSamples);
+        for (int tap = 1; tap < tapsPerPhase; ++tap)
+            juce::FloatVectorOperations::addWithMultiply(output, samples + historyLength - tap, taps[static_cast<size_t>(tap)], numSamples);
+
+        const auto range = juce::FloatVectorOperations::findMinAndMax(output, numSamples);
+        peak = juce::jmax(peak, -range.getStart(), range.getEnd());
+    }
+
+    std::copy(samples + numSamples, samples + numSamples + historyLength, samples);
+    return peak;
+}
+
+void LoudnessMeter::accumulate(const juce::AudioBuffer<float>& buffer, int numChannels, int offset, int numSamples)
+{
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto& channel = channels[static_cast<size_t>(ch)];
+        const auto* input = buffer.getReadPointer(ch, offset);
+
+        // Both biquads in transposed direct form II, in double so the 38 Hz
+        // high-pass stays accurate at high sample rates
+        auto s1 = channel.shelfState[0], s2 = channel.shelfState[1];
+        auto h1 = channel.highPassState[0], h2 = channel.highPassState[1];
+        double weighted = 0.0;
+        double squares = 0.0;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const double x = input[i];
+            const auto shelved = shelf.b0 * x + s1;
+            s1 = shelf.b1 * x - shelf.a1 * shelved + s2;
+            s2 = shelf.b2 * x - shelf.a2 * shelved;
+
+            const auto y = highPass.b0 * shelved + h1;
+            h1 = highPass.b1 * shelved - highPass.a1 * y + h2;
+            h2 = highPass.b2 * shelved - highPass.a2 * y;
+
+            weighted += y * y;
+            squares += x * x;
+        }
+
+        channel.shelfState = { s1, s2 };
+        channel.highPassState = { h1, h2 };
+
+        // BS.1770 sums the channels (left and right weigh 1); RMS averages them
+        segmentWeighted += weighted;
+        segmentSquares += squares / numChannels;
+    }
+}
+
+void LoudnessMeter::finishSegment()
+{
+    weightedSegments[static_cast<size_t>(segmentPosition)] = segmentWeighted / segmentLength;
+    squareSegments[static_cast<size_t>(segmentPosition)] = segmentSquares / segmentLength;
+    segmentPosition = (segmentPosition + 1) % numSegments;
+    segmentsFilled = juce::jmin(segmentsFilled + 1, numSegments);
+    segmentWeighted = 0.0;
+    segmentSquares = 0.0;
+    segmentSamples = 0;
+
+    // Mean of the newest count segments (fewer right after a reset)
+    const auto mean = [this](const std::array<double, numSegments>& segments, int count)
+    {
+        count = juce::jmin(count, segmentsFilled);
+        double sum = 0.0;
+        for (int i = 1; i <= count; ++i)
+            sum += segments[static_cast<size_t>((segmentPosition - i + numSegments) % numSegments)];
+        return sum / count;
+    };
+
+    const auto momentary = mean(weightedSegments, segmentsPerMomentary);
+    readings.momentaryLufs = energyToLufs(momentary);
+    readings.shortTermLufs = energyToLufs(mean(weightedSegments, numSegments));
+    readings.rmsDb = gainToDb(static_cast<float>(std::sqrt(mean(squareSegments, segmentsPerRms))));
+
+    if (segmentsFilled >= segmentsPerMomentary)
+    {
+        addGatingBlock(momentary);
+        readings.integratedLufs = energyToLufs(computeIntegratedEnergy());
+    }
+}
+
+void LoudnessMeter::addGatingBlock(double energy)
+{
+    const auto loudness = energyToLufs(energy);
+    if (loudness <= histogramFloorLufs)
+        return;
+
+    const auto bin = juce::jlimit(0, numHistogramBins - 1,
+                                  static_cast<int>((loudness - histogramFloorLufs) * histogramBinsPerLu));
+    ++histogramCounts[static_cast<size_t>(bin)];
+    histogramEnergy[static_cast<size_t>(bin)] += energy;
+}
+
+double LoudnessMeter::computeIntegratedEnergy() const
+{
+    juce::uint64 count = 0;
+    double energy = 0.0;
+    for (int bin = 0; bin < numHistogramBins; ++bin)
+    {
+        count += histogramCounts[static_cast<size_t>(bin)];
+        energy += histogramEnergy[static_cast<size_t>(bin)];
+    }
+    if (count == 0)
+        return 0.0;
+
+    // Relative gate: 10 LU below the loudness of everything above -70
+    const auto gate = energyToLufs(energy / static_cast<double>(count)) - 10.0f;
+    const auto firstBin = juce::jlimit(0, numHistogramBins,
+                                       static_cast<int>((gate - histogramFloorLufs) * histogramBinsPerLu));
+    count = 0;
+    energy = 0.0;
+    for (int bin = firstBin; bin < numHistogramBins; ++bin)
+    {
+        count += histogramCounts[static_cast<size_t>(bin)];
+        energy += histogramEnergy[static_cast<size_t>(bin)];
+    }
+    return count > 0 ? energy / static_cast<double>(count) : 0.0;
+}
+
+void LoudnessMeter::fallBack(int numSamples)
+{
+    const auto drop = fallbackPerSample * static_cast<float>(numSamples);
+    readings.peakDb = juce::jmax(floorDb, readings.peakDb - drop);
+    readings.truePeakDb = juce::jmax(floorDb, readings.truePeakDb - drop);
+}
+
+float LoudnessMeter::energyToLufs(double energy)
+{
+    if (energy <= 0.0)
+        return floorDb;
+    return juce::jmax(floorDb, static_cast<float>(-0.691 + 10.0 * std::log10(energy)));
+}
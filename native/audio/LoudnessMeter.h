@@ -0,0 +1,116 @@
+#pragma once
+#include "JuceHeader.h"
+#include "TripleBuffer.h"
+#include <array>
+#include <atomic>
+#include <vector>
+
+/**
+ * LoudnessMeter - Peak, RMS, loudness and true peak of a stereo signal,
+ * measured on the audio thread.
+ *
+ * Loudness follows ITU-R BS.1770 / EBU R128: the signal is K-weighted (a
+ * high shelf and a high-pass), and its mean square is kept per 100 ms
+ * segment. Momentary loudness covers the last 4 segments, short-term the
+ * last 30. Integrated loudness gates the 400 ms blocks (one every 100 ms) at
+ * -70 LUFS and then 10 LU below their mean; blocks go into a histogram of
+ * 0.1 LU bins, so it costs the same after an hour as after a second.
+ *
+ * True peak is the peak of the signal upsampled 4x by a 49-tap windowed-sinc
+ * interpolator. Its phase 0 is the input itself, so only the three in-between
+ * phases are computed, each as 12 FloatVectorOperations passes over the block.
+ *
+ * Peak and true peak fall back at fallbackDbPerSecond; the other readings
+ * update every 100 ms. Everything except prepare() is for the thread that
+ * measures and never allocates.
+ */
+class LoudnessMeter
+{
+public:
+    static constexpr float floorDb = -120.0f;
+    static constexpr float fallbackDbPerSecond = 20.0f;
+
+    struct Readings
+    {
+        float peakDb = floorDb;            // sample peak
+        float truePeakDb = floorDb;        // 4x oversampled peak
+        float maxTruePeakDb = floorDb;     // highest true peak since resetIntegrated()
+        float rmsDb = floorDb;             // last 300 ms, unweighted
+        float momentaryLufs = floorDb;     // last 400 ms
+        float shortTermLufs = floorDb;     // last 3 s
+        float integratedLufs = floorDb;    // gated, since resetIntegrated()
+    };
+
+    /** Allocates; not on the audio thread. */
+    void prepare(double sampleRate, int maximumBlockSize);
+    void reset();
+
+    /** Start integrated loudness and the true-peak maximum over. */
+    void resetIntegrated();
+
+    /** Measure the first two channels of the block (one for mono). */
+    void process(const juce::AudioBuffer<float>& buffer, int numSamples);
+
+    /** Account for a block of silence without looking at any samples. */
+    void processSilence(int numSamples);
+
+    const Readings& getReadings() const { return readings; }
+
+private:
+    static constexpr int maxChannels = 2;
+    static constexpr int oversampling = 4;
+    static constexpr int tapsPerPhase = 12;
+    static constexpr int historyLength = tapsPerPhase - 1;
+    static constexpr int segmentsPerMomentary = 4;
+    static constexpr int segmentsPerRms = 3;
+    static constexpr int numSegments = 30;     // short-term window
+    static constexpr float histogramFloorLufs = -70.0f;
+    static constexpr int histogramBinsPerLu = 10;
+    static constexpr int numHistogramBins = 80 * histogramBinsPerLu;  // -70 to +10 LUFS
+
+    struct Biquad
+    {
+        double b0 = 1.0, b1 = 0.0, b2 = 0.0, a1 = 0.0, a2 = 0.0;
+    };
+
+    struct ChannelState
+    {
+        std::array<double, 2> shelfState {};
+        std::array<double, 2> highPassState {};
+        std::vector<float> history;  // last historyLength inputs, then the block
+    };
+
+    float measureTruePeak(ChannelState& channel, const float* input, int numSamples);
+    void accumulate(const juce::AudioBuffer<float>& buffer, int numChannels, int offset, int numSamples);
+    void finishSegment();
+    void addGatingBlock(double energy);
+    double computeIntegratedEnergy() const;
+    void fallBack(int numSamples);
+    static float energyToLufs(double energy);
+
+    double currentSampleRate = 44100.0;
+    int segmentLength = 4410;
+
+    Biquad shelf, highPass;
+    std::array<std::array<float, tapsPerPhase>, oversampling - 1> phases {};
+    std::array<ChannelState, maxChannels> channels;
+    std::vector<float> phaseOutput;
+    bool isSilent = true;  // filter and interpolator state is all zero
+
+    // Current 100 ms segment, and the finished ones (mean squares, newest at
+    // segmentPosition - 1)
+    double segmentWeighted = 0.0;
+    double segmentSquares = 0.0;
+    int segmentSamples = 0;
+    std::array<double, numSegments> weightedSegments {};
+    std::array<double, numSegments> squareSegments {};
+    int segmentPosition = 0;
+    int segmentsFilled = 0;
+
+    // Gating blocks above the absolute gate
+    std::array<juce::uint32, numHistogramBins> histogramCounts {};
+    std::array<double, numHistogramBins> histogramEnergy {};
+
+    float fallbackPerSample = 0.0f;
+    Readings readings;
+};
@@ -0,0 +1,251 @@
+#include "MasterBus.h"
+
+namespace
+{
+    constexpr float defaultEqFrequencies[MasterBus::numEqBands] = { 100.0f, 1000.0f, 8000.0f };
+}
+
+MasterBus::MasterBus()
+{
+    for (int band = 0; band < numEqBands; ++band)
+        eqSettings[static_cast<size_t>(band)].frequency.store(defaultEqFrequencies[band], std::memory_order_relaxed);
+}
+
+void MasterBus::prepare(double sampleRate, int maximumBlockSize, int channels)
+{
+    currentSampleRate = sampleRate;
+    numChannels = juce::jmax(1, channels);
+
+    const juce::dsp::ProcessSpec spec { sampleRate,
+                                        static_cast<juce::uint32>(juce::jmax(1, maximumBlockSize)),
+                                        static_cast<juce::uint32>(numChannels) };
+
+    // Start at the target gain rather than ramping up from silence
+    inputGain.setTargetValue(gain.load(std::memory_order_relaxed));
+    inputGain.prepare(sampleRate, maximumBlockSize);
+
+    // Allocate coefficient storage here so later updates only overwrite it
+    for (int band = 0; band < numEqBands; ++band)
+    {
+        auto& filter = eqFilters[static_cast<size_t>(band)];
+        filter.prepare(spec);
+        updateEqCoefficients(band);
+        filter.reset();
+    }
+
+    compressor.prepare(spec);
+    makeupGain.prepare(sampleRate, maximumBlockSize);
+
+    limiter.prepare(sampleRate, maximumBlockSize, numChannels);
+
+    appliedVersion = 0;
+    applySettings();
+    makeupGain.snapToTarget();
+    prepared = true;
+}
+
+void MasterBus::process(const juce::dsp::AudioBlock<float>& fullBlock)
+{
+    if (!prepared)
+        return;
+
+    const auto channelsToProcess = juce::jmin(fullBlock.getNumChannels(), static_cast<size_t>(numChannels));
+    auto block = fullBlock.getSubsetChannelBlock(0, channelsToProcess);
+    juce::dsp::ProcessContextReplacing<float> context(block);
+
+    if (settingsVersion.load(std::memory_order_acquire) != appliedVersion)
+        applySettings();
+
+    inputGain.setTargetValue(gain.load(std::memory_order_relaxed));
+    inputGain.process(block);
+
+    if (eqActive)
+    {
+        for (auto& filter : eqFilters)
+            filter.process(context);
+    }
+
+    if (compressorActive)
+    {
+        compressor.process(context);
+        makeupGain.process(block);
+    }
+
+    if (limiterActive)
+    {
+        limiter.process(block);
+        limiterGainReductionDb.store(limiter.getLastGainReductionDecibels(), std::memory_order_relaxed);
+    }
+}
+
+// ──────────────────────────────────────────
+// Settings
+// ──────────────────────────────────────────
+
+void MasterBus::setGain(float newGain)
+{
+    gain.store(juce::jlimit(0.0f, 2.0f, newGain), std::memory_order_relaxed);
+}
+
+void MasterBus::setEqBand(EqBand band, float frequencyHz, float gainDb, float q)
+{
+    auto& settings = eqSettings[static_cast<size_t>(band)];
+    settings.frequency.store(juce::jlimit(20.0f, 20000.0f, frequencyHz), std::memory_order_relaxed);
+    settings.gainDb.store(juce::jlimit(-24.0f, 24.0f, gainDb), std::memory_order_relaxed);
+    settings.q.store(juce::jlimit(0.1f, 10.0f, q), std::memory_order_relaxed);
+    settingsVersion.fetch_add(1, std::memory_order_release);
+}
+
+void MasterBus::setEqEnabled(bool enabled)
+{
+    eqEnabled.store(enabled, std::memory_order_relaxed);
+    settingsVersion.fetch_add(1, std::memory_order_release);
+}
+
+void MasterBus::setCompressor(float thresholdDb, float ratio, float attackMs, float releaseMs, float makeupDb)
+{
+    compressorThresholdDb.store(juce::jlimit(-60.0f, 0.0f, thresholdDb), std::memory_order_relaxed);
+    compressorRatio.store(juce::jlimit(1.0f, 20.0f, ratio), std::memory_order_relaxed);
+    compressorAttackMs.store(juce::jlimit(0.1f, 200.0f, attackMs), std::memory_order_relaxed);
+    compressorReleaseMs.store(juce::jlimit(1.0f, 2000.0f, releaseMs), std::memory_order_relaxed);
+    compressorMakeupDb.store(juce::jlimit(0.0f, 24.0f, makeupDb), std::memory_order_relaxed);
+    settingsVersion.fetch_add(1, std::memory_order_release);
+}
+
+void MasterBus::setCompressorEnabled(bool enabled)
+{
+    compressorEnabled.store(enabled, std::memory_order_relaxed);
+    settingsVersion.fetch_add(1, std::memory_order_release);
+}
+
+void MasterBus::setLimiter(float ceilingDb, float releaseMs)
+{
+    limiterCeilingDb.store(juce::jlimit(-24.0f, 0.0f, ceilingDb), std::memory_order_relaxed);
+    limiterReleaseMs.store(juce::jlimit(1.0f, 2000.0f, releaseMs), std::memory_order_relaxed);
+    settingsVersion.fetch_add(1, std::memory_order_release);
+}
+
+void MasterBus::setLimiterEnabled(bool enabled)
+{
+    limiterEnabled.store(enabled, std::memory_order_relaxed);
+    settingsVersion.fetch_add(1, std::memory_order_release);
+}
+
+MasterBus::Settings MasterBus::getSettings() const
+{
+    Settings settings;
+    settings.gain = gain.load(std::memory_order_relaxed);
+
+    for (size_t band = 0; band < settings.eq.size(); ++band)
+    {
+        settings.eq[band].frequency = eqSettings[band].frequency.load(std::memory_order_relaxed);
+        settings.eq[band].gainDb = eqSettings[band].gainDb.load(std::memory_order_relaxed);
+        settings.eq[band].q = eqSettings[band].q.load(std::memory_order_relaxed);
+    }
+
+    settings.eqEnabled = eqEnabled.load(std::memory_order_relaxed);
+    settings.compressorThresholdDb = compressorThresholdDb.load(std::memory_order_relaxed);
+    settings.compressorRatio = compressorRatio.load(std::memory_order_relaxed);
+    settings.compressorAttackMs = compressorAttackMs.load(std::memory_order_relaxed);
+    settings.compressorReleaseMs = compressorReleaseMs.load(std::memory_order_relaxed);
+    settings.compressorMakeupDb = compressorMakeupDb.load(std::memory_order_relaxed);
+    settings.compressorEnabled = compressorEnabled.load(std::memory_order_relaxed);
+    settings.limiterCeilingDb = limiterCeilingDb.load(std::memory_order_relaxed);
+    settings.limiterReleaseMs = limiterReleaseMs.load(std::memory_order_relaxed);
+    settings.limiterEnabled = limiterEnabled.load(std::memory_order_relaxed);
+    return settings;
+}
+
+void MasterBus::setSettings(const Settings& settings)
+{
+    setGain(settings.gain);
+
+    for (int band = 0; band < numEqBands; ++band)
+    {
+        const auto& eq = settings.eq[static_cast<size_t>(band)];
+        setEqBand(static_cast<EqBand>(band), eq.frequency, eq.gainDb, eq.q);
+    }
+
+    setEqEnabled(settings.eqEnabled);
+    setCompressor(settings.compressorThresholdDb, settings.compressorRatio,
+                  settings.compressorAttackMs, settings.compressorReleaseMs,
+                  settings.compressorMakeupDb);
+    setCompressorEnabled(settings.compressorEnabled);
+    setLimiter(settings.limiterCeilingDb, settings.limiterReleaseMs);
+    setLimiterEnabled(settings.limiterEnabled);
+}
+
+// ──────────────────────────────────────────
+// Audio thread
+// ──────────────────────────────────────────
+
+void MasterBus::applySettings()
+{
+    appliedVersion = settingsVersion.load(std::memory_order_acquire);
+
+    for (int band = 0; band < numEqBands; ++band)
+        updateEqCoefficients(band);
+
+    compressor.setThreshold(compressorThresholdDb.load(std::memory_order_relaxed));
+    compressor.setRatio(compressorRatio.load(std::memory_order_relaxed));
+    compressor.setAttack(compressorAttackMs.load(std::memory_order_relaxed));
+    compressor.setRelease(compressorReleaseMs.load(std::memory_order_relaxed));
+    makeupGain.setTargetValue(juce::Decibels::decibelsToGain(compressorMakeupDb.load(std::memory_order_relaxed)));
+
+    limiter.setCeilingDecibels(limiterCeilingDb.load(std::memory_order_relaxed));
+    limiter.setReleaseMs(limiterReleaseMs.load(std::memory_order_relaxed));
+
+    // A stage switched back on still holds state from before it was switched off
+    const auto eqOn = eqEnabled.load(std::memory_order_relaxed);
+    if (eqOn && !eqActive)
+    {
+        for (auto& filter : eqFilters)
+            filter.reset();
+    }
+    eqActive = eqOn;
+
+    const auto compressorOn = compressorEnabled.load(std::memory_order_relaxed);
+    if (compressorOn && !compressorActive)
+        compressor.reset();
+    compressorActive = compressorOn;
+
+    const auto limiterOn = limiterEnabled.load(std::memory_order_relaxed);
+    if (limiterOn && !limiterActive)
+        limiter.reset();
+    if (!limiterOn)
+        limiterGainReductionDb.store(0.0f, std::memory_order_relaxed);
+    limiterActive = limiterOn;
+
+    publishLatency();
+}
+
+void MasterBus::updateEqCoefficients(int band)
+{
+    using ArrayCoefficients = juce::dsp::IIR::ArrayCoefficients<float>;
+
+    const auto& settings = eqSettings[static_cast<size_t>(band)];
+    const auto frequency = juce::jmin(settings.frequency.load(std::memory_order_relaxed),
+                                      static_cast<float>(currentSampleRate * 0.45));
+    const auto q = settings.q.load(std::memory_order_relaxed);
+    const auto gainFactor = juce::Decibels::decibelsToGain(settings.gainDb.load(std::memory_order_relaxed));
+
+    // Assigning an array into the existing Coefficients reuses its storage
+    auto& coefficients = *eqFilters[static_cast<size_t>(band)].state;
+    switch (static_cast<EqBand>(band))
+    {
+        case EqBand::LowShelf:
+            coefficients = ArrayCoefficients::makeLowShelf(currentSampleRate, frequency, q, gainFactor);
+            break;
+        case EqBand::Peak:
+            coefficients = ArrayCoefficients::makePeakFilter(currentSampleRate, frequency, q, gainFactor);
+            break;
+        case EqBand::HighShelf:
+            coefficients = ArrayCoefficients::makeHighShelf(currentSampleRate, frequency, q, gainFactor);
+            break;
+    }
+}
+
+void MasterBus::publishLatency()
+{
+    latencySamples.store(limiterActive ? limiter.getLatencySamples() : 0, std::memory_order_relaxed);
+}
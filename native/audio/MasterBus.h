@@ -0,0 +1,143 @@
+#pragma once
+#include "JuceHeader.h"
+#include "LookaheadLimiter.h"
+#include "SmoothedGain.h"
+#include <array>
+#include <atomic>
+
+/**
+ * MasterBus - Insert chain on the summed mix, in this order:
+ *
+ *   gain -> 3-band EQ -> bus compressor -> true-peak lookahead limiter
+ *
+ * Settings are written from any thread into atomics and picked up by the
+ * audio thread at the start of the next block, so process() never waits or
+ * allocates. Everything is sized in prepare(), which AudioEngine calls from
+ * audioDeviceAboutToStart() / prepareToPlay().
+ *
+ * The limiter is on by default (ceiling -1 dBTP) and delays the mix by
+ * getLatencySamples(); EQ and compressor start bypassed.
+ */
+class MasterBus
+{
+public:
+    enum class EqBand
+    {
+        LowShelf = 0,
+        Peak,
+        HighShelf
+    };
+    static constexpr int numEqBands = 3;
+
+    /** Everything the setters control, for saving and restoring a session. */
+    struct Settings
+    {
+        struct Band
+        {
+            float frequency = 1000.0f;
+            float gainDb = 0.0f;
+            float q = 0.707f;
+        };
+
+        float gain = 1.0f;
+        std::array<Band, numEqBands> eq {};
+        bool eqEnabled = false;
+        float compressorThresholdDb = -12.0f;
+        float compressorRatio = 2.0f;
+        float compressorAttackMs = 10.0f;
+        float compressorReleaseMs = 100.0f;
+        float compressorMakeupDb = 0.0f;
+        bool compressorEnabled = false;
+        float limiterCeilingDb = -1.0f;
+        float limiterReleaseMs = 100.0f;
+        bool limiterEnabled = true;
+    };
+
+    MasterBus();
+
+    /** Not on the audio thread. */
+    void prepare(double sampleRate, int maximumBlockSize, int numChannels);
+
+    /** Audio thread: process the first numChannels channels of the block in place. */
+    void process(const juce::dsp::AudioBlock<float>& block);
+
+    // ──────────────────────────────────────────
+    // Settings (any thread)
+    // ──────────────────────────────────────────
+    void setGain(float gain);
+    float getGain() const { return gain.load(std::memory_order_relaxed); }
+
+    void setEqBand(EqBand band, float frequencyHz, float gainDb, float q);
+    void setEqEnabled(bool enabled);
+
+    void setCompressor(float thresholdDb, float ratio, float attackMs, float releaseMs, float makeupDb);
+    void setCompressorEnabled(bool enabled);
+
+    void setLimiter(float ceilingDb, float releaseMs);
+    void setLimiterEnabled(bool enabled);
+
+    Settings getSettings() const;
+    void setSettings(const Settings& settings);
+
+    // ──────────────────────────────────────────
+    // Reporting (any thread)
+    // ──────────────────────────────────────────
+
+    /** How far the output lags the mix: the limiter's lookahead, or 0 when it's off. */
+    int getLatencySamples() const { return latencySamples.load(std::memory_order_relaxed); }
+
+    /** Deepest limiter gain reduction in the last block, in dB (0 or negative). */
+    float getLimiterGainReductionDb() const { return limiterGainReductionDb.load(std::memory_order_relaxed); }
+
+private:
+    struct EqBandSettings
+    {
+        std::atomic<float> frequency;
+        std::atomic<float> gainDb { 0.0f };
+        std::atomic<float> q { 0.707f };
+    };
+
+    using StereoFilter = juce::dsp::ProcessorDuplicator<juce::dsp::IIR::Filter<float>,
+                                                        juce::dsp::IIR::Coefficients<float>>;
+
+    // Audio thread: copy changed settings into the processors
+    void applySettings();
+    void updateEqCoefficients(int band);
+    void publishLatency();
+
+    // Written by setters, read at block start
+    std::atomic<float> gain { 1.0f };
+    std::array<EqBandSettings, numEqBands> eqSettings;
+    std::atomic<bool> eqEnabled { false };
+    std::atomic<float> compressorThresholdDb { -12.0f };
+    std::atomic<float> compressorRatio { 2.0f };
+    std::atomic<float> compressorAttackMs { 10.0f };
+    std::atomic<float> compressorReleaseMs { 100.0f };
+    std::atomic<float> compressorMakeupDb { 0.0f };
+    std::atomic<bool> compressorEnabled { false };
+    std::atomic<float> limiterCeilingDb { -1.0f };
+    std::atomic<float> limiterReleaseMs { 100.0f };
+    std::atomic<bool> limiterEnabled { true };
+
+    // Bumped by every setter except setGain(); the audio thread compares it
+    // with the version it last applied
+    std::atomic<juce::uint32> settingsVersion { 1 };
+    juce::uint32 appliedVersion = 0;
+
+    // Audio thread state
+    double currentSampleRate = 44100.0;
+    int numChannels = 2;
+    bool prepared = false;
+    bool eqActive = false;
+    bool compressorActive = false;
+    bool limiterActive = true;
+
+    SmoothedGain inputGain;
+    std::array<StereoFilter, numEqBands> eqFilters;
+    juce::dsp::Compressor<float> compressor;
+    SmoothedGain makeupGain;
+    LookaheadLimiter limiter;
+
+    std::atomic<int> latencySamples { 0 };
+    std::atomic<float> limiterGainReductionDb { 0.0f };
+};
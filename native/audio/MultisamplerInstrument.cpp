@@ -1,10 +1,11 @@
-#include "MultiSamplerInstrument.h"
+#include "MultisamplerInstrument.h"
+#include "RealtimeSafety.h"
+#include <algorithm>
 
 MultiSamplerInstrument::MultiSamplerInstrument(const Config& cfg)
     : config(cfg)
 {
-    // Initialize sample slots
-    sampleSlots.fill(false);
+    publishSounds(std::make_unique<SoundTable>());
     
     // Register audio formats
     formatManager.registerBasicFormats();
@@ -16,13 +17,13 @@ MultiSamplerInstrument::MultiSamplerInstrument(const Config& cfg)
         auto* voice = new MultiSamplerVoice();
         voice->setADSR(config.adsrParams);
         synth.addVoice(voice);
+        voices.push_back(voice);
     }
 }
 
 MultiSamplerInstrument::~MultiSamplerInstrument()
 {
     synth.clearVoices();
-    synth.clearSounds();
 }
 
 void MultiSamplerInstrument::prepareToPlay(double sampleRate, int samplesPerBlock)
@@ -31,13 +32,22 @@ void MultiSamplerInstrument::prepareToPlay(double sampleRate, int samplesPerBloc
     currentBlockSize = samplesPerBlock;
     
     synth.setCurrentPlaybackSampleRate(sampleRate);
+    gainPan.prepare(sampleRate, samplesPerBlock);
 }
 
-void MultiSamplerInstrument::renderNextBlock(juce::AudioBuffer<float>& buffer,
+bool MultiSamplerInstrument::renderNextBlock(juce::AudioBuffer<float>& buffer,
                                              const juce::MidiBuffer& midiMessages,
                                              int startSample,
-                                             int numSamples)
+                                             int numSamples,
+                                             juce::AudioBuffer<float>* preFaderTap)
 {
+    // Nothing new to start and nothing still sounding
+    if (midiMessages.isEmpty() && !isActive())
+    {
+        gainPan.snapToTarget();
+        return false;
+    }
+    
     // Create a view into the buffer for this render block
     juce::AudioBuffer<float> bufferView(
         buffer.getArrayOfWritePointers(),
@@ -47,10 +57,20 @@ void MultiSamplerInstrument::renderNextBlock(juce::AudioBuffer<float>& buffer,
     );
     
     // Render synth output
+    // juce::Synthesiser locks every block, but once published nothing else
+    // takes that lock: sample edits go through the sound table instead
+    const ScopedRealtimeLockExemption synthLock;
     synth.renderNextBlock(bufferView, midiMessages, 0, numSamples);
     
+    if (preFaderTap != nullptr)
+    {
+        for (int ch = 0; ch < juce::jmin(bufferView.getNumChannels(), preFaderTap->getNumChannels()); ++ch)
+            preFaderTap->copyFrom(ch, 0, bufferView, ch, 0, numSamples);
+    }
+    
     // Apply volume and pan
-    applyVolumeAndPan(bufferView, numSamples);
+    gainPan.process(bufferView, numSamples);
+    return true;
 }
 
 // ──────────────────────────────────────────
@@ -109,22 +129,31 @@ bool MultiSamplerInstrument::loadSampleFromBuffer(int slotIndex,
         return false;
     }
     
+    auto sampleData = std::make_shared<SampleData>();
+    sampleData->buffer.makeCopyOf(audioData);
+    sampleData->sampleRate = sampleRate;
+    
+    return loadSampleData(slotIndex, std::move(sampleData), sampleConfig);
+}
+
+bool MultiSamplerInstrument::loadSampleData(int slotIndex,
+                                            std::shared_ptr<const SampleData> sampleData,
+                                            const SampleConfig& sampleConfig)
+{
+    if (!isValidSlot(slotIndex) || sampleData == nullptr || sampleData->buffer.getNumSamples() == 0)
+        return false;
+    
     // Create the sound
-    auto* sound = new MultiSamplerSound(
+    juce::ReferenceCountedObjectPtr<MultiSamplerSound> sound = new MultiSamplerSound(
         sampleConfig.name.isEmpty() ? juce::String("Sample ") + juce::String(slotIndex) : sampleConfig.name,
-        audioData,
+        std::move(sampleData),
         sampleConfig.rootNote,
         sampleConfig.minNote,
         sampleConfig.maxNote
     );
     
-    // Remove existing sound in this slot if any
-    // Note: We need to find and remove sounds that might overlap with this slot
-    // For simplicity, we'll clear all sounds and re-add them
-    // A more sophisticated approach would track sound indices per slot
-    
-    synth.addSound(sound);
-    sampleSlots[slotIndex] = true;
+    // A slot holds one sample; loading into a used slot replaces it
+    setSlotSound(slotIndex, std::move(sound));
     
     DBG("Loaded sample in slot " << slotIndex << ": " << sampleConfig.name);
     return true;
@@ -132,21 +161,17 @@ bool MultiSamplerInstrument::loadSampleFromBuffer(int slotIndex,
 
 void MultiSamplerInstrument::clearSample(int slotIndex)
 {
-    if (!isValidSlot(slotIndex))
-        return;
-    
-    // For now, we'll need to rebuild the sound bank
-    // This is a simplification - a production system would track sounds better
-    sampleSlots[slotIndex] = false;
-    
-    // Note: In a production system, you'd want to track which juce::SynthesiserSound
-    // corresponds to which slot and remove only that one
+    if (hasSample(slotIndex))
+        setSlotSound(slotIndex, nullptr);
 }
 
 void MultiSamplerInstrument::clearAllSamples()
 {
-    synth.clearSounds();
-    sampleSlots.fill(false);
+    for (const auto& sound : *slotSounds)
+        if (sound != nullptr)
+            removedSounds.push_back(sound);
+    
+    publishSounds(std::make_unique<SoundTable>());
 }
 
 bool MultiSamplerInstrument::hasSample(int slotIndex) const
@@ -154,7 +179,7 @@ bool MultiSamplerInstrument::hasSample(int slotIndex) const
     if (!isValidSlot(slotIndex))
         return false;
     
-    return sampleSlots[slotIndex];
+    return (*slotSounds)[static_cast<size_t>(slotIndex)] != nullptr;
 }
 
 juce::String MultiSamplerInstrument::getSampleName(int slotIndex) const
@@ -162,8 +187,7 @@ juce::String MultiSamplerInstrument::getSampleName(int slotIndex) const
     if (!hasSample(slotIndex))
         return juce::String();
     
-    // Would need to track this separately in a production system
-    return juce::String("Sample ") + juce::String(slotIndex);
+    return (*slotSounds)[static_cast<size_t>(slotIndex)]->getName();
 }
 
 int MultiSamplerInstrument::getSampleRootNote(int slotIndex) const
@@ -171,14 +195,55 @@ int MultiSamplerInstrument::getSampleRootNote(int slotIndex) const
     if (!hasSample(slotIndex))
         return -1;
     
-    // Would need to track this separately in a production system
-    return 60; // Middle C default
+    return (*slotSounds)[static_cast<size_t>(slotIndex)]->getRootNote();
+}
+
+MultiSamplerInstrument::SampleConfig MultiSamplerInstrument::getSampleConfig(int slotIndex) const
+{
+    SampleConfig sampleConfig;
+    if (hasSample(slotIndex))
+    {
+        const auto& sound = (*slotSounds)[static_cast<size_t>(slotIndex)];
+        sampleConfig.name = sound->getName();
+        sampleConfig.rootNote = sound->getRootNote();
+        sampleConfig.minNote = sound->getMinNote();
+        sampleConfig.maxNote = sound->getMaxNote();
+    }
+    return sampleConfig;
+}
+
+std::shared_ptr<const SampleData> MultiSamplerInstrument::getSampleData(int slotIndex) const
+{
+    if (!hasSample(slotIndex))
+        return nullptr;
+    
+    return (*slotSounds)[static_cast<size_t>(slotIndex)]->getSampleData();
 }
 
 // ──────────────────────────────────────────
 // Note control
 // ──────────────────────────────────────────
 
+void MultiSamplerInstrument::SamplerSynthesiser::noteOn(int midiChannel, int midiNoteNumber, float velocity)
+{
+    // juce::Synthesiser::noteOn(), reading the sounds from the published table
+    const juce::ScopedLock sl(lock);
+    
+    for (const auto& sound : *owner.publishedSounds.load(std::memory_order_acquire))
+    {
+        if (sound == nullptr || !sound->appliesToNote(midiNoteNumber) || !sound->appliesToChannel(midiChannel))
+            continue;
+        
+        // A note still ringing (sustain pedal) is stopped before it restarts
+        for (auto* voice : voices)
+            if (voice->getCurrentlyPlayingNote() == midiNoteNumber && voice->isPlayingChannel(midiChannel))
+                stopVoice(voice, 1.0f, true);
+        
+        startVoice(findFreeVoice(sound.get(), midiChannel, midiNoteNumber, isNoteStealingEnabled()),
+                   sound.get(), midiChannel, midiNoteNumber, velocity);
+    }
+}
+
 void MultiSamplerInstrument::noteOn(int midiNote, float velocity)
 {
     synth.noteOn(1, midiNote, velocity);
@@ -202,23 +267,20 @@ void MultiSamplerInstrument::setADSR(const juce::ADSR::Parameters& params)
 {
     config.adsrParams = params;
     
-    for (int i = 0; i < synth.getNumVoices(); ++i)
-    {
-        if (auto* voice = dynamic_cast<MultiSamplerVoice*>(synth.getVoice(i)))
-        {
-            voice->setADSR(params);
-        }
-    }
+    for (auto* voice : voices)
+        voice->setADSR(params);
 }
 
 void MultiSamplerInstrument::setVolume(float volume)
 {
     config.volume = juce::jlimit(0.0f, 1.0f, volume);
+    gainPan.setVolume(config.volume);
 }
 
 void MultiSamplerInstrument::setPan(float pan)
 {
     config.pan = juce::jlimit(0.0f, 1.0f, pan);
+    gainPan.setPan(config.pan);
 }
 
 // ──────────────────────────────────────────
@@ -227,9 +289,9 @@ void MultiSamplerInstrument::setPan(float pan)
 
 bool MultiSamplerInstrument::isActive() const
 {
-    for (int i = 0; i < synth.getNumVoices(); ++i)
+    for (auto* voice : voices)
     {
-        if (synth.getVoice(i)->isVoiceActive())
+        if (voice->isVoiceActive())
             return true;
     }
     return false;
@@ -238,9 +300,9 @@ bool MultiSamplerInstrument::isActive() const
 int MultiSamplerInstrument::getLoadedSampleCount() const
 {
     int count = 0;
-    for (bool loaded : sampleSlots)
+    for (const auto& sound : *slotSounds)
     {
-        if (loaded)
+        if (sound != nullptr)
             ++count;
     }
     return count;
@@ -252,30 +314,43 @@ int MultiSamplerInstrument::getLoadedSampleCount() const
 
 void MultiSamplerInstrument::updateVoiceParameters()
 {
-    for (int i = 0; i < synth.getNumVoices(); ++i)
-    {
-        if (auto* voice = dynamic_cast<MultiSamplerVoice*>(synth.getVoice(i)))
-        {
-            voice->setADSR(config.adsrParams);
-        }
-    }
+    for (auto* voice : voices)
+        voice->setADSR(config.adsrParams);
 }
 
-void MultiSamplerInstrument::applyVolumeAndPan(juce::AudioBuffer<float>& buffer, int numSamples)
+void MultiSamplerInstrument::setSlotSound(int slotIndex, juce::ReferenceCountedObjectPtr<MultiSamplerSound> sound)
 {
-    if (buffer.getNumChannels() < 2)
-        return;
+    auto table = std::make_unique<SoundTable>(*slotSounds);
+    auto& slot = (*table)[static_cast<size_t>(slotIndex)];
     
-    auto* left = buffer.getWritePointer(0);
-    auto* right = buffer.getWritePointer(1);
+    if (slot != nullptr)
+        removedSounds.push_back(slot);
+    
+    slot = std::move(sound);
+    publishSounds(std::move(table));
+}
+
+void MultiSamplerInstrument::publishSounds(std::unique_ptr<SoundTable> table)
+{
+    publishedSounds.store(table.get(), std::memory_order_release);
+    std::swap(slotSounds, table);
     
-    // Calculate pan gains (constant power panning)
-    float leftGain = std::cos(config.pan * juce::MathConstants<float>::halfPi) * config.volume;
-    float rightGain = std::sin(config.pan * juce::MathConstants<float>::halfPi) * config.volume;
+    // table now holds the replaced one; without a reclaimer it goes here, so
+    // the sounds only it still held can be released below
+    if (reclaimer != nullptr)
+        reclaimer->retire(std::move(table));
     
-    for (int i = 0; i < numSamples; ++i)
-    {
-        left[i] *= leftGain;
-        right[i] *= rightGain;
-    }
+    table.reset();
+    releaseRemovedSounds();
+}
+
+void MultiSamplerInstrument::releaseRemovedSounds()
+{
+    // A voice still playing a removed sound keeps it alive, and would delete
+    // it on the audio thread when it lets go; so may a retired table still
+    // waiting for the reclaimer. Hold on to it until only this list refers
+    // to it, then delete it here.
+    removedSounds.erase(std::remove_if(removedSounds.begin(), removedSounds.end(),
+                                       [](const auto& sound) { return sound->getReferenceCount() == 1; }),
+                        removedSounds.end());
 }
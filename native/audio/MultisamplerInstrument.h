@@ -1,7 +1,14 @@
 #pragma once
 #include "JuceHeader.h"
-#include "MultiSamplerVoice.h"
-#include "MultiSamplerSound.h"
+#include "SmoothedGain.h"
+#include "RealtimeSynthesiser.h"
+#include "RealtimeReclaimer.h"
+#include "MultisamplerVoice.h"
+#include "MultisamplerSound.h"
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
 
 // Forward declarations for config structs
 namespace MultiSamplerConfig
@@ -27,6 +34,10 @@ namespace MultiSamplerConfig
 /**
  * MultiSamplerInstrument - A sample-based instrument that can load and play
  * up to 16 audio samples, each mapped to different MIDI note ranges.
+ *
+ * Samples can be loaded and cleared while the instrument plays: sounds are
+ * built on the calling thread and handed to the audio thread through an
+ * atomically published table, so neither side waits on the other.
  */
 class MultiSamplerInstrument
 {
@@ -41,10 +52,23 @@ public:
     // Core functionality
     // ──────────────────────────────────────────
     void prepareToPlay(double sampleRate, int samplesPerBlock);
-    void renderNextBlock(juce::AudioBuffer<float>& buffer,
+    
+    /**
+     * Where replaced sound tables are deleted once the audio thread is done
+     * with them. Without one they are deleted straight away, which is only
+     * safe while the instrument isn't rendering.
+     */
+    void setReclaimer(RealtimeReclaimer* newReclaimer) { reclaimer = newReclaimer; }
+    
+    /**
+     * Adds this block's output to buffer; returns false (buffer untouched) when
+     * idle. With preFaderTap, the block before volume and pan is copied there too.
+     */
+    bool renderNextBlock(juce::AudioBuffer<float>& buffer,
                         const juce::MidiBuffer& midiMessages,
                         int startSample,
-                        int numSamples);
+                        int numSamples,
+                        juce::AudioBuffer<float>* preFaderTap = nullptr);
     
     // ──────────────────────────────────────────
     // Sample loading (0-15 = 16 slots)
@@ -72,6 +96,14 @@ public:
                              double sampleRate,
                              const SampleConfig& config);
     
+    /**
+     * Load already decoded sample data without copying it (e.g. frames
+     * memory-mapped from a session snapshot)
+     */
+    bool loadSampleData(int slotIndex,
+                        std::shared_ptr<const SampleData> sampleData,
+                        const SampleConfig& config);
+    
     /**
      * Remove a sample from a slot
      */
@@ -92,6 +124,8 @@ public:
      */
     juce::String getSampleName(int slotIndex) const;
     int getSampleRootNote(int slotIndex) const;
+    SampleConfig getSampleConfig(int slotIndex) const;
+    std::shared_ptr<const SampleData> getSampleData(int slotIndex) const;  // nullptr if empty
     
     // ──────────────────────────────────────────
     // Note control
@@ -117,13 +151,49 @@ public:
     float getPan() const { return config.pan; }
     bool isActive() const;
     int getLoadedSampleCount() const;
+    
+    /** The voices, for reading their state on the audio thread. */
+    const std::vector<MultiSamplerVoice*>& getVoices() const { return voices; }
 
 private:
+    static constexpr int numSlots = 16;
+    
+    // Sounds are edited copy-on-write, like Instrument's effect chain: the
+    // control thread builds a new table and publishes it with one atomic
+    // store, and the replaced table goes to the reclaimer. The Synthesiser's
+    // own sound list is never used, as editing it takes the lock the audio
+    // thread holds while rendering.
+    using SoundTable = std::array<juce::ReferenceCountedObjectPtr<MultiSamplerSound>, numSlots>;
+    
+    /** Starts notes from the published sound table. */
+    class SamplerSynthesiser : public RealtimeSynthesiser
+    {
+    public:
+        explicit SamplerSynthesiser(const MultiSamplerInstrument& ownerToUse) : owner(ownerToUse) {}
+        
+        void noteOn(int midiChannel, int midiNoteNumber, float velocity) override;
+        
+    private:
+        const MultiSamplerInstrument& owner;
+    };
+    
     Config config;
-    juce::Synthesiser synth;
+    SamplerSynthesiser synth { *this };
+    
+    // The synth owns these; kept here so the audio thread can reach the voices
+    // without Synthesiser::getVoice(), which takes the synth's lock
+    std::vector<MultiSamplerVoice*> voices;
+    
+    // Volume and pan from config, ramped so changes don't click
+    StereoGainPan gainPan { config.volume, config.pan };
+    
+    // The sound loaded into each slot (nullptr = empty)
+    std::unique_ptr<SoundTable> slotSounds;                     // control thread
+    std::atomic<const SoundTable*> publishedSounds { nullptr };
+    RealtimeReclaimer* reclaimer = nullptr;
     
-    // Track which slots have samples loaded
-    std::array<bool, 16> sampleSlots;
+    // Sounds taken out of the table that a voice may still be playing
+    std::vector<juce::ReferenceCountedObjectPtr<MultiSamplerSound>> removedSounds;
     
     double currentSampleRate = 44100.0;
     int currentBlockSize = 512;
@@ -134,6 +204,8 @@ private:
     // Helper methods
     // ──────────────────────────────────────────
     void updateVoiceParameters();
-    void applyVolumeAndPan(juce::AudioBuffer<float>& buffer, int numSamples);
-    bool isValidSlot(int slotIndex) const { return slotIndex >= 0 && slotIndex < 16; }
+    bool isValidSlot(int slotIndex) const { return slotIndex >= 0 && slotIndex < numSlots; }
+    void setSlotSound(int slotIndex, juce::ReferenceCountedObjectPtr<MultiSamplerSound> sound);
+    void publishSounds(std::unique_ptr<SoundTable> table);
+    void releaseRemovedSounds();
 };
@@ -1,20 +1,17 @@
-#include "MultiSamplerSound.h"
+#include "MultisamplerSound.h"
 
 MultiSamplerSound::MultiSamplerSound(const juce::String& name,
-                                     juce::AudioBuffer<float>& audioData,
+                                     std::shared_ptr<const SampleData> sampleData,
                                      int rootNote,
                                      int minNote,
                                      int maxNote)
     : name(name)
+    , data(std::move(sampleData))
     , rootNote(juce::jlimit(0, 127, rootNote))
     , minNote(juce::jlimit(0, 127, minNote))
     , maxNote(juce::jlimit(0, 127, maxNote))
-    , length(audioData.getNumSamples())
-    , numChannels(audioData.getNumChannels())
-    , sourceSampleRate(44100.0) // Default, can be set from loaded file
 {
-    // Copy audio data
-    data.makeCopyOf(audioData);
+    jassert(data != nullptr);
 }
 
 MultiSamplerSound::~MultiSamplerSound() = default;
@@ -31,8 +28,8 @@ bool MultiSamplerSound::appliesToChannel(int /*midiChannel*/)
 
 const float* MultiSamplerSound::getAudioData(int channel) const
 {
-    if (channel >= 0 && channel < data.getNumChannels())
-        return data.getReadPointer(channel);
+    if (channel >= 0 && channel < data->buffer.getNumChannels())
+        return data->buffer.getReadPointer(channel);
     
     return nullptr;
 }
@@ -1,5 +1,21 @@
 #pragma once
 #include "JuceHeader.h"
+#include <memory>
+
+/**
+ * SampleData - Decoded sample frames plus their sample rate. Never modified
+ * once built, so sounds and session snapshots share one copy.
+ *
+ * The buffer either owns its frames or refers into a memory-mapped session
+ * snapshot; in that case mapping keeps the file mapped for as long as any
+ * sound still uses the frames.
+ */
+struct SampleData
+{
+    juce::AudioBuffer<float> buffer;
+    double sampleRate = 44100.0;
+    std::shared_ptr<const juce::MemoryMappedFile> mapping;
+};
 
 /**
  * MultiSamplerSound - Holds a single audio sample and its mapping to MIDI notes.
@@ -9,15 +25,15 @@ class MultiSamplerSound : public juce::SynthesiserSound
 {
 public:
     /**
-     * Create a sampler sound from audio data
+     * Create a sampler sound playing shared sample data
      * @param name Display name for this sample
-     * @param audioData Audio buffer containing the sample
+     * @param sampleData Frames and sample rate of the sample
      * @param rootNote The MIDI note that plays this sample at original pitch (0-127)
      * @param minNote Minimum MIDI note that triggers this sample (0-127)
      * @param maxNote Maximum MIDI note that triggers this sample (0-127)
      */
     MultiSamplerSound(const juce::String& name,
-                      juce::AudioBuffer<float>& audioData,
+                      std::shared_ptr<const SampleData> sampleData,
                       int rootNote,
                       int minNote,
                       int maxNote);
@@ -34,9 +50,10 @@ public:
     // Sample data access
     // ──────────────────────────────────────────
     const float* getAudioData(int channel) const;
-    int getAudioDataLength() const { return length; }
-    int getNumChannels() const { return numChannels; }
-    double getSampleRate() const { return sourceSampleRate; }
+    int getAudioDataLength() const { return data->buffer.getNumSamples(); }
+    int getNumChannels() const { return data->buffer.getNumChannels(); }
+    double getSampleRate() const { return data->sampleRate; }
+    const std::shared_ptr<const SampleData>& getSampleData() const { return data; }
     
     // ──────────────────────────────────────────
     // Sample properties
@@ -51,15 +68,11 @@ public:
 
 private:
     juce::String name;
-    juce::AudioBuffer<float> data;
+    std::shared_ptr<const SampleData> data;
     
     int rootNote;
     int minNote;
     int maxNote;
     
-    int length;
-    int numChannels;
-    double sourceSampleRate;
-    
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MultiSamplerSound)
 };
@@ -1,5 +1,5 @@
-#include "MultiSamplerVoice.h"
-#include "MultiSamplerSound.h"
+#include "MultisamplerVoice.h"
+#include "MultisamplerSound.h"
 
 MultiSamplerVoice::MultiSamplerVoice() = default;
 
@@ -73,6 +73,7 @@ void MultiSamplerVoice::renderNextBlock(juce::AudioBuffer<float>& outputBuffer,
     {
         // Get envelope value
         float env = adsr.getNextSample();
+        envelopeLevel = env;
         
         // Check if note should stop
         if (!adsr.isActive())
@@ -34,9 +34,13 @@ public:
     // ──────────────────────────────────────────
     void setADSR(const juce::ADSR::Parameters& params);
     void setPitchBend(float semitones);
+    
+    /** Envelope at the end of the last rendered block, 0 when silent. */
+    float getEnvelopeLevel() const { return isVoiceActive() ? envelopeLevel : 0.0f; }
 
 private:
     juce::ADSR adsr;
+    float envelopeLevel = 0.0f;
     
     double sourceSamplePosition = 0.0;
     double pitchRatio = 1.0;
@@ -0,0 +1,407 @@
+#include "OfflineRenderer.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // Enough for a couple of seconds of audio; the renderer waits when it's full
+    constexpr int writerBufferSeconds = 2;
+
+    // Leaves headroom in the engine's command queue for one block's notes
+    constexpr int maxNotesPerBlock = 512;
+
+    bool parseWaveform(const juce::String& name, BaseOscillatorVoice::Waveform& waveform)
+    {
+        if (name.equalsIgnoreCase("sine"))     { waveform = BaseOscillatorVoice::Waveform::Sine;     return true; }
+        if (name.equalsIgnoreCase("saw"))      { waveform = BaseOscillatorVoice::Waveform::Saw;      return true; }
+        if (name.equalsIgnoreCase("square"))   { waveform = BaseOscillatorVoice::Waveform::Square;   return true; }
+        if (name.equalsIgnoreCase("triangle")) { waveform = BaseOscillatorVoice::Waveform::Triangle; return true; }
+        if (name.equalsIgnoreCase("wavetable")) { waveform = BaseOscillatorVoice::Waveform::Wavetable; return true; }
+        return false;
+    }
+
+    bool parseEffectType(const juce::String& name, Instrument::EffectType& type)
+    {
+        if (name.equalsIgnoreCase("reverb"))     { type = Instrument::EffectType::Reverb;     return true; }
+        if (name.equalsIgnoreCase("delay"))      { type = Instrument::EffectType::Delay;      return true; }
+        if (name.equalsIgnoreCase("chorus"))     { type = Instrument::EffectType::Chorus;     return true; }
+        if (name.equalsIgnoreCase("distortion")) { type = Instrument::EffectType::Distortion; return true; }
+        if (name.equalsIgnoreCase("filter"))     { type = Instrument::EffectType::Filter;     return true; }
+        if (name.equalsIgnoreCase("compressor")) { type = Instrument::EffectType::Compressor; return true; }
+        return false;
+    }
+
+    template <typename Value>
+    Value getOr(const juce::var& object, const juce::Identifier& name, Value fallback)
+    {
+        const auto& value = object[name];
+        return value.isVoid() ? fallback : static_cast<Value>(value);
+    }
+
+    juce::ADSR::Parameters parseAdsr(const juce::var& adsr, juce::ADSR::Parameters params)
+    {
+        params.attack = static_cast<float>(getOr(adsr, "attack", static_cast<double>(params.attack)));
+        params.decay = static_cast<float>(getOr(adsr, "decay", static_cast<double>(params.decay)));
+        params.sustain = static_cast<float>(getOr(adsr, "sustain", static_cast<double>(params.sustain)));
+        params.release = static_cast<float>(getOr(adsr, "release", static_cast<double>(params.release)));
+        return params;
+    }
+}
+
+// ──────────────────────────────────────────
+// Session
+// ──────────────────────────────────────────
+
+double OfflineRenderer::Session::getContentLengthMs() const
+{
+    if (lengthMs > 0.0)
+        return lengthMs;
+
+    double end = 0.0;
+    for (const auto& channel : channels)
+        for (const auto& note : channel.notes)
+            end = juce::jmax(end, note.startMs + note.lengthMs);
+
+    return end;
+}
+
+juce::Result OfflineRenderer::parseSession(const juce::String& json, const juce::File& baseDirectory, Session& session)
+{
+    juce::var root;
+    const auto parseResult = juce::JSON::parse(json, root);
+    if (parseResult.failed())
+        return parseResult;
+
+    if (!root.isObject())
+        return juce::Result::fail("Session must be a JSON object");
+
+    session = Session();
+    session.lengthMs = getOr(root, "lengthMs", 0.0);
+    session.tailMs = getOr(root, "tailMs", session.tailMs);
+    session.masterVolume = static_cast<float>(getOr(root, "masterVolume", 1.0));
+
+    const auto* channels = root["channels"].getArray();
+    if (channels == nullptr)
+        return juce::Result::fail("Session has no \"channels\" array");
+
+    for (const auto& channelVar : *channels)
+    {
+        Channel channel;
+        channel.channel = getOr(channelVar, "channel", 0);
+        if (channel.channel < 1 || channel.channel > AudioEngine::maxChannels)
+            return juce::Result::fail("Channel numbers must be 1-" + juce::String(AudioEngine::maxChannels));
+
+        const auto instrument = getOr(channelVar, "instrument", juce::String("oscillator"));
+        const auto name = getOr(channelVar, "name", juce::String());
+
+        if (instrument.equalsIgnoreCase("oscillator"))
+        {
+            channel.type = AudioEngine::InstrumentType::Oscillator;
+            auto& config = channel.oscillator;
+            config.polyphony = getOr(channelVar, "polyphony", config.polyphony);
+            config.volume = static_cast<float>(getOr(channelVar, "volume", static_cast<double>(config.volume)));
+            config.pan = static_cast<float>(getOr(channelVar, "pan", static_cast<double>(config.pan)));
+            config.adsrParams = parseAdsr(channelVar["adsr"], config.adsrParams);
+            if (name.isNotEmpty())
+                config.name = name;
+
+            const auto wavetableFile = getOr(channelVar, "wavetable", juce::String());
+            if (wavetableFile.isNotEmpty())
+            {
+                config.wavetable = Wavetable::fromAudioFile(baseDirectory.getChildFile(wavetableFile));
+                if (config.wavetable == nullptr)
+                    return juce::Result::fail("Can't use wavetable: " + wavetableFile);
+            }
+
+            const auto waveform = getOr(channelVar, "waveform", juce::String(wavetableFile.isNotEmpty() ? "wavetable" : "sine"));
+            if (!parseWaveform(waveform, config.waveform))
+                return juce::Result::fail("Unknown waveform: " + waveform);
+        }
+        else if (instrument.equalsIgnoreCase("sampler"))
+        {
+            channel.type = AudioEngine::InstrumentType::MultiSampler;
+            auto& config = channel.sampler;
+            config.polyphony = getOr(channelVar, "polyphony", config.polyphony);
+            config.volume = static_cast<float>(getOr(channelVar, "volume", static_cast<double>(config.volume)));
+            config.pan = static_cast<float>(getOr(channelVar, "pan", static_cast<double>(config.pan)));
+            config.adsrParams = parseAdsr(channelVar["adsr"], config.adsrParams);
+            if (name.isNotEmpty())
+                config.name = name;
+
+            if (const auto* samples = channelVar["samples"].getArray())
+            {
+                for (const auto& sampleVar : *samples)
+                {
+                    Sample sample;
+                    sample.slot = getOr(sampleVar, "slot", 0);
+                    sample.file = baseDirectory.getChildFile(getOr(sampleVar, "file", juce::String()));
+                    sample.config.name = sample.file.getFileNameWithoutExtension();
+                    sample.config.rootNote = getOr(sampleVar, "rootNote", sample.config.rootNote);
+                    sample.config.minNote = getOr(sampleVar, "minNote", sample.config.minNote);
+                    sample.config.maxNote = getOr(sampleVar, "maxNote", sample.config.maxNote);
+                    channel.samples.push_back(sample);
+                }
+            }
+        }
+        else
+        {
+            return juce::Result::fail("Unknown instrument type: " + instrument);
+        }
+
+        if (const auto* effects = channelVar["effects"].getArray())
+        {
+            for (const auto& effectVar : *effects)
+            {
+                Effect effect;
+                const auto type = getOr(effectVar, "type", juce::String());
+                if (!parseEffectType(type, effect.type))
+                    return juce::Result::fail("Unknown effect type: " + type);
+
+                // Every other property is an effect parameter ("type" is taken, so
+                // the filter's type goes in as "filterType")
+                if (auto* object = effectVar.getDynamicObject())
+                {
+                    for (const auto& property : object->getProperties())
+                    {
+                        const auto paramName = property.name.toString();
+                        if (paramName == "type")
+                            continue;
+
+                        effect.parameters.emplace_back(paramName == "filterType" ? juce::String("type") : paramName,
+                                                       static_cast<float>(static_cast<double>(property.value)));
+                    }
+                }
+
+                channel.effects.push_back(std::move(effect));
+            }
+        }
+
+        // Notes are [startMs, lengthMs, midiNote, velocity]
+        if (const auto* notes = channelVar["notes"].getArray())
+        {
+            for (const auto& noteVar : *notes)
+            {
+                const auto* fields = noteVar.getArray();
+                if (fields == nullptr || fields->size() < 3)
+                    return juce::Result::fail("Notes must be [startMs, lengthMs, midiNote, velocity]");
+
+                Note note;
+                note.startMs = static_cast<double>((*fields)[0]);
+                note.lengthMs = static_cast<double>((*fields)[1]);
+                note.note = static_cast<int>((*fields)[2]);
+                note.velocity = fields->size() > 3 ? static_cast<float>(static_cast<double>((*fields)[3])) : 0.8f;
+
+                if (note.startMs < 0.0 || note.lengthMs < 0.0 || note.note < 0 || note.note > 127)
+                    return juce::Result::fail("Invalid note on channel " + juce::String(channel.channel));
+
+                channel.notes.push_back(note);
+            }
+        }
+
+        session.channels.push_back(std::move(channel));
+    }
+
+    return juce::Result::ok();
+}
+
+// ──────────────────────────────────────────
+// Rendering
+// ──────────────────────────────────────────
+
+OfflineRenderer::OfflineRenderer(const Options& opts)
+    : options(opts)
+{
+    options.blockSize = juce::jlimit(16, 8192, options.blockSize);
+}
+
+juce::Result OfflineRenderer::render(const Session& session, const juce::File& outputFile)
+{
+    stats = Stats();
+
+    // ── Writer ──
+    std::unique_ptr<juce::AudioFormat> format;
+    if (outputFile.hasFileExtension("flac"))
+        format = std::make_unique<juce::FlacAudioFormat>();
+    else if (outputFile.hasFileExtension("wav"))
+        format = std::make_unique<juce::WavAudioFormat>();
+    else
+        return juce::Result::fail("Output must be a .wav or .flac file");
+
+    const bool floatingPoint = options.bitsPerSample == 32;
+    if (!format->getPossibleBitDepths().contains(options.bitsPerSample))
+        return juce::Result::fail(juce::String(options.bitsPerSample) + "-bit isn't supported for " + format->getFormatName());
+
+    if (!outputFile.deleteFile())
+        return juce::Result::fail("Can't overwrite " + outputFile.getFullPathName());
+
+    std::unique_ptr<juce::OutputStream> stream = std::make_unique<juce::FileOutputStream>(outputFile);
+    if (static_cast<juce::FileOutputStream*>(stream.get())->failedToOpen())
+        return juce::Result::fail("Can't write to " + outputFile.getFullPathName());
+
+    const auto writerOptions = juce::AudioFormatWriterOptions {}
+                                   .withSampleRate(options.sampleRate)
+                                   .withNumChannels(2)
+                                   .withBitsPerSample(options.bitsPerSample)
+                                   .withSampleFormat(floatingPoint ? juce::AudioFormatWriterOptions::SampleFormat::floatingPoint
+                                                                   : juce::AudioFormatWriterOptions::SampleFormat::integral);
+
+    auto writer = format->createWriterFor(stream, writerOptions);
+    if (writer == nullptr)
+        return juce::Result::fail("Can't create a " + format->getFormatName() + " writer");
+
+    // ── Engine ──
+    AudioEngine engine;
+    engine.setProcessingQuantum(options.processingQuantum);
+    engine.prepareToPlay(options.sampleRate, options.blockSize);
+
+    const auto setUp = setUpEngine(engine, session);
+    if (setUp.failed())
+        return setUp;
+
+    const auto notes = collectNotes(session);
+    const auto contentSamples = static_cast<juce::int64>(std::ceil(session.getContentLengthMs() * options.sampleRate / 1000.0));
+    const auto maxSamples = contentSamples + static_cast<juce::int64>(std::ceil(session.tailMs * options.sampleRate / 1000.0));
+    const auto queueOverflowsBefore = engine.getCommandQueueOverflowCount();
+
+    juce::TimeSliceThread writerThread("Offline Render Writer");
+    writerThread.startThread();
+
+    {
+        juce::AudioFormatWriter::ThreadedWriter threadedWriter(writer.release(), writerThread,
+                                                               static_cast<int>(options.sampleRate) * writerBufferSeconds);
+
+        juce::AudioBuffer<float> block(2, options.blockSize);
+        size_t nextNote = 0;
+        juce::int64 position = 0;
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+
+        // The master limiter delays the mix: drop that much from the start
+        // and render the same amount longer, so the file lines up with the notes
+        const auto latency = static_cast<juce::int64>(engine.getMasterLatencySamples());
+        auto endPosition = maxSamples + latency;
+
+        while (position < endPosition)
+        {
+            const auto numSamples = static_cast<int>(std::min(static_cast<juce::int64>(options.blockSize), endPosition - position));
+            const auto blockEnd = position + numSamples;
+
+            // Hand this block's notes to the engine, stamped on the sample clock.
+            // With a processing quantum the engine renders up to one quantum
+            // ahead of the block, so notes have to arrive that much earlier.
+            const auto scheduleUntil = blockEnd + engine.getProcessingQuantum();
+            for (int queued = 0; nextNote < notes.size() && notes[nextNote].samplePosition < scheduleUntil && queued < maxNotesPerBlock; ++queued)
+            {
+                const auto& note = notes[nextNote++];
+                // Half a sample in, so the engine's ns -> sample truncation lands exactly on it
+                const auto hostTimeNs = sampleToHostTimeNs(static_cast<double>(juce::jmax(note.samplePosition, position)) + 0.5);
+
+                if (note.isNoteOn)
+                    engine.scheduleNoteOn(note.channel, note.note, note.velocity, hostTimeNs);
+                else
+                    engine.scheduleNoteOff(note.channel, note.note, hostTimeNs);
+            }
+
+            juce::AudioBuffer<float> view(block.getArrayOfWritePointers(), 2, numSamples);
+            engine.renderNextBlock(view, sampleToHostTimeNs(static_cast<double>(position)));
+
+            const auto skip = static_cast<int>(juce::jlimit(static_cast<juce::int64>(0), static_cast<juce::int64>(numSamples), latency - position));
+            const float* toWrite[] = { view.getReadPointer(0) + skip, view.getReadPointer(1) + skip };
+
+            // Faster than the disk: wait for the writer to catch up
+            while (skip < numSamples && !threadedWriter.write(toWrite, numSamples - skip))
+                juce::Thread::sleep(1);
+
+            position = blockEnd;
+
+            // Past the last note, once every channel has gone quiet only the
+            // limiter's delay line is left to flush
+            if (position >= contentSamples && nextNote >= notes.size() && endPosition > position + latency)
+            {
+                const auto bypass = engine.getBypassStats();
+                if (bypass.channelsBypassed == bypass.channelsRendered)
+                    endPosition = position + latency;
+            }
+        }
+
+        stats.samplesRendered = juce::jmax(static_cast<juce::int64>(0), position - latency);
+        stats.notesDropped = engine.getCommandQueueOverflowCount() - queueOverflowsBefore;
+
+        // Destroying the threaded writer flushes the rest to disk
+        engine.shutdown();
+        stats.renderSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+    }
+
+    writerThread.stopThread(1000);
+
+    stats.audioSeconds = static_cast<double>(stats.samplesRendered) / options.sampleRate;
+    stats.realtimeFactor = stats.renderSeconds > 0.0 ? stats.audioSeconds / stats.renderSeconds : 0.0;
+
+    return juce::Result::ok();
+}
+
+juce::Result OfflineRenderer::setUpEngine(AudioEngine& engine, const Session& session) const
+{
+    engine.setMasterVolume(session.masterVolume);
+    engine.setRenderThreadCount(options.renderThreads);
+
+    for (const auto& channel : session.channels)
+    {
+        if (channel.type == AudioEngine::InstrumentType::Oscillator)
+        {
+            engine.createOscillatorInstrument(channel.channel, channel.oscillator);
+
+            for (const auto& effect : channel.effects)
+            {
+                const auto effectId = engine.addEffect(channel.channel, effect.type);
+                if (effectId < 0)
+                    return juce::Result::fail("Effect type not available on channel " + juce::String(channel.channel));
+
+                for (const auto& [name, value] : effect.parameters)
+                    engine.setEffectParameter(channel.channel, effectId, name, value);
+            }
+        }
+        else
+        {
+            engine.createMultiSamplerInstrument(channel.channel, channel.sampler);
+
+            for (const auto& sample : channel.samples)
+                if (!engine.loadSample(channel.channel, sample.slot, sample.file.getFullPathName(), sample.config))
+                    return juce::Result::fail("Can't load sample " + sample.file.getFullPathName());
+        }
+    }
+
+    return juce::Result::ok();
+}
+
+std::vector<OfflineRenderer::TimedNote> OfflineRenderer::collectNotes(const Session& session) const
+{
+    std::vector<TimedNote> notes;
+
+    const auto toSamples = [this](double ms) { return static_cast<juce::int64>(std::llround(ms * options.sampleRate / 1000.0)); };
+
+    for (const auto& channel : session.channels)
+    {
+        for (const auto& note : channel.notes)
+        {
+            const auto start = toSamples(note.startMs);
+            const auto end = juce::jmax(start + 1, toSamples(note.startMs + note.lengthMs));
+            notes.push_back({ start, channel.channel, true, note.note, note.velocity });
+            notes.push_back({ end, channel.channel, false, note.note, 0.0f });
+        }
+    }
+
+    // Time order; at the same sample, note-offs first so a repeated note retriggers
+    std::stable_sort(notes.begin(), notes.end(), [](const TimedNote& a, const TimedNote& b)
+    {
+        if (a.samplePosition != b.samplePosition)
+            return a.samplePosition < b.samplePosition;
+        return !a.isNoteOn && b.isNoteOn;
+    });
+
+    return notes;
+}
+
+juce::uint64 OfflineRenderer::sampleToHostTimeNs(double samplePosition) const
+{
+    return static_cast<juce::uint64>(samplePosition * 1.0e9 / options.sampleRate);
+}
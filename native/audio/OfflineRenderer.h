@@ -0,0 +1,120 @@
+#pragma once
+#include "JuceHeader.h"
+#include "AudioEngine.h"
+#include <utility>
+#include <vector>
+
+/**
+ * OfflineRenderer - Bounces a session to a WAV or FLAC file as fast as the
+ * CPU allows, with no audio device involved.
+ *
+ * A private AudioEngine is set up from the session, notes are fed to it as
+ * timed commands on a sample clock, and rendered blocks are streamed to disk
+ * by an AudioFormatWriter on a writer thread. Nothing depends on wall-clock
+ * time, so the same session and options always produce the same file.
+ *
+ * After the last note the render keeps going until every channel has gone
+ * silent (releases and effect tails included), up to Session::tailMs.
+ * The master bus's lookahead delay is compensated, so the file starts on
+ * the session's time zero.
+ */
+class OfflineRenderer
+{
+public:
+    // ──────────────────────────────────────────
+    // Session description
+    // ──────────────────────────────────────────
+    struct Note
+    {
+        double startMs = 0.0;
+        double lengthMs = 0.0;
+        int note = 60;
+        float velocity = 0.8f;
+    };
+
+    struct Effect
+    {
+        Instrument::EffectType type = Instrument::EffectType::Reverb;
+        std::vector<std::pair<juce::String, float>> parameters;
+    };
+
+    struct Sample
+    {
+        int slot = 0;
+        juce::File file;
+        MultiSamplerConfig::SampleConfig config;
+    };
+
+    struct Channel
+    {
+        int channel = 1;
+        AudioEngine::InstrumentType type = AudioEngine::InstrumentType::Oscillator;
+        Config oscillator;
+        MultiSamplerConfig::Config sampler;
+        std::vector<Sample> samples;
+        std::vector<Effect> effects;
+        std::vector<Note> notes;
+    };
+
+    struct Session
+    {
+        std::vector<Channel> channels;
+        double lengthMs = 0.0;     // 0 = up to the end of the last note
+        double tailMs = 5000.0;    // longest wait for the mix to go silent afterwards
+        float masterVolume = 1.0f;
+
+        /** End of the last note, or lengthMs if that is set. */
+        double getContentLengthMs() const;
+    };
+
+    /**
+     * Parse a session from JSON (see native/tools/sessions/demo.json for the
+     * format). Sample and wavetable paths are resolved relative to baseDirectory.
+     */
+    static juce::Result parseSession(const juce::String& json, const juce::File& baseDirectory, Session& session);
+
+    // ──────────────────────────────────────────
+    // Rendering
+    // ──────────────────────────────────────────
+    struct Options
+    {
+        double sampleRate = 48000.0;
+        int blockSize = 512;
+        int bitsPerSample = 24;   // 16 or 24; 32 writes float WAV
+        int renderThreads = 0;    // see AudioEngine::setRenderThreadCount()
+        int processingQuantum = 0; // see AudioEngine::setProcessingQuantum()
+    };
+
+    struct Stats
+    {
+        juce::int64 samplesRendered = 0;
+        double audioSeconds = 0.0;
+        double renderSeconds = 0.0;   // wall clock, including waiting for the disk
+        double realtimeFactor = 0.0;  // audio seconds per wall-clock second
+        int notesDropped = 0;         // didn't fit the command queue (should stay 0)
+    };
+
+    explicit OfflineRenderer(const Options& options);
+
+    /** Render the session into outputFile (format picked from its extension). */
+    juce::Result render(const Session& session, const juce::File& outputFile);
+
+    const Stats& getStats() const { return stats; }
+
+private:
+    struct TimedNote
+    {
+        juce::int64 samplePosition;
+        int channel;
+        bool isNoteOn;
+        int note;
+        float velocity;
+    };
+
+    juce::Result setUpEngine(AudioEngine& engine, const Session& session) const;
+    std::vector<TimedNote> collectNotes(const Session& session) const;
+    juce::uint64 sampleToHostTimeNs(double samplePosition) const;
+
+    Options options;
+    Stats stats;
+};
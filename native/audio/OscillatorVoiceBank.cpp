@@ -0,0 +1,412 @@
+#include "OscillatorVoiceBank.h"
+#include <cmath>
+
+namespace
+{
+    // Output scale of a voice at full velocity, as in BaseOscillatorVoice
+    constexpr float voiceGain = 0.4f;
+
+    int samplesFor(double seconds, double sampleRate)
+    {
+        return juce::jmax(1, static_cast<int>(std::ceil(seconds * sampleRate)));
+    }
+}
+
+OscillatorVoiceBank::OscillatorVoiceBank(int voicesToAllocate)
+    : numVoices(juce::jmax(1, voicesToAllocate))
+    , numGroups((numVoices + lanes - 1) / lanes)
+    , phase(static_cast<size_t>(numGroups))
+    , increment(static_cast<size_t>(numGroups))
+    , level(static_cast<size_t>(numGroups))
+    , slope(static_cast<size_t>(numGroups))
+    , low(static_cast<size_t>(numGroups))
+    , high(static_cast<size_t>(numGroups))
+    , gain(static_cast<size_t>(numGroups))
+    , active(static_cast<size_t>(numGroups))
+    , voices(static_cast<size_t>(numVoices))
+    , activeInGroup(static_cast<size_t>(numGroups))
+{
+    for (int g = 0; g < numGroups; ++g)
+    {
+        for (auto* values : { &phase, &increment, &level, &slope, &low, &gain })
+            (*values)[static_cast<size_t>(g)] = Vector::expand(0.0f);
+        high[static_cast<size_t>(g)] = Vector::expand(1.0f);
+        active[static_cast<size_t>(g)] = Mask::expand(0);
+    }
+}
+
+void OscillatorVoiceBank::prepare(double newSampleRate)
+{
+    if (newSampleRate > 0.0)
+        sampleRate = newSampleRate;
+}
+
+// ──────────────────────────────────────────
+// Parameters
+// ──────────────────────────────────────────
+
+void OscillatorVoiceBank::setWaveform(BaseOscillatorVoice::Waveform newWaveform)
+{
+    waveform = newWaveform;
+    switch (waveform)
+    {
+        case BaseOscillatorVoice::Waveform::Saw:       table = &Wavetable::saw(); break;
+        case BaseOscillatorVoice::Waveform::Square:    table = &Wavetable::square(); break;
+        case BaseOscillatorVoice::Waveform::Triangle:  table = &Wavetable::triangle(); break;
+        case BaseOscillatorVoice::Waveform::Wavetable: table = wavetable != nullptr ? wavetable.get() : &Wavetable::sine(); break;
+        case BaseOscillatorVoice::Waveform::Sine:
+        default:                                       table = &Wavetable::sine(); break;
+    }
+}
+
+void OscillatorVoiceBank::setWavetable(std::shared_ptr<const Wavetable> newTable)
+{
+    wavetable = std::move(newTable);
+    setWaveform(waveform);
+}
+
+void OscillatorVoiceBank::setADSR(const juce::ADSR::Parameters& params)
+{
+    adsr = params;
+
+    // Carry on from where each envelope is, at the new rates
+    for (int v = 0; v < numVoices; ++v)
+    {
+        const auto stage = voices[static_cast<size_t>(v)].stage;
+        if (stage != Stage::Idle)
+            enterStage(v, stage);
+    }
+}
+
+void OscillatorVoiceBank::setDetune(float cents)
+{
+    detuneCents = cents;
+}
+
+// ──────────────────────────────────────────
+// Notes
+// ──────────────────────────────────────────
+
+void OscillatorVoiceBank::noteOn(int midiNote, float velocity)
+{
+    // A retriggered note lets the voice it was on ring out
+    for (int v = 0; v < numVoices; ++v)
+        if (voices[static_cast<size_t>(v)].note == midiNote)
+            releaseVoice(v, true);
+
+    startVoice(findVoiceToPlay(midiNote), midiNote, velocity);
+}
+
+void OscillatorVoiceBank::noteOff(int midiNote, bool allowTailOff)
+{
+    for (int v = 0; v < numVoices; ++v)
+        if (voices[static_cast<size_t>(v)].note == midiNote)
+            releaseVoice(v, allowTailOff);
+}
+
+void OscillatorVoiceBank::allNotesOff(bool allowTailOff)
+{
+    for (int v = 0; v < numVoices; ++v)
+        if (voices[static_cast<size_t>(v)].stage != Stage::Idle)
+            releaseVoice(v, allowTailOff);
+}
+
+int OscillatorVoiceBank::findVoiceToPlay(int midiNote) const
+{
+    for (int v = 0; v < numVoices; ++v)
+        if (voices[static_cast<size_t>(v)].stage == Stage::Idle)
+            return v;
+
+    // All busy: steal as RealtimeSynthesiser does. The lowest and highest
+    // held notes are kept until nothing else is left.
+    int lowest = -1, highest = -1;
+    for (int v = 0; v < numVoices; ++v)
+    {
+        const auto& voice = voices[static_cast<size_t>(v)];
+        if (!voice.keyDown)
+            continue;
+        if (lowest < 0 || voice.note < voices[static_cast<size_t>(lowest)].note)
+            lowest = v;
+        if (highest < 0 || voice.note > voices[static_cast<size_t>(highest)].note)
+            highest = v;
+    }
+    if (highest == lowest)
+        highest = -1;
+
+    const auto oldest = [this](auto&& condition)
+    {
+        int found = -1;
+        for (int v = 0; v < numVoices; ++v)
+        {
+            const auto& voice = voices[static_cast<size_t>(v)];
+            if (condition(v, voice) && (found < 0 || voice.startOrder < voices[static_cast<size_t>(found)].startOrder))
+                found = v;
+        }
+        return found;
+    };
+    const auto isUnprotected = [lowest, highest](int v) { return v != lowest && v != highest; };
+
+    for (const auto found : { oldest([midiNote](int, const Voice& voice) { return voice.note == midiNote; }),
+                              oldest([&](int v, const Voice& voice) { return isUnprotected(v) && voice.stage == Stage::Release; }),
+                              oldest([&](int v, const Voice& voice) { return isUnprotected(v) && !voice.keyDown; }),
+                              oldest([&](int v, const Voice&) { return isUnprotected(v); }) })
+    {
+        if (found >= 0)
+            return found;
+    }
+
+    // Only protected voices left: keep the bass note
+    return highest >= 0 ? highest : lowest;
+}
+
+void OscillatorVoiceBank::startVoice(int v, int midiNote, float velocity)
+{
+    auto& voice = voices[static_cast<size_t>(v)];
+    const auto freqHz = juce::MidiMessage::getMidiNoteInHertz(midiNote) * std::pow(2.0, detuneCents / 1200.0);
+    const auto phaseDelta = freqHz / sampleRate;
+
+    voice.note = midiNote;
+    voice.keyDown = true;
+    voice.startOrder = ++startCounter;
+    voice.tableLevel = Wavetable::getLevelForIncrement(phaseDelta);
+
+    setLane(phase, v, 0.0f);
+    setLane(increment, v, static_cast<float>(phaseDelta));
+    setLane(gain, v, velocity * voiceGain);
+    setActive(v, true);
+
+    // Like juce::ADSR::noteOn(), a stolen voice rises from where it was
+    if (adsr.attack > 0.0f)
+        enterStage(v, Stage::Attack);
+    else if (adsr.decay > 0.0f && adsr.sustain < 1.0f)
+    {
+        setLane(level, v, 1.0f);
+        enterStage(v, Stage::Decay);
+    }
+    else
+        enterStage(v, Stage::Sustain);
+}
+
+void OscillatorVoiceBank::releaseVoice(int v, bool allowTailOff)
+{
+    auto& voice = voices[static_cast<size_t>(v)];
+    voice.keyDown = false;
+    if (voice.stage == Stage::Idle)
+        return;
+
+    if (allowTailOff && adsr.release > 0.0f)
+        enterStage(v, Stage::Release);
+    else
+        enterStage(v, Stage::Idle);
+}
+
+void OscillatorVoiceBank::enterStage(int v, Stage stage)
+{
+    auto& voice = voices[static_cast<size_t>(v)];
+    const auto current = getLane(level, v);
+    float rate = 0.0f, bottom = 0.0f, top = 1.0f;
+
+    switch (stage)
+    {
+        case Stage::Attack:
+            if (adsr.attack <= 0.0f)
+            {
+                setLane(level, v, 1.0f);
+                return enterStage(v, Stage::Decay);
+            }
+            rate = static_cast<float>(1.0 / (adsr.attack * sampleRate));
+            voice.samplesLeft = samplesFor((1.0f - current) * adsr.attack, sampleRate);
+            break;
+
+        case Stage::Decay:
+            if (current <= adsr.sustain || adsr.decay <= 0.0f || adsr.sustain >= 1.0f)
+                return enterStage(v, Stage::Sustain);
+            rate = -static_cast<float>((1.0f - adsr.sustain) / (adsr.decay * sampleRate));
+            bottom = adsr.sustain;
+            voice.samplesLeft = samplesFor((current - adsr.sustain) / (1.0f - adsr.sustain) * adsr.decay, sampleRate);
+            break;
+
+        case Stage::Sustain:
+            setLane(level, v, adsr.sustain);
+            bottom = top = adsr.sustain;
+            voice.samplesLeft = forever;
+            break;
+
+        case Stage::Release:
+            if (current <= 0.0f || adsr.release <= 0.0f)
+                return enterStage(v, Stage::Idle);
+            // Straight down to 0 over the release time, from wherever it is
+            rate = -static_cast<float>(current / (adsr.release * sampleRate));
+            voice.samplesLeft = samplesFor(adsr.release, sampleRate);
+            break;
+
+        case Stage::Idle:
+        default:
+            setLane(level, v, 0.0f);
+            top = 0.0f;
+            voice.samplesLeft = forever;
+            voice.note = -1;
+            voice.keyDown = false;
+            setActive(v, false);
+            break;
+    }
+
+    voice.stage = stage;
+    setLane(slope, v, rate);
+    setLane(low, v, bottom);
+    setLane(high, v, top);
+}
+
+void OscillatorVoiceBank::setActive(int v, bool isActive)
+{
+    const auto group = static_cast<size_t>(v / lanes);
+    const auto lane = static_cast<size_t>(v % lanes);
+    const auto wasActive = active[group].get(lane) != 0;
+    if (wasActive == isActive)
+        return;
+
+    active[group].set(lane, isActive ? ~juce::uint32() : 0u);
+    activeInGroup[group] += isActive ? 1 : -1;
+    numActive += isActive ? 1 : -1;
+}
+
+// ──────────────────────────────────────────
+// Rendering
+// ──────────────────────────────────────────
+
+void OscillatorVoiceBank::renderNextBlock(juce::AudioBuffer<float>& buffer, const juce::MidiBuffer& midi,
+                                          int startSample, int numSamples)
+{
+    auto* left = buffer.getWritePointer(0, startSample);
+    auto* right = buffer.getNumChannels() > 1 ? buffer.getWritePointer(1, startSample) : nullptr;
+
+    // Render up to each event, then apply it, all at its own sample
+    int position = 0;
+    for (const auto metadata : midi)
+    {
+        const auto eventPosition = juce::jlimit(0, numSamples, metadata.samplePosition - startSample);
+        if (eventPosition > position)
+        {
+            renderVoices(left + position, right != nullptr ? right + position : nullptr, eventPosition - position);
+            position = eventPosition;
+        }
+        handleMidiEvent(metadata.getMessage());
+    }
+
+    if (position < numSamples)
+        renderVoices(left + position, right != nullptr ? right + position : nullptr, numSamples - position);
+}
+
+void OscillatorVoiceBank::handleMidiEvent(const juce::MidiMessage& message)
+{
+    if (message.isNoteOn())
+        noteOn(message.getNoteNumber(), message.getFloatVelocity());
+    else if (message.isNoteOff())
+        noteOff(message.getNoteNumber(), true);
+    else if (message.isAllNotesOff() || message.isAllSoundOff())
+        allNotesOff(true);
+}
+
+void OscillatorVoiceBank::renderVoices(float* left, float* right, int numSamples)
+{
+    if (numActive == 0)
+        return;
+
+    juce::ScopedNoDenormals noDenormals;
+
+    for (int offset = 0; offset < numSamples; offset += chunkSize)
+    {
+        const auto chunk = juce::jmin(chunkSize, numSamples - offset);
+        std::fill(mix.begin(), mix.begin() + chunk, Vector::expand(0.0f));
+
+        for (int g = 0; g < numGroups; ++g)
+        {
+            // Straight through to the next stage change, then make it
+            for (int done = 0; done < chunk && activeInGroup[static_cast<size_t>(g)] > 0;)
+            {
+                int run = chunk - done;
+                const auto end = juce::jmin((g + 1) * lanes, numVoices);
+                for (int v = g * lanes; v < end; ++v)
+                    run = juce::jmin(run, voices[static_cast<size_t>(v)].samplesLeft);
+
+                renderGroup(g, mix.data() + done, run);
+                done += run;
+
+                for (int v = g * lanes; v < end; ++v)
+                {
+                    auto& voice = voices[static_cast<size_t>(v)];
+                    if (voice.samplesLeft == forever || (voice.samplesLeft -= run) > 0)
+                        continue;
+
+                    switch (voice.stage)
+                    {
+                        case Stage::Attack:  enterStage(v, Stage::Decay); break;
+                        case Stage::Decay:   enterStage(v, Stage::Sustain); break;
+                        default:             enterStage(v, Stage::Idle); break;
+                    }
+                }
+            }
+        }
+
+        // One horizontal sum per sample, however many groups played
+        for (int i = 0; i < chunk; ++i)
+        {
+            const auto sample = mix[static_cast<size_t>(i)].sum();
+            left[offset + i] += sample;
+            if (right != nullptr)
+                right[offset + i] += sample;
+        }
+    }
+}
+
+void OscillatorVoiceBank::renderGroup(int group, Vector* output, int numSamples)
+{
+    const auto g = static_cast<size_t>(group);
+    auto groupPhase = phase[g];
+    auto groupLevel = level[g];
+    const auto groupIncrement = increment[g];
+    const auto groupSlope = slope[g];
+    const auto groupLow = low[g];
+    const auto groupHigh = high[g];
+    const auto groupGain = gain[g] & active[g];
+    const auto one = Vector::expand(1.0f);
+    const auto size = Vector::expand(static_cast<float>(Wavetable::tableSize));
+
+    // Each lane reads the band-limited level for its own pitch
+    std::array<const float*, lanes> tables {};
+    for (int lane = 0; lane < lanes; ++lane)
+    {
+        const auto v = juce::jmin(group * lanes + lane, numVoices - 1);
+        tables[static_cast<size_t>(lane)] = table->getLevel(voices[static_cast<size_t>(v)].tableLevel);
+    }
+
+    alignas(Vector::SIMDRegisterSize) float indices[lanes];
+    alignas(Vector::SIMDRegisterSize) float current[lanes];
+    alignas(Vector::SIMDRegisterSize) float next[lanes];
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        groupLevel = Vector::min(Vector::max(groupLevel + groupSlope, groupLow), groupHigh);
+
+        const auto position = groupPhase * size;
+        const auto index = Vector::truncate(position);
+        index.copyToRawArray(indices);
+        for (int lane = 0; lane < lanes; ++lane)
+        {
+            const auto* samples = tables[static_cast<size_t>(lane)] + static_cast<int>(indices[lane]);
+            current[lane] = samples[0];
+            next[lane] = samples[1];
+        }
+
+        const auto a = Vector::fromRawArray(current);
+        const auto b = Vector::fromRawArray(next);
+        const auto osc = a + (position - index) * (b - a);
+        output[i] += osc * groupLevel * groupGain;
+
+        groupPhase += groupIncrement;
+        groupPhase -= one & Vector::greaterThanOrEqual(groupPhase, one);
+    }
+
+    phase[g] = groupPhase;
+    level[g] = groupLevel;
+}
@@ -0,0 +1,134 @@
+#pragma once
+#include "JuceHeader.h"
+#include "BaseOscillatorVoice.h"
+#include "Wavetable.h"
+#include <array>
+#include <limits>
+#include <memory>
+#include <vector>
+
+/**
+ * OscillatorVoiceBank - The voices of an oscillator Instrument rendered
+ * several at a time, as one lane each of a juce::dsp::SIMDRegister (4 with
+ * SSE and NEON, 8 with AVX).
+ *
+ * Instead of a heap object per voice behind a virtual call, the state the
+ * render loop touches (phase, increment, envelope level, slope and bounds,
+ * velocity gain, active mask) is kept as arrays of aligned registers, one
+ * register per group of lanes. A group renders with vector arithmetic, and
+ * only the wavetable reads go lane by lane. Inactive lanes are masked out;
+ * groups with none active are skipped.
+ *
+ * Envelope stages change on a per-voice sample countdown rather than a test
+ * per sample: a group renders straight through to its next stage change,
+ * and the lane that reached it is moved on. Levels are clamped to each
+ * stage's bounds, so stages land exactly where juce::ADSR's would.
+ *
+ * Plays like BaseOscillatorVoice voices in a RealtimeSynthesiser: the same
+ * tables, envelope and gain, a retriggered note releasing the voice it
+ * played on, and the same voice stealing order. MIDI events are applied at
+ * their exact sample. Nothing here allocates or locks after construction.
+ */
+class OscillatorVoiceBank
+{
+public:
+    using Vector = juce::dsp::SIMDRegister<float>;
+    using Mask = juce::dsp::SIMDRegister<juce::uint32>;
+    static constexpr int lanes = static_cast<int>(Vector::SIMDNumElements);
+
+    explicit OscillatorVoiceBank(int numVoices);
+
+    void prepare(double sampleRate);
+    int getNumVoices() const { return numVoices; }
+
+    // ──────────────────────────────────────────
+    // Parameters (from the thread that renders)
+    // ──────────────────────────────────────────
+    void setWaveform(BaseOscillatorVoice::Waveform newWaveform);
+    void setWavetable(std::shared_ptr<const Wavetable> newTable);  // before rendering, as for the voices
+    void setADSR(const juce::ADSR::Parameters& params);
+    void setDetune(float cents);
+
+    // ──────────────────────────────────────────
+    // Notes and rendering
+    // ──────────────────────────────────────────
+    void noteOn(int midiNote, float velocity);
+    void noteOff(int midiNote, bool allowTailOff);
+    void allNotesOff(bool allowTailOff);
+
+    /** Adds the voices to both channels, applying note on/off and all-notes-off events in midi. */
+    void renderNextBlock(juce::AudioBuffer<float>& buffer, const juce::MidiBuffer& midi,
+                         int startSample, int numSamples);
+
+    bool isActive() const { return numActive > 0; }
+
+    /** Calls visit(note, keyDown, envelopeLevel) for each sounding voice. */
+    template <typename Visitor>
+    void visitVoices(Visitor&& visit) const
+    {
+        for (int v = 0; v < numVoices; ++v)
+            if (voices[static_cast<size_t>(v)].stage != Stage::Idle)
+                visit(voices[static_cast<size_t>(v)].note, voices[static_cast<size_t>(v)].keyDown, getLane(level, v));
+    }
+
+private:
+    enum class Stage : juce::uint8 { Idle, Attack, Decay, Sustain, Release };
+
+    /** What only changes at note and stage boundaries, one per voice. */
+    struct Voice
+    {
+        Stage stage = Stage::Idle;
+        int samplesLeft = 0;        // in this stage
+        int note = -1;
+        bool keyDown = false;
+        int tableLevel = 0;
+        juce::uint32 startOrder = 0;
+    };
+
+    static constexpr int chunkSize = 64;
+    static constexpr int forever = std::numeric_limits<int>::max();
+
+    int numVoices;
+    int numGroups;
+    int numActive = 0;
+    double sampleRate = 44100.0;
+
+    // Per lane, a register per group of lanes
+    std::vector<Vector> phase, increment;           // cycles
+    std::vector<Vector> level, slope, low, high;    // envelope, per sample
+    std::vector<Vector> gain;                       // velocity
+    std::vector<Mask> active;
+
+    std::vector<Voice> voices;
+    std::vector<int> activeInGroup;
+    juce::uint32 startCounter = 0;
+
+    BaseOscillatorVoice::Waveform waveform = BaseOscillatorVoice::Waveform::Sine;
+    std::shared_ptr<const Wavetable> wavetable;
+    const Wavetable* table = &Wavetable::sine();
+    juce::ADSR::Parameters adsr { 0.1f, 0.1f, 1.0f, 0.1f };
+    float detuneCents = 0.0f;
+
+    std::array<Vector, chunkSize> mix {};
+
+    static float getLane(const std::vector<Vector>& values, int voice)
+    {
+        return values[static_cast<size_t>(voice / lanes)].get(static_cast<size_t>(voice % lanes));
+    }
+    static void setLane(std::vector<Vector>& values, int voice, float value)
+    {
+        values[static_cast<size_t>(voice / lanes)].set(static_cast<size_t>(voice % lanes), value);
+    }
+
+    void handleMidiEvent(const juce::MidiMessage& message);
+    void renderVoices(float* left, float* right, int numSamples);
+    void renderGroup(int group, Vector* output, int numSamples);
+
+    int findVoiceToPlay(int midiNote) const;
+    void startVoice(int voice, int midiNote, float velocity);
+    void releaseVoice(int voice, bool allowTailOff);
+    void enterStage(int voice, Stage stage);
+    void setActive(int voice, bool isActive);
+
+    JUCE_DECLARE_NON_COPYABLE(OscillatorVoiceBank)
+};
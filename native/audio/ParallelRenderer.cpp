@@ -0,0 +1,217 @@
+#include "ParallelRenderer.h"
+
+#include <chrono>
+#include <semaphore>
+#include <thread>
+
+#if JUCE_INTEL
+ #include <emmintrin.h>
+#endif
+
+namespace
+{
+    /** Polite busy-wait hint to the CPU (lets the sibling hyperthread run). */
+    inline void cpuRelax() noexcept
+    {
+       #if JUCE_INTEL
+        _mm_pause();
+       #elif JUCE_ARM && ! JUCE_MSVC
+        __asm__ __volatile__ ("yield");
+       #endif
+    }
+
+    // How long an idle worker keeps polling before going to sleep. Roughly tens
+    // of microseconds: long enough to catch back-to-back small blocks without
+    // a wake-up, short enough not to burn a core between normal callbacks.
+    constexpr int workerSpinIterations = 4000;
+
+    constexpr int barrierSpinsBeforeYield = 20000;
+}
+
+// ──────────────────────────────────────────
+// Worker thread
+// ──────────────────────────────────────────
+class ParallelRenderer::Worker : public juce::Thread
+{
+public:
+    Worker(ParallelRenderer& o, int index)
+        : juce::Thread("AudioRenderWorker " + juce::String(index))
+        , owner(o)
+    {
+    }
+
+    ~Worker() override
+    {
+        signalThreadShouldExit();
+        wakeSemaphore.release();
+        stopThread(1000);
+    }
+
+    /** Audio thread: wake this worker if it went to sleep. */
+    void wakeIfSleeping()
+    {
+        if (sleeping.exchange(false, std::memory_order_seq_cst))
+            wakeSemaphore.release();
+    }
+
+    void run() override
+    {
+        juce::WorkgroupToken token;
+        int joinedWorkgroup = -1;
+        juce::uint32 lastGeneration = 0;
+
+        while (!threadShouldExit())
+        {
+            owner.joinWorkgroup(token, joinedWorkgroup);
+
+            const auto currentGeneration = generationOf(owner.work.load(std::memory_order_acquire));
+            if (currentGeneration != lastGeneration)
+            {
+                lastGeneration = currentGeneration;
+                owner.runTasks(currentGeneration);
+                continue;
+            }
+
+            if (spinForNewBatch(lastGeneration))
+                continue;
+
+            // Announce we're going to sleep, then check once more so a batch
+            // published in between can't be missed (pairs with wakeIfSleeping)
+            sleeping.store(true, std::memory_order_seq_cst);
+            if (generationOf(owner.work.load(std::memory_order_seq_cst)) == lastGeneration)
+                (void) wakeSemaphore.try_acquire_for(std::chrono::milliseconds(100));
+            sleeping.store(false, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    static juce::uint32 generationOf(juce::uint64 word) noexcept
+    {
+        return static_cast<juce::uint32>(word >> generationShift);
+    }
+
+    bool spinForNewBatch(juce::uint32 lastGeneration) const
+    {
+        for (int i = 0; i < workerSpinIterations; ++i)
+        {
+            if (generationOf(owner.work.load(std::memory_order_relaxed)) != lastGeneration)
+                return true;
+            cpuRelax();
+        }
+        return false;
+    }
+
+    ParallelRenderer& owner;
+    // Not a WaitableEvent: signalling that takes a mutex on the audio thread.
+    // A wake-up left over after a timeout only costs one extra loop.
+    std::counting_semaphore<> wakeSemaphore { 0 };
+    std::atomic<bool> sleeping { false };
+};
+
+// ──────────────────────────────────────────
+// ParallelRenderer
+// ──────────────────────────────────────────
+ParallelRenderer::ParallelRenderer(int numWorkers, int blockSize, double sampleRate)
+{
+    const auto options = juce::Thread::RealtimeOptions {}.withApproximateAudioProcessingTime(blockSize, sampleRate);
+
+    for (int i = 0; i < juce::jmax(0, numWorkers); ++i)
+    {
+        auto worker = std::make_unique<Worker>(*this, i + 1);
+
+        // Realtime scheduling may be refused (e.g. unprivileged Linux); still useful without it
+        if (!worker->startRealtimeThread(options))
+            worker->startThread(juce::Thread::Priority::highest);
+
+        workers.push_back(std::move(worker));
+    }
+}
+
+ParallelRenderer::~ParallelRenderer()
+{
+    workers.clear();
+}
+
+void ParallelRenderer::setWorkgroup(const juce::AudioWorkgroup& newWorkgroup)
+{
+    const juce::ScopedLock lock(workgroupLock);
+    workgroup = newWorkgroup;
+    workgroupGeneration.fetch_add(1, std::memory_order_release);
+}
+
+void ParallelRenderer::joinWorkgroup(juce::WorkgroupToken& token, int& joinedGeneration)
+{
+    const auto current = workgroupGeneration.load(std::memory_order_acquire);
+    if (current == joinedGeneration)
+        return;
+
+    // Only taken when the device changed, never on the audio thread
+    const juce::ScopedLock lock(workgroupLock);
+    if (workgroup)
+        workgroup.join(token);
+    else
+        token.reset();
+
+    joinedGeneration = current;
+}
+
+void ParallelRenderer::runErased(int numTasks, void* context, ErasedTask task)
+{
+    if (numTasks <= 0)
+        return;
+
+    jassert(numTasks <= maxTasks);
+
+    taskContext = context;
+    taskFunction = task;
+    completed.store(0, std::memory_order_relaxed);
+
+    // Generation 0 means "no batch yet" to the workers
+    if (++generation == 0)
+        generation = 1;
+
+    work.store((static_cast<juce::uint64>(generation) << generationShift)
+                   | (static_cast<juce::uint64>(numTasks) << countShift),
+               std::memory_order_seq_cst);
+
+    for (auto& worker : workers)
+        worker->wakeIfSleeping();
+
+    // The audio thread works too, then waits at the barrier for the stragglers
+    runTasks(generation);
+
+    // If a worker got preempted mid-task (more threads than free cores), stop
+    // hogging the CPU it may need to finish
+    for (int spins = 0; completed.load(std::memory_order_acquire) < numTasks; ++spins)
+    {
+        if (spins < barrierSpinsBeforeYield)
+            cpuRelax();
+        else
+            std::this_thread::yield();
+    }
+}
+
+void ParallelRenderer::runTasks(juce::uint32 batchGeneration)
+{
+    auto word = work.load(std::memory_order_acquire);
+
+    for (;;)
+    {
+        if (static_cast<juce::uint32>(word >> generationShift) != batchGeneration)
+            return;
+
+        const auto index = static_cast<int>(word & indexMask);
+        const auto count = static_cast<int>((word >> countShift) & indexMask);
+        if (index >= count)
+            return;
+
+        // A successful claim keeps this batch open until we report completion,
+        // so the task pointers below can't be replaced under us
+        if (work.compare_exchange_weak(word, word + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            taskFunction(taskContext, index);
+            completed.fetch_add(1, std::memory_order_release);
+            word = work.load(std::memory_order_acquire);
+        }
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include "JuceHeader.h"
+#include <atomic>
+#include <memory>
+#include <vector>
+
+/**
+ * ParallelRenderer - Pool of realtime worker threads that help the audio
+ * thread run a batch of independent tasks (one per channel) each block.
+ *
+ * The audio thread publishes a batch by storing a single 64-bit work word
+ * (generation | task count | next task). Workers and the audio thread claim
+ * tasks with a compare-and-swap on that word, so a worker that wakes up late
+ * can never claim work from a newer batch. The audio thread then spins until
+ * every task has finished, so callers can combine results in a fixed order.
+ *
+ * Workers spin briefly after each batch and otherwise sleep on a semaphore; they
+ * join the device's AudioWorkgroup when one is available (Apple platforms).
+ */
+class ParallelRenderer
+{
+public:
+    static constexpr int maxTasks = 0xffff;
+
+    /** Starts numWorkers threads; the audio thread is always an extra participant. */
+    ParallelRenderer(int numWorkers, int blockSize, double sampleRate);
+    ~ParallelRenderer();
+
+    int getNumWorkers() const { return static_cast<int>(workers.size()); }
+
+    /** Workers (re)join this workgroup before their next batch. */
+    void setWorkgroup(const juce::AudioWorkgroup& workgroup);
+
+    /**
+     * Audio thread: calls task(i) for every i in [0, numTasks) spread over the
+     * pool and returns once all of them have completed. Never allocates.
+     */
+    template <typename TaskFunction>
+    void run(int numTasks, TaskFunction& task)
+    {
+        runErased(numTasks, &task, [](void* context, int index) { (*static_cast<TaskFunction*>(context))(index); });
+    }
+
+private:
+    class Worker;
+    using ErasedTask = void (*)(void* context, int taskIndex);
+
+    static constexpr juce::uint64 indexMask = 0xffff;
+    static constexpr int countShift = 16;
+    static constexpr int generationShift = 32;
+
+    void runErased(int numTasks, void* context, ErasedTask task);
+
+    /** Claims and runs tasks from the given generation until none are left. */
+    void runTasks(juce::uint32 generation);
+
+    /** Gets a worker's token into the current workgroup if it changed. */
+    void joinWorkgroup(juce::WorkgroupToken& token, int& joinedGeneration);
+
+    // Current batch. The word is the only thing workers synchronise on.
+    alignas(64) std::atomic<juce::uint64> work { 0 };
+    alignas(64) std::atomic<int> completed { 0 };
+    void* taskContext = nullptr;
+    ErasedTask taskFunction = nullptr;
+    juce::uint32 generation = 0;
+
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    juce::CriticalSection workgroupLock;
+    juce::AudioWorkgroup workgroup;
+    std::atomic<int> workgroupGeneration { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE(ParallelRenderer)
+};
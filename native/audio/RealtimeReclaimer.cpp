@@ -0,0 +1,122 @@
+#include "RealtimeReclaimer.h"
+
+RealtimeReclaimer::RealtimeReclaimer()
+    : juce::Thread("RealtimeReclaimer")
+{
+    startThread(juce::Thread::Priority::background);
+}
+
+RealtimeReclaimer::~RealtimeReclaimer()
+{
+    stopThread(1000);
+    reclaimAll();
+}
+
+void RealtimeReclaimer::retireHolder(std::unique_ptr<Retired> holder)
+{
+    // Pairs with the fence in enterAudioCallback()
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    holder->retiredAtEpoch = epoch.load(std::memory_order_relaxed);
+
+    {
+        juce::ScopedLock lock(pendingLock);
+        pending.push_back(std::move(holder));
+    }
+
+    notify();
+}
+
+bool RealtimeReclaimer::pushReleased(const Released& object) noexcept
+{
+    const auto scope = releaseFifo.write(1);
+    if (scope.blockSize1 == 0)
+        return false;
+
+    released[static_cast<size_t>(scope.startIndex1)] = object;
+    return true;
+}
+
+void RealtimeReclaimer::takeReleased(std::vector<Released>& destination)
+{
+    // Only one reader at a time: callers hold pendingLock
+    const auto scope = releaseFifo.read(releaseFifo.getNumReady());
+    scope.forEach([this, &destination](int index)
+    {
+        destination.push_back(released[static_cast<size_t>(index)]);
+    });
+}
+
+void RealtimeReclaimer::destroy(const std::vector<Released>& objects)
+{
+    for (const auto& object : objects)
+        object.destroy(object.object);
+}
+
+bool RealtimeReclaimer::isSafeToDelete(const Retired& retired) const noexcept
+{
+    // An even epoch means no callback was running when the object was
+    // unpublished, so every later callback already sees the new pointer.
+    // An odd epoch means we have to wait for that callback to finish.
+    if ((retired.retiredAtEpoch & 1) == 0)
+        return true;
+
+    return epoch.load(std::memory_order_acquire) > retired.retiredAtEpoch;
+}
+
+void RealtimeReclaimer::reclaimNow()
+{
+    std::vector<std::unique_ptr<Retired>> toDelete;
+    std::vector<Released> releasedToDelete;
+
+    {
+        juce::ScopedLock lock(pendingLock);
+        takeReleased(releasedToDelete);
+        
+        for (auto it = pending.begin(); it != pending.end();)
+        {
+            if (isSafeToDelete(**it))
+            {
+                toDelete.push_back(std::move(*it));
+                it = pending.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    // Destructors run outside the lock - instruments can take a while to tear down
+    toDelete.clear();
+    destroy(releasedToDelete);
+}
+
+void RealtimeReclaimer::reclaimAll()
+{
+    std::vector<std::unique_ptr<Retired>> toDelete;
+    std::vector<Released> releasedToDelete;
+
+    {
+        juce::ScopedLock lock(pendingLock);
+        takeReleased(releasedToDelete);
+        toDelete.swap(pending);
+    }
+
+    toDelete.clear();
+    destroy(releasedToDelete);
+}
+
+int RealtimeReclaimer::getPendingCount() const
+{
+    juce::ScopedLock lock(pendingLock);
+    return static_cast<int>(pending.size());
+}
+
+void RealtimeReclaimer::run()
+{
+    while (!threadShouldExit())
+    {
+        reclaimNow();
+        wait(50);
+    }
+}
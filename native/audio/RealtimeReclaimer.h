@@ -0,0 +1,122 @@
+#pragma once
+#include "JuceHeader.h"
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+/**
+ * RealtimeReclaimer - Defers destruction of objects that the audio thread may
+ * still be reading until the audio callback has provably let go of them.
+ *
+ * The audio thread brackets every callback with enterAudioCallback() /
+ * exitAudioCallback(), which bump an epoch counter (odd = inside a callback).
+ * Control threads unpublish an object (e.g. swap an atomic pointer to nullptr)
+ * and hand it to retire(). A low-priority background thread deletes it once the
+ * callback that might have seen it has finished, so the audio thread never
+ * blocks on a lock and never frees memory itself.
+ *
+ * Objects can travel the other way too: something the audio thread owns and
+ * has finished with is handed back through releaseFromAudioThread(), a
+ * wait-free FIFO that the background thread drains.
+ */
+class RealtimeReclaimer : private juce::Thread
+{
+public:
+    RealtimeReclaimer();
+    ~RealtimeReclaimer() override;
+
+    // ──────────────────────────────────────────
+    // Audio thread (wait-free)
+    // ──────────────────────────────────────────
+    void enterAudioCallback() noexcept
+    {
+        epoch.fetch_add(1, std::memory_order_relaxed);
+        // Pairs with the fence in retireHolder(): either this callback sees the
+        // unpublished pointer, or the retiring thread sees this callback running.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
+    void exitAudioCallback() noexcept
+    {
+        epoch.fetch_add(1, std::memory_order_release);
+    }
+
+    /**
+     * Hand over an object only the audio thread can still reach, to be
+     * deleted on the background thread. Returns false, leaving the object
+     * with the caller, when the FIFO is full; try again next block.
+     */
+    template <typename ObjectType>
+    bool releaseFromAudioThread(ObjectType* object) noexcept
+    {
+        return pushReleased({ object, [](void* o) { delete static_cast<ObjectType*>(o); } });
+    }
+
+    // ──────────────────────────────────────────
+    // Control threads
+    // ──────────────────────────────────────────
+
+    /**
+     * Queue an already-unpublished object for deferred deletion.
+     * Must be called after the pointer has been removed from every place the
+     * audio thread can reach it.
+     */
+    template <typename ObjectType>
+    void retire(std::unique_ptr<ObjectType> object)
+    {
+        if (object != nullptr)
+            retireHolder(std::make_unique<Holder<ObjectType>>(std::move(object)));
+    }
+
+    /** Delete everything that is already safe to delete, on the calling thread. */
+    void reclaimNow();
+
+    /**
+     * Delete everything unconditionally. Only call this once the audio callback
+     * has been detached from the device (e.g. during shutdown).
+     */
+    void reclaimAll();
+
+    int getPendingCount() const;
+
+private:
+    struct Retired
+    {
+        virtual ~Retired() = default;
+        juce::uint64 retiredAtEpoch = 0;
+    };
+
+    template <typename ObjectType>
+    struct Holder : Retired
+    {
+        explicit Holder(std::unique_ptr<ObjectType> o) : object(std::move(o)) {}
+        std::unique_ptr<ObjectType> object;
+    };
+
+    struct Released
+    {
+        void* object = nullptr;
+        void (*destroy)(void*) = nullptr;
+    };
+
+    static constexpr int releaseCapacity = 64;
+
+    bool pushReleased(const Released& released) noexcept;
+    void takeReleased(std::vector<Released>& destination);
+    static void destroy(const std::vector<Released>& objects);
+    void retireHolder(std::unique_ptr<Retired> holder);
+    bool isSafeToDelete(const Retired& retired) const noexcept;
+    void run() override;
+
+    std::atomic<juce::uint64> epoch { 0 };
+
+    juce::CriticalSection pendingLock;  // never taken by the audio thread
+    std::vector<std::unique_ptr<Retired>> pending;
+
+    // Audio thread -> background thread; read under pendingLock
+    std::array<Released, releaseCapacity> released;
+    juce::AbstractFifo releaseFifo { releaseCapacity };
+
+    JUCE_DECLARE_NON_COPYABLE(RealtimeReclaimer)
+};
@@ -0,0 +1,196 @@
+#include "RealtimeSafety.h"
+#include <atomic>
+
+#if AUDIO_REALTIME_CHECKS && __has_include(<execinfo.h>)
+ #include <execinfo.h>
+ #define AUDIO_REALTIME_BACKTRACE 1
+#else
+ #define AUDIO_REALTIME_BACKTRACE 0
+#endif
+
+namespace RealtimeSafety
+{
+namespace
+{
+    // Plain thread_locals with constant initialisers: reading them from a
+    // malloc hook can't allocate
+    thread_local const char* currentTag = nullptr;
+    thread_local bool isReporting = false;
+    thread_local bool locksExempt = false;
+
+    std::atomic<bool> hooksInstalled { false };
+    std::atomic<juce::int64> allocationCount { 0 };
+    std::atomic<juce::int64> deallocationCount { 0 };
+    std::atomic<juce::int64> lockCount { 0 };
+
+    // Multi-writer ring (the audio thread and render workers). Each slot's
+    // sequence is 0 while being written and index + 1 once complete.
+    constexpr juce::uint64 ringSize = 256;
+
+    struct Slot
+    {
+        std::atomic<juce::uint64> sequence { 0 };
+        Violation violation;
+    };
+
+    Slot ring[ringSize];
+    std::atomic<juce::uint64> writeIndex { 0 };
+
+   #if AUDIO_REALTIME_BACKTRACE
+    // The first backtrace() call loads the unwinder, which allocates; get
+    // that out of the way before any audio thread runs
+    [[maybe_unused]] const bool backtraceWarmedUp = []
+    {
+        void* frame[1];
+        return backtrace(frame, 1) >= 0;
+    }();
+   #endif
+
+    const char* typeName(ViolationType type)
+    {
+        switch (type)
+        {
+            case ViolationType::Allocation:   return "allocation";
+            case ViolationType::Deallocation: return "deallocation";
+            case ViolationType::Lock:         return "lock";
+        }
+        return "?";
+    }
+}
+
+bool isEnabled()
+{
+    return AUDIO_REALTIME_CHECKS != 0;
+}
+
+bool areHooksInstalled()
+{
+    return hooksInstalled.load(std::memory_order_relaxed);
+}
+
+void markHooksInstalled() noexcept
+{
+    hooksInstalled.store(true, std::memory_order_relaxed);
+}
+
+Counts getCounts()
+{
+    Counts counts;
+    counts.allocations = allocationCount.load(std::memory_order_relaxed);
+    counts.deallocations = deallocationCount.load(std::memory_order_relaxed);
+    counts.locks = lockCount.load(std::memory_order_relaxed);
+    return counts;
+}
+
+std::vector<Violation> getRecentViolations()
+{
+    std::vector<Violation> violations;
+    const auto end = writeIndex.load(std::memory_order_acquire);
+    const auto begin = end > ringSize ? end - ringSize : 0;
+
+    for (auto index = begin; index < end; ++index)
+    {
+        auto& slot = ring[index % ringSize];
+        if (slot.sequence.load(std::memory_order_acquire) != index + 1)
+            continue;   // still being written, or already overwritten
+
+        auto copy = slot.violation;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) == index + 1)
+            violations.push_back(copy);
+    }
+
+    return violations;
+}
+
+juce::String describe(const Violation& violation)
+{
+    juce::String text;
+    text << typeName(violation.type) << " in " << (violation.tag != nullptr ? violation.tag : "?");
+
+   #if AUDIO_REALTIME_BACKTRACE
+    if (violation.numFrames > 0)
+    {
+        if (auto** symbols = backtrace_symbols(violation.frames, violation.numFrames))
+        {
+            for (int i = 0; i < violation.numFrames; ++i)
+                text << "\n    " << symbols[i];
+            std::free(symbols);
+        }
+    }
+   #endif
+
+    return text;
+}
+
+void reset()
+{
+    allocationCount.store(0, std::memory_order_relaxed);
+    deallocationCount.store(0, std::memory_order_relaxed);
+    lockCount.store(0, std::memory_order_relaxed);
+
+    for (auto& slot : ring)
+        slot.sequence.store(0, std::memory_order_relaxed);
+    writeIndex.store(0, std::memory_order_release);
+}
+
+bool isInRealtimeContext() noexcept
+{
+    return currentTag != nullptr;
+}
+
+void report(ViolationType type) noexcept
+{
+    // Whatever backtrace() or the counters do must not report again
+    if (currentTag == nullptr || isReporting)
+        return;
+    
+    if (type == ViolationType::Lock && locksExempt)
+        return;
+
+    isReporting = true;
+
+    switch (type)
+    {
+        case ViolationType::Allocation:   allocationCount.fetch_add(1, std::memory_order_relaxed); break;
+        case ViolationType::Deallocation: deallocationCount.fetch_add(1, std::memory_order_relaxed); break;
+        case ViolationType::Lock:         lockCount.fetch_add(1, std::memory_order_relaxed); break;
+    }
+
+    const auto index = writeIndex.fetch_add(1, std::memory_order_acq_rel);
+    auto& slot = ring[index % ringSize];
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.violation.type = type;
+    slot.violation.tag = currentTag;
+   #if AUDIO_REALTIME_BACKTRACE
+    slot.violation.numFrames = backtrace(slot.violation.frames, maxStackFrames);
+   #else
+    slot.violation.numFrames = 0;
+   #endif
+
+    slot.sequence.store(index + 1, std::memory_order_release);
+    isReporting = false;
+}
+
+namespace detail
+{
+    const char* enterContext(const char* tag) noexcept
+    {
+        const auto* previous = currentTag;
+        currentTag = tag;
+        return previous;
+    }
+
+    void exitContext(const char* previousTag) noexcept
+    {
+        currentTag = previousTag;
+    }
+
+    void exemptLocks(bool shouldExempt) noexcept
+    {
+        locksExempt = shouldExempt;
+    }
+}
+}
@@ -0,0 +1,124 @@
+#pragma once
+#include "JuceHeader.h"
+#include <cstdint>
+#include <vector>
+
+/**
+ * RealtimeSafety - Catches audio code doing what it must never do:
+ * allocating, freeing or taking a lock.
+ *
+ * Audio-thread code marks where it runs with ScopedRealtimeContext, tagged
+ * with a static string naming the stage. When AUDIO_REALTIME_CHECKS is on
+ * and RealtimeSafetyHooks.cpp is linked into the binary, the replaced
+ * operator new/delete (plus malloc/free and pthread locks on glibc) call
+ * report(). Inside a realtime context that records a Violation, with the
+ * innermost tag and a short stack, into a fixed lock-free ring and bumps a
+ * counter. Recording never allocates or locks itself.
+ *
+ * With checks off, ScopedRealtimeContext compiles to nothing and the counts
+ * stay zero.
+ */
+namespace RealtimeSafety
+{
+    enum class ViolationType : uint8_t
+    {
+        Allocation,
+        Deallocation,
+        Lock
+    };
+
+    static constexpr int maxStackFrames = 12;
+
+    struct Violation
+    {
+        ViolationType type = ViolationType::Allocation;
+        const char* tag = nullptr;    // innermost ScopedRealtimeContext
+        int numFrames = 0;
+        void* frames[maxStackFrames] {};
+    };
+
+    struct Counts
+    {
+        juce::int64 allocations = 0;
+        juce::int64 deallocations = 0;
+        juce::int64 locks = 0;
+
+        juce::int64 getTotal() const { return allocations + deallocations + locks; }
+    };
+
+    /** True when this build records violations (AUDIO_REALTIME_CHECKS). */
+    bool isEnabled();
+
+    /** True once RealtimeSafetyHooks.cpp has installed itself in this binary. */
+    bool areHooksInstalled();
+
+    Counts getCounts();
+
+    /** The most recent violations, oldest first (up to the ring's size). */
+    std::vector<Violation> getRecentViolations();
+
+    /** Type, tag and symbolised stack of a violation. Allocates: not for the audio thread. */
+    juce::String describe(const Violation& violation);
+
+    /** Clear counts and ring. Call while nothing is rendering. */
+    void reset();
+
+    // ──────────────────────────────────────────
+    // Used by the hooks
+    // ──────────────────────────────────────────
+    bool isInRealtimeContext() noexcept;
+    void report(ViolationType type) noexcept;
+    void markHooksInstalled() noexcept;
+
+    namespace detail
+    {
+        const char* enterContext(const char* tag) noexcept;
+        void exitContext(const char* previousTag) noexcept;
+        void exemptLocks(bool shouldExempt) noexcept;
+    }
+}
+
+/**
+ * Marks the enclosing scope as audio-thread code. Nests; the innermost tag
+ * is what a violation is recorded with. The tag must be a string literal.
+ */
+class ScopedRealtimeContext
+{
+public:
+   #if AUDIO_REALTIME_CHECKS
+    explicit ScopedRealtimeContext(const char* tag) noexcept
+        : previousTag(RealtimeSafety::detail::enterContext(tag)) {}
+    ~ScopedRealtimeContext() noexcept { RealtimeSafety::detail::exitContext(previousTag); }
+   #else
+    explicit ScopedRealtimeContext(const char*) noexcept {}
+   #endif
+
+    ScopedRealtimeContext(const ScopedRealtimeContext&) = delete;
+    ScopedRealtimeContext& operator=(const ScopedRealtimeContext&) = delete;
+
+private:
+   #if AUDIO_REALTIME_CHECKS
+    const char* previousTag;
+   #endif
+};
+
+/**
+ * Lets the enclosing scope take locks without reporting them; allocations
+ * and frees still count. Only for locks inside third-party code that are
+ * uncontended while rendering, such as the CriticalSection juce::Synthesiser
+ * takes around every render (other threads only take it while a sampler's
+ * sound list is edited). Does not nest.
+ */
+class ScopedRealtimeLockExemption
+{
+public:
+   #if AUDIO_REALTIME_CHECKS
+    ScopedRealtimeLockExemption() noexcept { RealtimeSafety::detail::exemptLocks(true); }
+    ~ScopedRealtimeLockExemption() noexcept { RealtimeSafety::detail::exemptLocks(false); }
+   #else
+    ScopedRealtimeLockExemption() noexcept {}
+   #endif
+
+    ScopedRealtimeLockExemption(const ScopedRealtimeLockExemption&) = delete;
+    ScopedRealtimeLockExemption& operator=(const ScopedRealtimeLockExemption&) = delete;
+};
@@ -0,0 +1,216 @@
+/**
+ * RealtimeSafetyHooks - Reports allocations, frees and locks to
+ * RealtimeSafety. Link this file into a binary (a test, or a debug app
+ * build) to turn checking on there; everything else only pays for the
+ * ScopedRealtimeContext bookkeeping.
+ *
+ * On glibc, malloc/calloc/realloc/free and the aligned allocators are
+ * replaced (forwarding to glibc's __libc_* entry points), which also covers
+ * operator new and juce::HeapBlock, and blocking pthread mutex, rwlock and
+ * condition variable calls are intercepted. Elsewhere the global operator
+ * new/delete are replaced, so plain malloc and locks go unseen.
+ *
+ * Hooks report before forwarding and do nothing outside a realtime context.
+ */
+#include "RealtimeSafety.h"
+
+#if AUDIO_REALTIME_CHECKS
+
+#include <cstdlib>
+#include <new>
+
+using RealtimeSafety::ViolationType;
+
+namespace
+{
+    struct HookInstaller
+    {
+        HookInstaller() { RealtimeSafety::markHooksInstalled(); }
+    } hookInstaller;
+}
+
+#if defined(__GLIBC__)
+
+#include <atomic>
+#include <dlfcn.h>
+#include <pthread.h>
+
+// ──────────────────────────────────────────
+// glibc allocator
+// ──────────────────────────────────────────
+extern "C"
+{
+    void* __libc_malloc(size_t);
+    void* __libc_calloc(size_t, size_t);
+    void* __libc_realloc(void*, size_t);
+    void* __libc_memalign(size_t, size_t);
+    void __libc_free(void*);
+
+    void* malloc(size_t size)
+    {
+        RealtimeSafety::report(ViolationType::Allocation);
+        return __libc_malloc(size);
+    }
+
+    void* calloc(size_t count, size_t size)
+    {
+        RealtimeSafety::report(ViolationType::Allocation);
+        return __libc_calloc(count, size);
+    }
+
+    void* realloc(void* pointer, size_t size)
+    {
+        RealtimeSafety::report(ViolationType::Allocation);
+        return __libc_realloc(pointer, size);
+    }
+
+    void free(void* pointer)
+    {
+        if (pointer != nullptr)
+            RealtimeSafety::report(ViolationType::Deallocation);
+        __libc_free(pointer);
+    }
+
+    void* memalign(size_t alignment, size_t size)
+    {
+        RealtimeSafety::report(ViolationType::Allocation);
+        return __libc_memalign(alignment, size);
+    }
+
+    void* aligned_alloc(size_t alignment, size_t size)
+    {
+        RealtimeSafety::report(ViolationType::Allocation);
+        return __libc_memalign(alignment, size);
+    }
+
+    int posix_memalign(void** result, size_t alignment, size_t size)
+    {
+        RealtimeSafety::report(ViolationType::Allocation);
+        if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0)
+            return 22; // EINVAL
+
+        *result = __libc_memalign(alignment, size);
+        return *result != nullptr || size == 0 ? 0 : 12; // ENOMEM
+    }
+}
+
+// ──────────────────────────────────────────
+// pthread locks
+// ──────────────────────────────────────────
+namespace
+{
+    // The real functions, looked up on first use. No function-local statics:
+    // their initialisation guard could itself take a lock and come back here.
+    // dlsym may allocate, which goes straight to glibc outside a render.
+    template <typename Function>
+    Function next(std::atomic<Function>& cached, const char* name)
+    {
+        auto function = cached.load(std::memory_order_relaxed);
+        if (function == nullptr)
+        {
+            function = reinterpret_cast<Function>(dlsym(RTLD_NEXT, name));
+            cached.store(function, std::memory_order_relaxed);
+        }
+        return function;
+    }
+
+    std::atomic<int (*)(pthread_mutex_t*)> realMutexLock { nullptr };
+    std::atomic<int (*)(pthread_rwlock_t*)> realReadLock { nullptr };
+    std::atomic<int (*)(pthread_rwlock_t*)> realWriteLock { nullptr };
+    std::atomic<int (*)(pthread_cond_t*, pthread_mutex_t*)> realConditionWait { nullptr };
+    std::atomic<int (*)(pthread_cond_t*, pthread_mutex_t*, const timespec*)> realConditionTimedWait { nullptr };
+}
+
+extern "C"
+{
+    int pthread_mutex_lock(pthread_mutex_t* mutex)
+    {
+        RealtimeSafety::report(ViolationType::Lock);
+        return next(realMutexLock, "pthread_mutex_lock")(mutex);
+    }
+
+    int pthread_rwlock_rdlock(pthread_rwlock_t* lock)
+    {
+        RealtimeSafety::report(ViolationType::Lock);
+        return next(realReadLock, "pthread_rwlock_rdlock")(lock);
+    }
+
+    int pthread_rwlock_wrlock(pthread_rwlock_t* lock)
+    {
+        RealtimeSafety::report(ViolationType::Lock);
+        return next(realWriteLock, "pthread_rwlock_wrlock")(lock);
+    }
+
+    int pthread_cond_wait(pthread_cond_t* condition, pthread_mutex_t* mutex)
+    {
+        RealtimeSafety::report(ViolationType::Lock);
+        return next(realConditionWait, "pthread_cond_wait")(condition, mutex);
+    }
+
+    int pthread_cond_timedwait(pthread_cond_t* condition, pthread_mutex_t* mutex, const timespec* time)
+    {
+        RealtimeSafety::report(ViolationType::Lock);
+        return next(realConditionTimedWait, "pthread_cond_timedwait")(condition, mutex, time);
+    }
+}
+
+#else
+
+// ──────────────────────────────────────────
+// operator new/delete
+// ──────────────────────────────────────────
+namespace
+{
+    void* allocate(std::size_t size)
+    {
+        RealtimeSafety::report(ViolationType::Allocation);
+        if (auto* pointer = std::malloc(size != 0 ? size : 1))
+            return pointer;
+        throw std::bad_alloc();
+    }
+
+    void* allocateAligned(std::size_t size, std::align_val_t alignment)
+    {
+        RealtimeSafety::report(ViolationType::Allocation);
+        const auto align = static_cast<std::size_t>(alignment);
+        void* pointer = nullptr;
+        if (posix_memalign(&pointer, align < sizeof(void*) ? sizeof(void*) : align, size != 0 ? size : 1) == 0)
+            return pointer;
+        throw std::bad_alloc();
+    }
+
+    void deallocate(void* pointer) noexcept
+    {
+        if (pointer != nullptr)
+            RealtimeSafety::report(ViolationType::Deallocation);
+        std::free(pointer);
+    }
+}
+
+void* operator new(std::size_t size) { return allocate(size); }
+void* operator new[](std::size_t size) { return allocate(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    try { return allocate(size); } catch (...) { return nullptr; }
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    try { return allocate(size); } catch (...) { return nullptr; }
+}
+void* operator new(std::size_t size, std::align_val_t alignment) { return allocateAligned(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return allocateAligned(size, alignment); }
+
+void operator delete(void* pointer) noexcept { deallocate(pointer); }
+void operator delete[](void* pointer) noexcept { deallocate(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { deallocate(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { deallocate(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { deallocate(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { deallocate(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept { deallocate(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { deallocate(pointer); }
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept { deallocate(pointer); }
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept { deallocate(pointer); }
+
+#endif
+
+#endif
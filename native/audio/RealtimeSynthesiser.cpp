@@ -0,0 +1,60 @@
+#include "RealtimeSynthesiser.h"
+
+juce::SynthesiserVoice* RealtimeSynthesiser::findVoiceToSteal(juce::SynthesiserSound* soundToPlay,
+                                                              int /*midiChannel*/,
+                                                              int midiNoteNumber) const
+{
+    jassert(!voices.isEmpty());
+    
+    // Lowest and highest sounding notes that are still held; only stolen
+    // when nothing else is left
+    juce::SynthesiserVoice* low = nullptr;
+    juce::SynthesiserVoice* top = nullptr;
+    
+    for (auto* voice : voices)
+    {
+        if (!voice->canPlaySound(soundToPlay) || voice->isPlayingButReleased())
+            continue;
+        
+        const auto note = voice->getCurrentlyPlayingNote();
+        if (low == nullptr || note < low->getCurrentlyPlayingNote())
+            low = voice;
+        if (top == nullptr || note > top->getCurrentlyPlayingNote())
+            top = voice;
+    }
+    
+    // With a single held note, that one is the one to protect
+    if (top == low)
+        top = nullptr;
+    
+    // The voice that started first among those matching a condition
+    const auto oldest = [this, soundToPlay](auto&& condition) -> juce::SynthesiserVoice*
+    {
+        juce::SynthesiserVoice* found = nullptr;
+        for (auto* voice : voices)
+        {
+            if (voice->canPlaySound(soundToPlay) && condition(voice)
+                && (found == nullptr || voice->wasStartedBefore(*found)))
+                found = voice;
+        }
+        return found;
+    };
+    
+    const auto isUnprotected = [low, top](const juce::SynthesiserVoice* voice) { return voice != low && voice != top; };
+    
+    if (auto* voice = oldest([midiNoteNumber](auto* v) { return v->getCurrentlyPlayingNote() == midiNoteNumber; }))
+        return voice;
+    
+    if (auto* voice = oldest([&](auto* v) { return isUnprotected(v) && v->isPlayingButReleased(); }))
+        return voice;
+    
+    if (auto* voice = oldest([&](auto* v) { return isUnprotected(v) && !v->isKeyDown(); }))
+        return voice;
+    
+    if (auto* voice = oldest(isUnprotected))
+        return voice;
+    
+    // Only protected voices left: keep the bass note
+    jassert(low != nullptr);
+    return top != nullptr ? top : low;
+}
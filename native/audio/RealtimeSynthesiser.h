@@ -0,0 +1,21 @@
+#pragma once
+#include "JuceHeader.h"
+
+/**
+ * RealtimeSynthesiser - juce::Synthesiser with voice stealing that doesn't
+ * touch the heap.
+ *
+ * The stock findVoiceToSteal() empties a member Array with clear(), which
+ * frees its storage, and grows it again every time a note has to steal a
+ * voice. This keeps the same heuristics (same-note voice first, then the
+ * oldest released, unheld and unprotected voices, protecting the lowest and
+ * highest held notes) but picks the oldest candidate with a scan instead of
+ * a sorted list.
+ */
+class RealtimeSynthesiser : public juce::Synthesiser
+{
+protected:
+    juce::SynthesiserVoice* findVoiceToSteal(juce::SynthesiserSound* soundToPlay,
+                                             int midiChannel,
+                                             int midiNoteNumber) const override;
+};
@@ -0,0 +1,254 @@
+#include "SendBuses.h"
+#include <cmath>
+#include <limits>
+
+namespace
+{
+    constexpr float unsetParameter = std::numeric_limits<float>::quiet_NaN();
+}
+
+SendBuses::SendBuses(RealtimeReclaimer& reclaimerToUse)
+    : reclaimer(reclaimerToUse)
+{
+    for (auto& bus : buses)
+    {
+        for (auto& parameter : bus.parameters)
+            parameter.store(unsetParameter, std::memory_order_relaxed);
+        for (auto& level : bus.sendLevels)
+            level.store(0.0f, std::memory_order_relaxed);
+    }
+}
+
+SendBuses::~SendBuses() = default;
+
+void SendBuses::prepare(double sampleRate, int maximumBlockSize)
+{
+    currentSampleRate = sampleRate;
+    currentBlockSize = maximumBlockSize;
+
+    for (auto& bus : buses)
+    {
+        if (bus.ownedEffect != nullptr)
+            bus.ownedEffect->processor->prepareToPlay(sampleRate, maximumBlockSize);
+
+        bus.buffer.setSize(2, maximumBlockSize);
+        bus.buffer.clear();
+        bus.dirtySamples = 0;
+
+        // Start at the current levels rather than ramping up from silence
+        for (size_t channel = 0; channel < bus.sends.size(); ++channel)
+        {
+            auto& send = bus.sends[channel];
+            send.reset(sampleRate, SmoothedGain::defaultRampSeconds);
+            send.setCurrentAndTargetValue(bus.sendLevels[channel].load(std::memory_order_relaxed));
+        }
+
+        bus.returnGain.setTargetValue(bus.returnLevel.load(std::memory_order_relaxed));
+        bus.returnGain.prepare(sampleRate, maximumBlockSize);
+        bus.returnGain.snapToTarget();
+
+        // Reapply parameters to the freshly prepared effect
+        bus.appliedVersion = bus.parametersVersion.load(std::memory_order_relaxed) - 1;
+    }
+}
+
+// ──────────────────────────────────────────
+// Settings
+// ──────────────────────────────────────────
+
+bool SendBuses::setEffect(int busIndex, Instrument::EffectType type)
+{
+    if (!isValidBus(busIndex))
+        return false;
+
+    auto processor = Instrument::createEffect(type);
+    if (processor == nullptr)
+        return false;
+
+    processor->prepareToPlay(currentSampleRate, currentBlockSize);
+
+    auto& bus = buses[static_cast<size_t>(busIndex)];
+
+    // Parameters set for the previous effect don't carry over
+    for (auto& parameter : bus.parameters)
+        parameter.store(unsetParameter, std::memory_order_relaxed);
+
+    if (type == Instrument::EffectType::Reverb)
+        bus.parameters[static_cast<size_t>(Instrument::EffectParameter::DryLevel)].store(0.0f, std::memory_order_relaxed);
+    else if (type == Instrument::EffectType::Delay)
+        bus.parameters[static_cast<size_t>(Instrument::EffectParameter::WetLevel)].store(1.0f, std::memory_order_relaxed);
+
+    // Nothing renders the new effect yet, so it can be set up here
+    for (int param = 0; param < numParameters; ++param)
+    {
+        const auto value = bus.parameters[static_cast<size_t>(param)].load(std::memory_order_relaxed);
+        if (!std::isnan(value))
+            Instrument::applyEffectParameter(*processor, type, static_cast<Instrument::EffectParameter>(param), value);
+    }
+
+    auto effect = std::make_unique<Effect>();
+    effect->type = type;
+    effect->processor = std::move(processor);
+    publishEffect(bus, std::move(effect));
+
+    bus.parametersVersion.fetch_add(1, std::memory_order_release);
+    return true;
+}
+
+void SendBuses::clearEffect(int busIndex)
+{
+    if (isValidBus(busIndex))
+        publishEffect(buses[static_cast<size_t>(busIndex)], nullptr);
+}
+
+bool SendBuses::hasEffect(int busIndex) const
+{
+    return isValidBus(busIndex) && buses[static_cast<size_t>(busIndex)].ownedEffect != nullptr;
+}
+
+void SendBuses::publishEffect(Bus& bus, std::unique_ptr<Effect> effect)
+{
+    bus.effectType.store(effect != nullptr ? static_cast<int>(effect->type) : -1, std::memory_order_relaxed);
+    bus.effect.store(effect.get(), std::memory_order_release);
+    std::swap(bus.ownedEffect, effect);
+
+    // effect now holds the replaced one
+    reclaimer.retire(std::move(effect));
+}
+
+void SendBuses::setEffectParameter(int busIndex, Instrument::EffectParameter param, float value)
+{
+    if (!isValidBus(busIndex) || param == Instrument::EffectParameter::Unknown || std::isnan(value))
+        return;
+
+    auto& bus = buses[static_cast<size_t>(busIndex)];
+    bus.parameters[static_cast<size_t>(param)].store(value, std::memory_order_relaxed);
+    bus.parametersVersion.fetch_add(1, std::memory_order_release);
+}
+
+void SendBuses::setReturnLevel(int busIndex, float level)
+{
+    if (isValidBus(busIndex))
+        buses[static_cast<size_t>(busIndex)].returnLevel.store(juce::jlimit(0.0f, 1.0f, level), std::memory_order_relaxed);
+}
+
+void SendBuses::setSendLevel(int channel, int busIndex, float level)
+{
+    if (isValidBus(busIndex) && channel >= 0 && channel < numChannels)
+        buses[static_cast<size_t>(busIndex)].sendLevels[static_cast<size_t>(channel)]
+            .store(juce::jlimit(0.0f, 1.0f, level), std::memory_order_relaxed);
+}
+
+// ──────────────────────────────────────────
+// Audio thread
+// ──────────────────────────────────────────
+
+void SendBuses::beginBlock()
+{
+    for (auto& bus : buses)
+    {
+        // Whatever is loaded here stays alive until the reclaimer's callback ends
+        bus.activeEffect = bus.effect.load(std::memory_order_acquire);
+
+        const auto version = bus.parametersVersion.load(std::memory_order_acquire);
+        if (version != bus.appliedVersion && bus.activeEffect != nullptr)
+        {
+            for (int param = 0; param < numParameters; ++param)
+            {
+                const auto value = bus.parameters[static_cast<size_t>(param)].load(std::memory_order_relaxed);
+                if (!std::isnan(value))
+                    Instrument::applyEffectParameter(*bus.activeEffect->processor, bus.activeEffect->type,
+                                                     static_cast<Instrument::EffectParameter>(param), value);
+            }
+            bus.appliedVersion = version;
+        }
+
+        if (bus.dirtySamples > 0)
+            bus.buffer.clear(0, bus.dirtySamples);
+        bus.dirtySamples = 0;
+        bus.hasInput = false;
+
+        for (size_t channel = 0; channel < bus.sends.size(); ++channel)
+            bus.sends[channel].setTargetValue(bus.sendLevels[channel].load(std::memory_order_relaxed));
+    }
+}
+
+void SendBuses::addChannel(int channel, const juce::AudioBuffer<float>& source, int numSamples)
+{
+    jassert(channel >= 0 && channel < numChannels);
+
+    for (auto& bus : buses)
+    {
+        if (bus.activeEffect == nullptr)
+            continue;
+
+        // Ramp across the block while the level glides
+        auto& send = bus.sends[static_cast<size_t>(channel)];
+        const auto startGain = send.getCurrentValue();
+        const auto endGain = send.skip(numSamples);
+        if (startGain == 0.0f && endGain == 0.0f)
+            continue;
+
+        const auto numChannelsToSend = juce::jmin(source.getNumChannels(), bus.buffer.getNumChannels());
+        for (int ch = 0; ch < numChannelsToSend; ++ch)
+            bus.buffer.addFromWithRamp(ch, 0, source.getReadPointer(ch), numSamples, startGain, endGain);
+
+        bus.hasInput = true;
+        bus.dirtySamples = numSamples;
+    }
+}
+
+int SendBuses::process(juce::AudioBuffer<float>& output, int numSamples)
+{
+    int effectsAsleep = 0;
+
+    for (auto& bus : buses)
+    {
+        auto* effect = bus.activeEffect;
+        if (effect == nullptr)
+            continue;
+
+        // Nothing sent and the tail has died away: skip it like a channel effect
+        if (!bus.hasInput && !effect->processor->isTailActive())
+        {
+            ++effectsAsleep;
+            continue;
+        }
+
+        juce::AudioBuffer<float> block(bus.buffer.getArrayOfWritePointers(), bus.buffer.getNumChannels(), numSamples);
+        {
+            const ScopedRenderTimer timer(bus.timing);
+            effect->processor->processBlock(block);
+        }
+        bus.dirtySamples = numSamples;
+
+        bus.returnGain.setTargetValue(bus.returnLevel.load(std::memory_order_relaxed));
+        bus.returnGain.process(juce::dsp::AudioBlock<float>(block));
+
+        for (int ch = 0; ch < juce::jmin(output.getNumChannels(), block.getNumChannels()); ++ch)
+            output.addFrom(ch, 0, block, ch, 0, numSamples);
+    }
+
+    return effectsAsleep;
+}
+
+void SendBuses::resetTimings()
+{
+    for (auto& bus : buses)
+        bus.timing.reset();
+}
+
+std::vector<SendBuses::BusTiming> SendBuses::getTimings() const
+{
+    std::vector<BusTiming> timings;
+
+    for (int index = 0; index < numBuses; ++index)
+    {
+        const auto& bus = buses[static_cast<size_t>(index)];
+        const auto type = bus.effectType.load(std::memory_order_relaxed);
+        if (type >= 0)
+            timings.push_back({ index, static_cast<Instrument::EffectType>(type), bus.timing.getSummary() });
+    }
+
+    return timings;
+}
@@ -0,0 +1,126 @@
+#pragma once
+#include "JuceHeader.h"
+#include "Instrument.h"
+#include "RealtimeReclaimer.h"
+#include "SmoothedGain.h"
+#include "TimingHistogram.h"
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+/**
+ * SendBuses - A few shared effect buses that every channel can send into.
+ *
+ * Each bus holds one effect. A channel sends its post-fader output to a bus
+ * at its send level; the bus runs its effect once on the sum and adds the
+ * result, at the bus's return level, to the mix ahead of the master bus. One
+ * reverb can so serve the whole session, however many channels use it.
+ *
+ * A return carries only the effected signal (the dry sound already reaches
+ * the mix through the channel), so a new reverb starts with its dry level at
+ * 0 and a new delay fully wet.
+ *
+ * Settings are written from the control thread into atomics and picked up at
+ * the start of the next block, like MasterBus. Effects are built and prepared
+ * on the control thread, published with one atomic store and retired through
+ * the reclaimer. Send and return levels glide instead of jumping. A bus whose
+ * sends are silent sleeps once its effect tail has rung out.
+ *
+ * Buses and channels are 0-based here.
+ */
+class SendBuses
+{
+public:
+    static constexpr int numBuses = 4;
+    static constexpr int numChannels = 16;
+
+    explicit SendBuses(RealtimeReclaimer& reclaimer);
+    ~SendBuses();
+
+    /** Not on the audio thread. */
+    void prepare(double sampleRate, int maximumBlockSize);
+
+    // ──────────────────────────────────────────
+    // Settings (control thread)
+    // ──────────────────────────────────────────
+
+    /** Replace the bus's effect; false if the type isn't implemented. */
+    bool setEffect(int bus, Instrument::EffectType type);
+    void clearEffect(int bus);
+    bool hasEffect(int bus) const;
+
+    void setEffectParameter(int bus, Instrument::EffectParameter param, float value);
+    void setReturnLevel(int bus, float level);    // 0.0 to 1.0
+    void setSendLevel(int channel, int bus, float level);
+
+    // ──────────────────────────────────────────
+    // Audio thread
+    // ──────────────────────────────────────────
+
+    /** Pick up new settings and empty the buses. */
+    void beginBlock();
+
+    /** Send a channel's rendered block to every bus it feeds. */
+    void addChannel(int channel, const juce::AudioBuffer<float>& buffer, int numSamples);
+
+    /** Run the bus effects and add their returns to output; returns how many slept. */
+    int process(juce::AudioBuffer<float>& output, int numSamples);
+
+    void resetTimings();
+
+    // ──────────────────────────────────────────
+    // Reporting (any thread)
+    // ──────────────────────────────────────────
+    struct BusTiming
+    {
+        int bus;
+        Instrument::EffectType type;
+        TimingHistogram::Summary summary;
+    };
+
+    /** Effect time of each bus that has an effect. */
+    std::vector<BusTiming> getTimings() const;
+
+private:
+    static constexpr int numParameters = Instrument::numEffectParameters;
+
+    struct Effect
+    {
+        Instrument::EffectType type;
+        std::unique_ptr<Instrument::EffectProcessor> processor;
+    };
+
+    struct Bus
+    {
+        // Control thread; the audio thread reads the published pointer
+        std::unique_ptr<Effect> ownedEffect;
+        std::atomic<Effect*> effect { nullptr };
+        std::atomic<int> effectType { -1 };
+
+        // Written by setters, read at block start. Parameters never set are NaN.
+        std::array<std::atomic<float>, numParameters> parameters;
+        std::atomic<juce::uint32> parametersVersion { 0 };
+        std::atomic<float> returnLevel { 1.0f };
+        std::array<std::atomic<float>, numChannels> sendLevels;
+
+        // Audio thread state
+        Effect* activeEffect = nullptr;
+        juce::uint32 appliedVersion = 0;
+        std::array<juce::SmoothedValue<float>, numChannels> sends;
+        SmoothedGain returnGain;
+        juce::AudioBuffer<float> buffer;
+        int dirtySamples = 0;
+        bool hasInput = false;
+        TimingHistogram timing;
+    };
+
+    void publishEffect(Bus& bus, std::unique_ptr<Effect> effect);
+    static bool isValidBus(int bus) { return bus >= 0 && bus < numBuses; }
+
+    RealtimeReclaimer& reclaimer;
+    std::array<Bus, numBuses> buses;
+
+    double currentSampleRate = 44100.0;
+    int currentBlockSize = 512;
+};
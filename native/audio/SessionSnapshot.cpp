@@ -0,0 +1,557 @@
+#include "SessionSnapshot.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace
+{
+    constexpr char magic[8] = { 'R', 'N', 'A', 'L', 'S', 'N', 'A', 'P' };
+    constexpr juce::int64 headerSize = 32;  // magic, version, alignment, metadata size, reserved
+
+    // Sanity limits for untrusted files
+    constexpr int maxEffectsPerChannel = 256;
+    constexpr int maxSampleChannels = 32;
+    constexpr int maxSequenceEvents = 1 << 20;
+
+    juce::int64 alignUp(juce::int64 offset)
+    {
+        const auto alignment = static_cast<juce::int64>(SessionSnapshot::payloadAlignment);
+        return (offset + alignment - 1) / alignment * alignment;
+    }
+
+    juce::int64 getPayloadSize(const SampleData& data)
+    {
+        return static_cast<juce::int64>(data.buffer.getNumChannels())
+             * data.buffer.getNumSamples() * static_cast<juce::int64>(sizeof(float));
+    }
+
+    bool writePadding(juce::OutputStream& out, juce::int64 toPosition)
+    {
+        return out.writeRepeatedByte(0, static_cast<size_t>(toPosition - out.getPosition()));
+    }
+
+    void writeAdsr(juce::OutputStream& out, const juce::ADSR::Parameters& adsr)
+    {
+        out.writeFloat(adsr.attack);
+        out.writeFloat(adsr.decay);
+        out.writeFloat(adsr.sustain);
+        out.writeFloat(adsr.release);
+    }
+
+    /** Reads metadata, going invalid instead of running past the end. */
+    class MetadataReader
+    {
+    public:
+        MetadataReader(const void* data, size_t size) : stream(data, size, false) {}
+
+        bool isValid() const { return valid; }
+        void fail() { valid = false; }
+
+        int readInt() { return need(4) ? stream.readInt() : 0; }
+        juce::int64 readInt64() { return need(8) ? stream.readInt64() : 0; }
+        float readFloat() { return need(4) ? stream.readFloat() : 0.0f; }
+        double readDouble() { return need(8) ? stream.readDouble() : 0.0; }
+        bool readBool() { return need(1) && stream.readByte() != 0; }
+        juce::String readString() { return need(1) ? stream.readString() : juce::String(); }
+
+        /** A count or enum value that must lie in [0, limit]. */
+        int readIndex(int limit)
+        {
+            const auto value = readInt();
+            if (value < 0 || value > limit)
+                valid = false;
+            return valid ? value : 0;
+        }
+
+        juce::ADSR::Parameters readAdsr()
+        {
+            juce::ADSR::Parameters adsr;
+            adsr.attack = readFloat();
+            adsr.decay = readFloat();
+            adsr.sustain = readFloat();
+            adsr.release = readFloat();
+            return adsr;
+        }
+
+    private:
+        bool need(juce::int64 numBytes)
+        {
+            if (stream.getNumBytesRemaining() < numBytes)
+                valid = false;
+            return valid;
+        }
+
+        juce::MemoryInputStream stream;
+        bool valid = true;
+    };
+
+    // Touch one float per page so the start of the sample is resident
+    void prefetch(const SampleData& data)
+    {
+        constexpr int floatsPerPage = 4096 / static_cast<int>(sizeof(float));
+        const auto numFrames = juce::jmin(data.buffer.getNumSamples(),
+                                          static_cast<int>(SessionSnapshot::prefetchBytesPerSample / sizeof(float)));
+        volatile float sink = 0.0f;
+
+        for (int channel = 0; channel < data.buffer.getNumChannels(); ++channel)
+        {
+            const auto* frames = data.buffer.getReadPointer(channel);
+            for (int frame = 0; frame < numFrames; frame += floatsPerPage)
+                sink = frames[frame];
+        }
+        juce::ignoreUnused(sink);
+    }
+}
+
+// ──────────────────────────────────────────
+// Channel state
+// ──────────────────────────────────────────
+
+void SessionSnapshot::Effect::setParameter(Instrument::EffectParameter param, float value)
+{
+    for (auto& [existing, existingValue] : parameters)
+    {
+        if (existing == param)
+        {
+            existingValue = value;
+            return;
+        }
+    }
+    parameters.emplace_back(param, value);
+}
+
+void SessionSnapshot::Channel::clearInstrument()
+{
+    type = ChannelType::Empty;
+    oscillator = Config();
+    sampler = MultiSamplerConfig::Config();
+    effects.clear();
+    samples.clear();
+}
+
+SessionSnapshot::Effect* SessionSnapshot::Channel::findEffect(int effectId)
+{
+    for (auto& effect : effects)
+    {
+        if (effect.id == effectId)
+            return &effect;
+    }
+    return nullptr;
+}
+
+void SessionSnapshot::Channel::setSample(int slot, const MultiSamplerConfig::SampleConfig& config,
+                                         std::shared_ptr<const SampleData> data)
+{
+    removeSample(slot);
+
+    Sample sample;
+    sample.slot = slot;
+    sample.config = config;
+    sample.data = std::move(data);
+
+    const auto position = std::find_if(samples.begin(), samples.end(),
+                                       [slot](const Sample& other) { return other.slot > slot; });
+    samples.insert(position, std::move(sample));
+}
+
+void SessionSnapshot::Channel::removeSample(int slot)
+{
+    samples.erase(std::remove_if(samples.begin(), samples.end(),
+                                 [slot](const Sample& sample) { return sample.slot == slot; }),
+                  samples.end());
+}
+
+// ──────────────────────────────────────────
+// Writing
+// ──────────────────────────────────────────
+
+juce::Result SessionSnapshot::write(const juce::File& file) const
+{
+    // Metadata first: it records where each payload will go, relative to
+    // the start of the (aligned) payload section
+    juce::MemoryOutputStream metadata;
+    std::vector<const SampleData*> payloads;
+    juce::int64 payloadOffset = 0;
+
+    metadata.writeFloat(master.gain);
+    for (const auto& band : master.eq)
+    {
+        metadata.writeFloat(band.frequency);
+        metadata.writeFloat(band.gainDb);
+        metadata.writeFloat(band.q);
+    }
+    metadata.writeBool(master.eqEnabled);
+    metadata.writeFloat(master.compressorThresholdDb);
+    metadata.writeFloat(master.compressorRatio);
+    metadata.writeFloat(master.compressorAttackMs);
+    metadata.writeFloat(master.compressorReleaseMs);
+    metadata.writeFloat(master.compressorMakeupDb);
+    metadata.writeBool(master.compressorEnabled);
+    metadata.writeFloat(master.limiterCeilingDb);
+    metadata.writeFloat(master.limiterReleaseMs);
+    metadata.writeBool(master.limiterEnabled);
+
+    metadata.writeInt(static_cast<int>(channels.size()));
+    for (const auto& channel : channels)
+    {
+        metadata.writeInt(static_cast<int>(channel.type));
+
+        if (channel.type == ChannelType::Oscillator)
+        {
+            const auto& config = channel.oscillator;
+            metadata.writeInt(config.polyphony);
+            metadata.writeInt(static_cast<int>(config.waveform));
+            const auto hasWavetable = config.wavetable != nullptr && !config.wavetable->getSourceCycle().empty();
+            metadata.writeBool(hasWavetable);
+            if (hasWavetable)
+                for (const auto sample : config.wavetable->getSourceCycle())
+                    metadata.writeFloat(sample);
+            writeAdsr(metadata, config.adsrParams);
+            metadata.writeFloat(config.volume);
+            metadata.writeFloat(config.pan);
+            metadata.writeFloat(config.detune);
+            metadata.writeString(config.name);
+
+            metadata.writeInt(static_cast<int>(channel.effects.size()));
+            for (const auto& effect : channel.effects)
+            {
+                metadata.writeInt(effect.id);
+                metadata.writeInt(static_cast<int>(effect.type));
+                metadata.writeBool(effect.enabled);
+                metadata.writeInt(effect.sidechainChannel);
+                metadata.writeInt(static_cast<int>(effect.parameters.size()));
+                for (const auto& [param, value] : effect.parameters)
+                {
+                    metadata.writeInt(static_cast<int>(param));
+                    metadata.writeFloat(value);
+                }
+            }
+        }
+        else if (channel.type == ChannelType::MultiSampler)
+        {
+            const auto& config = channel.sampler;
+            metadata.writeInt(config.polyphony);
+            writeAdsr(metadata, config.adsrParams);
+            metadata.writeFloat(config.volume);
+            metadata.writeFloat(config.pan);
+            metadata.writeString(config.name);
+
+            metadata.writeInt(static_cast<int>(channel.samples.size()));
+            for (const auto& sample : channel.samples)
+            {
+                jassert(sample.data != nullptr);
+                metadata.writeInt(sample.slot);
+                metadata.writeString(sample.config.name);
+                metadata.writeInt(sample.config.rootNote);
+                metadata.writeInt(sample.config.minNote);
+                metadata.writeInt(sample.config.maxNote);
+                metadata.writeDouble(sample.data->sampleRate);
+                metadata.writeInt(sample.data->buffer.getNumChannels());
+                metadata.writeInt(sample.data->buffer.getNumSamples());
+                metadata.writeInt64(payloadOffset);
+
+                payloads.push_back(sample.data.get());
+                payloadOffset = alignUp(payloadOffset + getPayloadSize(*sample.data));
+            }
+        }
+
+        metadata.writeDouble(channel.sequenceDurationMs);
+        metadata.writeInt(static_cast<int>(channel.sequence.size()));
+        for (const auto& event : channel.sequence)
+        {
+            metadata.writeDouble(event.timeMs);
+            metadata.writeBool(event.isNoteOn);
+            metadata.writeInt(event.note);
+            metadata.writeFloat(event.velocity);
+        }
+    }
+
+    metadata.writeInt(static_cast<int>(sendBuses.size()));
+    for (const auto& bus : sendBuses)
+    {
+        metadata.writeBool(bus.hasEffect);
+        metadata.writeInt(static_cast<int>(bus.effect.type));
+        metadata.writeFloat(bus.returnLevel);
+        metadata.writeInt(static_cast<int>(bus.effect.parameters.size()));
+        for (const auto& [param, value] : bus.effect.parameters)
+        {
+            metadata.writeInt(static_cast<int>(param));
+            metadata.writeFloat(value);
+        }
+    }
+
+    for (const auto& channel : channels)
+    {
+        for (const auto level : channel.sendLevels)
+            metadata.writeFloat(level);
+    }
+
+    // Write next to the target and swap it in, so a failed save never
+    // leaves a half-written session behind
+    juce::TemporaryFile temporary(file);
+    {
+        juce::FileOutputStream out(temporary.getFile());
+        if (out.failedToOpen())
+            return out.getStatus();
+
+        out.write(magic, sizeof(magic));
+        out.writeInt(static_cast<int>(currentVersion));
+        out.writeInt(static_cast<int>(payloadAlignment));
+        out.writeInt64(static_cast<juce::int64>(metadata.getDataSize()));
+        out.writeInt64(0);
+        out.write(metadata.getData(), metadata.getDataSize());
+
+        const auto payloadBase = alignUp(out.getPosition());
+        payloadOffset = 0;
+
+        for (const auto* data : payloads)
+        {
+            writePadding(out, payloadBase + payloadOffset);
+            for (int channel = 0; channel < data->buffer.getNumChannels(); ++channel)
+                out.write(data->buffer.getReadPointer(channel),
+                          static_cast<size_t>(data->buffer.getNumSamples()) * sizeof(float));
+
+            payloadOffset = alignUp(payloadOffset + getPayloadSize(*data));
+        }
+
+        out.flush();
+        if (out.getStatus().failed())
+            return out.getStatus();
+    }
+
+    if (!temporary.overwriteTargetFileWithTemporary())
+        return juce::Result::fail("Couldn't replace " + file.getFullPathName());
+
+    return juce::Result::ok();
+}
+
+// ──────────────────────────────────────────
+// Reading
+// ──────────────────────────────────────────
+
+juce::Result SessionSnapshot::read(const juce::File& file, SessionSnapshot& snapshot)
+{
+   #if JUCE_BIG_ENDIAN
+    // Payloads are raw little-endian floats
+    return juce::Result::fail("Session snapshots need a little-endian CPU");
+   #endif
+
+    juce::FileInputStream in(file);
+    if (in.failedToOpen())
+        return in.getStatus();
+
+    char fileMagic[sizeof(magic)] {};
+    if (in.read(fileMagic, sizeof(fileMagic)) != static_cast<int>(sizeof(fileMagic))
+        || std::memcmp(fileMagic, magic, sizeof(magic)) != 0)
+        return juce::Result::fail("Not a session snapshot");
+
+    const auto version = static_cast<juce::uint32>(in.readInt());
+    if (version == 0 || version > currentVersion)
+        return juce::Result::fail("Unsupported session snapshot version " + juce::String(version));
+
+    const auto alignment = static_cast<juce::uint32>(in.readInt());
+    const auto metadataSize = in.readInt64();
+    in.readInt64();
+
+    const auto fileSize = in.getTotalLength();
+    if (alignment == 0 || metadataSize < 0 || headerSize + metadataSize > fileSize)
+        return juce::Result::fail("Corrupt session snapshot header");
+
+    juce::MemoryBlock metadataBlock;
+    if (in.readIntoMemoryBlock(metadataBlock, static_cast<ssize_t>(metadataSize)) != static_cast<size_t>(metadataSize))
+        return juce::Result::fail("Truncated session snapshot");
+
+    // The payload section starts on the first boundary after the metadata
+    const auto payloadBase = (headerSize + metadataSize + alignment - 1) / alignment * alignment;
+
+    MetadataReader reader(metadataBlock.getData(), metadataBlock.getSize());
+    SessionSnapshot result;
+
+    struct PendingSample
+    {
+        Sample* sample;
+        double sampleRate;
+        int numChannels;
+        int numFrames;
+        juce::int64 offset;
+    };
+    std::vector<std::pair<int, PendingSample>> pending;   // channel index, sample
+
+    auto& master = result.master;
+    master.gain = reader.readFloat();
+    for (auto& band : master.eq)
+    {
+        band.frequency = reader.readFloat();
+        band.gainDb = reader.readFloat();
+        band.q = reader.readFloat();
+    }
+    master.eqEnabled = reader.readBool();
+    master.compressorThresholdDb = reader.readFloat();
+    master.compressorRatio = reader.readFloat();
+    master.compressorAttackMs = reader.readFloat();
+    master.compressorReleaseMs = reader.readFloat();
+    master.compressorMakeupDb = reader.readFloat();
+    master.compressorEnabled = reader.readBool();
+    master.limiterCeilingDb = reader.readFloat();
+    master.limiterReleaseMs = reader.readFloat();
+    master.limiterEnabled = reader.readBool();
+
+    const auto numChannels = reader.readIndex(static_cast<int>(result.channels.size()));
+    for (int index = 0; index < numChannels && reader.isValid(); ++index)
+    {
+        auto& channel = result.channels[static_cast<size_t>(index)];
+        channel.type = static_cast<ChannelType>(reader.readIndex(static_cast<int>(ChannelType::MultiSampler)));
+
+        if (channel.type == ChannelType::Oscillator)
+        {
+            auto& config = channel.oscillator;
+            config.polyphony = reader.readIndex(256);
+            config.waveform = static_cast<BaseOscillatorVoice::Waveform>(
+                reader.readIndex(static_cast<int>(BaseOscillatorVoice::Waveform::Wavetable)));
+            if (version >= 4 && reader.readBool())
+            {
+                std::array<float, Wavetable::tableSize> cycle {};
+                for (auto& sample : cycle)
+                    sample = reader.readFloat();
+                config.wavetable = Wavetable::fromCycle(cycle.data(), Wavetable::tableSize);
+                if (config.wavetable == nullptr)
+                    reader.fail();
+            }
+            config.adsrParams = reader.readAdsr();
+            config.volume = reader.readFloat();
+            config.pan = reader.readFloat();
+            config.detune = reader.readFloat();
+            config.name = reader.readString();
+
+            const auto numEffects = reader.readIndex(maxEffectsPerChannel);
+            for (int i = 0; i < numEffects && reader.isValid(); ++i)
+            {
+                Effect effect;
+                effect.id = reader.readInt();
+                effect.type = static_cast<Instrument::EffectType>(
+                    reader.readIndex(static_cast<int>(Instrument::EffectType::Compressor)));
+                effect.enabled = reader.readBool();
+                if (version >= 3)
+                    effect.sidechainChannel = reader.readIndex(static_cast<int>(result.channels.size()));
+
+                const auto numParameters = reader.readIndex(Instrument::numEffectParameters);
+                for (int p = 0; p < numParameters && reader.isValid(); ++p)
+                {
+                    const auto param = static_cast<Instrument::EffectParameter>(
+                        reader.readIndex(Instrument::numEffectParameters - 1));
+                    effect.setParameter(param, reader.readFloat());
+                }
+
+                if (effect.id <= 0 || effect.sidechainChannel == index + 1)
+                    reader.fail();
+                channel.effects.push_back(std::move(effect));
+            }
+        }
+        else if (channel.type == ChannelType::MultiSampler)
+        {
+            auto& config = channel.sampler;
+            config.polyphony = reader.readIndex(256);
+            config.adsrParams = reader.readAdsr();
+            config.volume = reader.readFloat();
+            config.pan = reader.readFloat();
+            config.name = reader.readString();
+
+            const auto numSamples = reader.readIndex(16);
+            channel.samples.resize(static_cast<size_t>(numSamples));
+            for (auto& sample : channel.samples)
+            {
+                sample.slot = reader.readIndex(15);
+                sample.config.name = reader.readString();
+                sample.config.rootNote = reader.readIndex(127);
+                sample.config.minNote = reader.readIndex(127);
+                sample.config.maxNote = reader.readIndex(127);
+
+                PendingSample payload { &sample, 0.0, 0, 0, 0 };
+                payload.sampleRate = reader.readDouble();
+                payload.numChannels = reader.readIndex(maxSampleChannels);
+                payload.numFrames = reader.readIndex(std::numeric_limits<int>::max());
+                payload.offset = reader.readInt64();
+
+                if (payload.sampleRate <= 0.0 || payload.numChannels == 0 || payload.numFrames == 0 || payload.offset < 0)
+                    reader.fail();
+                pending.emplace_back(index, payload);
+            }
+        }
+
+        channel.sequenceDurationMs = reader.readDouble();
+        const auto numEvents = reader.readIndex(maxSequenceEvents);
+        channel.sequence.resize(static_cast<size_t>(numEvents));
+        for (auto& event : channel.sequence)
+        {
+            event.timeMs = reader.readDouble();
+            event.isNoteOn = reader.readBool();
+            event.note = reader.readIndex(127);
+            event.velocity = reader.readFloat();
+        }
+    }
+
+    if (version >= 2)
+    {
+        const auto numBuses = reader.readIndex(static_cast<int>(result.sendBuses.size()));
+        for (int index = 0; index < numBuses && reader.isValid(); ++index)
+        {
+            auto& bus = result.sendBuses[static_cast<size_t>(index)];
+            bus.hasEffect = reader.readBool();
+            bus.effect.type = static_cast<Instrument::EffectType>(
+                reader.readIndex(static_cast<int>(Instrument::EffectType::Compressor)));
+            bus.returnLevel = reader.readFloat();
+
+            const auto numParameters = reader.readIndex(Instrument::numEffectParameters);
+            for (int p = 0; p < numParameters && reader.isValid(); ++p)
+            {
+                const auto param = static_cast<Instrument::EffectParameter>(
+                    reader.readIndex(Instrument::numEffectParameters - 1));
+                bus.effect.setParameter(param, reader.readFloat());
+            }
+        }
+
+        for (int index = 0; index < numChannels && reader.isValid(); ++index)
+        {
+            auto& levels = result.channels[static_cast<size_t>(index)].sendLevels;
+            for (int bus = 0; bus < numBuses; ++bus)
+                levels[static_cast<size_t>(bus)] = reader.readFloat();
+        }
+    }
+
+    if (!reader.isValid())
+        return juce::Result::fail("Corrupt session snapshot metadata");
+
+    // Map the file once; every sample's buffer points into the mapping
+    if (!pending.empty())
+    {
+        auto mapping = std::make_shared<const juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readOnly);
+        if (mapping->getData() == nullptr)
+            return juce::Result::fail("Couldn't map " + file.getFullPathName());
+
+        const auto* base = static_cast<const char*>(mapping->getData());
+        const auto mappedSize = static_cast<juce::int64>(mapping->getSize());
+
+        for (auto& [channelIndex, payload] : pending)
+        {
+            const auto start = payloadBase + payload.offset;
+            const auto size = static_cast<juce::int64>(payload.numChannels) * payload.numFrames * static_cast<juce::int64>(sizeof(float));
+            if (start % alignment != 0 || start + size > mappedSize)
+                return juce::Result::fail("Sample data on channel " + juce::String(channelIndex + 1) + " is out of range");
+
+            float* channelData[maxSampleChannels] {};
+            for (int channel = 0; channel < payload.numChannels; ++channel)
+                channelData[channel] = const_cast<float*>(reinterpret_cast<const float*>(base + start)) + static_cast<juce::int64>(channel) * payload.numFrames;
+
+            auto data = std::make_shared<SampleData>();
+            data->buffer.setDataToReferTo(channelData, payload.numChannels, payload.numFrames);
+            data->sampleRate = payload.sampleRate;
+            data->mapping = mapping;
+
+            prefetch(*data);
+            payload.sample->data = std::move(data);
+        }
+    }
+
+    snapshot = std::move(result);
+    return juce::Result::ok();
+}
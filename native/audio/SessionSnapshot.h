@@ -0,0 +1,109 @@
+#pragma once
+#include "JuceHeader.h"
+#include "Instrument.h"
+#include "MultisamplerInstrument.h"
+#include "LoopSequencer.h"
+#include "MasterBus.h"
+#include "SendBuses.h"
+#include <array>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/**
+ * SessionSnapshot - Everything needed to rebuild an engine session: each
+ * channel's instrument config, effect chain and sequence, the master bus
+ * settings, and the decoded frames of every loaded sample.
+ *
+ * On disk it is a versioned binary file:
+ *
+ *   header    "RNALSNAP", version, payload alignment, metadata size
+ *   metadata  master settings, channels (effects, samples, sequences), then
+ *             send buses and send levels, little-endian
+ *   payloads  one block of planar float32 frames per sample, each starting
+ *             on a payloadAlignment boundary
+ *
+ * read() parses the metadata and memory-maps the file instead of decoding
+ * samples: every Sample's data refers straight into the mapping, which stays
+ * open for as long as any of them is in use. Opening a session therefore
+ * costs the same however much audio it holds. Only the first
+ * prefetchBytesPerSample of each sample are touched up front, so note
+ * attacks don't page-fault on the audio thread; the rest is paged in from
+ * the file cache as it plays.
+ */
+class SessionSnapshot
+{
+public:
+    // 2 added send buses, 3 effect sidechains, 4 imported wavetables; older
+    // files load without them
+    static constexpr juce::uint32 currentVersion = 4;
+
+    // The largest page size we run on (Apple silicon), so payloads are
+    // page-aligned in the mapping everywhere
+    static constexpr juce::uint32 payloadAlignment = 16384;
+
+    static constexpr size_t prefetchBytesPerSample = 256 * 1024;
+
+    enum class ChannelType : uint8_t
+    {
+        Empty,
+        Oscillator,
+        MultiSampler
+    };
+
+    struct Effect
+    {
+        int id = 0;
+        Instrument::EffectType type = Instrument::EffectType::Reverb;
+        bool enabled = true;
+        std::vector<std::pair<Instrument::EffectParameter, float>> parameters;  // last value set for each
+        int sidechainChannel = 0;   // channel keying the detector, 0 = own input
+
+        void setParameter(Instrument::EffectParameter param, float value);
+    };
+
+    struct Sample
+    {
+        int slot = 0;
+        MultiSamplerConfig::SampleConfig config;
+        std::shared_ptr<const SampleData> data;
+    };
+
+    struct Channel
+    {
+        ChannelType type = ChannelType::Empty;
+        Config oscillator;                       // when type == Oscillator
+        MultiSamplerConfig::Config sampler;      // when type == MultiSampler
+        std::vector<Effect> effects;             // oscillator only, in chain order
+        std::vector<Sample> samples;             // sampler only, by slot
+
+        // Kept when the instrument changes, like the sequencer does
+        std::vector<LoopSequencer::Event> sequence;
+        double sequenceDurationMs = 0.0;
+        std::array<float, SendBuses::numBuses> sendLevels {};
+
+        /** Drop the instrument and everything that belongs to it. */
+        void clearInstrument();
+
+        Effect* findEffect(int effectId);
+        void setSample(int slot, const MultiSamplerConfig::SampleConfig& config, std::shared_ptr<const SampleData> data);
+        void removeSample(int slot);
+    };
+
+    struct SendBus
+    {
+        bool hasEffect = false;
+        Effect effect;              // id and enabled unused
+        float returnLevel = 1.0f;
+    };
+
+    std::array<Channel, LoopSequencer::numChannels> channels;
+    std::array<SendBus, SendBuses::numBuses> sendBuses;
+    MasterBus::Settings master;
+
+    /** Write to file, replacing it only once the whole snapshot is written. */
+    juce::Result write(const juce::File& file) const;
+
+    /** Parse file into snapshot, mapping its sample payloads. */
+    static juce::Result read(const juce::File& file, SessionSnapshot& snapshot);
+};
@@ -1,6 +1,65 @@
 #pragma once
 #include "JuceHeader.h"
 
+// ══════════════════════════════════════════════════════════════════════
+// Tail tracking shared by the effects below
+// ══════════════════════════════════════════════════════════════════════
+
+/**
+ * Decides when an effect has rung out. The tail is over once both its input
+ * and its output stayed below silenceThreshold for holdSamples in a row
+ * (at least the effect's longest internal delay), at which point the
+ * effect can clear its state and be skipped until new input arrives.
+ */
+class EffectTailTracker
+{
+public:
+    static constexpr float silenceThreshold = 1.0e-5f;  // -100 dBFS
+
+    /** Starts out asleep: a freshly prepared effect holds no signal. */
+    void prepare(int samplesToHold)
+    {
+        holdSamples = juce::jmax(1, samplesToHold);
+        quietSamples = holdSamples;
+    }
+
+    /** Feed each processed block's peaks; returns true on the block the tail ends. */
+    bool update(float inputPeak, float outputPeak, int numSamples)
+    {
+        if (inputPeak >= silenceThreshold || outputPeak >= silenceThreshold)
+        {
+            quietSamples = 0;
+            return false;
+        }
+
+        const bool wasActive = isTailActive();
+        quietSamples = juce::jmin(holdSamples, quietSamples + numSamples);
+        return wasActive && !isTailActive();
+    }
+
+    /** For effects whose longest delay follows a parameter. */
+    void setHoldSamples(int samplesToHold)
+    {
+        holdSamples = juce::jmax(1, samplesToHold);
+        quietSamples = juce::jmin(quietSamples, holdSamples);
+    }
+
+    bool isTailActive() const { return quietSamples < holdSamples; }
+
+private:
+    int holdSamples = 1;
+    int quietSamples = 1;
+};
+
+/** Loudest sample across all channels of a buffer. */
+inline float getPeakLevel(const juce::AudioBuffer<float>& buffer)
+{
+    float peak = 0.0f;
+    for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        peak = juce::jmax(peak, buffer.getMagnitude(ch, 0, buffer.getNumSamples()));
+    return peak;
+}
+
 // ══════════════════════════════════════════════════════════════════════
 // Simple Reverb Effect (lightweight, no AudioProcessor)
 // ══════════════════════════════════════════════════════════════════════
@@ -21,6 +80,10 @@ public:
         juce::ignoreUnused(samplesPerBlock);
         reverb.setSampleRate(sampleRate);
         reverb.setParameters(reverbParams);
+        reverb.reset();
+        
+        // Longest comb filter in juce::Reverb is ~1640 samples at 44.1 kHz
+        tail.prepare(static_cast<int>(sampleRate * 0.05));
     }
     
     void releaseResources()
@@ -28,8 +91,12 @@ public:
         reverb.reset();
     }
     
+    bool isTailActive() const { return tail.isTailActive(); }
+    
     void processBlock(juce::AudioBuffer<float>& buffer)
     {
+        const float inputPeak = getPeakLevel(buffer);
+        
         if (buffer.getNumChannels() == 2)
         {
             reverb.processStereo(buffer.getWritePointer(0),
@@ -40,6 +107,10 @@ public:
         {
             reverb.processMono(buffer.getWritePointer(0), buffer.getNumSamples());
         }
+        
+        // Flush the denormal-level leftovers so waking up starts from silence
+        if (tail.update(inputPeak, getPeakLevel(buffer), buffer.getNumSamples()))
+            reverb.reset();
     }
 
     // Parameter control
@@ -76,6 +147,7 @@ public:
 private:
     juce::Reverb reverb;
     juce::Reverb::Parameters reverbParams;
+    EffectTailTracker tail;
 };
 
 // ══════════════════════════════════════════════════════════════════════
@@ -100,10 +172,11 @@ public:
         
         // Allocate delay buffers (max 2 seconds)
         int maxDelaySamples = static_cast<int>(sampleRate * 2.0);
-        delayBufferL.resize(maxDelaySamples, 0.0f);
-        delayBufferR.resize(maxDelaySamples, 0.0f);
+        delayBufferL.assign(maxDelaySamples, 0.0f);
+        delayBufferR.assign(maxDelaySamples, 0.0f);
         
         writePosition = 0;
+        tail.prepare(maxDelaySamples);
     }
     
     void releaseResources()
@@ -112,6 +185,8 @@ public:
         delayBufferR.clear();
     }
     
+    bool isTailActive() const { return tail.isTailActive(); }
+    
     void processBlock(juce::AudioBuffer<float>& buffer)
     {
         const int numChannels = buffer.getNumChannels();
@@ -129,6 +204,12 @@ public:
         
         int delaySamples = static_cast<int>((delayTimeMs / 1000.0f) * sampleRate);
         delaySamples = juce::jlimit(1, bufferSize - 1, delaySamples);
+        tail.setHoldSamples(delaySamples);
+        
+        // The output can be silent while an echo is still travelling down the
+        // line, so watch what goes in and what comes out of the line instead
+        float inputPeak = 0.0f;
+        float delayedPeak = 0.0f;
         
         for (int i = 0; i < numSamples; ++i)
         {
@@ -141,6 +222,9 @@ public:
             float delayedL = delayBufferL[readPos];
             float delayedR = rightChannel ? delayBufferR[readPos] : delayedL;
             
+            inputPeak = juce::jmax(inputPeak, std::abs(leftChannel[i]), rightChannel ? std::abs(rightChannel[i]) : 0.0f);
+            delayedPeak = juce::jmax(delayedPeak, std::abs(delayedL), std::abs(delayedR));
+            
             // Mix dry and wet
             float outputL = leftChannel[i] * (1.0f - wetLevel) + delayedL * wetLevel;
             float outputR = rightChannel ? (rightChannel[i] * (1.0f - wetLevel) + delayedR * wetLevel) : outputL;
@@ -160,6 +244,13 @@ public:
             // Move write position
             writePosition = (writePosition + 1) % bufferSize;
         }
+        
+        // Quiet for a whole line length: only residue is left, drop it
+        if (tail.update(inputPeak, delayedPeak, numSamples))
+        {
+            std::fill(delayBufferL.begin(), delayBufferL.end(), 0.0f);
+            std::fill(delayBufferR.begin(), delayBufferR.end(), 0.0f);
+        }
     }
 
     void setDelayTime(float ms)
@@ -185,6 +276,7 @@ private:
     float feedback;
     float wetLevel;
     double sampleRate;
+    EffectTailTracker tail;
 };
 
 // ══════════════════════════════════════════════════════════════════════
@@ -225,6 +317,9 @@ public:
         filterR.reset();
         
         updateFilterCoefficients();
+        
+        // Resonant low cutoffs ring for a while; 20 ms covers the usable range
+        tail.prepare(static_cast<int>(sampleRate * 0.02));
     }
     
     void releaseResources()
@@ -233,12 +328,16 @@ public:
         filterR.reset();
     }
     
+    bool isTailActive() const { return tail.isTailActive(); }
+    
     void processBlock(juce::AudioBuffer<float>& buffer)
     {
         const int numChannels = buffer.getNumChannels();
         if (numChannels < 1)
             return;
 
+        const float inputPeak = getPeakLevel(buffer);
+
         updateFilterCoefficients();
         
         // Use JUCE DSP AudioBlock for processing
@@ -256,6 +355,12 @@ public:
             juce::dsp::ProcessContextReplacing<float> contextR(rightBlock);
             filterR.process(contextR);
         }
+        
+        if (tail.update(inputPeak, getPeakLevel(buffer), buffer.getNumSamples()))
+        {
+            filterL.reset();
+            filterR.reset();
+        }
     }
 
     void setCutoffFrequency(float freq)
@@ -276,29 +381,28 @@ public:
 private:
     void updateFilterCoefficients()
     {
-        auto coefficients = juce::dsp::IIR::Coefficients<float>::makeLowPass(
-            sampleRate, cutoffFreq, resonance);
+        // ArrayCoefficients and assigning into the existing state, because the
+        // Coefficients::make* factories allocate and this runs every block
+        using Design = juce::dsp::IIR::ArrayCoefficients<float>;
+        std::array<float, 6> coefficients {};
         
         switch (filterType)
         {
             case FilterType::LowPass:
-                coefficients = juce::dsp::IIR::Coefficients<float>::makeLowPass(
-                    sampleRate, cutoffFreq, resonance);
+                coefficients = Design::makeLowPass(sampleRate, cutoffFreq, resonance);
                 break;
                 
             case FilterType::HighPass:
-                coefficients = juce::dsp::IIR::Coefficients<float>::makeHighPass(
-                    sampleRate, cutoffFreq, resonance);
+                coefficients = Design::makeHighPass(sampleRate, cutoffFreq, resonance);
                 break;
                 
             case FilterType::BandPass:
-                coefficients = juce::dsp::IIR::Coefficients<float>::makeBandPass(
-                    sampleRate, cutoffFreq, resonance);
+                coefficients = Design::makeBandPass(sampleRate, cutoffFreq, resonance);
                 break;
         }
         
-        *filterL.state = *coefficients;
-        *filterR.state = *coefficients;
+        *filterL.state = coefficients;
+        *filterR.state = coefficients;
     }
 
     juce::dsp::ProcessorDuplicator<juce::dsp::IIR::Filter<float>, juce::dsp::IIR::Coefficients<float>> filterL;
@@ -307,4 +411,130 @@ private:
     float resonance;
     FilterType filterType;
     double sampleRate;
+    EffectTailTracker tail;
+};
+
+// ══════════════════════════════════════════════════════════════════════
+// Simple Compressor Effect (lightweight, no AudioProcessor)
+// ══════════════════════════════════════════════════════════════════════
+
+/**
+ * Same gain law and peak detector as juce::dsp::Compressor, but the detector
+ * can listen to a separate key signal (a sidechain) instead of the input,
+ * e.g. a kick channel ducking a bass.
+ */
+class SimpleCompressorProcessor
+{
+public:
+    void prepareToPlay(double sampleRate, int samplesPerBlock)
+    {
+        this->sampleRate = sampleRate;
+        
+        // One detector for all channels, so the stereo image doesn't shift
+        envelope.prepare({ sampleRate, static_cast<juce::uint32>(juce::jmax(1, samplesPerBlock)), 1 });
+        envelope.setLevelCalculationType(juce::dsp::BallisticsFilterLevelCalculationType::peak);
+        updateBallistics();
+        envelope.reset();
+        
+        tail.prepare(getReleaseSamples());
+    }
+    
+    void releaseResources()
+    {
+        envelope.reset();
+    }
+    
+    // The output is only ever the input made quieter, but keep running for
+    // a release time so the detector settles before the effect sleeps
+    bool isTailActive() const { return tail.isTailActive(); }
+    
+    /**
+     * Compress buffer in place. The detector follows key when given (at least
+     * as long as buffer, same channel count or fewer), otherwise the input.
+     */
+    void processBlock(juce::AudioBuffer<float>& buffer, const juce::AudioBuffer<float>* key = nullptr)
+    {
+        const int numChannels = buffer.getNumChannels();
+        const int numSamples = buffer.getNumSamples();
+        if (numChannels < 1)
+            return;
+        
+        // Waking up after a silent stretch: start the detector from rest
+        // rather than where it was left
+        if (!tail.isTailActive())
+            envelope.reset();
+        
+        const auto& detector = key != nullptr ? *key : buffer;
+        const int numDetectorChannels = detector.getNumChannels();
+        jassert(detector.getNumSamples() >= numSamples);
+        
+        const float inputPeak = getPeakLevel(buffer);
+        auto* const* channels = buffer.getArrayOfWritePointers();
+        const auto* const* detectorChannels = detector.getArrayOfReadPointers();
+        
+        for (int i = 0; i < numSamples; ++i)
+        {
+            float level = 0.0f;
+            for (int ch = 0; ch < numDetectorChannels; ++ch)
+                level = juce::jmax(level, std::abs(detectorChannels[ch][i]));
+            
+            const auto env = envelope.processSample(0, level);
+            const auto gain = makeupGain * (env < threshold ? 1.0f
+                                                             : std::pow(env * thresholdInverse, ratioInverse - 1.0f));
+            
+            for (int ch = 0; ch < numChannels; ++ch)
+                channels[ch][i] *= gain;
+        }
+        
+        envelope.snapToZero();
+        tail.update(inputPeak, getPeakLevel(buffer), numSamples);
+    }
+
+    void setThreshold(float dB)
+    {
+        threshold = juce::Decibels::decibelsToGain(juce::jlimit(-60.0f, 0.0f, dB));
+        thresholdInverse = 1.0f / threshold;
+    }
+    
+    void setRatio(float newRatio)
+    {
+        ratioInverse = 1.0f / juce::jlimit(1.0f, 20.0f, newRatio);
+    }
+    
+    void setAttack(float ms)
+    {
+        attackMs = juce::jlimit(0.1f, 500.0f, ms);
+        updateBallistics();
+    }
+    
+    void setRelease(float ms)
+    {
+        releaseMs = juce::jlimit(1.0f, 2000.0f, ms);
+        updateBallistics();
+        tail.setHoldSamples(getReleaseSamples());
+    }
+    
+    void setMakeupGain(float dB)
+    {
+        makeupGain = juce::Decibels::decibelsToGain(juce::jlimit(0.0f, 24.0f, dB));
+    }
+
+private:
+    void updateBallistics()
+    {
+        envelope.setAttackTime(attackMs);
+        envelope.setReleaseTime(releaseMs);
+    }
+    
+    int getReleaseSamples() const { return static_cast<int>(sampleRate * releaseMs * 0.001); }
+
+    juce::dsp::BallisticsFilter<float> envelope;
+    float threshold = juce::Decibels::decibelsToGain(-18.0f);
+    float thresholdInverse = 1.0f / juce::Decibels::decibelsToGain(-18.0f);
+    float ratioInverse = 1.0f / 4.0f;
+    float attackMs = 5.0f;
+    float releaseMs = 120.0f;
+    float makeupGain = 1.0f;
+    double sampleRate = 44100.0;
+    EffectTailTracker tail;
 };
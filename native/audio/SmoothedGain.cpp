@@ -0,0 +1,124 @@
+#include "SmoothedGain.h"
+
+// ──────────────────────────────────────────
+// SmoothedGain
+// ──────────────────────────────────────────
+
+SmoothedGain::SmoothedGain(float initialGain)
+    : smoother(initialGain)
+{
+}
+
+void SmoothedGain::prepare(double sampleRate, int maximumBlockSize, double rampSeconds)
+{
+    const auto size = static_cast<size_t>(juce::jmax(1, maximumBlockSize));
+    indexRamp.resize(size);
+    ramp.resize(size);
+
+    for (size_t i = 0; i < size; ++i)
+        indexRamp[i] = static_cast<float>(i + 1);
+
+    // Also lands on the target, so playback never starts with a fade
+    smoother.reset(sampleRate, rampSeconds);
+}
+
+void SmoothedGain::process(const juce::dsp::AudioBlock<float>& block)
+{
+    const auto numChannels = block.getNumChannels();
+    auto numSamples = static_cast<int>(block.getNumSamples());
+
+    if (!smoother.isSmoothing())
+    {
+        const auto gain = smoother.getTargetValue();
+        if (gain == 1.0f)
+            return;
+
+        for (size_t channel = 0; channel < numChannels; ++channel)
+        {
+            if (gain == 0.0f)
+                juce::FloatVectorOperations::clear(block.getChannelPointer(channel), numSamples);
+            else
+                juce::FloatVectorOperations::multiply(block.getChannelPointer(channel), gain, numSamples);
+        }
+        return;
+    }
+
+    jassert(!indexRamp.empty());   // prepare() first
+
+    // Blocks longer than the prepared size are done in pieces
+    const auto maxChunk = static_cast<int>(indexRamp.size());
+    for (int offset = 0; offset < numSamples;)
+    {
+        const auto chunk = juce::jmin(maxChunk, numSamples - offset);
+
+        const auto start = smoother.getCurrentValue();
+        const auto end = smoother.skip(chunk);
+        const auto step = (end - start) / static_cast<float>(chunk);
+
+        juce::FloatVectorOperations::copyWithMultiply(ramp.data(), indexRamp.data(), step, chunk);
+        juce::FloatVectorOperations::add(ramp.data(), start, chunk);
+
+        for (size_t channel = 0; channel < numChannels; ++channel)
+            juce::FloatVectorOperations::multiply(block.getChannelPointer(channel) + offset, ramp.data(), chunk);
+
+        offset += chunk;
+    }
+}
+
+// ──────────────────────────────────────────
+// StereoGainPan
+// ──────────────────────────────────────────
+
+StereoGainPan::StereoGainPan(float initialVolume, float initialPan)
+    : volume(initialVolume)
+    , pan(-1.0f)
+{
+    setPan(initialPan);
+    snapToTarget();
+}
+
+void StereoGainPan::prepare(double sampleRate, int maximumBlockSize)
+{
+    leftGain.prepare(sampleRate, maximumBlockSize);
+    rightGain.prepare(sampleRate, maximumBlockSize);
+}
+
+void StereoGainPan::setVolume(float newVolume)
+{
+    volume = newVolume;
+    updateTargets();
+}
+
+void StereoGainPan::setPan(float newPan)
+{
+    if (newPan == pan)
+        return;
+
+    // Constant power panning
+    pan = newPan;
+    panLeft = std::cos(pan * juce::MathConstants<float>::halfPi);
+    panRight = std::sin(pan * juce::MathConstants<float>::halfPi);
+    updateTargets();
+}
+
+void StereoGainPan::snapToTarget()
+{
+    leftGain.snapToTarget();
+    rightGain.snapToTarget();
+}
+
+void StereoGainPan::process(juce::AudioBuffer<float>& buffer, int numSamples)
+{
+    if (buffer.getNumChannels() < 2)
+        return;
+
+    auto* const* channels = buffer.getArrayOfWritePointers();
+    leftGain.process(juce::dsp::AudioBlock<float>(channels, 1, static_cast<size_t>(numSamples)));
+    rightGain.process(juce::dsp::AudioBlock<float>(channels + 1, 1, static_cast<size_t>(numSamples)));
+}
+
+void StereoGainPan::updateTargets()
+{
+    leftGain.setTargetValue(panLeft * volume);
+    rightGain.setTargetValue(panRight * volume);
+}
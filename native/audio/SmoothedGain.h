@@ -0,0 +1,76 @@
+#pragma once
+#include "JuceHeader.h"
+#include <vector>
+
+/**
+ * SmoothedGain - A gain that glides to new values instead of jumping.
+ *
+ * Built on a linear juce::SmoothedValue. The smoother is advanced once per
+ * block and the gain ramps in a straight line from its value at the start
+ * of the block to its value at the end, so the ramp is built and applied
+ * with FloatVectorOperations rather than a per-sample loop. Once the target
+ * is reached a block costs one vector multiply, or nothing at unity gain.
+ *
+ * Not thread-safe: everything, setTargetValue() included, is for the audio
+ * thread (or before it starts). Owners keep the control-side value in an
+ * atomic and copy it in with setTargetValue() at the start of a block, or
+ * apply it from a queued command. prepare() allocates.
+ */
+class SmoothedGain
+{
+public:
+    static constexpr double defaultRampSeconds = 0.02;
+
+    explicit SmoothedGain(float initialGain = 1.0f);
+
+    void prepare(double sampleRate, int maximumBlockSize, double rampSeconds = defaultRampSeconds);
+
+    void setTargetValue(float gain) { smoother.setTargetValue(gain); }
+    float getTargetValue() const { return smoother.getTargetValue(); }
+    bool isSmoothing() const { return smoother.isSmoothing(); }
+
+    /** Jump straight to the target, e.g. when nothing is playing to click. */
+    void snapToTarget() { smoother.setCurrentAndTargetValue(smoother.getTargetValue()); }
+
+    /** Multiply every channel of the block by this block's gain ramp. */
+    void process(const juce::dsp::AudioBlock<float>& block);
+
+private:
+    juce::SmoothedValue<float> smoother;
+
+    // 1, 2, 3, ... so a ramp is indexRamp * step + start
+    std::vector<float> indexRamp;
+    std::vector<float> ramp;
+};
+
+/**
+ * StereoGainPan - Channel volume and constant-power pan as two SmoothedGains.
+ *
+ * The pan law's cos/sin are only evaluated when the pan changes.
+ */
+class StereoGainPan
+{
+public:
+    StereoGainPan(float volume, float pan);
+
+    void prepare(double sampleRate, int maximumBlockSize);
+
+    void setVolume(float newVolume);
+    void setPan(float newPan);   // 0.0 (left) to 1.0 (right)
+
+    void snapToTarget();
+
+    /** Apply to the first numSamples of a stereo buffer (mono buffers are left alone). */
+    void process(juce::AudioBuffer<float>& buffer, int numSamples);
+
+private:
+    void updateTargets();
+
+    float volume;
+    float pan;
+    float panLeft = 1.0f;
+    float panRight = 0.0f;
+
+    SmoothedGain leftGain;
+    SmoothedGain rightGain;
+};
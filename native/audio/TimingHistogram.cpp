@@ -0,0 +1,88 @@
+#include "TimingHistogram.h"
+#include <cmath>
+
+TimingHistogram::TimingHistogram()
+{
+    for (auto& bucket : buckets)
+        bucket.store(0, std::memory_order_relaxed);
+}
+
+double TimingHistogram::ticksToMicros(juce::int64 ticks) noexcept
+{
+    static const double microsPerTick = 1.0e6 / static_cast<double>(juce::Time::getHighResolutionTicksPerSecond());
+    return static_cast<double>(ticks) * microsPerTick;
+}
+
+int TimingHistogram::bucketFor(double micros) noexcept
+{
+    if (micros <= 1.0)
+        return 0;
+
+    const auto bucket = static_cast<int>(std::log2(micros) * bucketsPerOctave);
+    return juce::jmin(bucket, numBuckets - 1);
+}
+
+double TimingHistogram::bucketUpperBound(int bucket) noexcept
+{
+    return std::exp2(static_cast<double>(bucket + 1) / bucketsPerOctave);
+}
+
+void TimingHistogram::record(double micros) noexcept
+{
+    // Single writer, so plain load/store is enough and avoids locked RMWs
+    auto& bucket = buckets[static_cast<size_t>(bucketFor(micros))];
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+    sumMicros.store(sumMicros.load(std::memory_order_relaxed) + micros, std::memory_order_relaxed);
+
+    if (micros > maxMicros.load(std::memory_order_relaxed))
+        maxMicros.store(micros, std::memory_order_relaxed);
+
+    // Published last: a reader that sees the count also sees its sample
+    count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void TimingHistogram::reset() noexcept
+{
+    count.store(0, std::memory_order_relaxed);
+    sumMicros.store(0.0, std::memory_order_relaxed);
+    maxMicros.store(0.0, std::memory_order_relaxed);
+
+    for (auto& bucket : buckets)
+        bucket.store(0, std::memory_order_relaxed);
+}
+
+TimingHistogram::Summary TimingHistogram::getSummary() const
+{
+    Summary summary;
+    summary.count = count.load(std::memory_order_acquire);
+    if (summary.count == 0)
+        return summary;
+
+    summary.meanMicros = sumMicros.load(std::memory_order_relaxed) / static_cast<double>(summary.count);
+    summary.maxMicros = maxMicros.load(std::memory_order_relaxed);
+
+    // Bucket counts may run slightly ahead of the count we read; that only
+    // shifts the percentile by a sample or two
+    std::array<juce::uint32, numBuckets> snapshot;
+    juce::int64 total = 0;
+    for (size_t i = 0; i < snapshot.size(); ++i)
+    {
+        snapshot[i] = buckets[i].load(std::memory_order_relaxed);
+        total += snapshot[i];
+    }
+
+    const auto rank = static_cast<juce::int64>(std::ceil(static_cast<double>(total) * 0.99));
+    juce::int64 seen = 0;
+    for (int i = 0; i < numBuckets; ++i)
+    {
+        seen += snapshot[static_cast<size_t>(i)];
+        if (seen >= rank)
+        {
+            summary.p99Micros = juce::jmin(bucketUpperBound(i), summary.maxMicros);
+            break;
+        }
+    }
+
+    return summary;
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include "JuceHeader.h"
+#include <array>
+#include <atomic>
+
+/**
+ * TimingHistogram - Lock-free distribution of render times, cheap enough to
+ * record on the audio thread for every block.
+ *
+ * Times land in log-spaced buckets (eight per octave, 1 us to ~65 ms), so the
+ * p99 is accurate to about 9%. There is one writer at a time (whichever thread
+ * rendered that block; blocks are ordered by the audio callback) and any
+ * number of readers, which may see a block half-recorded but never block it.
+ */
+class TimingHistogram
+{
+public:
+    static constexpr int bucketsPerOctave = 8;
+    static constexpr int numBuckets = 16 * bucketsPerOctave;
+
+    struct Summary
+    {
+        juce::int64 count = 0;
+        double meanMicros = 0.0;
+        double p99Micros = 0.0;
+        double maxMicros = 0.0;
+    };
+
+    TimingHistogram();
+
+    /** Writer: add one measurement. Never allocates or blocks. */
+    void record(double micros) noexcept;
+
+    /** Writer: forget everything recorded so far. */
+    void reset() noexcept;
+
+    /** Any thread. */
+    Summary getSummary() const;
+
+    // ──────────────────────────────────────────
+    // High-resolution timing helpers
+    // ──────────────────────────────────────────
+    static juce::int64 now() noexcept { return juce::Time::getHighResolutionTicks(); }
+    static double ticksToMicros(juce::int64 ticks) noexcept;
+
+private:
+    static int bucketFor(double micros) noexcept;
+    static double bucketUpperBound(int bucket) noexcept;
+
+    std::array<std::atomic<juce::uint32>, numBuckets> buckets;
+    std::atomic<juce::int64> count { 0 };
+    std::atomic<double> sumMicros { 0.0 };
+    std::atomic<double> maxMicros { 0.0 };
+
+    JUCE_DECLARE_NON_COPYABLE(TimingHistogram)
+};
+
+/** Times a scope into a histogram, like juce::AudioProcessLoadMeasurer::ScopedTimer. */
+class ScopedRenderTimer
+{
+public:
+    explicit ScopedRenderTimer(TimingHistogram& h) noexcept
+        : histogram(h), startTicks(TimingHistogram::now())
+    {
+    }
+
+    ~ScopedRenderTimer()
+    {
+        histogram.record(TimingHistogram::ticksToMicros(TimingHistogram::now() - startTicks));
+    }
+
+private:
+    TimingHistogram& histogram;
+    juce::int64 startTicks;
+
+    JUCE_DECLARE_NON_COPYABLE(ScopedRenderTimer)
+};
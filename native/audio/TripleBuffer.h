@@ -0,0 +1,43 @@
+#pragma once
+#include <array>
+#include <atomic>
+
+/**
+ * TripleBuffer - Hands a value from one writer thread to one reader thread
+ * without either waiting or seeing a half-written value.
+ *
+ * The writer fills a slot the reader can't see and publishes it with one
+ * atomic exchange; the reader takes the newest published slot with another.
+ * A third slot means neither ever has to wait for the other to finish, and
+ * the writer can publish as often as it likes however rarely the reader looks.
+ */
+template <typename Value>
+class TripleBuffer
+{
+public:
+    /** Writer: the slot to fill next. */
+    Value& getWriteSlot() { return slots[static_cast<size_t>(writeIndex)]; }
+
+    /** Writer: make the filled slot the newest value. */
+    void publish()
+    {
+        writeIndex = state.exchange(writeIndex | freshBit, std::memory_order_acq_rel) & indexMask;
+    }
+
+    /** Reader: the newest published value, valid until the next read(). */
+    const Value& read()
+    {
+        if ((state.load(std::memory_order_relaxed) & freshBit) != 0)
+            readIndex = state.exchange(readIndex, std::memory_order_acq_rel) & indexMask;
+        return slots[static_cast<size_t>(readIndex)];
+    }
+
+private:
+    static constexpr int indexMask = 3;
+    static constexpr int freshBit = 4;
+
+    std::array<Value, 3> slots {};
+    int writeIndex = 0;
+    int readIndex = 1;
+    std::atomic<int> state { 2 };  // the middle slot's index, plus freshBit when unread
+};
@@ -0,0 +1,225 @@
+#include "Wavetable.h"
+#include <cmath>
+
+namespace
+{
+    /**
+     * One cycle of any length resampled to Wavetable::tableSize in the spectral
+     * domain: its first maxHarmonics harmonics (fewer if the source is too short
+     * to hold them) carry over exactly and everything above is dropped, so a
+     * long cycle shrinks without its upper harmonics folding back down.
+     */
+    std::vector<float> resampleCycle(const float* samples, int numSamples)
+    {
+        constexpr auto size = Wavetable::tableSize;
+        if (numSamples == size)
+            return { samples, samples + numSamples };
+
+        // Interleaved complex bins, as juce::dsp::FFT lays them out. Forward
+        // transforms scale with length, so rescale to what tableSize would give.
+        std::vector<float> bins(static_cast<size_t>(2 * size));
+        const auto numHarmonics = juce::jmin(Wavetable::maxHarmonics, (numSamples - 1) / 2);
+        const auto scale = static_cast<double>(size) / numSamples;
+
+        if (juce::isPowerOfTwo(numSamples))
+        {
+            std::vector<float> source(samples, samples + numSamples);
+            source.resize(static_cast<size_t>(2 * numSamples));
+            juce::dsp::FFT(juce::roundToInt(std::log2(numSamples))).performRealOnlyForwardTransform(source.data());
+
+            for (int h = 1; h <= numHarmonics; ++h)
+            {
+                bins[static_cast<size_t>(2 * h)] = static_cast<float>(source[static_cast<size_t>(2 * h)] * scale);
+                bins[static_cast<size_t>(2 * h + 1)] = static_cast<float>(source[static_cast<size_t>(2 * h + 1)] * scale);
+            }
+        }
+        else
+        {
+            // No FFT at this length: a direct DFT of just the bins we keep
+            std::vector<double> cosines(static_cast<size_t>(numSamples));
+            std::vector<double> sines(static_cast<size_t>(numSamples));
+            for (int k = 0; k < numSamples; ++k)
+            {
+                const auto angle = juce::MathConstants<double>::twoPi * k / numSamples;
+                cosines[static_cast<size_t>(k)] = std::cos(angle);
+                sines[static_cast<size_t>(k)] = std::sin(angle);
+            }
+
+            for (int h = 1; h <= numHarmonics; ++h)
+            {
+                double re = 0.0, im = 0.0;
+                for (int n = 0, k = 0; n < numSamples; ++n)
+                {
+                    re += samples[n] * cosines[static_cast<size_t>(k)];
+                    im -= samples[n] * sines[static_cast<size_t>(k)];
+                    if ((k += h) >= numSamples)
+                        k -= numSamples;
+                }
+                bins[static_cast<size_t>(2 * h)] = static_cast<float>(re * scale);
+                bins[static_cast<size_t>(2 * h + 1)] = static_cast<float>(im * scale);
+            }
+        }
+
+        for (int h = 1; h <= numHarmonics; ++h)
+        {
+            bins[static_cast<size_t>(2 * (size - h))] = bins[static_cast<size_t>(2 * h)];
+            bins[static_cast<size_t>(2 * (size - h) + 1)] = -bins[static_cast<size_t>(2 * h + 1)];
+        }
+
+        juce::dsp::FFT(Wavetable::tableOrder).performRealOnlyInverseTransform(bins.data());
+        bins.resize(static_cast<size_t>(size));
+        return bins;
+    }
+}
+
+Wavetable::Wavetable(std::vector<float> spectrum, bool normalise)
+    : levels(static_cast<size_t>(numLevels * (tableSize + 1)))
+{
+    jassert(spectrum.size() == static_cast<size_t>(2 * tableSize));
+
+    juce::dsp::FFT fft(tableOrder);
+    std::vector<float> bins(static_cast<size_t>(2 * tableSize));
+
+    for (int level = 0; level < numLevels; ++level)
+    {
+        // Keep this level's harmonics (and their mirror images), drop DC and the rest
+        std::fill(bins.begin(), bins.end(), 0.0f);
+        const auto numHarmonics = maxHarmonics >> level;
+        for (int h = 1; h <= numHarmonics; ++h)
+        {
+            const auto re = spectrum[static_cast<size_t>(2 * h)];
+            const auto im = spectrum[static_cast<size_t>(2 * h + 1)];
+            bins[static_cast<size_t>(2 * h)] = re;
+            bins[static_cast<size_t>(2 * h + 1)] = im;
+            bins[static_cast<size_t>(2 * (tableSize - h))] = re;
+            bins[static_cast<size_t>(2 * (tableSize - h) + 1)] = -im;
+        }
+
+        fft.performRealOnlyInverseTransform(bins.data());
+
+        auto* table = levels.data() + static_cast<size_t>(level) * (tableSize + 1);
+        std::copy(bins.begin(), bins.begin() + tableSize, table);
+        table[tableSize] = table[0];
+    }
+
+    if (!normalise)
+        return;
+
+    // One gain for every level, taken from the fullest one
+    const auto range = juce::FloatVectorOperations::findMinAndMax(getLevel(0), tableSize);
+    const auto peak = juce::jmax(std::abs(range.getStart()), std::abs(range.getEnd()));
+    if (peak > 0.0f)
+        juce::FloatVectorOperations::multiply(levels.data(), 1.0f / peak, static_cast<int>(levels.size()));
+}
+
+std::shared_ptr<const Wavetable> Wavetable::fromCycle(const float* samples, int numSamples)
+{
+    if (samples == nullptr || numSamples < 4)
+        return nullptr;
+
+    auto cycle = resampleCycle(samples, numSamples);
+    std::vector<float> spectrum(cycle);
+    spectrum.resize(static_cast<size_t>(2 * tableSize));
+    juce::dsp::FFT(tableOrder).performRealOnlyForwardTransform(spectrum.data());
+
+    // Anything left once DC and the harmonics we can't keep are gone?
+    float energy = 0.0f;
+    for (int h = 1; h <= maxHarmonics; ++h)
+        energy += std::abs(spectrum[static_cast<size_t>(2 * h)]) + std::abs(spectrum[static_cast<size_t>(2 * h + 1)]);
+    if (energy < 1.0e-6f)
+        return nullptr;
+
+    auto table = std::shared_ptr<Wavetable>(new Wavetable(std::move(spectrum), true));
+    table->sourceCycle = std::move(cycle);
+    return table;
+}
+
+std::shared_ptr<const Wavetable> Wavetable::fromAudioFile(const juce::File& file)
+{
+    if (!file.existsAsFile())
+    {
+        DBG("Wavetable file not found: " << file.getFullPathName());
+        return nullptr;
+    }
+
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
+    if (reader == nullptr)
+    {
+        DBG("Failed to create reader for: " << file.getFullPathName());
+        return nullptr;
+    }
+
+    // Whole tableSize frames are a multi-frame table: read just the first frame
+    const auto length = reader->lengthInSamples;
+    const bool multiFrame = length > tableSize && length % tableSize == 0;
+
+    if ((!multiFrame && length > maxCycleLength) || reader->numChannels == 0)
+    {
+        DBG("Not a single-cycle wavetable: " << file.getFullPathName());
+        return nullptr;
+    }
+
+    const auto numSamples = multiFrame ? tableSize : static_cast<int>(length);
+    const auto numChannels = static_cast<int>(reader->numChannels);
+    juce::AudioBuffer<float> audioData(numChannels, numSamples);
+    reader->read(&audioData, 0, numSamples, 0, true, true);
+
+    for (int channel = 1; channel < numChannels; ++channel)
+        audioData.addFrom(0, 0, audioData, channel, 0, numSamples);
+    if (numChannels > 1)
+        audioData.applyGain(0, 0, numSamples, 1.0f / static_cast<float>(numChannels));
+
+    auto table = fromCycle(audioData.getReadPointer(0), numSamples);
+    if (table == nullptr)
+    {
+        DBG("Wavetable file is too short or silent: " << file.getFullPathName());
+    }
+    return table;
+}
+
+std::shared_ptr<const Wavetable> Wavetable::fromHarmonics(float (*sineAmplitude)(int),
+                                                          float (*cosineAmplitude)(int))
+{
+    // x[n] = a sin(2 pi h n / N) + b cos(2 pi h n / N) has bin h = (b - ia) N / 2
+    std::vector<float> spectrum(static_cast<size_t>(2 * tableSize));
+    for (int h = 1; h <= maxHarmonics; ++h)
+    {
+        spectrum[static_cast<size_t>(2 * h)] = cosineAmplitude(h) * (tableSize / 2);
+        spectrum[static_cast<size_t>(2 * h + 1)] = -sineAmplitude(h) * (tableSize / 2);
+    }
+    return std::shared_ptr<const Wavetable>(new Wavetable(std::move(spectrum), false));
+}
+
+struct Wavetable::BuiltIns
+{
+    std::shared_ptr<const Wavetable> sine = fromHarmonics(
+        [](int h) { return h == 1 ? 1.0f : 0.0f; },
+        [](int) { return 0.0f; });
+
+    std::shared_ptr<const Wavetable> saw = fromHarmonics(
+        [](int h) { return -2.0f / (juce::MathConstants<float>::pi * static_cast<float>(h)); },
+        [](int) { return 0.0f; });
+
+    std::shared_ptr<const Wavetable> square = fromHarmonics(
+        [](int h) { return (h & 1) ? 4.0f / (juce::MathConstants<float>::pi * static_cast<float>(h)) : 0.0f; },
+        [](int) { return 0.0f; });
+
+    std::shared_ptr<const Wavetable> triangle = fromHarmonics(
+        [](int) { return 0.0f; },
+        [](int h) { return (h & 1) ? 8.0f / (juce::MathConstants<float>::pi * juce::MathConstants<float>::pi
+                                             * static_cast<float>(h * h)) : 0.0f; });
+};
+
+const Wavetable::BuiltIns& Wavetable::getBuiltIns()
+{
+    static const BuiltIns builtIns;
+    return builtIns;
+}
+
+const Wavetable& Wavetable::sine()     { return *getBuiltIns().sine; }
+const Wavetable& Wavetable::saw()      { return *getBuiltIns().saw; }
+const Wavetable& Wavetable::square()   { return *getBuiltIns().square; }
+const Wavetable& Wavetable::triangle() { return *getBuiltIns().triangle; }
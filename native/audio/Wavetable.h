@@ -0,0 +1,109 @@
+#pragma once
+#include "JuceHeader.h"
+#include <memory>
+#include <vector>
+
+/**
+ * Wavetable - One cycle of a waveform, stored band-limited once per octave
+ * so an oscillator can play it at any pitch without aliasing.
+ *
+ * Level 0 keeps harmonics up to maxHarmonics; each level above it keeps half
+ * as many as the one below, down to a pure sine. The levels are cut from the
+ * cycle's spectrum with juce::dsp::FFT when the table is built, and every
+ * level is scaled the same, so a note sounds equally loud whichever it reads.
+ * A voice picks the level for its pitch once (getLevelForIncrement()) and
+ * then costs one interpolated lookup per sample.
+ *
+ * Tables never change after they are built. The built-in shapes are shared
+ * by every voice; imported ones are held through shared_ptr by the
+ * instruments playing them.
+ */
+class Wavetable
+{
+public:
+    static constexpr int tableOrder = 11;
+    static constexpr int tableSize = 1 << tableOrder;
+    static constexpr int maxHarmonics = tableSize / 4;  // leaves linear interpolation 4 points per cycle
+    static constexpr int numLevels = 10;                // maxHarmonics, half that, ... 1
+
+    // Longest file accepted as one cycle (longer ones are probably not
+    // single-cycle), unless it is a whole number of tableSize frames
+    static constexpr int maxCycleLength = tableSize * 64;
+
+    /**
+     * A table from one cycle of any length, resampled to tableSize through
+     * its spectrum (harmonics above maxHarmonics are dropped, not folded).
+     * DC is removed and the loudest level normalised to peak at 1. Returns
+     * nullptr for fewer than 4 samples or a silent cycle.
+     */
+    static std::shared_ptr<const Wavetable> fromCycle(const float* samples, int numSamples);
+
+    /**
+     * Import a single-cycle wavetable file (WAV, AIFF, ...), mixed to mono.
+     * A file holding any number of tableSize frames, as wavetable editors
+     * export (256 x 2048 is common), gives its first frame and only that is
+     * read; otherwise the whole file is taken as the cycle.
+     * Returns nullptr, logging why, if it can't be used.
+     */
+    static std::shared_ptr<const Wavetable> fromAudioFile(const juce::File& file);
+
+    // Built-in shapes from their Fourier series at full scale (the saw and
+    // square overshoot a little, as band-limited edges do). All four are built
+    // on the first call to any of them, so warm them up off the audio thread.
+    static const Wavetable& sine();
+    static const Wavetable& saw();       // rising, -1 to 1
+    static const Wavetable& square();    // +1 for the first half cycle
+    static const Wavetable& triangle();  // 1 at phase 0, -1 halfway
+
+    /** The level to play at a phase increment in cycles per sample. */
+    static int getLevelForIncrement(double increment) noexcept
+    {
+        // Highest harmonic must stay below Nyquist: (maxHarmonics >> level) * increment < 0.5
+        int level = 0;
+        while (level < numLevels - 1 && static_cast<double>(maxHarmonics >> level) * increment >= 0.5)
+            ++level;
+        return level;
+    }
+
+    /** tableSize samples of a level plus a copy of the first, for interpolation. */
+    const float* getLevel(int level) const noexcept
+    {
+        jassert(level >= 0 && level < numLevels);
+        return levels.data() + static_cast<size_t>(level) * (tableSize + 1);
+    }
+
+    /** A level at phase in [0, 1), linearly interpolated. */
+    static float lookup(const float* level, double phase) noexcept
+    {
+        const auto position = phase * tableSize;
+        const auto index = static_cast<int>(position);
+        const auto fraction = static_cast<float>(position - index);
+        return level[index] + fraction * (level[index + 1] - level[index]);
+    }
+
+    /**
+     * The tableSize samples an imported table was built from (what fromCycle()
+     * resampled the input to), for saving with a session: fromCycle() rebuilds
+     * the same table from them. Empty for the built-in shapes.
+     */
+    const std::vector<float>& getSourceCycle() const noexcept { return sourceCycle; }
+
+private:
+    /**
+     * spectrum is tableSize interleaved complex bins, as juce::dsp::FFT lays
+     * them out; only the positive ones are read. normalise scales the levels
+     * so level 0 peaks at 1.
+     */
+    Wavetable(std::vector<float> spectrum, bool normalise);
+
+    static std::shared_ptr<const Wavetable> fromHarmonics(float (*sineAmplitude)(int),
+                                                          float (*cosineAmplitude)(int));
+
+    struct BuiltIns;
+    static const BuiltIns& getBuiltIns();
+
+    std::vector<float> levels;  // numLevels * (tableSize + 1)
+    std::vector<float> sourceCycle;
+
+    JUCE_DECLARE_NON_COPYABLE(Wavetable)
+};
@@ -0,0 +1,477 @@
+/**
+ * AudioEngineBenchmark - Cost of the engine's building blocks in nanoseconds
+ * per output sample, written as JSON so runs can be diffed over time:
+ *
+ *   - oscillator voices: every BaseOscillatorVoice::Waveform at 1-256 voices
+ *     (Wavetable plays an imported 600-sample cycle)
+ *   - voice bank: an oscillator Instrument at 8-128 voices rendered by the
+ *     SIMD OscillatorVoiceBank against the same voices in a juce::Synthesiser
+ *   - sampler voices: 16 voices with linear interpolation at several pitch ratios
+ *   - effects: every Instrument::EffectType on a stereo noise signal
+ *   - reverb routing: 16 playing channels with a reverb each, against the
+ *     same channels sending to one shared reverb bus
+ *   - metering: one LoudnessMeter (peak, RMS, LUFS, true peak) on stereo
+ *     noise, and on silence
+ *
+ * Each case renders `--blocks` blocks and reports the median of `--repeats`
+ * runs. Usage:
+ *
+ *   AudioEngineBenchmark [--quick] [--blocks N] [--repeats N] [--output file.json]
+ */
+#include "AudioEngine.h"
+#include "Instrument.h"
+#include "MultisamplerInstrument.h"
+#include "SimpleEffects.h"
+#include "LoudnessMeter.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 256;
+    constexpr int warmupBlocks = 4;
+
+    struct Settings
+    {
+        int blocks = 200;
+        int repeats = 5;
+    };
+
+    /** Median over repeats of ns per output sample; setUp() runs before each repeat. */
+    double measure(const Settings& settings,
+                   const std::function<void()>& setUp,
+                   const std::function<void(juce::AudioBuffer<float>&)>& renderBlock)
+    {
+        juce::AudioBuffer<float> buffer(2, blockSize);
+        std::vector<double> results;
+
+        for (int repeat = 0; repeat < settings.repeats; ++repeat)
+        {
+            setUp();
+
+            for (int i = 0; i < warmupBlocks; ++i)
+                renderBlock(buffer);
+
+            const auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < settings.blocks; ++i)
+                renderBlock(buffer);
+            const auto end = std::chrono::steady_clock::now();
+
+            const auto ns = std::chrono::duration<double, std::nano>(end - start).count();
+            results.push_back(ns / (static_cast<double>(settings.blocks) * blockSize));
+        }
+
+        std::sort(results.begin(), results.end());
+        return results[results.size() / 2];
+    }
+
+    juce::var makeResult(std::initializer_list<std::pair<const char*, juce::var>> fields)
+    {
+        auto* object = new juce::DynamicObject();
+        for (const auto& [name, value] : fields)
+            object->setProperty(name, value);
+        return juce::var(object);
+    }
+
+    // ──────────────────────────────────────────
+    // Oscillator voices
+    // ──────────────────────────────────────────
+    juce::var benchmarkOscillators(const Settings& settings, const std::vector<int>& voiceCounts)
+    {
+        const std::pair<BaseOscillatorVoice::Waveform, const char*> waveforms[] = {
+            { BaseOscillatorVoice::Waveform::Sine, "sine" },
+            { BaseOscillatorVoice::Waveform::Saw, "saw" },
+            { BaseOscillatorVoice::Waveform::Square, "square" },
+            { BaseOscillatorVoice::Waveform::Triangle, "triangle" },
+            { BaseOscillatorVoice::Waveform::Wavetable, "wavetable" },
+        };
+
+        std::vector<float> cycle(600);
+        for (size_t i = 0; i < cycle.size(); ++i)
+            cycle[i] = std::tanh(3.0f * std::sin(2.0f * juce::MathConstants<float>::pi * static_cast<float>(i) / 600.0f));
+        const auto wavetable = Wavetable::fromCycle(cycle.data(), static_cast<int>(cycle.size()));
+
+        juce::Array<juce::var> results;
+
+        for (const auto& [waveform, name] : waveforms)
+        {
+            for (auto numVoices : voiceCounts)
+            {
+                // A bare synth like Instrument's, so voice counts above 128 can
+                // be reached by spreading notes over MIDI channels
+                juce::Synthesiser synth;
+                juce::MidiBuffer noMidi;
+
+                const auto setUp = [&]
+                {
+                    synth.clearVoices();
+                    synth.clearSounds();
+                    synth.addSound(new BasicSynthSound());
+                    for (int i = 0; i < numVoices; ++i)
+                    {
+                        auto* voice = new BaseOscillatorVoice();
+                        voice->setWavetable(wavetable);
+                        voice->setWaveform(waveform);
+                        voice->setADSR({ 0.001f, 0.01f, 1.0f, 0.1f });
+                        synth.addVoice(voice);
+                    }
+                    synth.setCurrentPlaybackSampleRate(sampleRate);
+
+                    for (int i = 0; i < numVoices; ++i)
+                        synth.noteOn(1 + i / 64, 36 + i % 64, 0.5f);
+                };
+
+                const auto render = [&](juce::AudioBuffer<float>& buffer)
+                {
+                    buffer.clear();
+                    synth.renderNextBlock(buffer, noMidi, 0, blockSize);
+                };
+
+                const auto nsPerSample = measure(settings, setUp, render);
+                results.add(makeResult({ { "waveform", name },
+                                         { "voices", numVoices },
+                                         { "nsPerSample", nsPerSample },
+                                         { "nsPerVoiceSample", nsPerSample / numVoices } }));
+            }
+        }
+
+        return results;
+    }
+
+    // ──────────────────────────────────────────
+    // Voice bank
+    // ──────────────────────────────────────────
+    juce::var benchmarkVoiceBank(const Settings& settings, const std::vector<int>& voiceCounts)
+    {
+        const std::pair<BaseOscillatorVoice::Waveform, const char*> waveforms[] = {
+            { BaseOscillatorVoice::Waveform::Sine, "sine" },
+            { BaseOscillatorVoice::Waveform::Saw, "saw" },
+        };
+
+        juce::Array<juce::var> results;
+
+        for (const auto& [waveform, name] : waveforms)
+        {
+            for (auto numVoices : voiceCounts)
+            {
+                double nsPerSample[2] {};
+
+                for (const bool simdVoices : { false, true })
+                {
+                    std::unique_ptr<Instrument> instrument;
+                    juce::MidiBuffer noMidi;
+
+                    const auto setUp = [&]
+                    {
+                        Config config;
+                        config.polyphony = numVoices;
+                        config.waveform = waveform;
+                        config.adsrParams = { 0.001f, 0.01f, 1.0f, 0.1f };
+                        config.simdVoices = simdVoices;
+
+                        instrument = std::make_unique<Instrument>(config);
+                        instrument->prepareToPlay(sampleRate, blockSize);
+                        for (int i = 0; i < numVoices; ++i)
+                            instrument->noteOn(i, 0.5f);
+                    };
+
+                    const auto render = [&](juce::AudioBuffer<float>& buffer)
+                    {
+                        buffer.clear();
+                        instrument->renderNextBlock(buffer, noMidi, 0, blockSize);
+                    };
+
+                    nsPerSample[simdVoices ? 1 : 0] = measure(settings, setUp, render);
+                }
+
+                results.add(makeResult({ { "waveform", name },
+                                         { "voices", numVoices },
+                                         { "lanes", OscillatorVoiceBank::lanes },
+                                         { "synthesiserNsPerSample", nsPerSample[0] },
+                                         { "voiceBankNsPerSample", nsPerSample[1] },
+                                         { "speedup", nsPerSample[0] / nsPerSample[1] } }));
+            }
+        }
+
+        return results;
+    }
+
+    // ──────────────────────────────────────────
+    // Sampler interpolation
+    // ──────────────────────────────────────────
+    juce::var benchmarkSampler(const Settings& settings)
+    {
+        constexpr int numVoices = 16;
+        const int semitoneShifts[] = { -12, -5, 0, 7, 12, 24 };
+
+        // Long enough that no voice reaches the end at 4x speed
+        const auto sampleLength = static_cast<int>(sampleRate) * 10;
+        juce::AudioBuffer<float> source(2, sampleLength);
+        juce::Random random(1234);
+        for (int ch = 0; ch < 2; ++ch)
+            for (int i = 0; i < sampleLength; ++i)
+                source.setSample(ch, i, random.nextFloat() * 2.0f - 1.0f);
+
+        juce::Array<juce::var> results;
+
+        for (auto semitones : semitoneShifts)
+        {
+            std::unique_ptr<MultiSamplerInstrument> sampler;
+            juce::MidiBuffer noMidi;
+
+            const auto setUp = [&]
+            {
+                sampler = std::make_unique<MultiSamplerInstrument>();
+                sampler->prepareToPlay(sampleRate, blockSize);
+
+                // One slot per voice, each mapped to a single key and re-rooted
+                // so every voice plays at the same pitch ratio
+                for (int slot = 0; slot < numVoices; ++slot)
+                {
+                    MultiSamplerInstrument::SampleConfig config;
+                    config.minNote = config.maxNote = 48 + slot;
+                    config.rootNote = 48 + slot - semitones;
+                    sampler->loadSampleFromBuffer(slot, source, sampleRate, config);
+                }
+
+                for (int slot = 0; slot < numVoices; ++slot)
+                    sampler->noteOn(48 + slot, 0.5f);
+            };
+
+            const auto render = [&](juce::AudioBuffer<float>& buffer)
+            {
+                buffer.clear();
+                sampler->renderNextBlock(buffer, noMidi, 0, blockSize);
+            };
+
+            const auto nsPerSample = measure(settings, setUp, render);
+            results.add(makeResult({ { "semitones", semitones },
+                                     { "pitchRatio", std::exp2(semitones / 12.0) },
+                                     { "voices", numVoices },
+                                     { "nsPerSample", nsPerSample },
+                                     { "nsPerVoiceSample", nsPerSample / numVoices } }));
+        }
+
+        return results;
+    }
+
+    // ──────────────────────────────────────────
+    // Effects
+    // ──────────────────────────────────────────
+    template <typename Processor>
+    double measureEffect(const Settings& settings, const std::function<void(Processor&)>& configure = {})
+    {
+        Processor processor;
+        juce::Random random(42);
+
+        const auto setUp = [&]
+        {
+            processor.prepareToPlay(sampleRate, blockSize);
+            if (configure)
+                configure(processor);
+        };
+
+        // Fresh noise every block so no effect can go to sleep
+        const auto render = [&](juce::AudioBuffer<float>& buffer)
+        {
+            for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+                for (int i = 0; i < blockSize; ++i)
+                    buffer.setSample(ch, i, random.nextFloat() * 0.5f - 0.25f);
+
+            processor.processBlock(buffer);
+        };
+
+        return measure(settings, setUp, render);
+    }
+
+    juce::var benchmarkEffects(const Settings& settings)
+    {
+        juce::Array<juce::var> results;
+
+        // Noise generation is part of every effect run; report it so it can be subtracted
+        struct NoEffect
+        {
+            void prepareToPlay(double, int) {}
+            void processBlock(juce::AudioBuffer<float>&) {}
+        };
+        results.add(makeResult({ { "effect", "none" }, { "nsPerSample", measureEffect<NoEffect>(settings) } }));
+
+        results.add(makeResult({ { "effect", "reverb" }, { "nsPerSample", measureEffect<SimpleReverbProcessor>(settings) } }));
+        results.add(makeResult({ { "effect", "delay" }, { "nsPerSample", measureEffect<SimpleDelayProcessor>(settings) } }));
+
+        const std::pair<SimpleFilterProcessor::FilterType, const char*> filterTypes[] = {
+            { SimpleFilterProcessor::FilterType::LowPass, "filter (lowpass)" },
+            { SimpleFilterProcessor::FilterType::HighPass, "filter (highpass)" },
+            { SimpleFilterProcessor::FilterType::BandPass, "filter (bandpass)" },
+        };
+        for (const auto& [type, name] : filterTypes)
+        {
+            const auto nsPerSample = measureEffect<SimpleFilterProcessor>(settings, [type = type](SimpleFilterProcessor& filter)
+            {
+                filter.setFilterType(type);
+            });
+            results.add(makeResult({ { "effect", name }, { "nsPerSample", nsPerSample } }));
+        }
+
+        results.add(makeResult({ { "effect", "compressor" }, { "nsPerSample", measureEffect<SimpleCompressorProcessor>(settings) } }));
+
+        // Listed so the JSON covers every EffectType; Instrument can't create these yet
+        for (auto name : { "chorus", "distortion" })
+            results.add(makeResult({ { "effect", name }, { "available", false } }));
+
+        return results;
+    }
+
+    // ──────────────────────────────────────────
+    // Reverb routing
+    // ──────────────────────────────────────────
+    juce::var benchmarkReverbRouting(const Settings& settings)
+    {
+        constexpr int numChannels = AudioEngine::maxChannels;
+        juce::Array<juce::var> results;
+
+        for (const bool useSendBus : { false, true })
+        {
+            std::unique_ptr<AudioEngine> engine;
+
+            const auto setUp = [&]
+            {
+                engine = std::make_unique<AudioEngine>();
+                engine->prepareToPlay(sampleRate, blockSize);
+
+                if (useSendBus)
+                    engine->setSendBusEffect(1, Instrument::EffectType::Reverb);
+
+                for (int channel = 1; channel <= numChannels; ++channel)
+                {
+                    engine->createOscillatorInstrument(channel);
+                    if (useSendBus)
+                        engine->setSendLevel(channel, 1, 0.3f);
+                    else
+                        engine->addEffect(channel, Instrument::EffectType::Reverb);
+                    engine->noteOn(channel, 48 + channel, 0.5f);
+                }
+            };
+
+            const auto render = [&](juce::AudioBuffer<float>& buffer)
+            {
+                engine->renderNextBlock(buffer, AudioEngine::getHostTimeNs());
+            };
+
+            results.add(makeResult({ { "routing", useSendBus ? "send bus" : "insert per channel" },
+                                     { "channels", numChannels },
+                                     { "nsPerSample", measure(settings, setUp, render) } }));
+            engine->shutdown();
+        }
+
+        return results;
+    }
+
+    // ──────────────────────────────────────────
+    // Metering
+    // ──────────────────────────────────────────
+    juce::var benchmarkMetering(const Settings& settings)
+    {
+        juce::Array<juce::var> results;
+
+        for (const bool silent : { false, true })
+        {
+            LoudnessMeter meter;
+            juce::Random random(42);
+
+            const auto setUp = [&] { meter.prepare(sampleRate, blockSize); };
+
+            // Noise generation is included; see effects "none" for its cost
+            const auto render = [&](juce::AudioBuffer<float>& buffer)
+            {
+                if (silent)
+                {
+                    meter.processSilence(blockSize);
+                    return;
+                }
+
+                for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+                    for (int i = 0; i < blockSize; ++i)
+                        buffer.setSample(ch, i, random.nextFloat() * 0.5f - 0.25f);
+
+                meter.process(buffer, blockSize);
+            };
+
+            results.add(makeResult({ { "signal", silent ? "silence" : "noise" },
+                                     { "nsPerSample", measure(settings, setUp, render) } }));
+        }
+
+        return results;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    Settings settings;
+    std::vector<int> voiceCounts { 1, 2, 4, 8, 16, 32, 64, 128, 256 };
+    std::vector<int> bankVoiceCounts { 8, 16, 32, 64, 128 };
+    juce::String outputPath;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--quick") == 0)
+        {
+            settings.blocks = 16;
+            settings.repeats = 1;
+            voiceCounts = { 1, 16, 256 };
+            bankVoiceCounts = { 16, 64 };
+        }
+        else if (std::strcmp(argv[i], "--blocks") == 0 && i + 1 < argc)
+            settings.blocks = juce::jmax(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--repeats") == 0 && i + 1 < argc)
+            settings.repeats = juce::jmax(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+            outputPath = argv[++i];
+    }
+
+    auto* report = new juce::DynamicObject();
+    report->setProperty("benchmark", "AudioEngineBenchmark");
+    report->setProperty("timestamp", juce::Time::getCurrentTime().toISO8601(true));
+    report->setProperty("compiler", __VERSION__);
+   #if JUCE_DEBUG
+    report->setProperty("debugBuild", true);
+   #else
+    report->setProperty("debugBuild", false);
+   #endif
+    report->setProperty("cpu", juce::SystemStats::getCpuModel());
+    report->setProperty("numCpus", juce::SystemStats::getNumCpus());
+    report->setProperty("sampleRate", sampleRate);
+    report->setProperty("blockSize", blockSize);
+    report->setProperty("blocks", settings.blocks);
+    report->setProperty("repeats", settings.repeats);
+    report->setProperty("oscillator", benchmarkOscillators(settings, voiceCounts));
+    report->setProperty("voiceBank", benchmarkVoiceBank(settings, bankVoiceCounts));
+    report->setProperty("sampler", benchmarkSampler(settings));
+    report->setProperty("effects", benchmarkEffects(settings));
+    report->setProperty("reverbRouting", benchmarkReverbRouting(settings));
+    report->setProperty("metering", benchmarkMetering(settings));
+
+    const auto json = juce::JSON::toString(juce::var(report));
+
+    if (outputPath.isNotEmpty())
+    {
+        const auto file = juce::File::getCurrentWorkingDirectory().getChildFile(outputPath);
+        if (!file.replaceWithText(json + "\n"))
+        {
+            std::fprintf(stderr, "Can't write %s\n", file.getFullPathName().toRawUTF8());
+            return 1;
+        }
+    }
+    else
+    {
+        std::printf("%s\n", json.toRawUTF8());
+    }
+
+    return 0;
+}
@@ -0,0 +1,467 @@
+/**
+ * RealtimeSafetyTest - Renders on one thread while another drives every
+ * control API of the engine, and fails if the render path allocated, freed
+ * or took a lock while doing so (see RealtimeSafety.h).
+ *
+ *   RealtimeSafetyTest [--rounds N]
+ *
+ * Runs once at the device block size and once with a processing quantum,
+ * with and without render worker threads. Prints each recorded violation
+ * with its stack, and exits with 1 if there were any (or if the hooks
+ * aren't linked in, which would make a clean run meaningless).
+ */
+#include "AudioEngine.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 256;
+
+    /** Calls renderNextBlock() in a loop until stopped, like a device would. */
+    class RenderThread
+    {
+    public:
+        explicit RenderThread(AudioEngine& engineToRender)
+            : engine(engineToRender)
+            , buffer(2, blockSize)
+            , thread([this] { run(); })
+        {
+        }
+
+        ~RenderThread()
+        {
+            running.store(false, std::memory_order_relaxed);
+            thread.join();
+        }
+
+        juce::int64 getBlocksRendered() const { return blocksRendered.load(std::memory_order_relaxed); }
+
+    private:
+        void run()
+        {
+            while (running.load(std::memory_order_relaxed))
+            {
+                engine.renderNextBlock(buffer, AudioEngine::getHostTimeNs());
+                blocksRendered.fetch_add(1, std::memory_order_relaxed);
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+        }
+
+        AudioEngine& engine;
+        juce::AudioBuffer<float> buffer;
+        std::atomic<bool> running { true };
+        std::atomic<juce::int64> blocksRendered { 0 };
+        std::thread thread;
+    };
+
+    void pause()
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+
+    void waitForSwap(AudioEngine& engine, int channel)
+    {
+        while (engine.isInstrumentSwapPending(channel))
+            std::this_thread::yield();
+    }
+
+    // Half a second of a decaying sine as raw float PCM, base64 encoded
+    juce::String makeSampleBase64()
+    {
+        std::vector<float> samples(static_cast<size_t>(sampleRate / 2));
+        for (size_t i = 0; i < samples.size(); ++i)
+        {
+            const auto t = static_cast<double>(i) / sampleRate;
+            samples[i] = static_cast<float>(std::sin(2.0 * juce::MathConstants<double>::pi * 440.0 * t) * std::exp(-6.0 * t));
+        }
+        return juce::Base64::toBase64(samples.data(), samples.size() * sizeof(float));
+    }
+
+    void driveOscillatorChannel(AudioEngine& engine, int channel, bool simdVoices)
+    {
+        Config config;
+        config.polyphony = 8;
+        config.waveform = BaseOscillatorVoice::Waveform::Saw;
+        config.simdVoices = simdVoices;
+        engine.createOscillatorInstrument(channel, config);
+
+        const auto reverb = engine.addEffect(channel, Instrument::EffectType::Reverb);
+        const auto delay = engine.addEffect(channel, Instrument::EffectType::Delay);
+        const auto filter = engine.addEffect(channel, Instrument::EffectType::Filter);
+
+        for (int note = 48; note < 60; note += 3)
+            engine.noteOn(channel, note, 0.8f);
+        pause();
+
+        engine.setWaveform(channel, BaseOscillatorVoice::Waveform::Square);
+        engine.setDetune(channel, 7.0f);
+        engine.setADSR(channel, 0.005f, 0.1f, 0.6f, 0.2f);
+        engine.setVolume(channel, 0.4f);
+        engine.setPan(channel, 0.2f);
+        engine.setEffectParameter(channel, reverb, "roomSize", 0.9f);
+        engine.setEffectParameter(channel, delay, "delayTime", 0.25f);
+        engine.setEffectParameter(channel, delay, "feedback", 0.6f);
+        engine.setEffectParameter(channel, filter, "cutoff", 800.0f);
+        engine.setEffectParameter(channel, filter, "resonance", 2.0f);
+        engine.setEffectParameter(channel, filter, "type", 1.0f);
+        engine.setEffectEnabled(channel, delay, false);
+        pause();
+
+        // Sweep the filter while it plays
+        for (int step = 0; step < 8; ++step)
+        {
+            engine.setEffectParameter(channel, filter, "cutoff", 200.0f + 600.0f * static_cast<float>(step));
+            pause();
+        }
+
+        engine.setEffectEnabled(channel, delay, true);
+        engine.removeEffect(channel, reverb);
+        pause();
+
+        // Change patch under the held notes, then again mid-crossfade
+        config.waveform = BaseOscillatorVoice::Waveform::Triangle;
+        engine.swapOscillatorInstrument(channel, config);
+        waitForSwap(engine, channel);
+        engine.noteOn(channel, 62, 0.8f);
+        config.adsrParams.attack = 0.02f;
+        config.simdVoices = !simdVoices;  // crossfade across to the other voice renderer
+        engine.swapOscillatorInstrument(channel, config, 5.0);
+        waitForSwap(engine, channel);
+        engine.swapOscillatorInstrument(channel, config, 50.0);
+        engine.setEffectParameter(channel, delay, "feedback", 0.3f);
+        waitForSwap(engine, channel);
+        pause();
+
+        // An imported wavetable under the held notes, then back and forth
+        std::vector<float> cycle(300);
+        for (size_t i = 0; i < cycle.size(); ++i)
+            cycle[i] = static_cast<float>(i % 100) / 50.0f - 1.0f;
+        engine.setWavetable(channel, Wavetable::fromCycle(cycle.data(), static_cast<int>(cycle.size())));
+        waitForSwap(engine, channel);
+        engine.noteOn(channel, 96, 0.8f);
+        engine.setWaveform(channel, BaseOscillatorVoice::Waveform::Saw);
+        pause();
+        engine.setWaveform(channel, BaseOscillatorVoice::Waveform::Wavetable);
+        pause();
+
+        engine.noteOff(channel, 48);
+        engine.allNotesOff(channel);
+        engine.addEffect(channel, Instrument::EffectType::Reverb);
+        pause();
+        engine.clearEffects(channel);
+        pause();
+    }
+
+    void driveSamplerChannel(AudioEngine& engine, int channel, const juce::String& sampleData)
+    {
+        engine.createMultiSamplerInstrument(channel);
+
+        MultiSamplerConfig::SampleConfig low;
+        low.name = "low";
+        low.maxNote = 59;
+        engine.loadSampleFromBase64(channel, 0, sampleData, sampleRate, 1, low);
+
+        MultiSamplerConfig::SampleConfig high;
+        high.name = "high";
+        high.rootNote = 72;
+        high.minNote = 60;
+        engine.loadSampleFromBase64(channel, 1, sampleData, sampleRate, 1, high);
+
+        engine.noteOn(channel, 55, 0.9f);
+        engine.noteOn(channel, 67, 0.9f);
+        pause();
+
+        engine.setVolume(channel, 0.5f);
+        engine.setPan(channel, 0.8f);
+        engine.noteOff(channel, 55);
+        pause();
+
+        MultiSamplerConfig::Config config;
+        config.polyphony = 8;
+        engine.swapMultiSamplerInstrument(channel, config);
+        waitForSwap(engine, channel);
+        engine.noteOn(channel, 67, 0.9f);
+        pause();
+
+        // Replaced and cleared while voices still play them
+        engine.loadSampleFromBase64(channel, 1, sampleData, sampleRate, 1, high);
+        engine.noteOn(channel, 55, 0.9f);
+        pause();
+        engine.clearSample(channel, 1);
+        pause();
+        engine.clearAllSamples(channel);
+        engine.noteOn(channel, 60, 0.9f);
+        pause();
+
+        engine.allNotesOff(channel);
+        pause();
+    }
+
+    void driveTransport(AudioEngine& engine, int channel)
+    {
+        std::vector<LoopSequencer::Event> events;
+        for (int step = 0; step < 8; ++step)
+        {
+            events.push_back({ step * 50.0, true, 60 + step, 0.7f });
+            events.push_back({ step * 50.0 + 40.0, false, 60 + step, 0.0f });
+        }
+
+        engine.setSequence(channel, events, 400.0);
+        engine.startTransport();
+        pause();
+
+        engine.startRecording(channel);
+        engine.noteOn(channel, 64, 0.6f);
+        pause();
+        engine.noteOff(channel, 64);
+        pause();
+        engine.stopRecording(channel);
+
+        // Timed notes a few blocks ahead, and one already late
+        const auto now = AudioEngine::getHostTimeNs();
+        engine.scheduleNoteOn(channel, 72, 0.7f, now + 5'000'000);
+        engine.scheduleNoteOff(channel, 72, now + 15'000'000);
+        engine.scheduleNoteOn(channel, 74, 0.7f, now - 1'000'000);
+        engine.scheduleNoteOff(channel, 74, now + 2'000'000);
+        pause();
+
+        // Parked far ahead, then dropped again by all-notes-off
+        engine.scheduleNoteOn(channel, 76, 0.7f, now + 1'000'000'000);
+        pause();
+        engine.allNotesOff(channel);
+        pause();
+
+        LoopSequencer::PlaybackEvent played[64];
+        engine.readSequencerEvents(played, 64);
+        engine.getHeardTransportPositionMs();
+        engine.getOutputLatencyMs();
+
+        engine.stopTransport();
+        engine.clearSequence(channel);
+        pause();
+    }
+
+    void driveMasterBus(AudioEngine& engine)
+    {
+        engine.setMasterVolume(0.6f);
+        engine.setMasterEqBand(MasterBus::EqBand::LowShelf, 120.0f, 3.0f, 0.7f);
+        engine.setMasterEqBand(MasterBus::EqBand::Peak, 2000.0f, -2.0f, 1.5f);
+        engine.setMasterEqBand(MasterBus::EqBand::HighShelf, 9000.0f, 1.5f, 0.7f);
+        engine.setMasterEqEnabled(true);
+        engine.setMasterCompressor(-18.0f, 3.0f, 5.0f, 80.0f, 2.0f);
+        engine.setMasterCompressorEnabled(true);
+        engine.setMasterLimiter(-1.0f, 60.0f);
+        engine.setMasterLimiterEnabled(true);
+        pause();
+
+        engine.setMasterEqEnabled(false);
+        engine.setMasterCompressorEnabled(false);
+        pause();
+        engine.setMasterEqEnabled(true);
+        engine.setMasterCompressorEnabled(true);
+        pause();
+    }
+
+    void driveSendBuses(AudioEngine& engine)
+    {
+        engine.setSendBusEffect(1, Instrument::EffectType::Reverb);
+        engine.setSendBusEffect(2, Instrument::EffectType::Delay);
+        for (int channel = 1; channel <= 6; ++channel)
+            engine.setSendLevel(channel, channel % 2 + 1, 0.4f);
+        pause();
+
+        engine.setSendBusParameter(1, "roomSize", 0.9f);
+        engine.setSendBusParameter(2, "delayTime", 120.0f);
+        engine.setSendBusReturnLevel(1, 0.6f);
+        engine.setSendLevel(3, 1, 0.0f);
+        pause();
+
+        // Replace the reverb while it rings, then drop the delay
+        engine.setSendBusEffect(1, Instrument::EffectType::Reverb);
+        pause();
+        engine.clearSendBusEffect(2);
+        pause();
+    }
+
+    /** Leaves 2 keyed from 1, 3 from 2 and 4 from sampler channel 5 in place. */
+    void driveSidechains(AudioEngine& engine)
+    {
+        for (int channel = 2; channel <= 4; ++channel)
+        {
+            const auto compressor = engine.addEffect(channel, Instrument::EffectType::Compressor);
+            engine.setEffectParameter(channel, compressor, "threshold", -30.0f);
+            engine.setEffectParameter(channel, compressor, "ratio", 8.0f);
+            engine.setEffectSidechain(channel, compressor, channel < 4 ? channel - 1 : 5);
+        }
+        pause();
+
+        // Refused: it would key channel 1 from itself through 2
+        const auto loop = engine.addEffect(1, Instrument::EffectType::Compressor);
+        engine.setEffectSidechain(1, loop, 2);
+        engine.setEffectSidechain(1, loop, 0);
+        engine.removeEffect(1, loop);
+        pause();
+    }
+
+    void driveBatch(AudioEngine& engine, int channel)
+    {
+        // A chord with a timed release, parameter changes and one bad record, in one call
+        const BatchRecord records[] = {
+            { BatchRecord::Op::NoteOn, static_cast<uint8_t>(channel), 60, 0, 0, 0.8f, 0.0f },
+            { BatchRecord::Op::NoteOn, static_cast<uint8_t>(channel), 64, 0, 0, 0.8f, 0.0f },
+            { BatchRecord::Op::NoteOn, static_cast<uint8_t>(channel), 67, 0, 0, 0.8f, 2.0f },
+            { BatchRecord::Op::SetVolume, static_cast<uint8_t>(channel), 0, 0, 0, 0.7f, 0.0f },
+            { BatchRecord::Op::SetWaveform, static_cast<uint8_t>(channel), 1, 0, 0, 0.0f, 0.0f },
+            { BatchRecord::Op::SetSendLevel, static_cast<uint8_t>(channel), 1, 0, 0, 0.3f, 0.0f },
+            { BatchRecord::Op::NoteOn, 99, 60, 0, 0, 0.8f, 0.0f },
+            { BatchRecord::Op::AllNotesOff, static_cast<uint8_t>(channel), 0, 0, 0, 0.0f, 10.0f },
+        };
+        engine.submitBatch(records, sizeof(records));
+        pause();
+    }
+
+    void driveStats(AudioEngine& engine)
+    {
+        engine.getActiveChannelCount();
+        engine.getActiveChannels();
+        engine.getBypassStats();
+        engine.getPerformanceStats();
+        engine.getCommandQueueDepth();
+        engine.getMasterLatencySamples();
+        engine.getMasterGainReductionDb();
+        engine.getTransportPositionMs();
+        engine.resetPerformanceStats();
+        engine.getMeters();
+        engine.resetLoudness();
+        EngineTelemetry::Snapshot telemetry;
+        engine.getTelemetry().read(telemetry);
+        pause();
+
+        // Analysis runs on its own thread; the render path only copies
+        AudioAnalyzer::Frame frame;
+        engine.attachAnalyzer(0);
+        engine.attachAnalyzer(1);
+        pause();
+        engine.getAnalyzerFrame(0, frame);
+        std::array<float, AudioAnalyzer::numSpectrumBins> spectrum;
+        std::array<float, AudioAnalyzer::scopeLength> scope;
+        double frameSampleRate = 0.0;
+        engine.copyAnalyzerFrame(1, spectrum.data(), scope.data(), frameSampleRate);
+        engine.detachAnalyzer(1);
+        pause();
+        engine.detachAnalyzer(0);
+    }
+
+    /** One pass over the control API while renderer keeps rendering. */
+    void driveEngine(AudioEngine& engine, const juce::String& sampleData)
+    {
+        driveMasterBus(engine);
+        driveSendBuses(engine);
+
+        // Voice bank on 1-2, juce::Synthesiser voices on 3-4
+        for (int channel = 1; channel <= 4; ++channel)
+            driveOscillatorChannel(engine, channel, channel <= 2);
+
+        driveSamplerChannel(engine, 5, sampleData);
+        driveSamplerChannel(engine, 6, sampleData);
+        driveTransport(engine, 1);
+        driveTransport(engine, 5);
+        driveSidechains(engine);
+        driveBatch(engine, 2);
+
+        // Everything sounding at once, across worker threads
+        engine.setRenderThreadCount(2);
+        for (int channel = 1; channel <= 6; ++channel)
+            engine.noteOn(channel, 60, 0.5f);
+        pause();
+        driveStats(engine);
+        engine.setRenderThreadCount(0);
+        pause();
+
+        // Swap the whole session for a saved copy of itself, mid-note
+        const auto snapshot = juce::File::createTempFile(".rnal");
+        engine.saveSnapshot(snapshot);
+        engine.loadSnapshot(snapshot);
+        snapshot.deleteFile();
+        pause();
+
+        engine.allNotesOffAllChannels();
+        engine.clearAllSamples(5);
+        engine.removeInstrument(6);
+        pause();
+        engine.clearAllInstruments();
+        pause();
+    }
+
+    bool runPass(const char* name, int processingQuantum, int rounds, const juce::String& sampleData)
+    {
+        AudioEngine engine;
+        engine.setProcessingQuantum(processingQuantum);
+        engine.prepareToPlay(sampleRate, blockSize);
+
+        // Prepared state and the first blocks are set up off the render path
+        engine.resetRealtimeViolations();
+
+        juce::int64 blocks = 0;
+        {
+            RenderThread renderer(engine);
+            for (int round = 0; round < rounds; ++round)
+                driveEngine(engine, sampleData);
+            blocks = renderer.getBlocksRendered();
+        }
+
+        const auto counts = engine.getRealtimeViolationCounts();
+        std::printf("%-10s %lld blocks, %lld allocations, %lld frees, %lld locks\n", name,
+                    static_cast<long long>(blocks),
+                    static_cast<long long>(counts.allocations),
+                    static_cast<long long>(counts.deallocations),
+                    static_cast<long long>(counts.locks));
+
+        // The same stack tends to repeat every block; print each one once
+        juce::StringArray seen;
+        for (const auto& description : engine.describeRealtimeViolations())
+        {
+            if (!seen.contains(description))
+            {
+                seen.add(description);
+                std::printf("  %s\n", description.toRawUTF8());
+            }
+        }
+
+        engine.shutdown();
+        return counts.getTotal() == 0 && blocks > 0;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    int rounds = 3;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--rounds") == 0)
+            rounds = juce::jmax(1, std::atoi(argv[i + 1]));
+    }
+
+    if (!RealtimeSafety::isEnabled() || !RealtimeSafety::areHooksInstalled())
+    {
+        std::fprintf(stderr, "Realtime checks are not active in this build\n");
+        return 1;
+    }
+
+    const auto sampleData = makeSampleBase64();
+
+    bool passed = true;
+    passed = runPass("device", 0, rounds, sampleData) && passed;
+    passed = runPass("quantum", 64, rounds, sampleData) && passed;
+
+    std::printf("%s\n", passed ? "OK" : "FAILED: the render path allocated, freed or locked");
+    return passed ? 0 : 1;
+}
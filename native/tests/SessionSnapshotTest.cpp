@@ -0,0 +1,213 @@
+/**
+ * SessionSnapshotTest - Saves a session with oscillator, wavetable, effect, sidechain,
+ * sampler, sequence, send bus and master bus settings, loads it into a fresh engine and checks
+ * that it comes back the same:
+ *
+ *   - saving the loaded session gives a byte-identical file
+ *   - sample frames are memory-mapped and match what was loaded
+ *   - the loaded session plays
+ *   - a truncated or foreign file is rejected, leaving the session alone
+ *
+ *   SessionSnapshotTest [--dir path]
+ */
+#include "AudioEngine.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 256;
+
+    int failures = 0;
+
+    void check(bool condition, const char* what)
+    {
+        if (!condition)
+        {
+            std::printf("FAILED: %s\n", what);
+            ++failures;
+        }
+    }
+
+    // A second of a decaying stereo sine as interleaved raw float PCM, base64 encoded
+    juce::String makeSampleBase64(double frequency)
+    {
+        const auto numFrames = static_cast<size_t>(sampleRate);
+        std::vector<float> samples(numFrames * 2);
+        for (size_t i = 0; i < numFrames; ++i)
+        {
+            const auto t = static_cast<double>(i) / sampleRate;
+            const auto value = static_cast<float>(std::sin(2.0 * juce::MathConstants<double>::pi * frequency * t) * std::exp(-3.0 * t));
+            samples[i * 2] = value;
+            samples[i * 2 + 1] = -value;
+        }
+        return juce::Base64::toBase64(samples.data(), samples.size() * sizeof(float));
+    }
+
+    void buildSession(AudioEngine& engine)
+    {
+        Config config;
+        config.polyphony = 6;
+        config.waveform = BaseOscillatorVoice::Waveform::Saw;
+        config.name = "Lead";
+        engine.createOscillatorInstrument(1, config);
+        engine.setDetune(1, 5.0f);
+        engine.setADSR(1, 0.02f, 0.2f, 0.5f, 0.4f);
+        engine.setPan(1, 0.3f);
+
+        const auto delay = engine.addEffect(1, Instrument::EffectType::Delay);
+        const auto filter = engine.addEffect(1, Instrument::EffectType::Filter);
+        const auto reverb = engine.addEffect(1, Instrument::EffectType::Reverb);
+        engine.setEffectParameter(1, delay, "delayTime", 0.3f);
+        engine.setEffectParameter(1, delay, "feedback", 0.4f);
+        engine.setEffectParameter(1, filter, "cutoff", 1200.0f);
+        engine.setEffectEnabled(1, filter, false);
+        engine.removeEffect(1, reverb);
+
+        // Ducked by the sampler on channel 2
+        const auto compressor = engine.addEffect(1, Instrument::EffectType::Compressor);
+        engine.setEffectParameter(1, compressor, "threshold", -24.0f);
+        engine.setEffectParameter(1, compressor, "ratio", 6.0f);
+        engine.setEffectParameter(1, compressor, "release", 200.0f);
+        engine.setEffectSidechain(1, compressor, 2);
+
+        engine.createMultiSamplerInstrument(2);
+        MultiSamplerConfig::SampleConfig low;
+        low.name = "low";
+        low.maxNote = 59;
+        engine.loadSampleFromBase64(2, 0, makeSampleBase64(220.0), sampleRate, 2, low);
+
+        MultiSamplerConfig::SampleConfig high;
+        high.name = "high";
+        high.rootNote = 72;
+        high.minNote = 60;
+        engine.loadSampleFromBase64(2, 3, makeSampleBase64(880.0), sampleRate, 2, high);
+        engine.setVolume(2, 0.6f);
+
+        engine.createOscillatorInstrument(3);
+        engine.removeInstrument(3);
+
+        // An imported cycle of odd length, so it's resampled on the way in
+        std::vector<float> cycle(600);
+        for (size_t i = 0; i < cycle.size(); ++i)
+            cycle[i] = std::tanh(3.0f * std::sin(2.0f * juce::MathConstants<float>::pi * static_cast<float>(i) / 600.0f));
+        engine.createOscillatorInstrument(4);
+        check(engine.setWavetable(4, Wavetable::fromCycle(cycle.data(), static_cast<int>(cycle.size()))), "set wavetable");
+
+        engine.setSequence(1, { { 0.0, true, 60, 0.8f }, { 100.0, false, 60, 0.0f } }, 250.0);
+        engine.setSequence(2, { { 0.0, true, 55, 0.9f }, { 50.0, true, 67, 0.7f }, { 300.0, false, 55, 0.0f } }, 500.0);
+
+        engine.setSendBusEffect(1, Instrument::EffectType::Reverb);
+        engine.setSendBusParameter(1, "roomSize", 0.85f);
+        engine.setSendBusReturnLevel(1, 0.7f);
+        engine.setSendBusEffect(3, Instrument::EffectType::Delay);
+        engine.setSendLevel(1, 1, 0.4f);
+        engine.setSendLevel(2, 1, 0.25f);
+        engine.setSendLevel(2, 3, 0.5f);
+
+        engine.setMasterVolume(0.8f);
+        engine.setMasterEqBand(MasterBus::EqBand::Peak, 1500.0f, -3.0f, 1.2f);
+        engine.setMasterEqEnabled(true);
+        engine.setMasterLimiter(-2.0f, 80.0f);
+    }
+
+    bool haveSameContent(const juce::File& a, const juce::File& b)
+    {
+        juce::MemoryBlock first, second;
+        return a.loadFileAsData(first) && b.loadFileAsData(second) && first == second;
+    }
+
+    float renderPeak(AudioEngine& engine, int numBlocks)
+    {
+        juce::AudioBuffer<float> buffer(2, blockSize);
+        float peak = 0.0f;
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            engine.renderNextBlock(buffer, AudioEngine::getHostTimeNs());
+            peak = juce::jmax(peak, buffer.getMagnitude(0, blockSize));
+        }
+        return peak;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    auto directory = juce::File::getSpecialLocation(juce::File::tempDirectory);
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--dir") == 0)
+            directory = juce::File(argv[i + 1]);
+    }
+    directory.createDirectory();
+
+    const auto original = directory.getChildFile("snapshot_original.rnal");
+    const auto resaved = directory.getChildFile("snapshot_resaved.rnal");
+    const auto broken = directory.getChildFile("snapshot_broken.rnal");
+
+    AudioEngine source;
+    source.prepareToPlay(sampleRate, blockSize);
+    buildSession(source);
+    check(source.saveSnapshot(original).wasOk(), "save");
+
+    AudioEngine loaded;
+    loaded.prepareToPlay(sampleRate, blockSize);
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto result = loaded.loadSnapshot(original);
+    const auto loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    check(result.wasOk(), "load");
+    std::printf("loaded %lld bytes in %.3f ms\n", static_cast<long long>(original.getSize()), loadMs);
+
+    check(loaded.saveSnapshot(resaved).wasOk(), "save loaded session");
+    check(haveSameContent(original, resaved), "loaded session saves identically");
+
+    check(loaded.getInstrumentType(1) == AudioEngine::InstrumentType::Oscillator, "channel 1 is an oscillator");
+    check(!loaded.hasInstrument(3), "channel 3 is empty");
+
+    auto* sampler = loaded.getMultiSamplerInstrument(2);
+    check(sampler != nullptr && sampler->getLoadedSampleCount() == 2, "channel 2 has both samples");
+    if (sampler != nullptr)
+    {
+        const auto sourceData = source.getMultiSamplerInstrument(2)->getSampleData(3);
+        const auto mappedData = sampler->getSampleData(3);
+        check(sampler->getSampleName(3) == "high" && sampler->getSampleRootNote(3) == 72, "sample config");
+        check(mappedData != nullptr && mappedData->mapping != nullptr, "sample frames are mapped");
+
+        if (sourceData != nullptr && mappedData != nullptr)
+        {
+            bool same = sourceData->sampleRate == mappedData->sampleRate
+                     && sourceData->buffer.getNumChannels() == mappedData->buffer.getNumChannels()
+                     && sourceData->buffer.getNumSamples() == mappedData->buffer.getNumSamples();
+            for (int channel = 0; same && channel < sourceData->buffer.getNumChannels(); ++channel)
+                same = std::memcmp(sourceData->buffer.getReadPointer(channel), mappedData->buffer.getReadPointer(channel),
+                                   static_cast<size_t>(sourceData->buffer.getNumSamples()) * sizeof(float)) == 0;
+            check(same, "sample frames match");
+        }
+    }
+
+    loaded.startTransport();
+    check(renderPeak(loaded, 100) > 0.01f, "loaded session plays");
+    loaded.stopTransport();
+
+    // Half a file, then something that isn't a snapshot at all
+    juce::MemoryBlock data;
+    original.loadFileAsData(data);
+    broken.replaceWithData(data.getData(), data.getSize() / 2);
+    check(loaded.loadSnapshot(broken).failed(), "truncated file is rejected");
+    broken.replaceWithText("{ \"not\": \"a snapshot\" }");
+    check(loaded.loadSnapshot(broken).failed(), "foreign file is rejected");
+    check(loaded.getMultiSamplerInstrument(2) != nullptr, "failed load leaves the session alone");
+
+    loaded.shutdown();
+    source.shutdown();
+    original.deleteFile();
+    resaved.deleteFile();
+    broken.deleteFile();
+
+    std::printf("%s\n", failures == 0 ? "OK" : "FAILED");
+    return failures == 0 ? 0 : 1;
+}
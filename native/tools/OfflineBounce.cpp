@@ -0,0 +1,84 @@
+/**
+ * OfflineBounce - Renders a session file to WAV or FLAC without an audio
+ * device, as fast as possible, and reports how long it took.
+ *
+ *   OfflineBounce <session.json> <output.wav|output.flac>
+ *                 [--sample-rate HZ] [--block-size N] [--bits 16|24|32] [--threads N]
+ *                 [--quantum N]
+ *
+ * The output only depends on the session and these options, so two runs can
+ * be compared byte for byte (see the offline_bounce tests in CMakeLists.txt).
+ */
+#include "OfflineRenderer.h"
+#include <cstdio>
+#include <cstring>
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        std::fprintf(stderr, "Usage: %s <session.json> <output.wav|output.flac> "
+                             "[--sample-rate HZ] [--block-size N] [--bits 16|24|32] [--threads N] [--quantum N]\n", argv[0]);
+        return 2;
+    }
+
+    const auto cwd = juce::File::getCurrentWorkingDirectory();
+    const auto sessionFile = cwd.getChildFile(argv[1]);
+    const auto outputFile = cwd.getChildFile(argv[2]);
+
+    OfflineRenderer::Options options;
+    for (int i = 3; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--sample-rate") == 0)
+            options.sampleRate = std::atof(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--block-size") == 0)
+            options.blockSize = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--bits") == 0)
+            options.bitsPerSample = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--threads") == 0)
+            options.renderThreads = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--quantum") == 0)
+            options.processingQuantum = std::atoi(argv[i + 1]);
+        else
+        {
+            std::fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return 2;
+        }
+    }
+
+    if (!sessionFile.existsAsFile())
+    {
+        std::fprintf(stderr, "Session not found: %s\n", sessionFile.getFullPathName().toRawUTF8());
+        return 1;
+    }
+
+    OfflineRenderer::Session session;
+    const auto parsed = OfflineRenderer::parseSession(sessionFile.loadFileAsString(),
+                                                      sessionFile.getParentDirectory(), session);
+    if (parsed.failed())
+    {
+        std::fprintf(stderr, "Invalid session: %s\n", parsed.getErrorMessage().toRawUTF8());
+        return 1;
+    }
+
+    OfflineRenderer renderer(options);
+    const auto rendered = renderer.render(session, outputFile);
+    if (rendered.failed())
+    {
+        std::fprintf(stderr, "Render failed: %s\n", rendered.getErrorMessage().toRawUTF8());
+        return 1;
+    }
+
+    const auto& stats = renderer.getStats();
+    std::printf("%s: %.2f s of audio in %.3f s (%.1fx realtime), block %d @ %.0f Hz, %d worker thread(s)\n",
+                outputFile.getFileName().toRawUTF8(), stats.audioSeconds, stats.renderSeconds,
+                stats.realtimeFactor, options.blockSize, options.sampleRate, options.renderThreads);
+
+    if (stats.notesDropped > 0)
+    {
+        std::fprintf(stderr, "%d notes didn't fit the command queue\n", stats.notesDropped);
+        return 1;
+    }
+
+    return 0;
+}
@@ -6,7 +6,6 @@ import {
   TouchableOpacity,
   Dimensions,
 } from 'react-native';
-import NativeAudioModule from '../../specs/NativeAudioModule';
 import { MidiVisualizer } from './midi-visualiser/MidiVisualiser';
 import Grid, { GridHandle } from './grid/Grid';
 import { createLoopSequence, quantizeEvents } from './utils/loopUtils.ts';
@@ -71,7 +70,7 @@ export default function Player({
   const sequencerRef = useRef(GlobalSequencer.getInstance());
 
   const rawNoteOn = useCallback(
-    (note: number, velocity: number, duration?: number) => {
+    (note: number, velocity: number, duration?: number, gridTime?: number) => {
       // Auto-start recording on first touch if nothing exists yet.
       // Use the sequencer's imperative state (always current) instead of
       // React state which may be stale in closures — otherwise the repeat
@@ -82,8 +81,7 @@ export default function Player({
         startRecording();
       }
 
-      NativeAudioModule.noteOn(channel, note, velocity);
-      pushNoteOn(note, velocity, duration);
+      pushNoteOn(note, velocity, duration, gridTime);
 
       // Live visual feedback (not from sequencer, since we're recording live)
       gridRef.current?.setPadActive(note, true);
@@ -92,9 +90,8 @@ export default function Player({
   );
 
   const rawNoteOff = useCallback(
-    (note: number) => {
-      NativeAudioModule.noteOff(channel, note);
-      pushNoteOff(note);
+    (note: number, gridTime?: number) => {
+      pushNoteOff(note, gridTime);
       gridRef.current?.setPadActive(note, false);
     },
     [channel, pushNoteOff],
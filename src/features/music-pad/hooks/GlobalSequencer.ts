@@ -22,14 +22,10 @@ export interface ChannelDelegate {
 interface ChannelState {
   delegate: ChannelDelegate;
   sequence: LoopSequence | null;
-  activeNotes: Set<number>;
-  eventIndex: number;
-  lastLoopTime: number;
-  // Recording
+  activeNotes: Set<number>; // notes the native sequencer reported as sounding
+  // Recording (events are captured natively; this only drives the visualizer)
   isRecording: boolean;
   recordingStartTime: number;
-  recordingLoopOffset: number; // where in the master loop recording started
-  recordedEvents: NoteEvent[];
 }
 
 export type TransportState = 'stopped' | 'playing';
@@ -46,10 +42,59 @@ const NO_OP_DELEGATE: ChannelDelegate = {
   onLoopWrap() {},
 };
 
+// Native sequencer event types (see NativeAudioModule.pollSequencer). Live
+// notes (3, 4) are skipped: players light their pads on touch.
+const EVENT_NOTE_ON = 0;
+const EVENT_NOTE_OFF = 1;
+const EVENT_LOOP_WRAP = 2;
+
+// pollSequencer(): [positionMs, heardPositionMs, outputLatencyMs, ...events]
+const FRAME_HEADER = 3;
+const EVENT_STRIDE = 5;
+
+// A frame built now is on screen about half a refresh later
+const FRAME_LEAD_MS = 8;
+
+/** A played event waiting for its sound to reach the speaker. */
+interface PendingEvent {
+  dueAt: number; // performance.now() time
+  channel: number;
+  type: number;
+  note: number;
+  velocity: number;
+}
+
+/** [timestampMs, isNoteOn, note, velocity] per event, as the native side expects. */
+function packEvents(events: NoteEvent[]): number[] {
+  const packed: number[] = [];
+  for (const e of events) {
+    packed.push(e.timestamp, e.type === 'noteOn' ? 1 : 0, e.note, e.velocity);
+  }
+  return packed;
+}
+
+function unpackEvents(packed: number[]): NoteEvent[] {
+  const events: NoteEvent[] = [];
+  for (let i = 0; i + 3 < packed.length; i += 4) {
+    events.push({
+      timestamp: packed[i],
+      type: packed[i + 1] ? 'noteOn' : 'noteOff',
+      note: packed[i + 2],
+      velocity: packed[i + 3],
+    });
+  }
+  return events;
+}
+
 // ─────────────────────────────────────────────────────────────────────────────
 // Singleton
 // ─────────────────────────────────────────────────────────────────────────────
 
+/**
+ * Sequences play on the native audio thread; this class uploads them, drives
+ * the transport and records via the native module, and runs a single RAF
+ * loop that polls what was played (one bridge call per frame) to update UI.
+ */
 class GlobalSequencer {
   private static _instance: GlobalSequencer | null = null;
 
@@ -65,7 +110,10 @@ class GlobalSequencer {
   private channels = new Map<number, ChannelState>();
   private rafId: number | null = null;
   private _transportState: TransportState = 'stopped';
-  private globalStartTime = 0;
+  // performance.now() at which transport position 0 was heard (refined every poll)
+  private globalStartTime = Infinity;
+  // Played events in time order, held until they are heard
+  private pendingEvents: PendingEvent[] = [];
   private masterDuration = 0;
 
   private transportListeners = new Set<TransportListener>();
@@ -86,20 +134,17 @@ class GlobalSequencer {
       delegate,
       sequence: null,
       activeNotes: new Set(),
-      eventIndex: 0,
-      lastLoopTime: -1,
       isRecording: false,
       recordingStartTime: 0,
-      recordingLoopOffset: 0,
-      recordedEvents: [],
     });
   }
 
   unregisterChannel(channel: number): void {
     const state = this.channels.get(channel);
     if (!state) return;
-    // Silence anything still ringing
-    state.activeNotes.forEach(n => NativeAudioModule.noteOff(channel, n));
+    // The native sequencer silences anything still ringing
+    NativeAudioModule.clearSequence(channel);
+    if (state.isRecording) NativeAudioModule.stopRecording(channel);
     this.channels.delete(channel);
     if (this.channels.size === 0) this.stop();
   }
@@ -130,8 +175,15 @@ class GlobalSequencer {
       );
     }
     state.sequence = sequence;
-    state.eventIndex = 0;
-    state.lastLoopTime = -1;
+    if (sequence) {
+      NativeAudioModule.setSequence(
+        channel,
+        packEvents(sequence.events),
+        sequence.duration,
+      );
+    } else {
+      NativeAudioModule.clearSequence(channel);
+    }
     this.recalcMasterDuration();
     this.channelSequenceListeners.forEach(fn => fn(channel, sequence));
   }
@@ -159,33 +211,21 @@ class GlobalSequencer {
     if (!s) return;
     s.isRecording = true;
     s.recordingStartTime = performance.now();
-    s.recordedEvents = [];
 
-    // Capture where in the master loop we are so recorded events
-    // can be placed at the correct loop-relative position
-    if (this._transportState === 'playing' && this.masterDuration > 0) {
-      const elapsed = performance.now() - this.globalStartTime;
-      s.recordingLoopOffset = elapsed % this.masterDuration;
-    } else {
-      s.recordingLoopOffset = 0;
-      // Start the RAF loop so delegates receive onTick during recording
-      // even when no sequence is playing yet.
-      this.ensureRAF();
-    }
+    // Live notes on this channel are captured on the audio thread, already
+    // offset to where the master loop was when recording started.
+    NativeAudioModule.startRecording(channel);
+
+    // Start the RAF loop so delegates receive onTick during recording
+    // even when no sequence is playing yet.
+    this.ensureRAF();
   }
 
   stopRecording(channel: number): NoteEvent[] {
     const s = this.channels.get(channel);
     if (!s) return [];
     s.isRecording = false;
-    const offset = s.recordingLoopOffset;
-    // Offset events so they're loop-aligned (e.g. if recording started at
-    // 2000ms into a 4000ms loop, a note played immediately gets timestamp 2000ms)
-    const evts = s.recordedEvents.map(e => ({
-      ...e,
-      timestamp: e.timestamp + offset,
-    }));
-    s.recordedEvents = [];
+    const evts = unpackEvents(NativeAudioModule.stopRecording(channel));
 
     // Stop RAF if nothing else needs it
     if (this._transportState !== 'playing' && !this.isAnyChannelRecording()) {
@@ -198,10 +238,11 @@ class GlobalSequencer {
     return this.channels.get(channel)?.isRecording ?? false;
   }
 
-  /** Called by the Player when the user touches a pad during recording.
-   *  An optional `timestamp` (ms since recording started) overrides the
-   *  auto-computed wall-clock time — used by note-repeat to record
-   *  grid-aligned events without RAF jitter. */
+  /** Called by the Player when the user touches a pad. Plays the note; while
+   *  the channel is recording the audio thread captures it as it plays.
+   *  An optional `timestamp` (performance.now() ms, the clock of
+   *  getNextGridTime()) overrides when it is captured — used by note-repeat
+   *  to record grid-aligned events without RAF jitter. */
   pushRecordEvent(
     channel: number,
     type: 'noteOn' | 'noteOff',
@@ -209,10 +250,20 @@ class GlobalSequencer {
     velocity = 0.85,
     timestamp?: number,
   ): void {
-    const s = this.channels.get(channel);
-    if (!s?.isRecording) return;
-    const ts = timestamp ?? performance.now() - s.recordingStartTime;
-    s.recordedEvents.push({ type, note, timestamp: ts, velocity });
+    if (timestamp == null) {
+      if (type === 'noteOn') NativeAudioModule.noteOn(channel, note, velocity);
+      else NativeAudioModule.noteOff(channel, note);
+      return;
+    }
+
+    // Same instant on the engine's clock, so the take lands on the grid line
+    const recordHostTimeNs =
+      NativeAudioModule.getHostTimeNs() + (timestamp - performance.now()) * 1e6;
+    if (type === 'noteOn') {
+      NativeAudioModule.noteOnRecordedAt(channel, note, velocity, recordHostTimeNs);
+    } else {
+      NativeAudioModule.noteOffRecordedAt(channel, note, recordHostTimeNs);
+    }
   }
 
   // ── Transport ────────────────────────────────────────────────────────────
@@ -222,11 +273,12 @@ class GlobalSequencer {
     if (this.masterDuration === 0) return;
 
     this._transportState = 'playing';
+    this.globalStartTime = Infinity;
 
-    this.channels.forEach(s => {
-      s.eventIndex = 0;
-      s.lastLoopTime = -1;
-    });
+    // Drop anything left over from the previous run before restarting
+    NativeAudioModule.pollSequencer();
+    this.pendingEvents = [];
+    NativeAudioModule.sequencerPlay();
 
     this.emitTransport();
     this.ensureRAF();
@@ -236,15 +288,13 @@ class GlobalSequencer {
     if (this._transportState === 'stopped') return;
     this._transportState = 'stopped';
 
-    // Silence every channel
-    this.channels.forEach((s, ch) => {
-      s.activeNotes.forEach(n => {
-        NativeAudioModule.noteOff(ch, n);
-        s.delegate.onNoteOff(n);
-      });
+    // The native side silences sounding notes; clear their visuals here since
+    // the RAF loop may not be around to deliver the note-offs.
+    NativeAudioModule.sequencerStop();
+    this.pendingEvents = [];
+    this.channels.forEach(s => {
+      s.activeNotes.forEach(n => s.delegate.onNoteOff(n));
       s.activeNotes.clear();
-      s.eventIndex = 0;
-      s.lastLoopTime = -1;
     });
 
     // Stop RAF if no channels are recording
@@ -289,7 +339,6 @@ class GlobalSequencer {
   /** Start RAF if not already running. */
   private ensureRAF(): void {
     if (this.rafId !== null) return;
-    this.globalStartTime = performance.now();
     this.startRAF();
   }
 
@@ -313,12 +362,30 @@ class GlobalSequencer {
       const isRecording = this.isAnyChannelRecording();
 
       // Nothing needs the loop — stop it
-      if (!isPlaying && !isRecording) return;
+      if (!isPlaying && !isRecording) {
+        this.pendingEvents = [];
+        this.rafId = null;
+        return;
+      }
 
       const now = performance.now();
-      const elapsed = now - this.globalStartTime;
 
-      this.channels.forEach((s, ch) => {
+      // ── Everything the audio thread played since the last frame, shown
+      // when it comes out of the speaker rather than when it was rendered ──
+      const frame = NativeAudioModule.pollSequencer();
+      this.queuePlayedEvents(frame, now);
+      this.dispatchDueEvents(now + FRAME_LEAD_MS);
+
+      // Follow the heard position, not the rendered one, so the playhead
+      // lines up with the sound. The smallest now − position seen is the
+      // closest estimate of when position 0 was heard.
+      const heardMs = frame[1];
+      if (isPlaying && heardMs > 0) {
+        this.globalStartTime = Math.min(this.globalStartTime, now - heardMs);
+      }
+      const elapsed = isPlaying ? this.getElapsedMs(now) : 0;
+
+      this.channels.forEach(s => {
         const seq = s.sequence;
 
         // ── Recording-only mode (no sequences playing yet) ────────
@@ -341,42 +408,8 @@ class GlobalSequencer {
           return;
         }
 
-        const loopTime = elapsed % seq.duration;
-
-        // ── Loop wrap ──────────────────────────────────────────────
-        if (loopTime < s.lastLoopTime) {
-          s.activeNotes.forEach(n => {
-            NativeAudioModule.noteOff(ch, n);
-            s.delegate.onNoteOff(n);
-          });
-          s.activeNotes.clear();
-          s.eventIndex = 0;
-          s.delegate.onLoopWrap();
-        }
-
-        // ── Dispatch events ────────────────────────────────────────
-        const evts = seq.events;
-        while (
-          s.eventIndex < evts.length &&
-          evts[s.eventIndex].timestamp <= loopTime
-        ) {
-          const e = evts[s.eventIndex];
-          if (e.type === 'noteOn') {
-            NativeAudioModule.noteOn(ch, e.note, e.velocity);
-            s.activeNotes.add(e.note);
-            s.delegate.onNoteOn(e.note, e.velocity);
-          } else {
-            NativeAudioModule.noteOff(ch, e.note);
-            s.activeNotes.delete(e.note);
-            s.delegate.onNoteOff(e.note);
-          }
-          s.eventIndex++;
-        }
-
         // ── Per-frame tick (playhead, visualizer) ──────────────────
-        s.delegate.onTick(loopTime, seq.duration);
-
-        s.lastLoopTime = loopTime;
+        s.delegate.onTick(elapsed % seq.duration, seq.duration);
       });
 
       this.rafId = requestAnimationFrame(tick);
@@ -385,6 +418,51 @@ class GlobalSequencer {
     this.rafId = requestAnimationFrame(tick);
   }
 
+  /** Queue note / wrap events reported by the native sequencer until they are heard. */
+  private queuePlayedEvents(frame: number[], now: number): void {
+    for (let i = FRAME_HEADER; i + EVENT_STRIDE <= frame.length; i += EVENT_STRIDE) {
+      const type = frame[i + 1];
+      if (type > EVENT_LOOP_WRAP) continue;
+
+      this.pendingEvents.push({
+        dueAt: now + frame[i + 4],
+        channel: frame[i],
+        type,
+        note: frame[i + 2],
+        velocity: frame[i + 3],
+      });
+    }
+  }
+
+  /** Forward queued events heard by `time` to delegates, in order. */
+  private dispatchDueEvents(time: number): void {
+    let count = 0;
+    while (count < this.pendingEvents.length && this.pendingEvents[count].dueAt <= time) {
+      const { channel, type, note, velocity } = this.pendingEvents[count++];
+      const s = this.channels.get(channel);
+      if (!s) continue;
+
+      if (type === EVENT_NOTE_ON) {
+        s.activeNotes.add(note);
+        s.delegate.onNoteOn(note, velocity);
+      } else if (type === EVENT_NOTE_OFF) {
+        if (s.activeNotes.delete(note)) s.delegate.onNoteOff(note);
+      } else if (type === EVENT_LOOP_WRAP) {
+        // Native already released the sounding notes just before this
+        s.activeNotes.clear();
+        s.delegate.onLoopWrap();
+      }
+    }
+    if (count > 0) this.pendingEvents.splice(0, count);
+  }
+
+  /** Transport time (ms) at `now`; 0 until the native transport has moved. */
+  private getElapsedMs(now: number): number {
+    return Number.isFinite(this.globalStartTime)
+      ? Math.max(0, now - this.globalStartTime)
+      : 0;
+  }
+
   // ── Utilities ────────────────────────────────────────────────────────────
 
   hasAnySequence(): boolean {
@@ -413,7 +491,7 @@ class GlobalSequencer {
     if (!s) return 0;
     if (this._transportState === 'playing') {
       const seq = s.sequence;
-      const elapsed = performance.now() - this.globalStartTime;
+      const elapsed = this.getElapsedMs(performance.now());
       const dur = seq ? seq.duration : this.masterDuration;
       return dur > 0 ? elapsed % dur : elapsed;
     }
@@ -431,6 +509,7 @@ class GlobalSequencer {
   getNextGridTime(intervalMs: number): number {
     const now = performance.now();
     if (this._transportState !== 'playing' || intervalMs <= 0) return now;
+    if (!Number.isFinite(this.globalStartTime)) return now;
     const elapsed = now - this.globalStartTime;
     const nextGrid = Math.ceil(elapsed / intervalMs) * intervalMs;
     return this.globalStartTime + nextGrid;
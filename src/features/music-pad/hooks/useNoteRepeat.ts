@@ -66,9 +66,10 @@ export function getIntervalMs(mode: NoteRepeatMode, bpm: number): number {
 
 interface UseNoteRepeatOptions {
   mode: NoteRepeatMode;
-  /** Called to trigger a note. 3rd arg is the predicted visual duration (ms). */
-  onNoteOn: (note: number, velocity: number, duration?: number) => void;
-  onNoteOff: (note: number) => void;
+  /** Called to trigger a note. 3rd arg is the predicted visual duration (ms),
+   *  4th the performance.now() grid line a repeat hit belongs to. */
+  onNoteOn: (note: number, velocity: number, duration?: number, gridTime?: number) => void;
+  onNoteOff: (note: number, gridTime?: number) => void;
 }
 
 /**
@@ -157,17 +158,20 @@ export function useNoteRepeat({
 
     // ── Normal repeat phase ────────────────────────────────────────────
     if (now >= nextTriggerRef.current) {
+      // Advance past any missed boundaries (e.g. if a frame took too long).
+      // The last one passed is the grid line this tick stands for.
+      let gridTime = nextTriggerRef.current;
+      while (nextTriggerRef.current <= now) {
+        gridTime = nextTriggerRef.current;
+        nextTriggerRef.current += intervalMsRef.current;
+      }
+
       // 1. NoteOff all sounding notes (completes their full duration)
       soundingNotesRef.current.forEach(note => {
-        onNoteOffRef.current(note);
+        onNoteOffRef.current(note, gridTime);
       });
       soundingNotesRef.current.clear();
 
-      // Advance past any missed boundaries (e.g. if a frame took too long)
-      while (nextTriggerRef.current <= now) {
-        nextTriggerRef.current += intervalMsRef.current;
-      }
-
       // 2. If no fingers are held, we just sent the final noteOffs — done
       if (heldNotesRef.current.size === 0) {
         rafIdRef.current = null;
@@ -177,7 +181,7 @@ export function useNoteRepeat({
       // 3. Re-trigger all held notes together on this grid tick
       const dur = intervalMsRef.current;
       heldNotesRef.current.forEach((velocity, note) => {
-        onNoteOnRef.current(note, velocity, dur);
+        onNoteOnRef.current(note, velocity, dur, gridTime);
         soundingNotesRef.current.add(note);
       });
     }
@@ -255,8 +259,8 @@ export function useNoteRepeat({
 
   /**
    * Synchronously close all sounding notes and stop the clock.
-   * Call this before commitRecording to ensure the final noteOff events are
-   * pushed to the recording buffer before stopRecording() drains it.
+   * Call this before commitRecording so the final notes are released (and
+   * closed in the take) before stopRecording() collects it.
    */
   const flushRepeat = useCallback(() => {
     soundingNotesRef.current.forEach(note => {
@@ -209,9 +209,11 @@ export function useSequencer({ channel, gridRef }: UseSequencerOptions) {
   );
 
   // ── Recording event push (called by Player on pad touch) ─────────────────
+  // Notes are played and recorded natively; these also keep the visualizer
+  // in step with what the user is playing.
 
   const pushNoteOn = useCallback(
-    (note: number, velocity: number, duration?: number) => {
+    (note: number, velocity: number, duration?: number, gridTime?: number) => {
       const arr = visualNotesRef.current;
       // Use fresh performance.now()-based time instead of the stale
       // SharedValue (~16ms behind). This ensures all notes triggered in
@@ -236,15 +238,9 @@ export function useSequencer({ channel, gridRef }: UseSequencerOptions) {
         }
       }
 
-      // Pass the snapped startTime to the recording so committed sequences
-      // are grid-aligned (no wall-clock RAF jitter).
-      sequencer.pushRecordEvent(
-        channel,
-        'noteOn',
-        note,
-        velocity,
-        duration != null ? startTime : undefined,
-      );
+      // Note-repeat hits are recorded at their grid line, not when the RAF
+      // tick that fired them ran, so committed sequences stay grid-aligned.
+      sequencer.pushRecordEvent(channel, 'noteOn', note, velocity, gridTime);
 
       const vn: VisualNote = {
         id: ++noteIdRef.current,
@@ -260,29 +256,11 @@ export function useSequencer({ channel, gridRef }: UseSequencerOptions) {
   );
 
   const pushNoteOff = useCallback(
-    (note: number) => {
+    (note: number, gridTime?: number) => {
       const endTime = sequencer.getCurrentMusicalMs(channel);
       const arr = visualNotesRef.current;
 
-      // Find the latest note for this pitch to get its predicted endTime
-      // (repeat mode) for grid-aligned recording.
-      let snappedEnd: number | undefined;
-      for (let i = arr.length - 1; i >= 0; i--) {
-        if (arr[i].note === note) {
-          if (arr[i].endTime != null) {
-            snappedEnd = arr[i].endTime!;
-          }
-          break;
-        }
-      }
-
-      sequencer.pushRecordEvent(
-        channel,
-        'noteOff',
-        note,
-        0,
-        snappedEnd,
-      );
+      sequencer.pushRecordEvent(channel, 'noteOff', note, 0, gridTime);
 
       // Close the visual note (only needed for non-repeat mode where
       // endTime is not predicted).
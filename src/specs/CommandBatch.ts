@@ -0,0 +1,179 @@
+// CommandBatch.ts
+// Loading the module is what installs the JSI binding used below
+import './NativeAudioModule';
+
+/**
+ * Packs engine commands into one ArrayBuffer and hands them to native code
+ * in a single call. A chord, a pattern step or a knob sweep across several
+ * channels then costs one trip into native code instead of one per command,
+ * and nothing on the way is a string.
+ *
+ * The layout mirrors native/audio/CommandBatch.h: 16 bytes per record,
+ * little-endian. Keep the two in step.
+ *
+ *   const batch = new CommandBatch();
+ *   batch.noteOn(1, 60, 0.8).noteOn(1, 64, 0.8).noteOff(1, 60, 250);
+ *   batch.submit();
+ */
+
+const RECORD_SIZE = 16;
+
+export const BatchOp = {
+  NoteOn: 1,
+  NoteOff: 2,
+  AllNotesOff: 3,
+  SetVolume: 4,
+  SetPan: 5,
+  SetDetune: 6,
+  SetWaveform: 7,
+  SetEffectEnabled: 8,
+  SetEffectParameter: 9,
+  SetSendLevel: 10,
+  StartTransport: 11,
+  StopTransport: 12,
+} as const;
+
+export const BatchWaveform = {
+  sine: 0,
+  saw: 1,
+  square: 2,
+  triangle: 3,
+  wavetable: 4, // the channel's loaded wavetable (see loadWavetable)
+} as const;
+
+/** Numbering of Instrument::EffectParameter. */
+export const BatchEffectParameter = {
+  roomSize: 1,
+  damping: 2,
+  wetLevel: 3,
+  dryLevel: 4,
+  width: 5,
+  delayTime: 6,
+  feedback: 7,
+  cutoff: 8,
+  resonance: 9,
+  type: 10,
+  threshold: 11,
+  ratio: 12,
+  attack: 13,
+  release: 14,
+  makeupGain: 15,
+} as const;
+
+declare global {
+  // Installed by AudioModule's JSI bindings; count limits how many records are read
+  var __audioModuleSubmitBatch: ((buffer: ArrayBuffer, count?: number) => number) | undefined;
+}
+
+/**
+ * Apply packed records in order. Returns how many were applied (invalid ones
+ * are skipped), or -1 if the engine isn't available.
+ */
+export function submitBatch(buffer: ArrayBuffer, count?: number): number {
+  const submit = global.__audioModuleSubmitBatch;
+  return submit ? submit(buffer, count) : -1;
+}
+
+export class CommandBatch {
+  private buffer: ArrayBuffer;
+  private view: DataView;
+  private count = 0;
+
+  constructor(capacity = 64) {
+    this.buffer = new ArrayBuffer(Math.max(1, capacity) * RECORD_SIZE);
+    this.view = new DataView(this.buffer);
+  }
+
+  get length(): number {
+    return this.count;
+  }
+
+  /** delayMs schedules the note that far after submit() on the audio clock. */
+  noteOn(channel: number, note: number, velocity: number, delayMs = 0): this {
+    return this.push(BatchOp.NoteOn, channel, note, 0, velocity, delayMs);
+  }
+
+  noteOff(channel: number, note: number, delayMs = 0): this {
+    return this.push(BatchOp.NoteOff, channel, note, 0, 0, delayMs);
+  }
+
+  /** Channel 0 silences every channel. */
+  allNotesOff(channel = 0): this {
+    return this.push(BatchOp.AllNotesOff, channel, 0, 0, 0, 0);
+  }
+
+  setVolume(channel: number, volume: number): this {
+    return this.push(BatchOp.SetVolume, channel, 0, 0, volume, 0);
+  }
+
+  setPan(channel: number, pan: number): this {
+    return this.push(BatchOp.SetPan, channel, 0, 0, pan, 0);
+  }
+
+  setDetune(channel: number, cents: number): this {
+    return this.push(BatchOp.SetDetune, channel, 0, 0, cents, 0);
+  }
+
+  setWaveform(channel: number, waveform: keyof typeof BatchWaveform): this {
+    return this.push(BatchOp.SetWaveform, channel, BatchWaveform[waveform], 0, 0, 0);
+  }
+
+  setEffectEnabled(channel: number, effectId: number, enabled: boolean): this {
+    return this.push(BatchOp.SetEffectEnabled, channel, 0, effectId, enabled ? 1 : 0, 0);
+  }
+
+  setEffectParameter(channel: number, effectId: number,
+                     param: keyof typeof BatchEffectParameter, value: number): this {
+    return this.push(BatchOp.SetEffectParameter, channel, BatchEffectParameter[param], effectId, value, 0);
+  }
+
+  setSendLevel(channel: number, bus: number, level: number): this {
+    return this.push(BatchOp.SetSendLevel, channel, bus, 0, level, 0);
+  }
+
+  startTransport(): this {
+    return this.push(BatchOp.StartTransport, 0, 0, 0, 0, 0);
+  }
+
+  stopTransport(): this {
+    return this.push(BatchOp.StopTransport, 0, 0, 0, 0, 0);
+  }
+
+  /**
+   * Send everything packed so far and start over, keeping the buffer.
+   * Returns how many commands the engine applied.
+   */
+  submit(): number {
+    if (this.count === 0) {
+      return 0;
+    }
+    const applied = submitBatch(this.buffer, this.count);
+    this.count = 0;
+    return applied;
+  }
+
+  clear(): void {
+    this.count = 0;
+  }
+
+  private push(op: number, channel: number, index: number, effectId: number,
+               value: number, delayMs: number): this {
+    if ((this.count + 1) * RECORD_SIZE > this.buffer.byteLength) {
+      const grown = new ArrayBuffer(this.buffer.byteLength * 2);
+      new Uint8Array(grown).set(new Uint8Array(this.buffer));
+      this.buffer = grown;
+      this.view = new DataView(grown);
+    }
+
+    const offset = this.count * RECORD_SIZE;
+    this.view.setUint8(offset, op);
+    this.view.setUint8(offset + 1, channel);
+    this.view.setUint8(offset + 2, index);
+    this.view.setUint8(offset + 3, 0);
+    this.view.setInt32(offset + 4, effectId, true);
+    this.view.setFloat32(offset + 8, value, true);
+    this.view.setFloat32(offset + 12, delayMs, true);
+    this.count += 1;
+    return this;
+  }
+}
@@ -0,0 +1,103 @@
+// EngineTelemetry.ts
+// Loading the module is what installs the JSI binding used below
+import './NativeAudioModule';
+
+/**
+ * The engine's telemetry block, read straight from native memory: the audio
+ * thread rewrites it every block and reading it costs no native call, so
+ * worklets can poll it at display rate for playheads and pad glow.
+ *
+ *   const frame = useFrameCallback(() => {
+ *     const t = readTelemetry();
+ *     if (t) glow.value = t.channels[channel - 1].envelope;
+ *   });
+ *
+ * The layout mirrors native/audio/EngineTelemetry.h. Updates are guarded by
+ * a seqlock (word 0 is odd while the audio thread writes and changes with
+ * every update), so a read is retried when it overlaps a write.
+ */
+
+const LAYOUT_VERSION = 1;
+const HEADER_WORDS = 16;
+const CHANNEL_WORDS = 8;
+const MAX_READ_ATTEMPTS = 4;
+
+export type ChannelTelemetry = {
+  heldNotes: number[]; // 4 words of 32 bits: note n is bit n % 32 of word n / 32
+  voices: number; // voices sounding, release tails included
+  envelope: number; // loudest voice envelope, 0-1
+};
+
+export type Telemetry = {
+  playing: boolean;
+  transportPositionMs: number; // at the start of the newest block
+  presentationTimeMs: number; // host time (getHostTimeNs() / 1e6) that position is heard
+  sampleRate: number;
+  channels: ChannelTelemetry[]; // index 0 is channel 1
+};
+
+declare global {
+  // A JSI HostObject installed by AudioModule; each runtime gets its own view
+  var __audioModuleTelemetry: { readonly buffer: ArrayBuffer } | undefined;
+}
+
+const host = global.__audioModuleTelemetry;
+
+/** The raw block (shared with the audio thread; never write to it). */
+export function getTelemetryBuffer(): ArrayBuffer | null {
+  'worklet';
+  return host ? host.buffer : null;
+}
+
+/** A consistent copy of the newest update, or null if none could be taken. */
+export function readTelemetry(): Telemetry | null {
+  'worklet';
+  const buffer = host ? host.buffer : null;
+  if (!buffer) return null;
+
+  const words = new Uint32Array(buffer);
+  if (words[1] !== LAYOUT_VERSION) return null;
+  const floats = new Float32Array(buffer);
+  const doubles = new Float64Array(buffer);
+
+  for (let attempt = 0; attempt < MAX_READ_ATTEMPTS; attempt++) {
+    const before = words[0];
+    if (before & 1) continue;
+
+    const numChannels = words[2];
+    const channels: ChannelTelemetry[] = [];
+    for (let c = 0; c < numChannels; c++) {
+      const base = HEADER_WORDS + c * CHANNEL_WORDS;
+      channels.push({
+        heldNotes: [words[base], words[base + 1], words[base + 2], words[base + 3]],
+        voices: words[base + 4],
+        envelope: floats[base + 5],
+      });
+    }
+    const result: Telemetry = {
+      playing: (words[3] & 1) !== 0,
+      transportPositionMs: doubles[2],
+      presentationTimeMs: doubles[3],
+      sampleRate: floats[8],
+      channels,
+    };
+
+    if (words[0] === before) return result;
+  }
+  return null;
+}
+
+export function isNoteHeld(channel: ChannelTelemetry, note: number): boolean {
+  'worklet';
+  return (channel.heldNotes[note >> 5] & (1 << (note & 31))) !== 0;
+}
+
+/**
+ * The transport position being heard at hostTimeMs (e.g. workletHostTimeNs() / 1e6),
+ * moved on from the newest block; 0 while stopped.
+ */
+export function heardPositionMs(telemetry: Telemetry, hostTimeMs: number): number {
+  'worklet';
+  if (!telemetry.playing) return 0;
+  return Math.max(0, telemetry.transportPositionMs + hostTimeMs - telemetry.presentationTimeMs);
+}
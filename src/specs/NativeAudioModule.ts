@@ -2,6 +2,24 @@
 import type { TurboModule } from 'react-native';
 import { TurboModuleRegistry } from 'react-native';
 
+export type BlockTiming = {
+  count: number;
+  meanMicros: number;
+  p99Micros: number;
+  maxMicros: number;
+};
+
+/** dB and LUFS values bottom out at -120. */
+export type MeterReadings = {
+  peakDb: number;         // sample peak, falling back 20 dB/s
+  truePeakDb: number;     // 4x oversampled peak (dBTP), falling back likewise
+  maxTruePeakDb: number;  // highest true peak since resetLoudness()
+  rmsDb: number;          // last 300 ms
+  momentaryLufs: number;  // last 400 ms, K-weighted
+  shortTermLufs: number;  // last 3 s
+  integratedLufs: number; // gated (EBU R128), since resetLoudness()
+};
+
 export interface Spec extends TurboModule {
   // ────────────────────────────────────────────────
   // Instrument Management
@@ -13,6 +31,15 @@ export interface Spec extends TurboModule {
   // Create multi-sampler instrument
   createMultiSamplerInstrument(channel: number, name: string, polyphony: number): void;
   
+  /**
+   * Change a playing channel's instrument without a click: the new one is
+   * built in the background and crossfaded in over crossfadeMs (20 is a good
+   * default). The channel keeps its effects (oscillator) or samples (sampler)
+   * when the type stays the same.
+   */
+  swapOscillatorInstrument(channel: number, name: string, polyphony: number, waveform: string, crossfadeMs: number): void;
+  swapMultiSamplerInstrument(channel: number, name: string, polyphony: number, crossfadeMs: number): void;
+  
   // Remove instruments
   removeInstrument(channel: number): void;
   clearAllInstruments(): void;
@@ -80,6 +107,72 @@ export interface Spec extends TurboModule {
   allNotesOff(channel: number): void;
   allNotesOffAllChannels(): void;
 
+  // Many commands at once (chords, pattern steps, parameter sweeps) are
+  // cheaper packed into one ArrayBuffer with CommandBatch (./CommandBatch.ts),
+  // which goes through a JSI binding because codegen can't pass ArrayBuffers.
+  // Pads driven from gesture worklets can trigger notes on the UI thread
+  // with WorkletNotes (./WorkletNotes.ts), skipping the JS thread entirely.
+
+  // ────────────────────────────────────────────────
+  // Sample-accurate scheduling
+  // ────────────────────────────────────────────────
+
+  /**
+   * Schedule a note at an absolute host time. The engine places it on the
+   * exact sample inside the audio block that covers that time; events
+   * scheduled further ahead wait on the audio thread instead of being dropped.
+   * @param hostTimeNs Time on the getHostTimeNs() clock, in nanoseconds
+   */
+  scheduleNoteOn(channel: number, midiNote: number, velocity: number, hostTimeNs: number): void;
+  scheduleNoteOff(channel: number, midiNote: number, hostTimeNs: number): void;
+
+  /**
+   * Play a note now, but have a recording channel capture it at
+   * recordHostTimeNs instead (e.g. a note-repeat hit on the grid line it
+   * fired a frame after).
+   */
+  noteOnRecordedAt(channel: number, midiNote: number, velocity: number, recordHostTimeNs: number): void;
+  noteOffRecordedAt(channel: number, midiNote: number, recordHostTimeNs: number): void;
+
+  /**
+   * Current time on the engine's scheduling clock, in nanoseconds.
+   * Exact as a JS number for ~104 days of uptime.
+   */
+  getHostTimeNs(): number;
+
+  // ────────────────────────────────────────────────
+  // Loop Sequencer (runs on the audio thread)
+  // ────────────────────────────────────────────────
+
+  /**
+   * Upload a channel's loop in one call. Events are packed as
+   * [timestampMs, isNoteOn (1/0), midiNote, velocity] per event; the engine
+   * plays them sample-accurately and restarts the loop every durationMs.
+   */
+  setSequence(channel: number, events: Array<number>, durationMs: number): void;
+  clearSequence(channel: number): void;
+
+  sequencerPlay(): void;
+  sequencerStop(): void;
+
+  /** Capture live notes on a channel using the audio clock. */
+  startRecording(channel: number): void;
+  /** Returns the take packed like setSequence(), loop-aligned in ms. */
+  stopRecording(channel: number): Array<number>;
+
+  /**
+   * Poll once per frame: [transportPositionMs, heardPositionMs, outputLatencyMs,
+   * then per event channel, type (0 = noteOn, 1 = noteOff, 2 = loop wrap,
+   * 3 = live noteOn, 4 = live noteOff), midiNote, velocity, delayMs] for
+   * everything played since the previous poll.
+   *
+   * transportPositionMs is where the audio thread has rendered to;
+   * heardPositionMs is the part coming out of the speaker now, outputLatencyMs
+   * behind. delayMs is how long after this call the event is heard (negative
+   * if it already was), so visuals keyed to now + delayMs match the sound.
+   */
+  pollSequencer(): Array<number>;
+
   // ────────────────────────────────────────────────
   // Common Parameters (work for both instrument types)
   // ────────────────────────────────────────────────
@@ -93,6 +186,14 @@ export interface Spec extends TurboModule {
   setWaveform(channel: number, type: string): void;
   setDetune(channel: number, cents: number): void;
 
+  /**
+   * Play a single-cycle wavetable file (WAV, AIFF, ...) on an oscillator
+   * channel, crossfading to it like swapOscillatorInstrument. The waveform
+   * becomes 'wavetable', which setWaveform can switch away from and back to.
+   * Returns false if the channel isn't an oscillator or the file can't be used.
+   */
+  loadWavetable(channel: number, filePath: string, crossfadeMs: number): boolean;
+
   // ────────────────────────────────────────────────
   // Effects Management (Oscillator only)
   // ────────────────────────────────────────────────
@@ -102,10 +203,228 @@ export interface Spec extends TurboModule {
   setEffectEnabled(channel: number, effectId: number, enabled: boolean): void;
   setEffectParameter(channel: number, effectId: number, paramName: string, value: number): void;
 
+  /**
+   * Key an effect from another channel's output (before its volume and pan),
+   * e.g. a compressor on a bass ducking under the kick. sourceChannel 0 uses
+   * the effect's own input again. Returns false for an unknown effect or a
+   * route that would loop back to this channel. Compressor parameters:
+   * threshold (dB), ratio, attack and release (ms), makeup (dB).
+   */
+  setEffectSidechain(channel: number, effectId: number, sourceChannel: number): boolean;
+
+  // ────────────────────────────────────────────────
+  // Send/Return Buses (effects shared by all channels)
+  // ────────────────────────────────────────────────
+
+  /**
+   * Put an effect on a shared bus (1-4), replacing any it had. Channels feed
+   * it with setSendLevel and its output returns to the mix ahead of the
+   * master bus, so one reverb serves every channel. A bus reverb starts with
+   * no dry signal and a bus delay fully wet. Returns false for an unknown bus
+   * or effect type.
+   */
+  setSendBusEffect(bus: number, type: string): boolean;
+  clearSendBusEffect(bus: number): void;
+  setSendBusParameter(bus: number, paramName: string, value: number): void;
+  setSendBusReturnLevel(bus: number, level: number): void;  // 0-1, default 1
+  setSendLevel(channel: number, bus: number, level: number): void;  // post volume/pan, 0-1
+
   // ────────────────────────────────────────────────
   // Global Controls
   // ────────────────────────────────────────────────
   setMasterVolume(volume: number): void;
+
+  /**
+   * Render channels on this many extra worker threads (0 = audio thread only).
+   * Output is identical either way; this only spreads the CPU load.
+   */
+  setRenderThreadCount(count: number): void;
+
+  /**
+   * Render internally in fixed blocks of this many frames (16-1024) whatever
+   * block size the device picks; 0 follows the device. Restarts the device.
+   */
+  setProcessingQuantum(frames: number): void;
+  getProcessingQuantum(): number;
+
+  /**
+   * Silence tracking: channels and effects skipped in the last block because
+   * they had nothing to play, plus running totals since the engine started.
+   */
+  getBypassStats(): {
+    channelsRendered: number;
+    channelsBypassed: number;
+    effectsBypassed: number;
+    totalBlocks: number;
+    totalChannelsBypassed: number;
+    totalEffectsBypassed: number;
+  };
+
+  /**
+   * CPU time spent per block, in microseconds: the whole callback, each
+   * channel's render, each effect and each send bus effect. Each timing has count, mean, p99 and max.
+   * overruns counts callbacks that took longer than their block; xruns are
+   * dropouts reported by the device.
+   */
+  getPerformanceStats(): {
+    budgetMicros: number;
+    loadPercent: number;
+    overruns: number;
+    xruns: number;
+    callback: BlockTiming;
+    channels: Array<{
+      channel: number;
+      render: BlockTiming;
+      effects: Array<{
+        effectId: number;
+        type: string;
+        enabled: boolean;
+        timing: BlockTiming;
+      }>;
+    }>;
+    sendBuses: Array<{
+      bus: number;
+      type: string;
+      timing: BlockTiming;
+    }>;
+  };
+  resetPerformanceStats(): void;
+
+  /**
+   * Allocations, frees and locks caught on the audio thread since start.
+   * Only debug builds check (enabled is false otherwise); recent describes
+   * the latest ones with their stacks.
+   */
+  getRealtimeViolations(): {
+    enabled: boolean;
+    allocations: number;
+    deallocations: number;
+    locks: number;
+    recent: string[];
+  };
+
+  // ────────────────────────────────────────────────
+  // Metering
+  // ────────────────────────────────────────────────
+
+  // Held notes, voice counts, envelopes and the transport position can also
+  // be read without a call at all, from worklets too: see EngineTelemetry.ts.
+
+  /**
+   * Levels of each channel with an instrument (after volume and pan) and of
+   * the master output. Measured on the audio thread every block whether or
+   * not anyone asks, so polling at display rate costs the audio nothing and
+   * never blocks it. blocks stops moving while no audio is rendered.
+   */
+  getMeters(): {
+    blocks: number;
+    master: MeterReadings;
+    channels: Array<MeterReadings & { channel: number }>;
+  };
+  resetLoudness(): void;
+
+  // ────────────────────────────────────────────────
+  // Spectrum and Oscilloscope
+  // ────────────────────────────────────────────────
+
+  /**
+   * Analyse a channel's output (1-16, after volume and pan) or the master
+   * output (0). Attach when a view starts drawing and detach when it goes
+   * away: signals nobody is attached to are neither copied off the audio
+   * thread nor analysed. Returns false for a bad channel.
+   */
+  attachAnalyzer(channel: number): boolean;
+  detachAnalyzer(channel: number): void;
+
+  // Frames are read into Float32Arrays with readAnalyzerFrame(), below.
+
+  // ────────────────────────────────────────────────
+  // Master Bus (gain -> EQ -> compressor -> lookahead limiter)
+  // ────────────────────────────────────────────────
+  setMasterEqBand(band: string, frequency: number, gainDb: number, q: number): void;  // 'lowShelf' | 'peak' | 'highShelf'
+  setMasterEqEnabled(enabled: boolean): void;
+  setMasterCompressor(thresholdDb: number, ratio: number, attackMs: number, releaseMs: number, makeupDb: number): void;
+  setMasterCompressorEnabled(enabled: boolean): void;
+  setMasterLimiter(ceilingDb: number, releaseMs: number): void;  // on by default at -1 dB
+  setMasterLimiterEnabled(enabled: boolean): void;
+
+  /**
+   * How far the master output lags the mix (the limiter's lookahead; 0 when
+   * the limiter is off). Add this to output latency when lining up visuals.
+   */
+  getMasterLatency(): {
+    samples: number;
+    ms: number;
+  };
+
+  /** Deepest limiter gain reduction in the last block, in dB (0 or negative). */
+  getMasterGainReduction(): number;
+
+  // ────────────────────────────────────────────────
+  // Session Snapshots
+  // ────────────────────────────────────────────────
+
+  /**
+   * Write every channel, effect, sample and sequence plus the master bus to
+   * a binary file. Loading maps the sample data instead of decoding it, so
+   * even large sampler sessions reopen in milliseconds. Both return false
+   * on failure; a failed load leaves the current session as it was.
+   */
+  saveSnapshot(path: string): boolean;
+  loadSnapshot(path: string): boolean;
+}
+
+export default TurboModuleRegistry.getEnforcing<Spec>('AudioModule');
+
+// ────────────────────────────────────────────────
+// Analyzer frames (JSI, outside the spec: codegen has no typed arrays)
+// ────────────────────────────────────────────────
+
+export const ANALYZER_SPECTRUM_BINS = 128;
+export const ANALYZER_SCOPE_LENGTH = 256;
+
+declare global {
+  // Installed by AudioModule's JSI bindings; fills `into` as
+  // [sampleRate, ...spectrum, ...scope] and returns the frame number
+  var __audioModuleReadAnalyzerFrame: ((channel: number, into: Float32Array) => number) | undefined;
 }
 
-export default TurboModuleRegistry.getEnforcing<Spec>('AudioModule');
\ No newline at end of file
+/**
+ * A reusable frame. spectrum is 128 dB values (floor -120) for log-spaced
+ * bands from 20 Hz to 20 kHz; scope is 256 points covering the last 1024
+ * samples. Both are views into one Float32Array that readAnalyzerFrame()
+ * overwrites in place.
+ */
+export type AnalyzerFrame = {
+  frame: number; // 0 until the first one is ready, counts up after that
+  sampleRate: number;
+  spectrum: Float32Array;
+  scope: Float32Array;
+  data: Float32Array;
+};
+
+export function createAnalyzerFrame(): AnalyzerFrame {
+  const data = new Float32Array(1 + ANALYZER_SPECTRUM_BINS + ANALYZER_SCOPE_LENGTH);
+  return {
+    frame: 0,
+    sampleRate: 0,
+    spectrum: data.subarray(1, 1 + ANALYZER_SPECTRUM_BINS),
+    scope: data.subarray(1 + ANALYZER_SPECTRUM_BINS),
+    data,
+  };
+}
+
+/**
+ * Copy a channel's (or the master's, 0) newest frame, refreshed up to 60
+ * times a second, into `frame`. Returns false, leaving it as it was, if there
+ * is none yet or the engine isn't available.
+ */
+export function readAnalyzerFrame(channel: number, frame: AnalyzerFrame): boolean {
+  const read = global.__audioModuleReadAnalyzerFrame;
+  const number = read ? read(channel, frame.data) : 0;
+  if (number === 0) return false;
+
+  frame.frame = number;
+  frame.sampleRate = frame.data[0];
+  return true;
+}
@@ -0,0 +1,46 @@
+// WorkletNotes.ts
+// Loading the module is what installs the JSI binding used below
+import './NativeAudioModule';
+
+/**
+ * Note triggers callable from Reanimated / gesture-handler worklets, so a
+ * pad can sound from the UI thread without waiting for the JS thread:
+ *
+ *   const tap = Gesture.Tap()
+ *     .onBegin(() => { workletNoteOn(channel, note, 0.85); })
+ *     .onFinalize(() => { workletNoteOff(channel, note); });
+ *
+ * Notes go into the engine's lock-free command queue stamped with the host
+ * time of the call (or the hostTimeNs given, on the getHostTimeNs() clock).
+ * Each returns false if the engine isn't there or an argument isn't a number.
+ * They also work from the JS thread.
+ */
+
+type WorkletNotes = {
+  noteOn(channel: number, note: number, velocity: number, hostTimeNs?: number): boolean;
+  noteOff(channel: number, note: number, hostTimeNs?: number): boolean;
+  getHostTimeNs(): number;
+};
+
+declare global {
+  // A JSI HostObject installed by AudioModule; worklets capture it as is
+  var __audioModuleWorkletNotes: WorkletNotes | undefined;
+}
+
+const notes = global.__audioModuleWorkletNotes;
+
+export function workletNoteOn(channel: number, note: number, velocity: number, hostTimeNs?: number): boolean {
+  'worklet';
+  return notes ? notes.noteOn(channel, note, velocity, hostTimeNs) : false;
+}
+
+export function workletNoteOff(channel: number, note: number, hostTimeNs?: number): boolean {
+  'worklet';
+  return notes ? notes.noteOff(channel, note, hostTimeNs) : false;
+}
+
+/** The engine's scheduling clock, in nanoseconds. */
+export function workletHostTimeNs(): number {
+  'worklet';
+  return notes ? notes.getHostTimeNs() : 0;
+}